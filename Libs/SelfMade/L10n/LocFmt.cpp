@@ -6,6 +6,9 @@ template class loc::Fmt<char8_t>;
 template class loc::FmtL<char>;
 template class loc::FmtL<wchar_t>;
 template class loc::FmtL<char8_t>;
+template class loc::Tmpl<char>;
+template class loc::Tmpl<wchar_t>;
+template class loc::Tmpl<char8_t>;
 
 constinit const loc::DefaultQtyRule loc::DefaultQtyRule::INST;
 constinit const loc::DefaultLocale loc::DefaultLocale::INST;
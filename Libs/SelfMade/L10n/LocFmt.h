@@ -6,6 +6,10 @@
 #include <cstdint>
 
 // STL
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <span>
 #include <string>
 #include <vector>
 #include <tuple>
@@ -832,3 +836,668 @@ QString loc::Fmt<Ch>::q() const
     }
 }
 #endif
+
+
+///// Precompiled templates ////////////////////////////////////////////////////
+
+namespace loc {
+
+    ///
+    ///  Fmt parses its template and links substitutions every time it is
+    ///    constructed: OK for a message box, slow for UI loops.
+    ///  Precompiled template is parsed once into pieces, and formatting
+    ///    just appends them to output buffer.
+    ///  • Tmpl<Ch> — parsed at run time, for strings loaded from files
+    ///  • tmpl<u8"…"> — parsed at compile time, for literals
+    ///  Results are the same as Fmt’s: {{ escape, {1}/{} keys, plural forms
+    ///    with the same fallbacks, unfilled substitutions are left as is.
+    ///  Plural fallbacks are resolved on parsing too: form of each Plural
+    ///    is known beforehand.
+    ///
+
+    enum class TmplKind : unsigned char {
+        TEXT,       ///< piece of pool
+        ARG,        ///< substitution, its form pieces follow
+        NUMBER      ///< # in plural form: {1|one=# file}
+    };
+
+    struct TmplPiece {
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+        TmplKind kind = TmplKind::TEXT;
+        uint32_t start = 0, length = 0;  ///< TEXT: piece of pool
+                                         ///< ARG: raw substitution, used if no such argument
+        uint32_t key = 0;           ///< ARG: 0-based, {1} = 0
+        uint32_t iPlurals = NONE;   ///< ARG: index in plurals; [NONE] just substitute
+        uint32_t nInner = 0;        ///< ARG: # of form pieces right after it
+    };
+
+    /// Range of pieces; [start = NONE] no form, just substitute
+    struct TmplForm {
+        uint32_t start = TmplPiece::NONE, length = 0;
+    };
+
+    /// Form for each Plural, fallbacks resolved
+    struct TmplPlurals {
+        TmplForm of[Plural_N_Full];
+    };
+
+    template <Char Ch>
+    struct TmplView {
+        std::span<const TmplPiece> pieces;
+        std::span<const TmplPlurals> plurals;
+        std::basic_string_view<Ch> pool;
+    };
+
+    ///
+    ///  Argument of template, made on stack right in formatting call;
+    ///    strings are not copied.
+    ///
+    template <Char Ch>
+    class TmplArg
+    {
+    public:
+        using Sv = std::basic_string_view<Ch>;
+
+        TmplArg() noexcept = default;
+        TmplArg(const Ch& x) noexcept : fStr(&x, 1) {}
+        TmplArg(Sv x) noexcept : fStr(x) {}
+        TmplArg(const Ch* x) noexcept : fStr(x) {}
+        TmplArg(const std::basic_string<Ch>& x) noexcept : fStr(x) {}
+        template <std::integral T> requires (!std::is_same_v<T, Ch> && !std::is_same_v<T, bool>)
+            TmplArg(T x) noexcept;
+        template <std::integral T>
+            TmplArg(const PreformN<Ch, T>& x) noexcept : fStr(x.str) { setValue(x.val); }
+
+        bool isNumber() const noexcept { return (fType != Type::STR); }
+        Plural plural(const PluralRule& rule) const;
+        void appendTo(std::basic_string<Ch>& r) const;
+    private:
+        enum class Type : unsigned char { STR, SIGNED, UNSIGNED };
+        Type fType = Type::STR;
+        unsigned char fNDigits = 0;   ///< [0] fStr is used: string or preformatted number
+        char fDigits[std::numeric_limits<unsigned long long>::digits10 + 3];
+        Sv fStr;
+        unsigned long long fValue = 0;
+
+        template <std::integral T>
+            void setValue(T x) noexcept;
+    };
+
+    namespace detail {
+
+        struct TmplSizes {
+            uint32_t pool = 0, pieces = 0, plurals = 0;
+        };
+
+        /// Plural of key, as Fmt does: names of all Plural’s
+        /// @return [BAD] not a plural key
+        template <Char Ch>
+        constexpr Plural pluralOfKey(std::basic_string_view<Ch> x) noexcept;
+
+        /// Calls f(plural, rawValue) for key=value pairs of substitution
+        ///   that have plural keys, in order
+        template <Char Ch, class F>
+        constexpr void forEachTmplKv(std::basic_string_view<Ch> inner, const F& f);
+
+        /// @return  # of plural key=value pair that serves plural,
+        ///          with Fmt’s fallbacks; [NONE] just substitute
+        template <Char Ch>
+        constexpr uint32_t tmplFormOf(std::basic_string_view<Ch> inner, Plural plural);
+
+        /// Parses template into sink: TmplCounter, then TmplWriter
+        template <Char Ch, class Sink>
+        constexpr void parseTmpl(std::basic_string_view<Ch> x, Sink& sink);
+
+        /// Sink that just counts sizes
+        class TmplCounter
+        {
+        public:
+            TmplSizes sizes;
+
+            template <class Sv> constexpr void addText(Sv x)
+                { sizes.pool += x.length();  ++sizes.pieces; }
+            template <class Sv> constexpr void extendText(Sv x)
+                { sizes.pool += x.length(); }
+            template <class Sv> constexpr uint32_t addArg(uint32_t, Sv raw)
+                { sizes.pool += raw.length();  return sizes.pieces++; }
+            constexpr void addNumber() { ++sizes.pieces; }
+            constexpr void setPlurals(uint32_t, const TmplPlurals&, uint32_t)
+                { ++sizes.plurals; }
+            constexpr uint32_t nPieces() const { return sizes.pieces; }
+        };
+
+        /// Sink that writes into storage of TmplCounter’s sizes
+        template <Char Ch>
+        class TmplWriter
+        {
+        public:
+            using Sv = std::basic_string_view<Ch>;
+            constexpr TmplWriter(Ch* aPool, TmplPiece* aPieces, TmplPlurals* aPlurals)
+                : pool(aPool), pieces(aPieces), plurals(aPlurals) {}
+
+            constexpr void addText(Sv x);
+            constexpr void extendText(Sv x);
+            constexpr uint32_t addArg(uint32_t key, Sv raw);
+            constexpr void addNumber()
+                { pieces[fNPieces++] = { .kind = TmplKind::NUMBER }; }
+            constexpr void setPlurals(uint32_t iArg, const TmplPlurals& x, uint32_t nInner);
+            constexpr uint32_t nPieces() const { return fNPieces; }
+        private:
+            Ch* pool;
+            TmplPiece* pieces;
+            TmplPlurals* plurals;
+            uint32_t fNPool = 0, fNPieces = 0, fNPlurals = 0;
+
+            constexpr uint32_t putPool(Sv x);
+        };
+
+        template <Char Ch>
+        constexpr TmplSizes measureTmpl(std::basic_string_view<Ch> x)
+        {
+            TmplCounter counter;
+            parseTmpl(x, counter);
+            return counter.sizes;
+        }
+
+        template <Char Ch>
+        void appendTmpl(const TmplView<Ch>& tmpl, const Locale& lc,
+                        std::basic_string<Ch>& r, std::span<const TmplArg<Ch>> args);
+
+    }   // namespace detail
+
+    ///
+    ///  Formatting functions of precompiled templates
+    ///  Me should have view()
+    ///
+    template <class Me, Char Ch>
+    class TmplBase
+    {
+    public:
+        using Str = std::basic_string<Ch>;
+
+        /// Appends formatted string to r, default locale (as Fmt)
+        template <class... Args>
+        void append(Str& r, const Args&... args) const
+            { append(DefaultLocale::INST, r, args...); }
+
+        template <class... Args>
+        void append(const Locale& lc, Str& r, const Args&... args) const
+        {
+            // +1: no zero-size arrays
+            const TmplArg<Ch> a[sizeof...(Args) + 1] { TmplArg<Ch>(args)..., TmplArg<Ch>() };
+            detail::appendTmpl<Ch>(static_cast<const Me&>(*this).view(), lc, r,
+                                   std::span<const TmplArg<Ch>>(a, sizeof...(Args)));
+        }
+
+        template <class... Args>
+                requires (!(std::is_base_of_v<Locale, Args> || ...))
+        Str str(const Args&... args) const
+            { Str r;  append(r, args...);  return r; }
+
+        template <class... Args>
+        Str str(const Locale& lc, const Args&... args) const
+            { Str r;  append(lc, r, args...);  return r; }
+    };
+
+    ///
+    ///  Template parsed at run time
+    ///
+    template <Char Ch>
+    class Tmpl : public TmplBase<Tmpl<Ch>, Ch>
+    {
+    public:
+        using Str = std::basic_string<Ch>;
+        using Sv = std::basic_string_view<Ch>;
+        Tmpl() = default;
+        Tmpl(Sv x);
+        Tmpl(const Str& x) : Tmpl(Sv{x}) {}
+        Tmpl(const Ch* x) : Tmpl(Sv{x}) {}
+
+        TmplView<Ch> view() const noexcept
+            { return { .pieces = pieces, .plurals = plurals, .pool = pool }; }
+    private:
+        Str pool;
+        std::vector<TmplPiece> pieces;
+        std::vector<TmplPlurals> plurals;
+    };
+
+    template <class Ch> Tmpl(std::basic_string<Ch>) -> Tmpl<Ch>;
+    template <class Ch> Tmpl(std::basic_string_view<Ch>) -> Tmpl<Ch>;
+    template <class Ch> Tmpl(const Ch*) -> Tmpl<Ch>;
+
+    /// String literal as template parameter
+    template <Char Ch, size_t N>
+    struct TmplLiteral {
+        using CharType = Ch;
+        Ch data[N] {};
+
+        constexpr TmplLiteral(const Ch (&x)[N]) { std::copy_n(x, N, data); }
+        constexpr std::basic_string_view<Ch> sv() const { return { data, N - 1 }; }
+    };
+
+    ///
+    ///  Template parsed at compile time, storage is of exact size
+    ///
+    template <TmplLiteral L>
+    class StaticTmpl : public TmplBase<StaticTmpl<L>, typename decltype(L)::CharType>
+    {
+    public:
+        using Ch = typename decltype(L)::CharType;
+        consteval StaticTmpl();
+        StaticTmpl(const StaticTmpl&) = delete;
+        StaticTmpl& operator = (const StaticTmpl&) = delete;
+
+        constexpr TmplView<Ch> view() const noexcept
+        {
+            return { .pieces = pieces, .plurals = plurals,
+                     .pool = { pool.data(), pool.size() } };
+        }
+    private:
+        static constexpr detail::TmplSizes SIZES = detail::measureTmpl(L.sv());
+        std::array<Ch, SIZES.pool> pool {};
+        std::array<TmplPiece, SIZES.pieces> pieces {};
+        std::array<TmplPlurals, SIZES.plurals> plurals {};
+    };
+
+    /// Usage: loc::tmpl<u8"{1|one=# file|many=# files}">.str(n)
+    template <TmplLiteral L>
+    inline constexpr StaticTmpl<L> tmpl {};
+
+}   // namespace loc
+
+extern template class loc::Tmpl<char>;
+extern template class loc::Tmpl<wchar_t>;
+extern template class loc::Tmpl<char8_t>;
+
+
+///// TmplArg //////////////////////////////////////////////////////////////////
+
+template <loc::Char Ch> template <std::integral T>
+    requires (!std::is_same_v<T, Ch> && !std::is_same_v<T, bool>)
+loc::TmplArg<Ch>::TmplArg(T x) noexcept
+{
+    setValue(x);
+    auto q = std::to_chars(fDigits, fDigits + std::size(fDigits), x);
+    fNDigits = q.ptr - fDigits;
+}
+
+
+template <loc::Char Ch> template <std::integral T>
+void loc::TmplArg<Ch>::setValue(T x) noexcept
+{
+    if constexpr (std::is_signed_v<T>) {
+        fType = Type::SIGNED;
+        fValue = static_cast<unsigned long long>(static_cast<long long>(x));
+    } else {
+        fType = Type::UNSIGNED;
+        fValue = x;
+    }
+}
+
+
+template <loc::Char Ch>
+loc::Plural loc::TmplArg<Ch>::plural(const PluralRule& rule) const
+{
+    return (fType == Type::SIGNED)
+            ? rule.ofInt(static_cast<long long>(fValue))
+            : rule.ofUint(fValue);
+}
+
+
+template <loc::Char Ch>
+void loc::TmplArg<Ch>::appendTo(std::basic_string<Ch>& r) const
+{
+    if (fNDigits != 0) {
+        r.append(fDigits, fDigits + fNDigits);
+    } else {
+        r.append(fStr);
+    }
+}
+
+
+///// Template parser //////////////////////////////////////////////////////////
+
+template <loc::Char Ch>
+constexpr loc::Plural loc::detail::pluralOfKey(std::basic_string_view<Ch> x) noexcept
+{
+    // Fmt trims isBlank’s, but other blanks are bad characters for it
+    while (!x.empty() && x.front() == ' ')
+        x.remove_prefix(1);
+    while (!x.empty() && x.back() == ' ')
+        x.remove_suffix(1);
+    constexpr std::string_view names[Plural_N_Full] {
+        key::ZERO, key::ONE, key::TWO, key::FEW, key::MANY, key::OTHER,
+        key::A, key::B, key::C, key::D, key::REST };
+    for (unsigned i = 0; i < Plural_N_Full; ++i) {
+        auto name = names[i];
+        if (name.length() == x.length()
+                && std::equal(name.begin(), name.end(), x.begin()))
+            return static_cast<Plural>(i);
+    }
+    return Plural::BAD;
+}
+
+
+template <loc::Char Ch, class F>
+constexpr void loc::detail::forEachTmplKv(std::basic_string_view<Ch> inner, const F& f)
+{
+    constexpr auto NPOS = std::basic_string_view<Ch>::npos;
+    size_t start = 0;
+    size_t iEqual = NPOS;
+    auto processPart = [&](size_t end) {
+        if (iEqual == NPOS)
+            return;
+        auto plural = pluralOfKey(inner.substr(start, iEqual - start));
+        if (plural != Plural::BAD)
+            f(plural, inner.substr(iEqual + 1, end - iEqual - 1));
+    };
+    for (size_t i = 0; i < inner.length(); ++i) {
+        switch (inner[i]) {
+        case '=':   // Key-value delimiter
+            if (iEqual == NPOS)
+                iEqual = i;
+            break;
+        case '{':   // Escape
+            ++i;
+            break;
+        case '|':   // Pair delimiter
+            processPart(i);
+            start = i + 1;
+            iEqual = NPOS;
+            break;
+        default: ;
+        }
+    }
+    processPart(inner.length());
+}
+
+
+template <loc::Char Ch>
+constexpr uint32_t loc::detail::tmplFormOf(
+        std::basic_string_view<Ch> inner, Plural plural)
+{
+    constexpr auto NONE = TmplPiece::NONE;
+    constexpr auto REST = static_cast<unsigned>(Plural::REST);
+    constexpr auto OTHER = static_cast<unsigned>(Plural::OTHER);
+    const auto iPlural = static_cast<unsigned>(plural);
+    uint32_t exact = NONE;
+    uint32_t fallbacks[Plural_N_Full];
+    std::fill(std::begin(fallbacks), std::end(fallbacks), NONE);
+    bool hasFallback = false;
+    uint32_t i = 0;
+    forEachTmplKv(inner, [&](Plural key, std::basic_string_view<Ch>) {
+        if (exact == NONE) {
+            auto iKey = static_cast<unsigned>(key);
+            if (key == plural) {
+                exact = i;
+            } else if (iKey <= OTHER || iKey == REST) {  // what Fmt::parsePluralKey knows
+                fallbacks[iKey] = i;
+                hasFallback = true;
+            }
+        }
+        ++i;
+    });
+    if (exact != NONE)
+        return exact;
+    if (!hasFallback)
+        return NONE;
+    if (fallbacks[REST] != NONE)
+        return fallbacks[REST];
+    // Go forward
+    for (auto p = iPlural + 1; p <= OTHER; ++p)
+        if (fallbacks[p] != NONE)
+            return fallbacks[p];
+    // Go back
+    for (auto p = std::min(iPlural, REST); p > 0; ) { --p;
+        if (fallbacks[p] != NONE)
+            return fallbacks[p];
+    }
+    return NONE;
+}
+
+
+template <loc::Char Ch, class Sink>
+constexpr void loc::detail::parseTmpl(std::basic_string_view<Ch> x, Sink& sink)
+{
+    using Sv = std::basic_string_view<Ch>;
+    constexpr auto NONE = TmplPiece::NONE;
+    constexpr auto NPOS = Sv::npos;
+
+    // Unescaped text goes in chunks, and they are joined into one piece
+    bool isLastText = false;
+    auto text = [&sink, &isLastText](Sv chunk) {
+        if (chunk.empty())
+            return;
+        if (isLastText) {
+            sink.extendText(chunk);
+        } else {
+            sink.addText(chunk);
+        }
+        isLastText = true;
+    };
+
+    // Plural form: text and # = number
+    auto form = [&sink, &isLastText, &text](Sv value) {
+        isLastText = false;
+        size_t start = 0;
+        for (size_t i = 0; i < value.length(); ++i) {
+            switch (value[i]) {
+            case '{':   // Escape: next char goes to the next chunk
+                text(value.substr(start, i - start));
+                start = ++i;
+                break;
+            case '#':
+                text(value.substr(start, i - start));
+                sink.addNumber();
+                isLastText = false;
+                start = i + 1;
+                break;
+            default: ;
+            }
+        }
+        if (start < value.length())
+            text(value.substr(start));
+    };
+
+    uint32_t nextKey = 0;
+    size_t pos = 0;
+    while (true) {
+        auto p = x.find('{', pos);
+        if (p == NPOS || p + 1 >= x.length())
+            break;
+        if (x[p + 1] == '{') {
+            // {{ = escaped {
+            text(x.substr(pos, p + 1 - pos));
+            pos = p + 2;
+            continue;
+        }
+        // Find closing brace, {x is escape
+        size_t p1 = p + 1;
+        bool isFound = false;
+        for (; p1 < x.length(); ++p1) {
+            if (x[p1] == '{') {
+                ++p1;
+            } else if (x[p1] == '}') {
+                isFound = true;
+                break;
+            }
+        }
+        if (!isFound)
+            break;  // incomplete substitution → the rest is as is
+        text(x.substr(pos, p - pos));
+
+        // Key: digits up to | or }, otherwise next one
+        uint32_t key = 0;
+        for (size_t p2 = p + 1; p2 < p1; ++p2) {
+            auto c = x[p2];
+            if (c == '|')
+                break;
+            if (c < '0' || c > '9') {
+                key = 0;
+                break;
+            }
+            unsigned digit = c - '0';
+            key = key * 10u + digit;
+            if (key % 10u != digit) {   // overflow, as in Fmt
+                key = 0;
+                break;
+            }
+        }
+        key = (key == 0) ? nextKey : key - 1;
+        nextKey = key + 1;
+
+        auto iArg = sink.addArg(key, x.substr(p, p1 + 1 - p));
+        auto inner = x.substr(p + 1, p1 - p - 1);
+        TmplPlurals plurals {};
+        uint32_t iKv[Plural_N_Full];
+        bool hasForms = false;
+        for (unsigned i = 0; i < Plural_N_Full; ++i) {
+            iKv[i] = tmplFormOf(inner, static_cast<Plural>(i));
+            if (iKv[i] == NONE)
+                continue;
+            hasForms = true;
+            // Several plurals share a form?
+            for (unsigned j = 0; j < i; ++j) {
+                if (iKv[j] == iKv[i]) {
+                    plurals.of[i] = plurals.of[j];
+                    break;
+                }
+            }
+            if (plurals.of[i].start != NONE)
+                continue;
+            auto start = sink.nPieces();
+            uint32_t iCurr = 0;
+            forEachTmplKv(inner, [&](Plural, Sv value) {
+                if (iCurr++ == iKv[i])
+                    form(value);
+            });
+            plurals.of[i] = { .start = start, .length = sink.nPieces() - start };
+        }
+        if (hasForms)
+            sink.setPlurals(iArg, plurals, sink.nPieces() - iArg - 1);
+        isLastText = false;
+        pos = p1 + 1;
+    }
+    text(x.substr(pos));
+}
+
+
+template <loc::Char Ch>
+constexpr uint32_t loc::detail::TmplWriter<Ch>::putPool(Sv x)
+{
+    auto r = fNPool;
+    std::copy(x.begin(), x.end(), pool + fNPool);
+    fNPool += x.length();
+    return r;
+}
+
+
+template <loc::Char Ch>
+constexpr void loc::detail::TmplWriter<Ch>::addText(Sv x)
+{
+    auto start = putPool(x);
+    pieces[fNPieces++] = {
+            .kind = TmplKind::TEXT, .start = start,
+            .length = static_cast<uint32_t>(x.length()) };
+}
+
+
+template <loc::Char Ch>
+constexpr void loc::detail::TmplWriter<Ch>::extendText(Sv x)
+{
+    putPool(x);
+    pieces[fNPieces - 1].length += x.length();
+}
+
+
+template <loc::Char Ch>
+constexpr uint32_t loc::detail::TmplWriter<Ch>::addArg(uint32_t key, Sv raw)
+{
+    auto start = putPool(raw);
+    pieces[fNPieces] = {
+            .kind = TmplKind::ARG, .start = start,
+            .length = static_cast<uint32_t>(raw.length()), .key = key };
+    return fNPieces++;
+}
+
+
+template <loc::Char Ch>
+constexpr void loc::detail::TmplWriter<Ch>::setPlurals(
+        uint32_t iArg, const TmplPlurals& x, uint32_t nInner)
+{
+    plurals[fNPlurals] = x;
+    pieces[iArg].iPlurals = fNPlurals++;
+    pieces[iArg].nInner = nInner;
+}
+
+
+///// Template formatter ///////////////////////////////////////////////////////
+
+template <loc::Char Ch>
+void loc::detail::appendTmpl(
+        const TmplView<Ch>& tmpl, const Locale& lc,
+        std::basic_string<Ch>& r, std::span<const TmplArg<Ch>> args)
+{
+    auto& pieces = tmpl.pieces;
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        auto& piece = pieces[i];
+        switch (piece.kind) {
+        case TmplKind::TEXT:
+            r.append(tmpl.pool.substr(piece.start, piece.length));
+            break;
+        case TmplKind::ARG: {
+                if (piece.key >= args.size()) {
+                    // No argument → as is
+                    r.append(tmpl.pool.substr(piece.start, piece.length));
+                } else {
+                    auto& arg = args[piece.key];
+                    const TmplForm* form = nullptr;
+                    if (piece.iPlurals != TmplPiece::NONE && arg.isNumber()) {
+                        /// @todo [future] modes other than cardinal, as in Fmt
+                        auto iPlural = static_cast<unsigned char>(arg.plural(lc.cardinalRule()));
+                        if (iPlural < Plural_N_Full) {
+                            auto& q = tmpl.plurals[piece.iPlurals].of[iPlural];
+                            if (q.start != TmplPiece::NONE)
+                                form = &q;
+                        }
+                    }
+                    if (form) {
+                        for (auto& v : pieces.subspan(form->start, form->length)) {
+                            if (v.kind == TmplKind::NUMBER) {
+                                arg.appendTo(r);
+                            } else {
+                                r.append(tmpl.pool.substr(v.start, v.length));
+                            }
+                        }
+                    } else {
+                        arg.appendTo(r);
+                    }
+                }
+                i += piece.nInner;
+            } break;
+        case TmplKind::NUMBER: ;    // form pieces only, skipped
+        }
+    }
+}
+
+
+///// Tmpl, StaticTmpl /////////////////////////////////////////////////////////
+
+template <loc::Char Ch>
+loc::Tmpl<Ch>::Tmpl(Sv x)
+{
+    auto sizes = detail::measureTmpl(x);
+    pool.resize(sizes.pool);
+    pieces.resize(sizes.pieces);
+    plurals.resize(sizes.plurals);
+    detail::TmplWriter<Ch> writer(pool.data(), pieces.data(), plurals.data());
+    detail::parseTmpl(x, writer);
+}
+
+
+template <loc::TmplLiteral L>
+consteval loc::StaticTmpl<L>::StaticTmpl()
+{
+    detail::TmplWriter<Ch> writer(pool.data(), pieces.data(), plurals.data());
+    detail::parseTmpl(L.sv(), writer);
+}
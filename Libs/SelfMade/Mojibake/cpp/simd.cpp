@@ -0,0 +1,459 @@
+// My header
+#include "../internal/simd.hpp"
+
+// C++
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+    #define MJ_SIMD_X86
+    #define MJ_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+    #include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+    #define MJ_SIMD_X86
+    #define MJ_TARGET_AVX2
+    #include <immintrin.h>
+    #include <intrin.h>
+#endif
+
+namespace simd = mojibake::detail::simd;
+
+namespace {
+
+    using Byte = unsigned char;
+
+    constexpr bool isCont(Byte b) { return (b & 0xC0) == 0x80; }
+
+    ///// Scalar ///////////////////////////////////////////////////////////////
+
+    /// @return  length of valid code sequence at p, [0] bad or incomplete
+    inline int validCpLength(const Byte* p, const Byte* end)
+    {
+        Byte b = *p;
+        if (b < 0x80)
+            return 1;
+        auto rem = end - p;
+        if (b < 0xC2)   // continuation, or overlong C0/C1
+            return 0;
+        if (b < 0xE0)
+            return (rem >= 2 && isCont(p[1])) ? 2 : 0;
+        if (b < 0xF0) {
+            if (rem < 3 || !isCont(p[1]) || !isCont(p[2]))
+                return 0;
+            // E0 A0 = 800 (1st 3-byte), ED A0…BF = surrogates
+            unsigned cp = (b << 8) | p[1];
+            if (cp < 0xE0A0 || (cp >= 0xEDA0 && cp <= 0xEDBF))
+                return 0;
+            return 3;
+        }
+        if (b < 0xF5) {
+            if (rem < 4 || !isCont(p[1]) || !isCont(p[2]) || !isCont(p[3]))
+                return 0;
+            // F0 90 = 1'0000 (1st 4-byte), F4 8F = 10'FFFF (last Unicode)
+            unsigned cp = (b << 8) | p[1];
+            if (cp < 0xF090 || cp > 0xF48F)
+                return 0;
+            return 4;
+        }
+        return 0;
+    }
+
+    inline simd::ValidPrefix prefixScalar(const Byte* p, const Byte* end, size_t nCps)
+    {
+        while (p != end) {
+            auto len = validCpLength(p, end);
+            if (len == 0)
+                break;
+            p += len;
+            ++nCps;
+        }
+        return { reinterpret_cast<const char*>(p), nCps };
+    }
+
+    /// Decodes one code point, no checks
+    inline char32_t* decodeCp(const Byte*& p, char32_t* dest)
+    {
+        Byte b = *p;
+        if (b < 0x80) {
+            *dest = b;
+            p += 1;
+        } else if (b < 0xE0) {
+            *dest = ((b & 0x1F) << 6) | (p[1] & 0x3F);
+            p += 2;
+        } else if (b < 0xF0) {
+            *dest = ((b & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+            p += 3;
+        } else {
+            *dest = ((b & 0x07) << 18) | ((p[1] & 0x3F) << 12)
+                  | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+            p += 4;
+        }
+        return dest + 1;
+    }
+
+    simd::ValidPrefix validU8PrefixScalar(const char* p, const char* end) noexcept
+    {
+        return prefixScalar(reinterpret_cast<const Byte*>(p),
+                            reinterpret_cast<const Byte*>(end), 0);
+    }
+
+    char32_t* decodeValidU8Scalar(const char* p, const char* end, char32_t* dest) noexcept
+    {
+        auto q = reinterpret_cast<const Byte*>(p);
+        auto e = reinterpret_cast<const Byte*>(end);
+        while (q != e)
+            dest = decodeCp(q, dest);
+        return dest;
+    }
+
+#ifdef MJ_SIMD_X86
+
+    inline unsigned ctz(unsigned x)
+    {
+    #ifdef _MSC_VER
+        unsigned long r;
+        _BitScanForward(&r, x);
+        return r;
+    #else
+        return __builtin_ctz(x);
+    #endif
+    }
+
+    ///// SSE2 /////////////////////////////////////////////////////////////////
+
+    // SSE2 has no byte shuffle, so non-ASCII goes byte by byte;
+    // the gain is in Latin texts, markup and identifiers
+
+    simd::ValidPrefix validU8PrefixSse2(const char* p0, const char* end) noexcept
+    {
+        auto p = reinterpret_cast<const Byte*>(p0);
+        auto e = reinterpret_cast<const Byte*>(end);
+        size_t nCps = 0;
+        for (;;) {
+            // Skip ASCII
+            while (e - p >= 16) {
+                unsigned mask = _mm_movemask_epi8(
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+                if (mask != 0) {
+                    auto k = ctz(mask);
+                    p += k;
+                    nCps += k;
+                    break;
+                }
+                p += 16;
+                nCps += 16;
+            }
+            if (e - p < 16)
+                return prefixScalar(p, e, nCps);
+            // Non-ASCII run
+            do {
+                auto len = validCpLength(p, e);
+                if (len == 0)
+                    return { reinterpret_cast<const char*>(p), nCps };
+                p += len;
+                ++nCps;
+            } while (p != e && *p >= 0x80);
+        }
+    }
+
+    char32_t* decodeValidU8Sse2(const char* p0, const char* end, char32_t* dest) noexcept
+    {
+        auto p = reinterpret_cast<const Byte*>(p0);
+        auto e = reinterpret_cast<const Byte*>(end);
+        const auto zero = _mm_setzero_si128();
+        while (e - p >= 16) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(v) == 0) {
+                auto lo = _mm_unpacklo_epi8(v, zero);
+                auto hi = _mm_unpackhi_epi8(v, zero);
+                auto d = reinterpret_cast<__m128i*>(dest);
+                _mm_storeu_si128(d,     _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128(d + 1, _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128(d + 2, _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128(d + 3, _mm_unpackhi_epi16(hi, zero));
+                p += 16;
+                dest += 16;
+            } else {
+                // Decode the whole block, last CP may stick out
+                auto blockEnd = p + 16;
+                while (p < blockEnd)
+                    dest = decodeCp(p, dest);
+            }
+        }
+        while (p < e)
+            dest = decodeCp(p, dest);
+        return dest;
+    }
+
+    ///// AVX2 /////////////////////////////////////////////////////////////////
+
+    // Lookup validator by J. Keiser and D. Lemire,
+    // “Validating UTF-8 in less than one instruction per byte”, 2021.
+    // Three 16-entry tables classify pairs of (previous, current) byte
+    // by high nibble of previous, low nibble of previous, high nibble of current;
+    // bitwise AND of results is non-zero for bad pairs.
+    // 3rd and 4th bytes of sequence are checked separately.
+
+    constexpr Byte TOO_SHORT  = 1 << 0;     // 11______ 0_______, 11______ 11______
+    constexpr Byte TOO_LONG   = 1 << 1;     // 0_______ 10______
+    constexpr Byte OVERLONG_3 = 1 << 2;     // 11100000 100_____
+    constexpr Byte TOO_LARGE  = 1 << 3;     // 11110100 1001____, 11110100 101_____ etc.
+    constexpr Byte SURROGATE  = 1 << 4;     // 11101101 101_____
+    constexpr Byte OVERLONG_2 = 1 << 5;     // 1100000_ 10______
+    constexpr Byte TOO_LARGE_1000 = 1 << 6; // 11110101 1000____ etc.
+    constexpr Byte OVERLONG_4 = 1 << 6;     // 11110000 1000____
+    constexpr Byte TWO_CONTS  = 1 << 7;     // 10______ 10______
+    constexpr Byte CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+    #define MJ_TABLE(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+    MJ_TARGET_AVX2 inline __m256i shr4(__m256i x)
+        { return _mm256_and_si256(_mm256_srli_epi16(x, 4), _mm256_set1_epi8(0x0F)); }
+
+    /// Previous N bytes, crossing 128-bit lanes
+    template <int N>
+    MJ_TARGET_AVX2 inline __m256i prevBytes(__m256i input, __m256i prevInput)
+    {
+        return _mm256_alignr_epi8(
+                input, _mm256_permute2x128_si256(prevInput, input, 0x21), 16 - N);
+    }
+
+    MJ_TARGET_AVX2 inline __m256i checkBlock(__m256i input, __m256i prevInput)
+    {
+        auto prev1 = prevBytes<1>(input, prevInput);
+        auto byte1High = _mm256_shuffle_epi8(MJ_TABLE(
+                // 0_______ ________ <ASCII in byte 1>
+                TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+                TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+                // 10______ ________ <continuation in byte 1>
+                TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+                // 1100____ ________ <two byte lead in byte 1>
+                TOO_SHORT | OVERLONG_2,
+                // 1101____ ________ <two byte lead in byte 1>
+                TOO_SHORT,
+                // 1110____ ________ <three byte lead in byte 1>
+                TOO_SHORT | OVERLONG_3 | SURROGATE,
+                // 1111____ ________ <four+ byte lead in byte 1>
+                char(TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4)),
+            shr4(prev1));
+        auto byte1Low = _mm256_shuffle_epi8(MJ_TABLE(
+                // ____0000 ________
+                char(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4),
+                // ____0001 ________
+                char(CARRY | OVERLONG_2),
+                // ____001_ ________
+                char(CARRY), char(CARRY),
+                // ____0100 ________
+                char(CARRY | TOO_LARGE),
+                // ____0101 ________
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+                // ____011_ ________
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+                // ____1___ ________
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+                // ____1101 ________
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000),
+                char(CARRY | TOO_LARGE | TOO_LARGE_1000)),
+            _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+        auto byte2High = _mm256_shuffle_epi8(MJ_TABLE(
+                // ________ 0_______ <ASCII in byte 2>
+                TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                // ________ 1000____
+                char(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4),
+                // ________ 1001____
+                char(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+                // ________ 101_____
+                char(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE),
+                char(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE),
+                // ________ 11______
+                TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT),
+            shr4(input));
+        auto special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+        // 111_____ two bytes back, or 1111____ three bytes back →
+        // should be continuation, and TWO_CONTS above marked it as error
+        auto prev2 = prevBytes<2>(input, prevInput);
+        auto prev3 = prevBytes<3>(input, prevInput);
+        auto is3rd = _mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xE0 - 0x80)));
+        auto is4th = _mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xF0 - 0x80)));
+        auto must23 = _mm256_and_si256(_mm256_or_si256(is3rd, is4th),
+                                       _mm256_set1_epi8(char(0x80)));
+        return _mm256_xor_si256(must23, special);
+    }
+
+    #undef MJ_TABLE
+
+    /// @return  non-zero if block ends with incomplete code sequence
+    MJ_TARGET_AVX2 inline __m256i isIncomplete(__m256i input)
+    {
+        const auto maxValue = _mm256_setr_epi8(
+                -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1));
+        return _mm256_subs_epu8(input, maxValue);
+    }
+
+    MJ_TARGET_AVX2 simd::ValidPrefix validU8PrefixAvx2(const char* p0, const char* end) noexcept
+    {
+        auto beg = reinterpret_cast<const Byte*>(p0);
+        auto e = reinterpret_cast<const Byte*>(end);
+        auto p = beg;
+        auto prev = _mm256_setzero_si256();
+        auto prevIncomplete = _mm256_setzero_si256();
+        // Continuation bytes are in 80…BF, i.e. −128…−65 signed
+        const auto contLimit = _mm256_set1_epi8(-65 + 1);
+        size_t nConts = 0;
+        while (e - p >= 32) {
+            auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            if (_mm256_movemask_epi8(input) == 0) {
+                // ASCII: just should not break previous sequence
+                if (!_mm256_testz_si256(prevIncomplete, prevIncomplete))
+                    break;
+            } else {
+                auto err = checkBlock(input, prev);
+                if (!_mm256_testz_si256(err, err))
+                    break;
+                nConts += _mm_popcnt_u32(static_cast<unsigned>(
+                        _mm256_movemask_epi8(_mm256_cmpgt_epi8(contLimit, input))));
+            }
+            prevIncomplete = isIncomplete(input);
+            prev = input;
+            p += 32;
+        }
+        if (p == beg)
+            return prefixScalar(p, e, 0);
+        // [beg, p) is good, but may end with incomplete sequence →
+        // go back to last starting byte and check the rest byte by byte
+        auto lead = p - 1;
+        while (lead != beg && isCont(*lead))
+            --lead;
+        nConts -= (p - lead - 1);
+        return prefixScalar(lead, e, (lead - beg) - nConts);
+    }
+
+    MJ_TARGET_AVX2 char32_t* decodeValidU8Avx2(const char* p0, const char* end, char32_t* dest) noexcept
+    {
+        auto p = reinterpret_cast<const Byte*>(p0);
+        auto e = reinterpret_cast<const Byte*>(end);
+        while (e - p >= 16) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(v) == 0) {
+                auto d = reinterpret_cast<__m256i*>(dest);
+                _mm256_storeu_si256(d,     _mm256_cvtepu8_epi32(v));
+                _mm256_storeu_si256(d + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+                p += 16;
+                dest += 16;
+            } else {
+                auto blockEnd = p + 16;
+                while (p < blockEnd)
+                    dest = decodeCp(p, dest);
+            }
+        }
+        while (p < e)
+            dest = decodeCp(p, dest);
+        return dest;
+    }
+
+    bool hasAvx2()
+    {
+    #ifdef _MSC_VER
+        int regs[4];
+        __cpuid(regs, 1);
+        constexpr int OSXSAVE = 1 << 27, AVX = 1 << 28;
+        if ((regs[2] & (OSXSAVE | AVX)) != (OSXSAVE | AVX))
+            return false;
+        // OS saves YMM registers
+        if ((_xgetbv(0) & 6) != 6)
+            return false;
+        __cpuidex(regs, 7, 0);
+        return regs[1] & (1 << 5);
+    #else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    #endif
+    }
+
+#endif  // MJ_SIMD_X86
+
+    ///// Dispatch /////////////////////////////////////////////////////////////
+
+    struct Impl {
+        simd::Level level;
+        simd::ValidPrefix (*validU8Prefix)(const char*, const char*) noexcept;
+        char32_t* (*decodeValidU8)(const char*, const char*, char32_t*) noexcept;
+    };
+
+    constexpr Impl IMPL_SCALAR { simd::Level::SCALAR, validU8PrefixScalar, decodeValidU8Scalar };
+#ifdef MJ_SIMD_X86
+    constexpr Impl IMPL_SSE2 { simd::Level::SSE2, validU8PrefixSse2, decodeValidU8Sse2 };
+    constexpr Impl IMPL_AVX2 { simd::Level::AVX2, validU8PrefixAvx2, decodeValidU8Avx2 };
+#endif
+
+    const Impl& implFor(simd::Level x)
+    {
+        switch (x) {
+    #ifdef MJ_SIMD_X86
+        case simd::Level::AVX2: return IMPL_AVX2;
+        case simd::Level::SSE2: return IMPL_SSE2;
+    #endif
+        default: return IMPL_SCALAR;
+        }
+    }
+
+    simd::Level detectLevel()
+    {
+    #ifdef MJ_SIMD_X86
+        return hasAvx2() ? simd::Level::AVX2 : simd::Level::SSE2;
+    #else
+        return simd::Level::SCALAR;
+    #endif
+    }
+
+    /// nullptr → not detected yet; static init order does not matter
+    std::atomic<const Impl*> currImpl = nullptr;
+
+    const Impl& impl()
+    {
+        auto r = currImpl.load(std::memory_order_relaxed);
+        if (!r) {
+            r = &implFor(detectLevel());
+            currImpl.store(r, std::memory_order_relaxed);
+        }
+        return *r;
+    }
+
+}   // anon namespace
+
+
+simd::Level simd::maxLevel() noexcept
+{
+    static const Level r = detectLevel();
+    return r;
+}
+
+
+simd::Level simd::level() noexcept
+    { return impl().level; }
+
+
+void simd::setLevel(Level x) noexcept
+{
+    if (x > maxLevel())
+        x = maxLevel();
+    currImpl.store(&implFor(x), std::memory_order_relaxed);
+}
+
+
+simd::ValidPrefix simd::validU8Prefix(const char* p, const char* end) noexcept
+    { return impl().validU8Prefix(p, end); }
+
+
+char32_t* simd::decodeValidU8(const char* p, const char* end, char32_t* dest) noexcept
+    { return impl().decodeValidU8(p, end, dest); }
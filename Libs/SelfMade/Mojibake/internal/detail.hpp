@@ -13,8 +13,11 @@
 
 #if __cplusplus >= 202002L
     #include <bit>
+    #include <memory>
 #endif
 
+#include "simd.hpp"
+
 namespace mojibake::detail {
 
     template <class It>
@@ -431,6 +434,30 @@ namespace mojibake::detail {
         return true;
     }
 
+    ///
+    /// @return [+] It is contiguous iterator of bytes:
+    ///         vectorized routines can read data directly
+    ///
+    template <class It>
+    constexpr bool isContiguousU8()
+    {
+    #if __cplusplus >= 202002L
+        return std::contiguous_iterator<It> && sizeof(ChType<It>) == 1;
+    #else
+        return std::is_pointer_v<It> && sizeof(ChType<It>) == 1;
+    #endif
+    }
+
+    template <class It>
+    inline const char* u8Ptr(It it)
+    {
+    #if __cplusplus >= 202002L
+        return reinterpret_cast<const char*>(std::to_address(it));
+    #else
+        return reinterpret_cast<const char*>(it);
+    #endif
+    }
+
     template <class It>
     class ItEnc<It, Utf8>
     {
@@ -526,6 +553,27 @@ namespace mojibake::detail {
                 ++p;
 
         for (; p != end;) {
+            if constexpr (isContiguousU8<It>() && std::is_same_v<Enc2, Utf32>
+                          && !IteratorLimit<It2>::isLimited) {
+                // Vectorized: decode valid prefix by chunks,
+                // and the rest of loop body gets just bad code sequence
+                auto q = u8Ptr(p);
+                auto prefixEnd = simd::validU8Prefix(q, u8Ptr(end)).end;
+                p += prefixEnd - q;
+                constexpr ptrdiff_t CHUNK = 256;
+                char32_t buf[CHUNK];
+                while (q != prefixEnd) {
+                    auto chunkEnd = (prefixEnd - q > CHUNK) ? q + CHUNK : prefixEnd;
+                    while (chunkEnd != prefixEnd && isU8ContinueByte(*chunkEnd))
+                        --chunkEnd;
+                    auto bufEnd = simd::decodeValidU8(q, chunkEnd, buf);
+                    for (auto c = buf; c != bufEnd; ++c)
+                        ItEnc<It2, Enc2>::put(dest, *c);
+                    q = chunkEnd;
+                }
+                if (p == end)
+                    break;
+            }
             auto cpStart = p++;
             unsigned char byte1 = *cpStart;
             unsigned char byte2;
@@ -606,6 +654,16 @@ namespace mojibake::detail {
             ++p;
 
         for (; p != end;) {
+            if constexpr (isContiguousU8<It>()) {
+                // Vectorized: count valid prefix,
+                // and the rest of loop body gets just bad code sequence
+                auto q = u8Ptr(p);
+                auto prefix = simd::validU8Prefix(q, u8Ptr(end));
+                r += prefix.nCps;
+                p += prefix.end - q;
+                if (p == end)
+                    break;
+            }
             auto cpStart = p++;
             unsigned char byte1 = *cpStart;
             unsigned cp;
@@ -657,6 +715,11 @@ namespace mojibake::detail {
     template <class It>
     bool ItEnc<It, Utf8>::isValid(It p, It end)
     {
+        if constexpr (isContiguousU8<It>()) {
+            auto e = u8Ptr(end);
+            return (simd::validU8Prefix(u8Ptr(p), e).end == e);
+        }
+
 #define MJ_READCP \
             if (p == end) return false; \
             byte1 = *p;  \
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+namespace mojibake::detail::simd {
+
+    ///
+    ///  Instruction set used by vectorized UTF-8 routines.
+    ///  Chosen at runtime by first call, x86 only; other machines are SCALAR.
+    ///
+    enum class Level : unsigned char {
+        SCALAR,     ///< byte by byte
+        SSE2,       ///< skips ASCII runs 16 bytes at once
+        AVX2,       ///< validates 32 bytes at once, any script
+    };
+
+    /// @return  level currently used
+    Level level() noexcept;
+    /// @return  best level this CPU supports
+    Level maxLevel() noexcept;
+    /// Forces some level (tests and benchmarks), clamped to maxLevel
+    void setLevel(Level x) noexcept;
+
+    struct ValidPrefix {
+        const char* end;    ///< prefix [p, end) is valid UTF-8 ending at CP boundary
+        size_t nCps;        ///< # of code points in prefix
+    };
+
+    ///
+    /// Finds valid UTF-8 prefix; it is either whole [p, end),
+    /// or ends right before the first bad code sequence
+    ///
+    ValidPrefix validU8Prefix(const char* p, const char* end) noexcept;
+
+    ///
+    /// Decodes UTF-8 to UTF-32, NO CHECKS
+    /// @pre   [p, end) is validU8Prefix
+    /// @return  dest + # of code points
+    ///
+    char32_t* decodeValidU8(const char* p, const char* end, char32_t* dest) noexcept;
+
+}   // namespace mojibake::detail::simd
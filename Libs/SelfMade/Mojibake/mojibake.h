@@ -339,8 +339,24 @@ namespace mojibake {
     To to(const From& from, const Mjh& onMojibake = Mjh{})
     {
         To r;
-        std::back_insert_iterator it(r);
         using It1 = decltype(std::begin(from));
+    #if __cplusplus >= 202002L
+        // UTF-8 → UTF-32 string: if valid, size is known in advance
+        if constexpr (detail::isContiguousU8<It1>() && std::is_same_v<Enc1, Utf8>
+                && std::is_same_v<Enc2, Utf32>
+                && sizeof(typename To::value_type) == sizeof(char32_t)
+                && requires { r.resize(size_t{}); *r.data() = char32_t{}; }) {
+            auto beg = detail::u8Ptr(std::begin(from));
+            auto end = detail::u8Ptr(std::end(from));
+            auto prefix = detail::simd::validU8Prefix(beg, end);
+            if (prefix.end == end) {
+                r.resize(prefix.nCps);
+                detail::simd::decodeValidU8(beg, end, reinterpret_cast<char32_t*>(r.data()));
+                return r;
+            }
+        }
+    #endif
+        std::back_insert_iterator it(r);
         using It2 = decltype(it);
         copy<It1, It2, Enc1, Enc2, Mjh>(std::begin(from), std::end(from), it, onMojibake);
         return r;
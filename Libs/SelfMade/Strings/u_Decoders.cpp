@@ -5,6 +5,7 @@
 #include "u_Strings.h"
 
 // C++
+#include <algorithm>
 #include <regex>
 
 using namespace std::string_view_literals;
@@ -12,6 +13,18 @@ using namespace std::string_view_literals;
 constexpr char32_t PARA_SEP_32 = 0x2029;      // U+2029 paragraph separator
 constexpr wchar_t PARA_SEP_16 = PARA_SEP_32;
 
+namespace {
+
+    /// Turns result of some xxxSv(x, cache) into string
+    std::u8string svToString(std::u8string_view r, std::u8string& cache)
+    {
+        if (r.data() == cache.data())
+            return std::move(cache);
+        return std::u8string{r};
+    }
+
+}   // anon namespace
+
 
 ///// escape::Text /////////////////////////////////////////////////////////////
 
@@ -65,24 +78,54 @@ void escape::Text::writeSimpleString(std::ostream& os, std::u8string_view x) con
 void escape::Text::write(
         std::ostream& os, std::u8string_view x, std::u8string& cache) const
 {
+    cache.clear();
+    append(cache, x);
+    os << str::toSv(cache);
+}
+
+
+void escape::Text::append(std::u8string& r, std::u8string_view x) const
+{
+    constexpr auto C_QUOTE = '"';
+    bool isQuoted = (space == SpaceMode::QUOTED);
     switch (lineBreak) {
     case LineBreakMode::BANNED:
-        writeSimpleString(os, x);
-        break;
     case LineBreakMode::SPECIFIED_TEXT: {
-            auto s = str::replaceSv(x, u8"\n", lineBreakText, cache);
-            writeSimpleString(os, s);
+            bool wantReplace = (lineBreak == LineBreakMode::SPECIFIED_TEXT);
+            if (isQuoted)
+                r += C_QUOTE;
+            if ((!wantReplace || x.find('\n') == std::u8string_view::npos)
+                    && (!isQuoted || x.find(C_QUOTE) == std::u8string_view::npos)) {
+                // Quick
+                r.append(x);
+            } else {
+                // Char-by-char; line-break text is quoted as well
+                for (auto c : x) {
+                    if (c == '\n' && wantReplace) {
+                        for (auto d : lineBreakText) {
+                            if (d == C_QUOTE && isQuoted)
+                                r += C_QUOTE;
+                            r += d;
+                        }
+                    } else {
+                        if (c == C_QUOTE && isQuoted)
+                            r += C_QUOTE;
+                        r += c;
+                    }
+                }
+            }
+            if (isQuoted)
+                r += C_QUOTE;
         } break;
     case LineBreakMode::C_CR:
     case LineBreakMode::C_LF: {
             auto ch = (lineBreak == LineBreakMode::C_CR) ? 'r' : 'n';
-            auto s = escape::cppSv(x, cache, ch,
+            escape::appendCpp(r, x, ch,
                 ecIf<escape::Spaces>(space == SpaceMode::SLASH_SPACE),
-                ecIf<Enquote>(space == SpaceMode::QUOTED));
-            os << str::toSv(s);
+                ecIf<Enquote>(isQuoted));
         } break;
     }
-    os << str::toSv(activeSpaceDelimiter());
+    r.append(activeSpaceDelimiter());
 }
 
 
@@ -97,26 +140,43 @@ std::u8string escape::Text::unescapeMaybeQuoted(std::u8string_view text) const
 
 
 std::u8string escape::Text::unescape(std::u8string_view text) const
+{
+    std::u8string cache;
+    auto r = unescapeSv(text, cache);
+    return svToString(r, cache);
+}
+
+
+std::u8string_view escape::Text::unescapeSv(
+        std::u8string_view text, std::u8string& cache) const
 {
     // Delimited mode: ends → remove
     if (space == SpaceMode::DELIMITED && text.ends_with(spaceDelimiter))
-        text = text.substr(text.length() - spaceDelimiter.length());
+        text = text.substr(0, text.length() - spaceDelimiter.length());
     switch (lineBreak) {
     case LineBreakMode::SPECIFIED_TEXT:
         if (!lineBreakText.empty()) {
-            std::u8string tmp {text};
-            str::replace(tmp, lineBreakText, u8"\n");
-            return unescapeMaybeQuoted(tmp);
+            // Unquote first: append() doubles quotes in line-break text too
+            auto s = (space == SpaceMode::QUOTED)
+                    ? decode::quotedSv(text, cache) : text;
+            if (s.find(lineBreakText) == std::u8string_view::npos)
+                return s;
+            if (s.data() != cache.data())
+                cache = s;
+            str::replace(cache, lineBreakText, u8"\n");
+            return cache;
         }
         [[fallthrough]];
     case LineBreakMode::BANNED:
-        return unescapeMaybeQuoted(text);
+        if (space == SpaceMode::QUOTED)
+            return decode::quotedSv(text, cache);
+        return text;
     case LineBreakMode::C_CR:
     case LineBreakMode::C_LF: { // We recognize both \r and \n
             // Only two modes remain here: bare/quoted
             // \s will be recognized anyway
             auto mq = ecIf<decode::MaybeQuoted>(space == SpaceMode::QUOTED);
-            return decode::cppLite(text, mq);
+            return decode::cppLiteSv(text, cache, mq);
         }
     }
     return {};
@@ -237,6 +297,22 @@ decode::BomType decode::detectBom(std::istream& is)
 }
 
 
+decode::BomType decode::detectBom(std::u8string_view& data)
+{
+    if (data.starts_with(u8"\xEF\xBB\xBF"sv)) {
+        data = data.substr(3);
+        return BomType::UTF8;
+    } else if (data.starts_with(u8"\xFF\xFE"sv)) {
+        data = data.substr(2);
+        return BomType::UTF16LE;
+    } else if (data.starts_with(u8"\xFE\xFF"sv)) {
+        data = data.substr(2);
+        return BomType::UTF16BE;
+    }
+    return BomType::NONE;
+}
+
+
 std::u32string_view decode::normalizeEolSv(
         std::u32string_view x,
         std::u32string &cache)
@@ -623,6 +699,60 @@ std::wstring decode::htmlP(std::wstring_view x)
 }
 
 
+void escape::appendCpp(
+        std::u8string& r,
+        std::u8string_view x,
+        char8_t lf,
+        escape::Spaces escapeSpaces,
+        Enquote enquote)
+{
+    // Special bhv on " ", see cppSv
+    if (x.length() == 1 && x[0] == ' ') {
+        if (static_cast<bool>(enquote))
+            r += '"';
+        r.append(static_cast<bool>(escapeSpaces) ? u8R"(\s)" : u8" ");
+        if (static_cast<bool>(enquote))
+            r += '"';
+        return;
+    }
+
+    bool hasLeadingSpace = false;
+    bool hasTrailingSpace = false;
+    if (static_cast<bool>(escapeSpaces)) {
+        hasLeadingSpace = x.starts_with(' ');
+        hasTrailingSpace = x.ends_with(' ');
+    }
+    int myOffset = hasLeadingSpace;
+    int myLength = x.length() - myOffset - static_cast<int>(hasTrailingSpace);
+    auto xx = x.substr(myOffset, myLength);
+
+    if (static_cast<bool>(enquote))
+        r += '"';
+    if (hasLeadingSpace)
+        r.append(u8R"(\s)");
+    // Copy runs of plain chars at once
+    auto isSpecial = [enquote](char8_t c) {
+        return (c == '\n' || c == '\\'
+                || (c == '"' && static_cast<bool>(enquote)));
+    };
+    auto p = xx.begin();
+    auto end = xx.end();
+    while (true) {
+        auto q = std::find_if(p, end, isSpecial);
+        r.append(p, q);
+        if (q == end)
+            break;
+        r += '\\';
+        r += (*q == '\n') ? lf : *q;
+        p = q + 1;
+    }
+    if (hasTrailingSpace)
+        r.append(u8R"(\s)");
+    if (static_cast<bool>(enquote))
+        r += '"';
+}
+
+
 std::u8string_view escape::cppSv(
         std::u8string_view x,
         std::u8string& cache,
@@ -718,27 +848,34 @@ std::u8string_view escape::cppSv(
 }
 
 
-void decode::ini(std::istream& is, IniCallback& cb)
-{
-    auto bomType = detectBom(is);
-    switch (bomType) {
-    case BomType::UTF16BE:
-    case BomType::UTF16LE:
-        throw std::logic_error("UTF-16 INI files are not supported!");
-    case BomType::NONE:     // These two are supported
-    case BomType::UTF8:;
+namespace {
+
+    void checkIniBom(decode::BomType bomType)
+    {
+        switch (bomType) {
+        case decode::BomType::UTF16BE:
+        case decode::BomType::UTF16LE:
+            throw std::logic_error("UTF-16 INI files are not supported!");
+        case decode::BomType::NONE:     // These two are supported
+        case decode::BomType::UTF8:;
+        }
     }
-    std::string line;
-    while (std::getline(is, line)) {
-        std::u8string_view s = str::toU8sv(str::trimLeftSv(line));
+
+    /// Processes one line of INI, w/o LF
+    void iniLine(std::u8string_view line, decode::IniCallback& cb)
+    {
+        // CR LF → LF
+        if (line.ends_with('\r'))
+            line.remove_suffix(1);
+        std::u8string_view s = str::trimLeftSv(line);
         if (s.empty()) {
             cb.onEmptyLine();
-            continue;
+            return;
         }
         if (s.starts_with(';') || s.starts_with('#')) {
             s = str::trimSv(s.substr(1));
             cb.onComment(s);
-            continue;
+            return;
         }
         if (s.starts_with('[')) {   // “[ group ] ”
             // GROUP
@@ -767,10 +904,46 @@ void decode::ini(std::istream& is, IniCallback& cb)
             }
         }
     }
+
+}   // anon namespace
+
+
+void decode::ini(std::istream& is, IniCallback& cb)
+{
+    checkIniBom(detectBom(is));
+    std::string line;
+    while (std::getline(is, line)) {
+        iniLine(str::toU8sv(line), cb);
+    }
+}
+
+
+void decode::ini(std::u8string_view data, IniCallback& cb)
+{
+    checkIniBom(detectBom(data));
+    // Same lines as getline makes: trailing LF does not give empty line
+    while (!data.empty()) {
+        auto pEol = data.find('\n');
+        if (pEol == std::u8string_view::npos) {
+            iniLine(data, cb);
+            break;
+        }
+        iniLine(data.substr(0, pEol), cb);
+        data = data.substr(pEol + 1);
+    }
 }
 
 
 std::u8string decode::cppLite(std::u8string_view x, MaybeQuoted maybeQuoted)
+{
+    std::u8string cache;
+    auto r = cppLiteSv(x, cache, maybeQuoted);
+    return svToString(r, cache);
+}
+
+
+std::u8string_view decode::cppLiteSv(
+        std::u8string_view x, std::u8string& cache, MaybeQuoted maybeQuoted)
 {
     bool hasRightQuote = false;
     if (maybeQuoted != MaybeQuoted::NO) {
@@ -788,9 +961,10 @@ std::u8string decode::cppLite(std::u8string_view x, MaybeQuoted maybeQuoted)
     }
     // Totally unescaped?
     if (x.find('\\') == std::u8string_view::npos) {
-        return std::u8string{x};
+        return x;
     }
-    std::u8string r;
+    auto& r = cache;
+    r.clear();
     auto p = std::to_address(x.begin());
     auto end = std::to_address(x.end());
     while (p != end) {
@@ -825,11 +999,19 @@ std::u8string decode::cppLite(std::u8string_view x, MaybeQuoted maybeQuoted)
 
 
 std::u8string decode::quoted(std::u8string_view x)
+{
+    std::u8string cache;
+    auto r = quotedSv(x, cache);
+    return svToString(r, cache);
+}
+
+
+std::u8string_view decode::quotedSv(std::u8string_view x, std::u8string& cache)
 {
     // Does not start with quote → return param
     auto x1 = str::trimLeftSv(x);
     if (!x1.starts_with('"')) {
-        return std::u8string(x);
+        return x;
     }
     // Now have starting quote
     x = x1.substr(1);
@@ -839,8 +1021,12 @@ std::u8string decode::quoted(std::u8string_view x)
     if (x2.ends_with('"'))
         x = x2.substr(0, x2.length() - 1);
 
-    std::u8string r;
-    r.reserve(x.length());
+    // No doubled quotes inside?
+    if (x.find('"') == std::u8string_view::npos)
+        return x;
+
+    auto& r = cache;
+    r.clear();
     auto p = std::to_address(x.begin());
     auto end = std::to_address(x.end());
     while (p != end) {
@@ -854,6 +1040,5 @@ std::u8string decode::quoted(std::u8string_view x)
             r += c;
         }
     }
-    r.shrink_to_fit();
     return r;
 }
@@ -46,6 +46,8 @@ namespace escape {
         static void writeQuoted(std::ostream& os, std::u8string_view x);
         void writeSimpleString(std::ostream& os, std::u8string_view x) const;
         void write(std::ostream& os, std::u8string_view x, std::u8string& cache) const;
+        /// Same as write, but appends right to r
+        void append(std::u8string& r, std::u8string_view x) const;
 
         void setLineBreakText(std::u8string_view x);
         std::u8string_view visibleLineBreakText() const noexcept;
@@ -61,6 +63,9 @@ namespace escape {
         std::u8string_view activeSpaceDelimiter() const noexcept;
 
         std::u8string unescape(std::u8string_view text) const;
+        /// Same as unescape, but does not allocate when nothing to unescape
+        /// @return  either text (or its part), or cache
+        std::u8string_view unescapeSv(std::u8string_view text, std::u8string& cache) const;
         std::u8string unescapeMaybeQuoted(std::u8string_view text) const;
     };
 
@@ -73,6 +78,14 @@ namespace escape {
             escape::Spaces escapeSpaces = escape::Spaces::NO,
             Enquote enquote = Enquote::NO);
 
+    /// Same as cppSv, but appends right to r
+    void appendCpp(
+            std::u8string& r,
+            std::u8string_view x,
+            char8_t lf,
+            escape::Spaces escapeSpaces = escape::Spaces::NO,
+            Enquote enquote = Enquote::NO);
+
 }
 
 namespace decode {
@@ -86,6 +99,13 @@ namespace decode {
     ///
     BomType detectBom(std::istream& is);
 
+    ///
+    /// \brief detectBom
+    ///    Same for memory buffer: skips BOM in data
+    /// \return BOM type
+    ///
+    BomType detectBom(std::u8string_view& data);
+
     class IniCallback {     // interface
     public:
         virtual void onGroup(std::u8string_view) = 0;
@@ -98,8 +118,13 @@ namespace decode {
         virtual ~IniCallback() = default;
     };
 
+    /// CR LF line breaks are treated as LF
     void ini(std::istream& is, IniCallback& cb);
 
+    ///  Same for the whole file in memory: names and values given
+    ///  to callback point right into data
+    void ini(std::u8string_view data, IniCallback& cb);
+
 
     /// @return 0..15 if x = 0..F
     ///         999 otherwise
@@ -147,11 +172,20 @@ namespace decode {
     ///
     std::u8string cppLite(std::u8string_view x, MaybeQuoted maybeQuoted);
 
+    /// Same as cppLite
+    /// @return  either x (or its part) if nothing to decode, or cache
+    std::u8string_view cppLiteSv(
+            std::u8string_view x, std::u8string& cache, MaybeQuoted maybeQuoted);
+
     ///
     /// Decoding of "some ""quoted"" string"
     ///
     std::u8string quoted(std::u8string_view x);
 
+    /// Same as quoted
+    /// @return  either x (or its part) if nothing to decode, or cache
+    std::u8string_view quotedSv(std::u8string_view x, std::u8string& cache);
+
     /// Decodes C++
     /// "alpha\nbravo" → alpha<LF>bravo
     /// Why U32: handle \U00012345
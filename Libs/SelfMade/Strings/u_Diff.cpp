@@ -0,0 +1,559 @@
+// My header
+#include "u_Diff.h"
+
+// C++
+#include <span>
+#include <unordered_map>
+
+// Libs
+#include "u_Array.h"
+
+
+dif::SimpleSplit dif::simpleSplit(std::u32string_view a, std::u32string_view b)
+{
+    size_t minLen = std::min(a.length(), b.length());
+
+    size_t commonPrefLen = 0;
+    while (commonPrefLen < minLen
+           && a[commonPrefLen] == b[commonPrefLen]) {
+        ++commonPrefLen;
+    }
+
+    minLen -= commonPrefLen;
+    const size_t lenA1 = a.length() - 1;
+    const size_t lenB1 = b.length() - 1;
+    size_t commonSuffLen = 0;
+    while (commonSuffLen < minLen
+           && a[lenA1 - commonSuffLen] == b[lenB1 - commonSuffLen]) {
+        ++commonSuffLen;
+    }
+
+    const size_t suffA = a.length() - commonSuffLen;
+    const size_t suffB = b.length() - commonSuffLen;
+    return {
+        .commonPrefix = a.substr(0, commonPrefLen),
+        .aMid = a.substr(commonPrefLen, suffA - commonPrefLen),
+        .bMid = b.substr(commonPrefLen, suffB - commonPrefLen),
+        .commonSuffix = a.substr(suffA),
+    };
+}
+
+
+namespace {
+
+    constexpr std::u32string_view UEMPTY {};
+    constexpr size_t W_CHG = 10;        // Weight of change
+    constexpr size_t W_DEL = 10;        // Weight of deletion
+    constexpr size_t W_INS = W_DEL;     // Weight of insertion
+    constexpr size_t W_BONUS = 1;       // A small bonus for several identical commands in a row
+    constexpr size_t W_DEL_BONUS = W_DEL - W_BONUS;
+    constexpr size_t W_INS_BONUS = W_DEL_BONUS;
+    constexpr size_t SZ_SMALL_CHG = 1;  // size of common span <= X → stick to del/ins
+
+    enum class Dir : unsigned char { COM, DEL, CHG, INS };
+
+    void appendN(std::u32string_view& subst, size_t n)
+        { subst = std::u32string_view { subst.data(), subst.size() + n }; }
+
+    dif::Pair& backOf(dif::EditScript& r, bool needCommon,
+                       const char32_t* a, const char32_t* b)
+    {
+        if (!r.empty()) {
+            auto& bk = r.back();
+            if (bk.isCommon == needCommon)
+                return bk;
+            // Stick small common spans to prev del/ins
+            // There WILL be a few common letters → don’t make noise
+            if constexpr (SZ_SMALL_CHG != 0) {
+                if (r.size() >= 2 && bk.isCommon && bk.del.size() <= SZ_SMALL_CHG) {
+                    // bk1 += bk
+                    auto& bk1 = ((&bk)[-1]);
+                    appendN(bk1.del, bk.del.size());
+                    appendN(bk1.ins, bk.del.size());
+
+                    // Pop, check once again
+                    // See bug 1 description below
+                    r.pop_back();
+                        // pop_back guarantees to preserve iterators/pointers
+                        // except bk and end, so OK!
+                    if (bk1.isCommon == needCommon)
+                        return bk1;
+                }
+            }
+        }
+        auto& newBk = r.emplace_back();
+        newBk.del = std::u32string_view { a, 0 };
+        newBk.ins = std::u32string_view { b, 0 };
+        newBk.isCommon = needCommon;
+        return newBk;
+    }
+
+    // Bug 1: медного → бронзового
+    //    (Russian genitive: made of copper → made of bronze)
+    //   Final “ого” is common suffix
+    //   C = changed, U = common, I = inserted
+    //   CCCU → CCCUIII
+    // 0 = common prefix
+    // 1 = three changed
+    // 2 = one common
+    // (no number) three inserted? — we see one common, stick with three changed
+    //     and start writing those inserted at 2
+    // so BAD: 1 = four changed, 2 = three inserted, 3 = common suffix
+    //   so we see both deleted text “медн” and insert sign
+    // RIGHT: stick 1+2, check once again and write at 1!!!!!
+    //   0 = common prefix, 1 = changed 4→7, 2 = common suffix
+
+    /// Appends a span, sticking small common spans the same way
+    void appendSpan(dif::EditScript& r, bool isCommon,
+                    std::u32string_view del, std::u32string_view ins)
+    {
+        if (del.empty() && ins.empty())
+            return;
+        auto& bk = backOf(r, isCommon, del.data(), ins.data());
+        appendN(bk.del, del.size());
+        appendN(bk.ins, ins.size());
+    }
+
+    void inc1(std::u32string_view& subst, size_t& index)
+    {
+        subst = std::u32string_view { subst.data(), subst.size() + 1 };
+        ++index;
+    }
+
+}   // anon namespace
+
+
+void dif::detail::appendDpScript(
+        EditScript& r, std::u32string_view a, std::u32string_view b)
+{
+    if (a.empty()) {
+        if (b.empty()) {
+            return;
+        } else {
+            r.emplace_back( UEMPTY, b );
+            return;
+        }
+    } else if (b.empty()) {
+        r.emplace_back( a, UEMPTY );
+        return;
+    }
+
+    // cumulative
+    Array2d<size_t> cm(a.length() + 1, b.length() + 1);
+    // direction
+    Array2d<Dir> dr(a.length() + 1, b.length() + 1);
+
+    // Fill edge things
+    for (size_t i = 0; i <= a.length(); ++i) {
+        cm(i, b.length()) = (a.length() - i) * W_DEL_BONUS;
+        dr(i, b.length()) = Dir::DEL;
+    }
+    for (size_t j = 0; j <= b.length(); ++j) {
+        cm(a.length(), j) = (b.length() - j) * W_INS_BONUS;
+        dr(a.length(), j) = Dir::INS;
+    }
+    dr(a.length(), b.length()) = Dir::COM;
+
+    // Go by matrix!
+    for (size_t i = a.length(); i != 0;) { --i;
+        for (size_t j = b.length(); j != 0;) { --j;
+            if (a[i] == b[j]) {
+                cm(i, j) = cm(i + 1, j + 1);
+                dr(i, j) = Dir::COM;
+            } else {
+                auto& cij = cm(i, j);
+                auto& dij = dr(i, j);
+                // Change
+                cij = cm(i + 1, j + 1) + W_CHG;
+                if constexpr (W_BONUS != 0) {
+                    if (dr(i + 1, j + 1) == Dir::CHG)
+                        cij -= W_BONUS;
+                }
+                dij = Dir::CHG;
+                // Delete
+                auto distDel = cm(i + 1, j) + W_DEL;
+                if constexpr (W_BONUS != 0) {
+                    if (dr(i + 1, j) == Dir::DEL)
+                        distDel -= W_BONUS;
+                }
+                if (distDel <= cij) {
+                    cij = distDel;
+                    dij = Dir::DEL;
+                }
+                // Insert
+                auto distIns = cm(i, j + 1) + W_INS;
+                if constexpr (W_BONUS != 0) {
+                    if (dr(i, j + 1) == Dir::INS)
+                        distIns -= W_BONUS;
+                }
+                if (distIns <= cij) {
+                    cij = distIns;
+                    dij = Dir::INS;
+                }
+            }
+        }
+    }
+
+    //std::cout << "Cumulative (0, 0) = " << cm(0, 0) << std::endl;
+
+    // Forward move
+    size_t ii = 0, jj = 0;
+    while (ii != a.length() || jj != b.length()) {
+        if (ii > a.length() || jj > b.length()) {
+            throw std::logic_error("Went too far away");
+        }
+        const char32_t* pA = a.data() + ii;
+        const char32_t* pB = b.data() + jj;
+        switch (dr(ii, jj)) {
+        case Dir::COM: {
+                //std::cout << "Common at " << ii << "/" << jj << std::endl;
+                auto& bk = backOf(r, true, pA, pB);
+                inc1(bk.del, ii);
+                inc1(bk.ins, jj);
+            } break;
+        case Dir::CHG: {
+                //std::cout << "Change at " << ii << "/" << jj << std::endl;
+                auto& bk = backOf(r, false, pA, pB);
+                inc1(bk.del, ii);
+                inc1(bk.ins, jj);
+            } break;
+        case Dir::DEL: {
+                //std::cout << "Delete at " << ii << "/" << jj << std::endl;
+                auto& bk = backOf(r, false, pA, pB);
+                inc1(bk.del, ii);
+            } break;
+        case Dir::INS: {
+                //std::cout << "Insert at " << ii << "/" << jj << std::endl;
+                auto& bk = backOf(r, false, pA, pB);
+                inc1(bk.ins, jj);
+            } break;
+        }
+    }
+}
+
+
+namespace {
+
+    ///
+    ///  Myers’ O(ND) diff in linear space: finds middle snake,
+    ///  then divides and conquers.
+    ///  Follows GNU diff’s diag/compareseq, with its “too expensive” heuristic:
+    ///  past some cost the split point is just the furthest one reached,
+    ///  so the script is not always minimal, but time is bounded.
+    ///
+    template <class T>
+    class Myers
+    {
+    public:
+        Myers(std::span<const T> a, std::span<const T> b);
+
+        /// Calls body(isCommon, xBeg, xEnd, yBeg, yEnd) for all spans in order;
+        /// uncommon spans may be reported in several pieces
+        template <class Body>
+        void run(const Body& body);
+    private:
+        using Off = ptrdiff_t;
+        struct Split { Off x, y; };
+
+        const T* const xv;
+        const T* const yv;
+        const Off n, m;
+        Off tooExpensive;
+        // Forward/backward furthest x, indexed by diagonal x−y ∈ [−m−1, n+1]
+        SafeVector<Off> fdBuf, bdBuf;
+        Off* fd;
+        Off* bd;
+
+        Split diag(Off xoff, Off xlim, Off yoff, Off ylim);
+        template <class Body>
+        void compareSeq(Off xoff, Off xlim, Off yoff, Off ylim, const Body& body);
+    };
+
+    template <class T>
+    Myers<T>::Myers(std::span<const T> a, std::span<const T> b)
+        : xv(a.data()), yv(b.data()), n(a.size()), m(b.size()),
+          fdBuf(n + m + 3), bdBuf(n + m + 3),
+          fd(fdBuf.data() + m + 1), bd(bdBuf.data() + m + 1)
+    {
+        // ≈ √(n+m), but not less than some minimum
+        tooExpensive = 1;
+        for (auto diags = n + m + 3; diags != 0; diags >>= 2)
+            tooExpensive <<= 1;
+        tooExpensive = std::max(tooExpensive, dif::MYERS_MIN_COST);
+    }
+
+    template <class T>
+    auto Myers<T>::diag(Off xoff, Off xlim, Off yoff, Off ylim) -> Split
+    {
+        const Off dmin = xoff - ylim;       // minimum valid diagonal
+        const Off dmax = xlim - yoff;       // maximum valid diagonal
+        const Off fmid = xoff - yoff;       // center diagonal of forward search
+        const Off bmid = xlim - ylim;       // center diagonal of backward search
+        Off fmin = fmid, fmax = fmid;       // limits of forward search
+        Off bmin = bmid, bmax = bmid;       // limits of backward search
+        // True if southeast corner is on an odd diagonal w.r.t. northwest
+        const bool odd = (fmid - bmid) & 1;
+
+        fd[fmid] = xoff;
+        bd[bmid] = xlim;
+
+        for (Off c = 1;; ++c) {
+            // Extend the forward search by one edit step in each diagonal
+            if (fmin > dmin)
+                fd[--fmin - 1] = -1;
+            else
+                ++fmin;
+            if (fmax < dmax)
+                fd[++fmax + 1] = -1;
+            else
+                --fmax;
+            for (Off d = fmax; d >= fmin; d -= 2) {
+                Off tlo = fd[d - 1], thi = fd[d + 1];
+                Off x = (tlo < thi) ? thi : tlo + 1;
+                Off y = x - d;
+                while (x < xlim && y < ylim && xv[x] == yv[y]) {
+                    ++x;  ++y;
+                }
+                fd[d] = x;
+                if (odd && bmin <= d && d <= bmax && bd[d] <= x)
+                    return { x, y };
+            }
+
+            // Similarly extend the backward search
+            if (bmin > dmin)
+                bd[--bmin - 1] = PTRDIFF_MAX;
+            else
+                ++bmin;
+            if (bmax < dmax)
+                bd[++bmax + 1] = PTRDIFF_MAX;
+            else
+                --bmax;
+            for (Off d = bmax; d >= bmin; d -= 2) {
+                Off tlo = bd[d - 1], thi = bd[d + 1];
+                Off x = (tlo < thi) ? tlo : thi - 1;
+                Off y = x - d;
+                while (xoff < x && yoff < y && xv[x - 1] == yv[y - 1]) {
+                    --x;  --y;
+                }
+                bd[d] = x;
+                if (!odd && fmin <= d && d <= fmax && x <= fd[d])
+                    return { x, y };
+            }
+
+            if (c >= tooExpensive) {
+                // Gone well beyond the call of duty: take the best result so far.
+                // Forward diagonal that maximizes x+y
+                Off fxyBest = -1, fxBest = 0;
+                for (Off d = fmax; d >= fmin; d -= 2) {
+                    Off x = std::min(fd[d], xlim);
+                    Off y = x - d;
+                    if (ylim < y) {
+                        x = ylim + d;
+                        y = ylim;
+                    }
+                    if (fxyBest < x + y) {
+                        fxyBest = x + y;
+                        fxBest = x;
+                    }
+                }
+                // Backward diagonal that minimizes x+y
+                Off bxyBest = PTRDIFF_MAX, bxBest = 0;
+                for (Off d = bmax; d >= bmin; d -= 2) {
+                    Off x = std::max(xoff, bd[d]);
+                    Off y = x - d;
+                    if (y < yoff) {
+                        x = yoff + d;
+                        y = yoff;
+                    }
+                    if (x + y < bxyBest) {
+                        bxyBest = x + y;
+                        bxBest = x;
+                    }
+                }
+                // Use the better of two
+                if ((xlim + ylim) - bxyBest < fxyBest - (xoff + yoff))
+                    return { fxBest, fxyBest - fxBest };
+                return { bxBest, bxyBest - bxBest };
+            }
+        }
+    }
+
+    template <class T> template <class Body>
+    void Myers<T>::compareSeq(Off xoff, Off xlim, Off yoff, Off ylim, const Body& body)
+    {
+        // Slide down the top diagonal
+        auto x0 = xoff, y0 = yoff;
+        while (xoff < xlim && yoff < ylim && xv[xoff] == yv[yoff]) {
+            ++xoff;  ++yoff;
+        }
+        if (xoff != x0)
+            body(true, x0, xoff, y0, yoff);
+
+        // Slide up the bottom diagonal, report later
+        auto x1 = xlim, y1 = ylim;
+        while (xoff < xlim && yoff < ylim && xv[xlim - 1] == yv[ylim - 1]) {
+            --xlim;  --ylim;
+        }
+
+        if (xoff == xlim || yoff == ylim) {
+            // Just deleted or just inserted
+            if (xoff != xlim || yoff != ylim)
+                body(false, xoff, xlim, yoff, ylim);
+        } else {
+            auto split = diag(xoff, xlim, yoff, ylim);
+            compareSeq(xoff, split.x, yoff, split.y, body);
+            compareSeq(split.x, xlim, split.y, ylim, body);
+        }
+
+        if (xlim != x1)
+            body(true, xlim, x1, ylim, y1);
+    }
+
+    template <class T> template <class Body>
+    void Myers<T>::run(const Body& body)
+    {
+        compareSeq(0, n, 0, m, body);
+    }
+
+    ///// Words ////////////////////////////////////////////////////////////////
+
+    enum class CharClass : unsigned char { SPACE, PUNCT, WORD, IDEOGRAPH };
+
+    CharClass charClass(char32_t c)
+    {
+        if (c < 0x80) {
+            if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z')
+                    || (c >= 'a' && c <= 'z') || c == '_')
+                return CharClass::WORD;
+            if (c <= ' ')
+                return CharClass::SPACE;
+            return CharClass::PUNCT;
+        }
+        switch (c) {
+        case 0xA0:      // NBSP
+        case 0x1680:    // Ogham space
+        case 0x2028:    // line separator
+        case 0x2029:    // paragraph separator
+        case 0x202F:    // narrow NBSP
+        case 0x205F:    // math space
+        case 0x3000:    // ideographic space
+            return CharClass::SPACE;
+        default: ;
+        }
+        if (c >= 0x2000 && c <= 0x200B)     // various spaces
+            return CharClass::SPACE;
+        if ((c >= 0x2010 && c <= 0x2027) || (c >= 0x2030 && c <= 0x205E)
+                || (c >= 0x3001 && c <= 0x303F)     // CJK punctuation
+                || (c >= 0xFF01 && c <= 0xFF0F))    // fullwidth punctuation
+            return CharClass::PUNCT;
+        if ((c >= 0x2E80 && c <= 0x9FFF)    // CJK radicals…unified ideographs, kana
+                || (c >= 0xF900 && c <= 0xFAFF)     // CJK compatibility ideographs
+                || (c >= 0x20000 && c <= 0x3FFFF))  // CJK extensions
+            return CharClass::IDEOGRAPH;
+        return CharClass::WORD;
+    }
+
+    /// @return [+] a and b are in the same word, so we cannot break between
+    bool isSameWord(char32_t a, char32_t b)
+    {
+        auto ca = charClass(a);
+        return (ca == charClass(b)
+                && (ca == CharClass::WORD || ca == CharClass::SPACE));
+    }
+
+    /// Splits text into words; punctuation and ideographs are one-char words
+    /// @return  starts of words, plus text length
+    SafeVector<size_t> splitWords(std::u32string_view x)
+    {
+        SafeVector<size_t> r;
+        for (size_t i = 0; i < x.length(); ++i) {
+            if (i == 0 || !isSameWord(x[i - 1], x[i]))
+                r.push_back(i);
+        }
+        r.push_back(x.length());
+        return r;
+    }
+
+    void appendWordScript(
+            dif::EditScript& r,
+            std::u32string_view a,
+            std::u32string_view b)
+    {
+        auto wa = splitWords(a);
+        auto wb = splitWords(b);
+
+        // Words → numbers
+        std::unordered_map<std::u32string_view, uint32_t> dic;
+        auto toIds = [&dic](std::u32string_view x, const SafeVector<size_t>& words) {
+            SafeVector<uint32_t> ids;
+            ids.reserve(words.size() - 1);
+            for (size_t i = 1; i < words.size(); ++i) {
+                auto word = x.substr(words[i - 1], words[i] - words[i - 1]);
+                auto [it, wasIns] = dic.try_emplace(word, dic.size());
+                ids.push_back(it->second);
+            }
+            return ids;
+        };
+        auto ia = toIds(a, wa);
+        auto ib = toIds(b, wb);
+
+        Myers<uint32_t> myers(ia, ib);
+        myers.run([&](bool isCommon, size_t xBeg, size_t xEnd, size_t yBeg, size_t yEnd) {
+            appendSpan(r, isCommon,
+                       a.substr(wa[xBeg], wa[xEnd] - wa[xBeg]),
+                       b.substr(wb[yBeg], wb[yEnd] - wb[yBeg]));
+        });
+    }
+
+}   // anon namespace
+
+
+void dif::detail::appendMyersScript(
+        EditScript& r, std::u32string_view a, std::u32string_view b)
+{
+    Myers<char32_t> myers(a, b);
+    myers.run([&](bool isCommon, size_t xBeg, size_t xEnd, size_t yBeg, size_t yEnd) {
+        appendSpan(r, isCommon, a.substr(xBeg, xEnd - xBeg), b.substr(yBeg, yEnd - yBeg));
+    });
+}
+
+
+dif::EditScript dif::editScript(
+        std::u32string_view a, std::u32string_view b, Granularity granularity)
+{
+    EditScript r;
+    // For simplicity, we cut head and tail
+    auto split = simpleSplit(a, b);
+    if (granularity == Granularity::WORD) {
+        // Cut them by word boundary
+        size_t pref = split.commonPrefix.length();
+        while (pref != 0 && ((pref < a.length() && isSameWord(a[pref - 1], a[pref]))
+                          || (pref < b.length() && isSameWord(b[pref - 1], b[pref]))))
+            --pref;
+        size_t suff = split.commonSuffix.length();
+        auto isInWord = [suff](std::u32string_view x) {
+            auto i = x.length() - suff;
+            return (i != 0 && isSameWord(x[i - 1], x[i]));
+        };
+        while (suff != 0 && (isInWord(a) || isInWord(b)))
+            --suff;
+        split.commonPrefix = a.substr(0, pref);
+        split.aMid = a.substr(pref, a.length() - pref - suff);
+        split.bMid = b.substr(pref, b.length() - pref - suff);
+        split.commonSuffix = a.substr(a.length() - suff);
+    }
+    if (!split.commonPrefix.empty())
+        r.emplace_back(split.commonPrefix, UEMPTY, true);
+    if (split.aMid.empty() || split.bMid.empty()) {
+        detail::appendDpScript(r, split.aMid, split.bMid);
+    } else if (granularity == Granularity::WORD) {
+        appendWordScript(r, split.aMid, split.bMid);
+    } else if (split.aMid.length() * split.bMid.length() <= DP_MAX_CELLS) {
+        detail::appendDpScript(r, split.aMid, split.bMid);
+    } else {
+        detail::appendMyersScript(r, split.aMid, split.bMid);
+    }
+    if (!split.commonSuffix.empty())
+        r.emplace_back(split.commonSuffix, UEMPTY, true);
+    return r;
+}
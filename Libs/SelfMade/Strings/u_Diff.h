@@ -0,0 +1,54 @@
+#pragma once
+
+// C++
+#include <string>
+#include <cstddef>
+
+#include "u_Vector.h"
+
+namespace dif {
+
+    struct Pair {
+        std::u32string_view del, ins;
+        bool isCommon = false;
+    };
+    struct SimpleSplit {
+        std::u32string_view commonPrefix, aMid, bMid, commonSuffix;
+    };
+
+    using EditScript = SafeVector<Pair>;
+
+    enum class Granularity : unsigned char {
+        CHAR,   ///< any code point may differ
+        WORD    ///< words differ as a whole; CJK ideographs are words themselves
+    };
+
+    /// Bigger n×m of middle part → Myers rather than weighted DP
+    constexpr size_t DP_MAX_CELLS = 1'000'000;
+    /// Myers’ search from both ends gives up no earlier than after
+    /// this many steps each, taking the furthest point reached;
+    /// so scripts of up to 2× that dels+inses are surely minimal
+    constexpr ptrdiff_t MYERS_MIN_COST = 256;
+
+    /// Gets common prefix and suffix, to reduce O(n²) of edit distance algo
+    SimpleSplit simpleSplit(std::u32string_view a, std::u32string_view b);
+
+    /// Gets edit script which turns a to b
+    /// Script consists of Pair’s whose isCommon interleaves true/false.
+    /// Short strings: weighted edit distance, O(nm) time and memory;
+    /// long ones: Myers’ diff, O((n+m)·d) time, O(n+m) memory.
+    EditScript editScript(std::u32string_view a, std::u32string_view b,
+                          Granularity granularity = Granularity::CHAR);
+
+    namespace detail {
+        // Engines of editScript, w/o prefix/suffix cutting; for testing
+
+        /// Weighted edit distance, O(nm)
+        void appendDpScript(
+                EditScript& r, std::u32string_view a, std::u32string_view b);
+        /// Myers’ diff, code point by code point
+        void appendMyersScript(
+                EditScript& r, std::u32string_view a, std::u32string_view b);
+    }
+
+}
@@ -0,0 +1,146 @@
+// My header
+#include "u_StringArena.h"
+
+// C++
+#include <cstring>
+#include <utility>
+#include <stdexcept>
+
+
+///// ArenaString //////////////////////////////////////////////////////////////
+
+
+void str::ArenaString::assignOwn(std::u8string_view x)
+{
+    if (x.empty()) {
+        p = nullptr;
+        len = 0;
+        isOwn = false;
+        return;
+    }
+    if (x.length() > UINT32_MAX)
+        throw std::length_error("ArenaString: string too long");
+    auto buf = new char8_t[x.length() + 1];
+    std::memcpy(buf, x.data(), x.length());
+    buf[x.length()] = 0;
+    p = buf;
+    len = static_cast<uint32_t>(x.length());
+    isOwn = true;
+}
+
+
+void str::ArenaString::freeOwn() noexcept
+{
+    if (isOwn)
+        delete[] p;
+}
+
+
+void str::ArenaString::stealFrom(ArenaString& x)
+{
+    if (x.isOwn) {
+        p = std::exchange(x.p, nullptr);
+        len = std::exchange(x.len, 0);
+        isOwn = std::exchange(x.isOwn, false);
+    } else {
+        // Borrowed → copy, the target may outlive arena
+        assignOwn(x.sv());
+    }
+}
+
+
+str::ArenaString& str::ArenaString::operator = (std::u8string_view x)
+{
+    // x may be a part of me → make a new buffer first
+    ArenaString tmp(x);
+    freeOwn();
+    p = std::exchange(tmp.p, nullptr);
+    len = std::exchange(tmp.len, 0);
+    isOwn = std::exchange(tmp.isOwn, false);
+    return *this;
+}
+
+
+str::ArenaString& str::ArenaString::operator = (ArenaString&& x)
+{
+    if (&x != this) {
+        if (x.isOwn) {
+            freeOwn();
+            p = std::exchange(x.p, nullptr);
+            len = std::exchange(x.len, 0);
+            isOwn = std::exchange(x.isOwn, false);
+        } else {
+            operator = (x.sv());
+        }
+    }
+    return *this;
+}
+
+
+///// StringArena //////////////////////////////////////////////////////////////
+
+
+char8_t* str::StringArena::newChunk(size_t size)
+{
+    auto& chunk = chunks.emplace_back(new char8_t[size]);
+    fnAllocated += size;
+    return chunk.get();
+}
+
+
+void str::StringArena::put(ArenaString& target, std::u8string_view x)
+{
+    if (x.empty()) {
+        target.clear();
+        return;
+    }
+    if (x.length() > UINT32_MAX)
+        throw std::length_error("StringArena: string too long");
+
+    auto size = x.length() + 1;    // + null
+    char8_t* place;
+    if (size > MAX_SHARED) {
+        place = newChunk(size);
+    } else {
+        if (size > remainder) {
+            curr = newChunk(CHUNK_SIZE);
+            remainder = CHUNK_SIZE;
+        }
+        place = curr;
+        curr += size;
+        remainder -= size;
+    }
+    std::memcpy(place, x.data(), x.length());
+    place[x.length()] = 0;
+    fnUsed += size;
+
+    target.freeOwn();
+    target.p = place;
+    target.len = static_cast<uint32_t>(x.length());
+    target.isOwn = false;
+}
+
+
+std::u8string_view str::StringArena::putBlock(std::u8string_view x)
+{
+    if (x.empty())
+        return {};
+    auto place = newChunk(x.length());
+    std::memcpy(place, x.data(), x.length());
+    fnUsed += x.length();
+    return { place, x.length() };
+}
+
+
+void str::StringArena::borrow(ArenaString& target, std::u8string_view x) noexcept
+{
+    target.freeOwn();
+    if (x.empty()) {
+        target.p = nullptr;
+        target.len = 0;
+    } else {
+        target.p = x.data();
+        target.len = static_cast<uint32_t>(x.length());
+    }
+    target.isOwn = false;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+// C++
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace str {
+
+    class StringArena;
+
+    ///
+    ///  Compact immutable string (16 bytes), either:
+    ///  • owns exact-size heap buffer;
+    ///  • borrows a piece of StringArena.
+    ///  Copy-on-write: copying/moving a borrowed string makes an own copy,
+    ///    so borrowed strings never leave the object that keeps the arena.
+    ///  Editing is done by assigning a new value.
+    ///  Data is null-terminated, as we often give it to C APIs.
+    ///
+    class ArenaString
+    {
+    public:
+        using value_type = char8_t;
+
+        ArenaString() noexcept = default;
+        ArenaString(std::u8string_view x) { assignOwn(x); }    ///< implicit OK!
+        ArenaString(const std::u8string& x) : ArenaString(std::u8string_view{x}) {}
+        ArenaString(const char8_t* x) : ArenaString(std::u8string_view{x}) {}
+        ArenaString(const ArenaString& x) : ArenaString(x.sv()) {}
+        ArenaString(ArenaString&& x) { stealFrom(x); }
+        ~ArenaString() { freeOwn(); }
+
+        ArenaString& operator = (std::u8string_view x);
+        ArenaString& operator = (const std::u8string& x)
+            { return operator = (std::u8string_view{x}); }
+        ArenaString& operator = (const char8_t* x)
+            { return operator = (std::u8string_view{x}); }
+        ArenaString& operator = (const ArenaString& x)
+            { return operator = (x.sv()); }
+        ArenaString& operator = (ArenaString&& x);
+
+        const char8_t* data() const noexcept { return p; }
+        const char8_t* c_str() const noexcept { return p ? p : u8""; }
+        size_t size() const noexcept { return len; }
+        size_t length() const noexcept { return len; }
+        bool empty() const noexcept { return (len == 0); }
+        const char8_t* begin() const noexcept { return p; }
+        const char8_t* end() const noexcept { return p + len; }
+        char8_t operator [] (size_t i) const noexcept { return p[i]; }
+        char8_t front() const noexcept { return p[0]; }
+        char8_t back() const noexcept { return p[len - 1]; }
+
+        std::u8string_view sv() const noexcept { return { p, len }; }
+        operator std::u8string_view() const noexcept { return sv(); }
+        std::u8string str() const { return std::u8string{sv()}; }
+
+        void clear() noexcept { freeOwn(); p = nullptr; len = 0; }
+        /// @return [+] data is in some arena
+        bool isBorrowed() const noexcept { return (len != 0 && !isOwn); }
+
+        friend bool operator == (const ArenaString& x, const ArenaString& y) noexcept
+            { return (x.sv() == y.sv()); }
+        friend bool operator == (const ArenaString& x, std::u8string_view y) noexcept
+            { return (x.sv() == y); }
+        friend auto operator <=> (const ArenaString& x, const ArenaString& y) noexcept
+            { return (x.sv() <=> y.sv()); }
+        friend auto operator <=> (const ArenaString& x, std::u8string_view y) noexcept
+            { return (x.sv() <=> y); }
+        // Same for types that convert to both
+        friend bool operator == (const ArenaString& x, const std::u8string& y) noexcept
+            { return (x.sv() == y); }
+        friend bool operator == (const ArenaString& x, const char8_t* y) noexcept
+            { return (x.sv() == y); }
+        friend auto operator <=> (const ArenaString& x, const std::u8string& y) noexcept
+            { return (x.sv() <=> y); }
+        friend auto operator <=> (const ArenaString& x, const char8_t* y) noexcept
+            { return (x.sv() <=> y); }
+    private:
+        friend class StringArena;
+        const char8_t* p = nullptr;
+        uint32_t len = 0;
+        uint32_t isOwn = false;
+
+        void assignOwn(std::u8string_view x);
+        void freeOwn() noexcept;
+        void stealFrom(ArenaString& x);
+    };
+
+    ///
+    ///  Append-only storage for many strings loaded at once.
+    ///  Everything is freed together with the arena.
+    ///  @warning  Not thread-safe: one arena is filled by one loader.
+    ///
+    class StringArena
+    {
+    public:
+        StringArena() = default;
+        StringArena(const StringArena&) = delete;
+        StringArena& operator = (const StringArena&) = delete;
+
+        /// Copies x into arena, target then borrows arena’s data
+        /// @warning  Keep the arena alive while target lives
+        void put(ArenaString& target, std::u8string_view x);
+        /// Copies a ready block of null-terminated strings at once,
+        ///   e.g. string table of some binary file
+        /// @return  the copy in arena, give its pieces to borrow
+        std::u8string_view putBlock(std::u8string_view x);
+        /// Target borrows x w/o copying
+        /// @pre  x is a piece of putBlock’s result, and x.end() is null
+        void borrow(ArenaString& target, std::u8string_view x) noexcept;
+
+        /// @return  bytes actually taken by strings
+        size_t nBytesUsed() const noexcept { return fnUsed; }
+        /// @return  bytes allocated for chunks
+        size_t nBytesAllocated() const noexcept { return fnAllocated; }
+    private:
+        static constexpr size_t CHUNK_SIZE = 64 * 1024;
+        /// Longer strings go to their own chunks
+        static constexpr size_t MAX_SHARED = CHUNK_SIZE / 8;
+        std::vector<std::unique_ptr<char8_t[]>> chunks;
+        char8_t* curr = nullptr;
+        size_t remainder = 0;
+        size_t fnUsed = 0, fnAllocated = 0;
+
+        char8_t* newChunk(size_t size);
+    };
+
+}   // namespace str
@@ -0,0 +1,214 @@
+#pragma once
+
+///
+///  Binary catalog of strings, exported by UTranslator: lookup by joined ID
+///    right in the mapped file, w/o parsing and allocation.
+///  Header-only, take it together with u_MappedFile.h.
+///
+///  File (numbers are native, byte order mark guards them):
+///    Header
+///    uint32_t disp[n]     displacements of minimal perfect hash, by bucket
+///    uint32_t slots[n]    slot → entry
+///    Entry entries[n]     in export order
+///    char8_t blob[]       IDs and texts, each one followed by null
+///  Lookup:
+///    h = hashId(id);  d = disp[mix(h, 0) % n];
+///    slot = (d & DIRECT) ? (d & ~DIRECT) : mix(h, d) % n;
+///    the entry is entries[slots[slot]], if its ID is the same:
+///    hash is perfect for IDs that are present only.
+///
+
+// C++
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+// Libs
+#include "u_MappedFile.h"
+
+namespace bincat {
+
+    constexpr char MAGIC[8] { 'U', 'T', 'r', 'a', 'n', 'C', 'a', 't' };
+    constexpr uint32_t VERSION = 1;
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    /// Flag in disp: the bucket has one ID, and the rest is its slot
+    constexpr uint32_t DIRECT = 0x8000'0000;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrderMark;
+        uint32_t nEntries;
+        uint32_t reserved;
+        uint64_t blobSize;
+    };
+    static_assert(sizeof(Header) == 32);
+
+    struct Entry {
+        uint32_t idOffset, idLength;
+        uint32_t textOffset, textLength;
+    };
+    static_assert(sizeof(Entry) == 16);
+
+    /// FNV-1a 64 of ID, computed once per lookup
+    constexpr uint64_t hashId(std::u8string_view x) noexcept
+    {
+        uint64_t h = 14695981039346656037ull;
+        for (auto c : x) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    /// Seeded hash function of the family, made of ID’s hash
+    ///   (MurmurHash3’s finalizer: FNV’s low bits are weak, and we take modulo)
+    constexpr uint64_t mix(uint64_t h, uint32_t seed) noexcept
+    {
+        h ^= seed * 0x9E37'79B9'7F4A'7C15ull;
+        h ^= h >> 33;
+        h *= 0xFF51'AFD7'ED55'8CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CE'B9FE'1A85'EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    struct Item {
+        std::u8string_view id, text;
+    };
+
+    ///
+    ///  Read-only catalog, mapped into memory.
+    ///  Opening checks just header and sizes, the rest is checked
+    ///    on access: bad file does not crash, just finds nothing.
+    ///
+    class Catalog
+    {
+    public:
+        Catalog() noexcept = default;
+        explicit Catalog(const std::filesystem::path& fname) noexcept { open(fname); }
+        Catalog(const Catalog&) = delete;
+        Catalog(Catalog&& x) noexcept { *this = std::move(x); }
+        Catalog& operator = (const Catalog&) = delete;
+        Catalog& operator = (Catalog&& x) noexcept;
+
+        /// @return [+] OK  [-] cannot map, or not a catalog
+        bool open(const std::filesystem::path& fname) noexcept;
+        void close() noexcept { fFile.close(); fSize = 0; }
+        bool isOpen() const noexcept { return fFile.isOpen(); }
+
+        /// @return  # of texts
+        size_t size() const noexcept { return fSize; }
+        /// @return  text, followed by null;  [nullopt] no such ID
+        std::optional<std::u8string_view> find(std::u8string_view id) const noexcept;
+        /// @return  i’th text in export order; [empty] bad file
+        Item at(size_t i) const noexcept;
+    private:
+        mf::MappedFile fFile;
+        uint32_t fSize = 0;
+        const uint32_t* fDisp = nullptr;
+        const uint32_t* fSlots = nullptr;
+        const Entry* fEntries = nullptr;
+        std::u8string_view fBlob;
+
+        /// @return [+] piece of blob  [nullopt] bad
+        std::optional<std::u8string_view> piece(uint32_t offset, uint32_t length) const noexcept;
+    };
+
+}   // namespace bincat
+
+
+///// Implementation ///////////////////////////////////////////////////////////
+
+
+inline bincat::Catalog& bincat::Catalog::operator = (Catalog&& x) noexcept
+{
+    if (&x != this) {
+        fFile = std::move(x.fFile);
+        fSize = std::exchange(x.fSize, 0);
+        fDisp = x.fDisp;
+        fSlots = x.fSlots;
+        fEntries = x.fEntries;
+        fBlob = x.fBlob;
+    }
+    return *this;
+}
+
+
+inline bool bincat::Catalog::open(const std::filesystem::path& fname) noexcept
+{
+    close();
+    if (!fFile.open(fname))
+        return false;
+    if (fFile.size() < sizeof(Header)) {
+        close();
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, fFile.data(), sizeof(Header));
+    // 32-bit count → no overflow
+    uint64_t blobPos = sizeof(Header)
+            + uint64_t{header.nEntries} * (sizeof(uint32_t) * 2 + sizeof(Entry));
+    if (std::memcmp(header.magic, MAGIC, std::size(MAGIC)) != 0
+            || header.version != VERSION
+            || header.byteOrderMark != BYTE_ORDER_MARK
+            || blobPos + header.blobSize != fFile.size()) {
+        close();
+        return false;
+    }
+    fSize = header.nEntries;
+    // Mapping is page-aligned, and so are the arrays within
+    fDisp = reinterpret_cast<const uint32_t*>(fFile.data() + sizeof(Header));
+    fSlots = fDisp + fSize;
+    fEntries = reinterpret_cast<const Entry*>(fSlots + fSize);
+    fBlob = { reinterpret_cast<const char8_t*>(fFile.data() + blobPos), header.blobSize };
+    return true;
+}
+
+
+inline auto bincat::Catalog::piece(
+        uint32_t offset, uint32_t length) const noexcept
+    -> std::optional<std::u8string_view>
+{
+    // length < rest: null after the piece is within blob too
+    if (offset >= fBlob.size() || length >= fBlob.size() - offset)
+        return std::nullopt;
+    return fBlob.substr(offset, length);
+}
+
+
+inline auto bincat::Catalog::find(
+        std::u8string_view id) const noexcept -> std::optional<std::u8string_view>
+{
+    if (fSize == 0)
+        return std::nullopt;
+    auto h = hashId(id);
+    auto d = fDisp[mix(h, 0) % fSize];
+    auto slot = (d & DIRECT) ? (d & ~DIRECT) : static_cast<uint32_t>(mix(h, d) % fSize);
+    if (slot >= fSize)
+        return std::nullopt;
+    auto iEntry = fSlots[slot];
+    if (iEntry >= fSize)
+        return std::nullopt;
+    auto& entry = fEntries[iEntry];
+    if (piece(entry.idOffset, entry.idLength) != id)
+        return std::nullopt;
+    return piece(entry.textOffset, entry.textLength);
+}
+
+
+inline bincat::Item bincat::Catalog::at(size_t i) const noexcept
+{
+    if (i >= fSize)
+        return {};
+    auto& entry = fEntries[i];
+    auto id = piece(entry.idOffset, entry.idLength);
+    auto text = piece(entry.textOffset, entry.textLength);
+    if (!id || !text)
+        return {};
+    return { *id, *text };
+}
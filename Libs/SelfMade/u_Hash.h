@@ -0,0 +1,55 @@
+#pragma once
+
+// C++
+#include <cstdint>
+#include <string_view>
+
+namespace hash {
+
+    ///
+    ///  FNV-1a, 64 bit: simple, and stable between runs and platforms.
+    ///  Not for cryptography, just to find out whether something changed.
+    ///
+    class Fnv64
+    {
+    public:
+        static constexpr uint64_t BASIS = 14695981039346656037ull;
+        static constexpr uint64_t PRIME = 1099511628211ull;
+
+        constexpr void addBytes(const unsigned char* data, size_t length) noexcept
+        {
+            for (size_t i = 0; i < length; ++i) {
+                v ^= data[i];
+                v *= PRIME;
+            }
+        }
+
+        /// Adds number, 8 bytes little-endian
+        constexpr void addNum(uint64_t x) noexcept
+        {
+            for (int i = 0; i < 8; ++i) {
+                v ^= static_cast<unsigned char>(x);
+                v *= PRIME;
+                x >>= 8;
+            }
+        }
+
+        /// Adds string with its length, so that fields do not stick together:
+        ///   {"ab", "c"} and {"a", "bc"} are hashed differently
+        template <class Ch>
+        void addField(std::basic_string_view<Ch> x) noexcept
+        {
+            addNum(x.length());
+            addBytes(reinterpret_cast<const unsigned char*>(x.data()),
+                     x.length() * sizeof(Ch));
+        }
+
+        void addField(std::string_view x) noexcept { addField<char>(x); }
+        void addField(std::u8string_view x) noexcept { addField<char8_t>(x); }
+
+        constexpr uint64_t value() const noexcept { return v; }
+    private:
+        uint64_t v = BASIS;
+    };
+
+}   // namespace hash
@@ -0,0 +1,172 @@
+#pragma once
+
+///
+///  Read-only file mapped into memory, header-only.
+///  Windows and POSIX.
+///
+
+// C++
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace mf {
+
+    ///
+    ///  Read-only mapping of the whole file.
+    ///  Errors are not thrown: mapping is used for caches and fast paths,
+    ///    and caller has a slower way then.
+    ///  @warning  Someone who changes the file in place changes the data too,
+    ///            write such files via temporary file + rename
+    ///
+    class MappedFile
+    {
+    public:
+        MappedFile() noexcept = default;
+        explicit MappedFile(const std::filesystem::path& fname) noexcept { open(fname); }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& x) noexcept
+            : fData(std::exchange(x.fData, nullptr)),
+              fSize(std::exchange(x.fSize, 0)),
+              fIsOpen(std::exchange(x.fIsOpen, false)) {}
+        MappedFile& operator = (const MappedFile&) = delete;
+        MappedFile& operator = (MappedFile&& x) noexcept;
+        ~MappedFile() { close(); }
+
+        /// @return [+] OK, an empty file is OK too  [-] cannot open or map
+        bool open(const std::filesystem::path& fname) noexcept;
+        void close() noexcept;
+
+        bool isOpen() const noexcept { return fIsOpen; }
+        const std::byte* data() const noexcept { return fData; }
+        size_t size() const noexcept { return fSize; }
+        std::string_view sv() const noexcept
+            { return { reinterpret_cast<const char*>(fData), fSize }; }
+    private:
+        const std::byte* fData = nullptr;   ///< [0] closed or empty
+        size_t fSize = 0;
+        bool fIsOpen = false;
+    };
+
+}   // namespace mf
+
+
+///// Implementation ///////////////////////////////////////////////////////////
+
+
+inline mf::MappedFile& mf::MappedFile::operator = (MappedFile&& x) noexcept
+{
+    if (&x != this) {
+        close();
+        fData = std::exchange(x.fData, nullptr);
+        fSize = std::exchange(x.fSize, 0);
+        fIsOpen = std::exchange(x.fIsOpen, false);
+    }
+    return *this;
+}
+
+
+#ifdef _WIN32
+
+inline bool mf::MappedFile::open(const std::filesystem::path& fname) noexcept
+{
+    close();
+    HANDLE hFile = CreateFileW(fname.c_str(), GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hFile, &size)
+            || static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX) {
+        CloseHandle(hFile);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        // Empty file cannot be mapped
+        CloseHandle(hFile);
+        fIsOpen = true;
+        return true;
+    }
+    HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // Mapping and view hold the file themselves
+    CloseHandle(hFile);
+    if (!hMapping)
+        return false;
+    auto view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hMapping);
+    if (!view)
+        return false;
+    fData = static_cast<const std::byte*>(view);
+    fSize = static_cast<size_t>(size.QuadPart);
+    fIsOpen = true;
+    return true;
+}
+
+
+inline void mf::MappedFile::close() noexcept
+{
+    if (fData)
+        UnmapViewOfFile(fData);
+    fData = nullptr;
+    fSize = 0;
+    fIsOpen = false;
+}
+
+#else
+
+inline bool mf::MappedFile::open(const std::filesystem::path& fname) noexcept
+{
+    close();
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        // Empty file cannot be mapped
+        ::close(fd);
+        fIsOpen = true;
+        return true;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Mapping holds the file itself
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return false;
+    fData = static_cast<const std::byte*>(p);
+    fSize = st.st_size;
+    fIsOpen = true;
+    return true;
+}
+
+
+inline void mf::MappedFile::close() noexcept
+{
+    if (fData)
+        munmap(const_cast<std::byte*>(fData), fSize);
+    fData = nullptr;
+    fSize = 0;
+    fIsOpen = false;
+}
+
+#endif
@@ -0,0 +1,426 @@
+// My header
+#include "u_XmlSax.h"
+
+// C++
+#include <cstring>
+
+
+///// Attrs ////////////////////////////////////////////////////////////////////
+
+
+const sax::Attr* sax::Attrs::find(std::string_view name) const
+{
+    for (auto& v : items) {
+        if (v.name == name)
+            return &v;
+    }
+    return nullptr;
+}
+
+
+std::string_view sax::Attrs::value(std::string_view name, std::string_view def) const
+{
+    if (auto p = find(name))
+        return p->value;
+    return def;
+}
+
+
+bool sax::Attrs::asBool(std::string_view name, bool def) const
+{
+    auto p = find(name);
+    if (!p)
+        return def;
+    if (p->value.empty())
+        return false;
+    switch (p->value[0]) {
+    case '1':
+    case 't':
+    case 'T':
+    case 'y':
+    case 'Y':
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+std::string_view sax::Attrs::rqValue(
+        std::string_view tagName, std::string_view name) const
+{
+    auto p = find(name);
+    if (!p) {
+        std::string s = "Tag <";
+        s.append(tagName);
+        s.append("> needs attribute <");
+        s.append(name);
+        s.append(">");
+        throw Error(s);
+    }
+    return p->value;
+}
+
+
+///// Parser ///////////////////////////////////////////////////////////////////
+
+
+namespace {
+
+    enum class Eol : unsigned char { TO_LF, TO_SPACE };
+
+    inline bool isSpace(char c)
+        { return (c == ' ' || c == '\t' || c == '\r' || c == '\n'); }
+
+    inline bool isNameEnd(char c)
+        { return isSpace(c) || c == '/' || c == '>' || c == '='; }
+
+    /// Writes code point as UTF-8, same as pugixml’s utf8_writer::any
+    void appendUtf8(std::string& r, unsigned c)
+    {
+        if (c < 0x80) {
+            r += static_cast<char>(c);
+        } else if (c < 0x800) {
+            r += static_cast<char>(0xC0 | (c >> 6));
+            r += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            r += static_cast<char>(0xE0 | (c >> 12));
+            r += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            r += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            r += static_cast<char>(0xF0 | (c >> 18));
+            r += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            r += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            r += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    /// Decodes escape starting at p (*p == '&')
+    /// @return  position after escape; if escape is bad, after the
+    ///          part that was copied as-is (pugixml’s behaviour)
+    const char* decodeEscape(const char* p, const char* end, std::string& r)
+    {
+        auto rest = std::string_view(p + 1, end - p - 1);
+        auto simple = [&](std::string_view name, char c) -> const char* {
+            if (rest.starts_with(name)) {
+                r += c;
+                return p + 1 + name.length();
+            }
+            return nullptr;
+        };
+        if (rest.starts_with('#')) {
+            const char* q = p + 2;
+            unsigned code = 0;
+            bool isHex = (q != end && *q == 'x');
+            if (isHex)
+                ++q;
+            if (q != end && *q == ';') {
+                // &#; &#x; → copied as-is, ; is then parsed normally
+                r.append(p, q);
+                return q;
+            }
+            for (; q != end; ++q) {
+                char c = *q;
+                if (c >= '0' && c <= '9') {
+                    code = code * (isHex ? 16 : 10) + (c - '0');
+                } else if (isHex && (c | ' ') >= 'a' && (c | ' ') <= 'f') {
+                    code = code * 16 + ((c | ' ') - 'a' + 10);
+                } else if (c == ';') {
+                    appendUtf8(r, code);
+                    return q + 1;
+                } else {
+                    break;
+                }
+            }
+            // Cancel
+            r.append(p, q);
+            return q;
+        }
+        if (auto q = simple("amp;", '&')) return q;
+        if (auto q = simple("apos;", '\'')) return q;
+        if (auto q = simple("gt;", '>')) return q;
+        if (auto q = simple("lt;", '<')) return q;
+        if (auto q = simple("quot;", '"')) return q;
+        r += '&';
+        return p + 1;
+    }
+
+    /// Decodes text/attribute value
+    /// @return  either x itself (nothing to decode) or cache
+    std::string_view decodeText(
+            std::string_view x, std::string& cache, Eol eol, bool wantEscapes)
+    {
+        std::string_view specials;
+        switch (eol) {
+        case Eol::TO_LF:
+            specials = wantEscapes ? "&\r" : "\r";
+            break;
+        case Eol::TO_SPACE:
+            specials = wantEscapes ? "&\r\n\t" : "\r\n\t";
+            break;
+        }
+        if (x.find_first_of(specials) == std::string_view::npos)
+            return x;
+
+        cache.clear();
+        const char* p = x.data();
+        const char* end = p + x.length();
+        while (p != end) {
+            char c = *p;
+            switch (c) {
+            case '&':
+                if (wantEscapes) {
+                    p = decodeEscape(p, end, cache);
+                    continue;
+                }
+                break;
+            case '\r':
+                cache += (eol == Eol::TO_LF) ? '\n' : ' ';
+                ++p;
+                if (p != end && *p == '\n')
+                    ++p;
+                continue;
+            case '\n':
+            case '\t':
+                if (eol == Eol::TO_SPACE)
+                    c = ' ';
+                break;
+            default: ;
+            }
+            cache += c;
+            ++p;
+        }
+        return cache;
+    }
+
+    class Parser
+    {
+    public:
+        Parser(std::string_view aData, sax::Callback& aCb)
+            : p(aData.data()), end(aData.data() + aData.length()), cb(aCb) {}
+        void run();
+    private:
+        const char* p;
+        const char* end;
+        sax::Callback& cb;
+        std::vector<std::string_view> stack;
+        sax::Attrs attrs;
+        std::vector<std::string> attrCache;
+        std::string textCache;
+        bool hadRoot = false;
+
+        [[noreturn]] static void fail(const char* what) { throw sax::Error(what); }
+        void skipSpaces() { while (p != end && isSpace(*p)) ++p; }
+        /// Skips until text, p is after it
+        void skipPast(std::string_view text, const char* what);
+        std::string_view readName();
+        void readText();
+        void readCdata();
+        void readDeclaration();
+        void readStartTag();
+        void readEndTag();
+    };
+
+    void Parser::skipPast(std::string_view text, const char* what)
+    {
+        auto rest = std::string_view(p, end - p);
+        auto pos = rest.find(text);
+        if (pos == std::string_view::npos)
+            fail(what);
+        p += pos + text.length();
+    }
+
+    std::string_view Parser::readName()
+    {
+        auto beg = p;
+        while (p != end && !isNameEnd(*p))
+            ++p;
+        if (p == beg)
+            fail("Bad tag/attribute name");
+        return { beg, static_cast<size_t>(p - beg) };
+    }
+
+    void Parser::readText()
+    {
+        auto beg = p;
+        auto q = static_cast<const char*>(std::memchr(p, '<', end - p));
+        p = q ? q : end;
+        if (stack.empty()) {
+            // Outside of root: only whitespace allowed
+            for (auto c = beg; c != p; ++c)
+                if (!isSpace(*c))
+                    fail("Text outside of root element");
+            return;
+        }
+        std::string_view raw(beg, p - beg);
+        cb.onText(decodeText(raw, textCache, Eol::TO_LF, true));
+    }
+
+    void Parser::readCdata()
+    {
+        // p is after <![CDATA[
+        auto rest = std::string_view(p, end - p);
+        auto pos = rest.find("]]>");
+        if (pos == std::string_view::npos)
+            fail("Unclosed CDATA");
+        if (stack.empty())
+            fail("CDATA outside of root element");
+        cb.onText(decodeText(rest.substr(0, pos), textCache, Eol::TO_LF, false));
+        p += pos + 3;
+    }
+
+    void Parser::readDeclaration()
+    {
+        // p is after <?
+        auto beg = p;
+        skipPast("?>", "Unclosed processing instruction");
+        std::string_view body(beg, p - beg - 2);
+        if (body.starts_with("xml") && body.length() > 3 && isSpace(body[3])) {
+            // Declaration: we support UTF-8 only
+            auto pos = body.find("encoding");
+            if (pos != std::string_view::npos) {
+                auto rest = body.substr(pos + 8);
+                auto q1 = rest.find_first_of("\"'");
+                if (q1 == std::string_view::npos)
+                    fail("Bad declaration");
+                auto q2 = rest.find(rest[q1], q1 + 1);
+                if (q2 == std::string_view::npos)
+                    fail("Bad declaration");
+                auto enc = rest.substr(q1 + 1, q2 - q1 - 1);
+                std::string lower(enc);
+                for (auto& c : lower)
+                    c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+                if (lower != "utf-8" && lower != "utf8")
+                    fail("Encodings other than UTF-8 are not supported");
+            }
+        }
+    }
+
+    void Parser::readStartTag()
+    {
+        // p is after <
+        if (hadRoot && stack.empty())
+            fail("Several root elements");
+        auto name = readName();
+
+        attrs.items.clear();
+        size_t nAttrs = 0;
+        while (true) {
+            skipSpaces();
+            if (p == end)
+                fail("Unclosed tag");
+            if (*p == '>' || *p == '/')
+                break;
+            auto attrName = readName();
+            skipSpaces();
+            if (p == end || *p != '=')
+                fail("Attribute needs =");
+            ++p;
+            skipSpaces();
+            if (p == end || (*p != '"' && *p != '\''))
+                fail("Attribute needs quotes");
+            char quote = *p++;
+            auto q = static_cast<const char*>(std::memchr(p, quote, end - p));
+            if (!q)
+                fail("Unclosed attribute");
+            std::string_view rawValue(p, q - p);
+            if (rawValue.find('<') != std::string_view::npos)
+                fail("< in attribute");
+            p = q + 1;
+            if (nAttrs >= attrCache.size())
+                attrCache.emplace_back();
+            auto value = decodeText(rawValue, attrCache[nAttrs], Eol::TO_SPACE, true);
+            // attrCache may still grow and move strings → null = “take from cache”
+            if (value.data() == attrCache[nAttrs].data())
+                value = {};
+            attrs.items.push_back({ attrName, value });
+            ++nAttrs;
+        }
+        for (size_t i = 0; i < nAttrs; ++i) {
+            auto& v = attrs.items[i];
+            if (!v.value.data())
+                v.value = attrCache[i];
+        }
+
+        bool isEmpty = (*p == '/');
+        if (isEmpty) {
+            ++p;
+            if (p == end || *p != '>')
+                fail("Bad empty tag");
+        }
+        ++p;    // >
+
+        hadRoot = true;
+        cb.onStart(name, attrs);
+        if (isEmpty) {
+            cb.onEnd(name);
+        } else {
+            stack.push_back(name);
+        }
+    }
+
+    void Parser::readEndTag()
+    {
+        // p is after </
+        auto name = readName();
+        skipSpaces();
+        if (p == end || *p != '>')
+            fail("Bad end tag");
+        ++p;
+        if (stack.empty() || stack.back() != name)
+            fail("Mismatched end tag");
+        stack.pop_back();
+        cb.onEnd(name);
+    }
+
+    void Parser::run()
+    {
+        using namespace std::string_view_literals;
+        auto all = std::string_view(p, end - p);
+        if (all.starts_with("\xEF\xBB\xBF"sv)) {
+            p += 3;
+        } else if (!all.empty() && static_cast<unsigned char>(all[0]) >= 0xFE) {
+            fail("UTF-16/32 is not supported");
+        }
+        if (std::memchr(p, 0, end - p))
+            fail("Zero bytes are not supported");
+
+        while (p != end) {
+            if (*p != '<') {
+                readText();
+                continue;
+            }
+            ++p;
+            auto rest = std::string_view(p, end - p);
+            if (rest.starts_with('/')) {
+                ++p;
+                readEndTag();
+            } else if (rest.starts_with('?')) {
+                ++p;
+                readDeclaration();
+            } else if (rest.starts_with("!--"sv)) {
+                p += 3;
+                skipPast("-->", "Unclosed comment");
+            } else if (rest.starts_with("![CDATA["sv)) {
+                p += 8;
+                readCdata();
+            } else if (rest.starts_with('!')) {
+                fail("DOCTYPE is not supported");
+            } else {
+                readStartTag();
+            }
+        }
+        if (!stack.empty())
+            fail("Unclosed element");
+        if (!hadRoot)
+            fail("No root element");
+    }
+
+}   // anon namespace
+
+
+void sax::parse(std::string_view data, Callback& cb)
+{
+    Parser parser(data, cb);
+    parser.run();
+}
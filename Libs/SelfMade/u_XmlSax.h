@@ -0,0 +1,67 @@
+#pragma once
+
+// C++
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+///
+///  Lightweight SAX-style XML reader.
+///  Designed for files we write ourselves, mimics pugixml with
+///  parse_default | parse_ws_pcdata:
+///  • EOLs normalized: CR LF, CR → LF
+///  • Escapes &lt; &gt; &amp; &apos; &quot; &#N; &#xN; decoded
+///  • Whitespace in attributes turned to spaces
+///  • Comments, declarations and processing instructions skipped
+///  • Whitespace-only text is NOT skipped
+///
+///  Does not support: non-UTF-8 encodings, DOCTYPE.
+///  On those and on malformed XML throws sax::Error,
+///  the caller is expected to fall back to DOM.
+///
+namespace sax {
+
+    class Error : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    struct Attr {
+        std::string_view name, value;
+    };
+
+    struct Attrs {
+        std::vector<Attr> items;
+
+        /// @return  ptr to attribute, or null if absent
+        ///          (first one if several have the same name)
+        const Attr* find(std::string_view name) const;
+        /// @return [+] attribute is present
+        bool has(std::string_view name) const { return find(name); }
+        /// @return  attribute value, or def if absent
+        std::string_view value(std::string_view name, std::string_view def = {}) const;
+        /// @return  attribute value in pugixml’s as_bool manner
+        bool asBool(std::string_view name, bool def) const;
+        /// @return  attribute value
+        /// @throw   sax::Error  if absent
+        std::string_view rqValue(std::string_view tagName, std::string_view name) const;
+    };
+
+    class Callback     // interface
+    {
+    public:
+        virtual void onStart(std::string_view name, const Attrs& attrs) = 0;
+        virtual void onEnd(std::string_view name) = 0;
+        /// PCDATA or CDATA, already decoded.
+        /// @warning  Text inside one tag may come in several pieces
+        ///           (e.g. split by comment or CDATA)
+        virtual void onText(std::string_view text) = 0;
+        virtual ~Callback() = default;
+    };
+
+    /// Parses the whole buffer, calling back on each tag/text
+    /// @throw sax::Error
+    void parse(std::string_view data, Callback& cb);
+
+}   // namespace sax
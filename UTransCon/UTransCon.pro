@@ -17,15 +17,23 @@ DEFINES += AT_RANGE_CHECK
 SOURCES += \
         ../Libs/PugiXml/pugixml.cpp \
         ../Libs/SelfMade/L10n/LocFmt.cpp \
+        ../Libs/SelfMade/Mojibake/cpp/auto_casefold.cpp \
+        ../Libs/SelfMade/Mojibake/cpp/simd.cpp \
         ../Libs/SelfMade/Strings/u_Decoders.cpp \
+        ../Libs/SelfMade/Strings/u_StringArena.cpp \
         ../Libs/SelfMade/Strings/u_Strings.cpp \
         ../Libs/SelfMade/u_Args.cpp \
+        ../Libs/SelfMade/u_XmlSax.cpp \
         ../Libs/SelfMade/u_XmlUtils.cpp \
         ../UTranslator/TrProject/Modifiable.cpp \
         ../UTranslator/TrProject/TrDefines.cpp \
         ../UTranslator/TrProject/TrFile.cpp \
         ../UTranslator/TrProject/TrFileDefines.cpp \
+        ../UTranslator/TrProject/TrJournal.cpp \
+        ../UTranslator/TrProject/TrMemory.cpp \
         ../UTranslator/TrProject/TrProject.cpp \
+        ../UTranslator/TrProject/TrSearchIndex.cpp \
+        ../UTranslator/TrProject/TrSnapshot.cpp \
         ../UTranslator/TrProject/TrVirtuals.cpp \
         main.cpp
 
@@ -46,16 +54,26 @@ HEADERS += \
     ../Libs/PugiXml/pugixml.hpp \
     ../Libs/SelfMade/L10n/LocFmt.h \
     ../Libs/SelfMade/Strings/u_Decoders.h \
+    ../Libs/SelfMade/Strings/u_StringArena.h \
     ../Libs/SelfMade/Strings/u_Strings.h \
     ../Libs/SelfMade/u_Args.h \
+    ../Libs/SelfMade/u_BinCatalog.h \
+    ../Libs/SelfMade/u_Hash.h \
+    ../Libs/SelfMade/u_MappedFile.h \
     ../Libs/SelfMade/u_Vector.h \
+    ../Libs/SelfMade/u_XmlSax.h \
     ../Libs/SelfMade/u_XmlUtils.h \
     ../Libs/function_ref.hpp \
     ../UTranslator/TrProject/Modifiable.h \
     ../UTranslator/TrProject/TrDefines.h \
     ../UTranslator/TrProject/TrFile.h \
     ../UTranslator/TrProject/TrFileDefines.h \
+    ../UTranslator/TrProject/TrJournal.h \
+    ../UTranslator/TrProject/TrMemory.h \
+    ../UTranslator/TrProject/TrProgress.h \
     ../UTranslator/TrProject/TrProject.h \
+    ../UTranslator/TrProject/TrSearchIndex.h \
+    ../UTranslator/TrProject/TrSnapshot.h \
     ../UTranslator/TrProject/TrVirtuals.h
 
 VERSION_FILE = ../VERSION
@@ -1,9 +1,18 @@
 #include <iostream>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <future>
+#include <map>
+#include <thread>
 
 #include "u_Args.h"
 
 // Transl
 #include "TrProject.h"
+#include "TrMemory.h"
 
 
 using namespace std;
@@ -22,15 +31,322 @@ void writeUsage()
     std::cout << ENDL
                  "UTransCon: console version of UTranslator" ENDL
                  ENDL
-                 "USAGE: UTransCon filename.uorig(.utran) -options" ENDL
+                 "USAGE: UTransCon filename.uorig(.utran) [more files] -options" ENDL
+                 "Files:" ENDL
+                 "  several files, wildcards in file name (*.utran) and" ENDL
+                 "  @list.txt (one file per line) are allowed" ENDL
                  "Options:" ENDL
                  "-update            update (does not make files for itself!)" ENDL
                  "-rqupdate          same but update should do nothing, otherwise ERRORLEVEL" ENDL
                  "-build:directory   build L10n resource" ENDL
+                 "-incremental       with -build: skip files that did not change since last build" ENDL
+                 "-jobs:N            work in N threads (-jobs = as many as CPU has)" ENDL
+                 "                   several files: N files at once; one file: build/pre-translate it in N threads" ENDL
+                 "-pretranslate[:N]  fill untranslated texts from translation memory, and save;" ENDL
+                 "                   N = min. score 0..100 (default 100: same original only)," ENDL
+                 "                   fuzzy suggestions are marked for attention" ENDL
+                 "-memory:file       add more .utran files to translation memory, several allowed;" ENDL
+                 "                   wildcards and @list too; project and its trash are always there" ENDL
+                 "-memcache:file     keep index of -memory files there, rebuilt when they change" ENDL
+                 "-snapshot          write binary snapshots next to projects, for faster load next time" ENDL
                  ENDL;
 }
 
 
+namespace {
+
+    struct Options {
+        bool rqUpdate = false;
+        bool wantUpdate = false;
+        std::optional<std::filesystem::path> exportDir;
+        tr::Incremental incremental = tr::Incremental::NO;
+        unsigned nBuildJobs = 1;
+        tr::LoadMode loadMode = tr::LoadMode::READ;
+        std::optional<unsigned> pretranslateScore;
+        /// Memory of -memory files, shared by all projects
+        std::shared_ptr<const tr::TranslMemory> memory;
+    };
+
+    struct Outcome {
+        int exitCode = 0;
+        double ms = 0;
+        std::string log;
+    };
+
+    ///  Originals shared among translations: each is loaded once,
+    ///  even if several threads want it simultaneously
+    class OrigCache
+    {
+    public:
+        OrigCache(tr::LoadMode aLoadMode) : loadMode(aLoadMode) {}
+        std::shared_ptr<const tr::Project> get(const std::filesystem::path& path);
+    private:
+        const tr::LoadMode loadMode;
+        using Future = std::shared_future<std::shared_ptr<const tr::Project>>;
+        std::mutex mutex;
+        std::map<std::filesystem::path, Future> data;
+    };
+
+    std::shared_ptr<const tr::Project> OrigCache::get(const std::filesystem::path& path)
+    {
+        std::unique_lock lk(mutex);
+        auto [it, isNew] = data.try_emplace(path);
+        if (!isNew) {
+            auto future = it->second;
+            lk.unlock();
+            return future.get();
+        }
+        std::promise<std::shared_ptr<const tr::Project>> promise;
+        auto future = it->second = promise.get_future().share();
+        lk.unlock();
+
+        try {
+            auto prj = tr::Project::make();
+            prj->load(path, nullptr, loadMode);
+            promise.set_value(std::move(prj));
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        return future.get();
+    }
+
+    /// @return [+] s matches wildcard with * and ?
+    bool matchesWildcard(std::u8string_view s, std::u8string_view wildcard)
+    {
+        // Classic greedy algorithm with backtracking to last *
+        size_t is = 0, iw = 0;
+        size_t starW = std::u8string_view::npos, starS = 0;
+        while (is < s.length()) {
+            if (iw < wildcard.length()
+                    && (wildcard[iw] == '?' || wildcard[iw] == s[is])) {
+                ++is; ++iw;
+            } else if (iw < wildcard.length() && wildcard[iw] == '*') {
+                starW = iw++;
+                starS = is;
+            } else if (starW != std::u8string_view::npos) {
+                iw = starW + 1;
+                is = ++starS;
+            } else {
+                return false;
+            }
+        }
+        while (iw < wildcard.length() && wildcard[iw] == '*')
+            ++iw;
+        return (iw == wildcard.length());
+    }
+
+    /// Adds file name, expanding wildcards in the name (not in directory)
+    void addFileName(
+            SafeVector<std::filesystem::path>& r,
+            const std::filesystem::path& fname)
+    {
+        auto name = fname.filename().u8string();
+        if (name.find_first_of(u8"*?") == std::u8string::npos) {
+            r.push_back(fname);
+            return;
+        }
+        auto dir = fname.parent_path();
+        SafeVector<std::filesystem::path> found;
+        std::error_code ec;
+        for (auto& v : std::filesystem::directory_iterator(
+                    dir.empty() ? std::filesystem::path(".") : dir, ec)) {
+            if (v.is_regular_file()
+                    && matchesWildcard(v.path().filename().u8string(), name))
+                found.push_back(dir / v.path().filename());
+        }
+        if (found.empty())
+            throw std::logic_error("No files match " + fname.string());
+        std::sort(found.begin(), found.end());
+        r.insert(r.end(), found.begin(), found.end());
+    }
+
+    /// Adds files from @list: one per line, relative to list’s directory
+    void addListFile(
+            SafeVector<std::filesystem::path>& r,
+            const std::filesystem::path& listName)
+    {
+        std::ifstream is(listName);
+        if (!is.is_open())
+            throw std::logic_error("Cannot open list " + listName.string());
+        auto dir = listName.parent_path();
+        std::string line;
+        while (std::getline(is, line)) {
+            auto sv = str::trimSv(line);
+            if (sv.empty() || sv.starts_with('#'))
+                continue;
+            addFileName(r, dir / str::toU8sv(sv));
+        }
+    }
+
+    SafeVector<std::filesystem::path> collectFiles(const Args<char8_t>& args)
+    {
+        SafeVector<std::filesystem::path> r;
+        for (size_t i = 0; i < args.size(); ++i) {
+            std::u8string_view arg = args[i];
+            if (arg.starts_with('-'))
+                continue;
+            if (arg.starts_with('@')) {
+                addListFile(r, arg.substr(1));
+            } else {
+                addFileName(r, arg);
+            }
+        }
+        return r;
+    }
+
+    /// Loads memory from cache if it has the same files, and they did not change;
+    /// otherwise builds and saves to cache
+    std::shared_ptr<const tr::TranslMemory> loadMemory(
+            const SafeVector<std::filesystem::path>& fnames,
+            const std::optional<std::filesystem::path>& cacheName)
+    {
+        auto r = std::make_shared<tr::TranslMemory>();
+        if (fnames.empty())
+            return r;
+        SafeVector<std::filesystem::path> absNames;
+        for (auto& v : fnames)
+            absNames.push_back(std::filesystem::weakly_canonical(v));
+        std::sort(absNames.begin(), absNames.end());
+        absNames.erase(std::unique(absNames.begin(), absNames.end()), absNames.end());
+
+        if (cacheName && r->load(*cacheName)) {
+            auto cached = r->files();
+            std::sort(cached.begin(), cached.end());
+            if (cached == absNames && r->isUpToDate()) {
+                std::cout << "Loaded translation memory from <" << cacheName->string()
+                          << ">, " << r->size() << " pair(s)." ENDL;
+                return r;
+            }
+            r = std::make_shared<tr::TranslMemory>();
+        }
+        for (auto& v : absNames)
+            r->addFile(v);
+        r->build();
+        std::cout << "Built translation memory of " << absNames.size() << " file(s), "
+                  << r->size() << " pair(s)." ENDL;
+        if (cacheName)
+            r->save(*cacheName);
+        return r;
+    }
+
+    Outcome processProject(
+            const std::filesystem::path& fname,
+            const Options& opts,
+            OrigCache* origCache)
+    {
+        auto time0 = std::chrono::steady_clock::now();
+        Outcome r;
+        std::ostringstream os;
+        try {
+            if (!std::filesystem::exists(fname))
+                throw std::logic_error("File " + fname.string() + " not found");
+
+            auto prj = tr::Project::make();
+            prj->load(fname, nullptr, opts.loadMode);
+            os << "Loaded project <" << fname.string() << ">." ENDL;
+
+            if (opts.wantUpdate) {
+                std::shared_ptr<const tr::Project> original;
+                if (origCache && prj->info.isTranslation())
+                    original = origCache->get(prj->info.orig.absPath);
+                auto res = prj->updateData(tr::TrashMode::LEAVE, original.get());
+                if (res.isOriginal) {
+                    os << "WARN: the project is original, no update needed." ENDL;
+                } else {
+                    /// @todo [patch, #23] Every activity beyond patched strings is OK, check
+                    if (opts.rqUpdate && res.hasSmth())
+                        throw std::logic_error("The translation is not up to date." ENDL
+                                "It's usually turned on for known languages." ENDL
+                                "Open in UTranslator, File - Update data, save file.");
+                    os << "Updated data." ENDL;
+                }
+            }
+
+            if (opts.pretranslateScore) {
+                if (!prj->info.isTranslation()) {
+                    os << "WARN: the project is original, nothing to pre-translate." ENDL;
+                } else {
+                    tr::TranslMemory memory(opts.memory);
+                    memory.addProject(*prj);
+                    memory.build();
+                    auto n = memory.pretranslate(*prj, *opts.pretranslateScore,
+                                                  opts.nBuildJobs);
+                    os << "Pre-translated " << n << " text(s)." ENDL;
+                    if (n != 0)
+                        prj->save();
+                }
+            }
+
+            if (opts.exportDir) {
+                auto res = prj->doBuild(*opts.exportDir, opts.nBuildJobs,
+                                        opts.incremental);
+                os << "Exported " << res.nExported << " file(s) to <"
+                   << opts.exportDir->string() << ">." ENDL;
+                if (opts.incremental != tr::Incremental::NO)
+                    os << "Skipped " << res.nSkipped << " unchanged file(s)." ENDL;
+                for (auto& v : res.errors) {
+                    os << "ERR: cannot export <" << str::toSv(v.fileId)
+                       << ">: " << v.message << ENDL;
+                }
+                if (!res.isOk())
+                    r.exitCode = EXIT_ERROR;
+            }
+        } catch (const std::exception& e) {
+            os << "ERR: " << e.what() << '\n';
+            r.exitCode = EXIT_ERROR;
+        } catch (...) {
+            os << "ERR: Unknown error" ENDL;
+            r.exitCode = EXIT_ERROR;
+        }
+        r.log = std::move(os).str();
+        r.ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - time0).count();
+        return r;
+    }
+
+    int processBatch(
+            const SafeVector<std::filesystem::path>& fnames,
+            const Options& opts,
+            unsigned nJobs)
+    {
+        OrigCache origCache(opts.loadMode);
+        SafeVector<Outcome> outcomes(fnames.size());
+        std::mutex coutMutex;
+        std::atomic<size_t> iNext = 0;
+        auto work = [&]() {
+            size_t i;
+            while ((i = iNext++) < fnames.size()) {
+                outcomes[i] = processProject(fnames[i], opts, &origCache);
+                std::lock_guard lk(coutMutex);
+                std::cout << outcomes[i].log << std::flush;
+            }
+        };
+
+        if (nJobs > fnames.size())
+            nJobs = static_cast<unsigned>(fnames.size());
+        SafeVector<std::thread> threads;
+        for (unsigned i = 1; i < nJobs; ++i)
+            threads.emplace_back(work);
+        work();
+        for (auto& v : threads)
+            v.join();
+
+        int r = 0;
+        std::cout << ENDL "Summary:" ENDL;
+        for (size_t i = 0; i < fnames.size(); ++i) {
+            auto& v = outcomes[i];
+            char buf[80];
+            snprintf(buf, std::size(buf), "%-3s %d %9.0f ms  ",
+                     (v.exitCode == 0) ? "OK" : "ERR", v.exitCode, v.ms);
+            std::cout << buf << fnames[i].string() << ENDL;
+            r = std::max(r, v.exitCode);
+        }
+        return r;
+    }
+
+}   // anon namespace
+
+
 int myMain(const Args<char8_t>& args)
 {
     if (args.size() == 0) {
@@ -39,52 +355,81 @@ int myMain(const Args<char8_t>& args)
     }
     enum : unsigned char { I_START = 1 };
 
-    try {
-        std::filesystem::path fname = args[0];
-        if (!std::filesystem::exists(fname))
-            throw std::logic_error("File " + fname.string() + " not found");
-
-        auto prj = tr::Project::make();
-        prj->load(fname);
-        std::cout << "Loaded project <" << fname.string() << ">." ENDL;
-
-        bool didSmth = false;
-
-        bool rqUpdate = args.hasParam(u8"-rqupdate", I_START);
-        bool wantUpdate = rqUpdate || args.hasParam(u8"-update", I_START);
-        if (wantUpdate) {
-            auto res = prj->updateData(tr::TrashMode::LEAVE);
-            if (res.isOriginal) {
-                std::cout << "WARN: the project is original, no update needed." ENDL;
-            } else {
-                /// @todo [patch, #23] Every activity beyond patched strings is OK, check
-                if (rqUpdate && res.hasSmth())
-                    throw std::logic_error("The translation is not up to date." ENDL
-                            "It's usually turned on for known languages." ENDL
-                            "Open in UTranslator, File - Update data, save file.");
-                didSmth = true;
-                std::cout << "Updated data." ENDL;
-            }
-        }
+    Options opts;
+    opts.rqUpdate = args.hasParam(u8"-rqupdate", I_START);
+    opts.wantUpdate = opts.rqUpdate || args.hasParam(u8"-update", I_START);
+    if (auto dir = args.paramOptDef(u8"-build", u8".", I_START))
+        opts.exportDir = *dir;
+    if (args.hasParam(u8"-incremental", I_START))
+        opts.incremental = tr::Incremental::YES;
+    if (args.hasParam(u8"-snapshot", I_START))
+        opts.loadMode = tr::LoadMode::CACHE;
 
-        if (auto dir = args.paramOptDef(u8"-build", u8".", I_START)) {
-            std::filesystem::path exportDir = *dir;
-            prj->doBuild(exportDir);
-            std::cout << "Exported data to <" << exportDir.string() << ">." ENDL;
-            didSmth = true;
+    unsigned nJobs = 1;
+    if (auto sJobs = args.paramOptDef(u8"-jobs", u8"0", I_START)) {
+        auto [_, ec] = str::fromChars(*sJobs, nJobs);
+        if (ec != std::errc()) {
+            std::cout << "ERR: -jobs needs a number" ENDL;
+            return EXIT_BAD_CMDLINE;
         }
+    }
+    if (nJobs == 0)
+        nJobs = std::max(std::thread::hardware_concurrency(), 1u);
 
-        if (!didSmth) {
-            std::cout << "No actions specified! Maybe you wanted -build?" ENDL;
+    if (auto sScore = args.paramOptDef(u8"-pretranslate", u8"100", I_START)) {
+        unsigned score = 0;
+        auto [_, ec] = str::fromChars(*sScore, score);
+        if (ec != std::errc() || score > 100) {
+            std::cout << "ERR: -pretranslate needs a score 0..100" ENDL;
             return EXIT_BAD_CMDLINE;
         }
-        return 0;
+        opts.pretranslateScore = score;
+    }
+
+    if (!opts.wantUpdate && !opts.exportDir && !opts.pretranslateScore) {
+        std::cout << "No actions specified! Maybe you wanted -build?" ENDL;
+        return EXIT_BAD_CMDLINE;
+    }
+
+    SafeVector<std::filesystem::path> fnames;
+    try {
+        fnames = collectFiles(args);
+        if (opts.pretranslateScore) {
+            SafeVector<std::filesystem::path> memNames;
+            for (size_t i = I_START; i < args.size(); ++i) {
+                auto& arg = args[i];
+                if (arg.key != u8"-memory")
+                    continue;
+                if (arg.value.empty())
+                    throw std::logic_error("-memory needs a file name");
+                if (arg.value.starts_with('@')) {
+                    addListFile(memNames, arg.value.substr(1));
+                } else {
+                    addFileName(memNames, arg.value);
+                }
+            }
+            std::optional<std::filesystem::path> cacheName;
+            if (auto p = args.param(u8"-memcache", I_START); p && !p->value.empty())
+                cacheName = p->value;
+            opts.memory = loadMemory(memNames, cacheName);
+        }
     } catch (const std::exception& e) {
         std::cout << "ERR: " << e.what() << '\n';
         return EXIT_ERROR;
-    } catch (...) {
-        std::cout << "ERR: Unknown error" ENDL;
-        return EXIT_ERROR;
+    }
+
+    if (fnames.empty()) {
+        writeUsage();
+        return EXIT_USAGE;
+    } else if (fnames.size() == 1) {
+        // One project: parallel build inside
+        opts.nBuildJobs = nJobs;
+        auto r = processProject(fnames[0], opts, nullptr);
+        std::cout << r.log;
+        return r.exitCode;
+    } else {
+        // Several projects: in parallel, each builds serially
+        return processBatch(fnames, opts, nJobs);
     }
 }
 
@@ -61,6 +61,27 @@ std::u8string FindOptions::caption() const
             (str::toU8sv(text.toStdString())).giveStr();
 }
 
+std::optional<tr::SearchQuery> FindOptions::searchQuery() const
+{
+    tr::SearchQuery r;
+    r.text = str::toU8(text);
+    if (channels.id)
+        r.channels |= tr::SearchChannel::ID;
+    if (channels.original)
+        r.channels |= tr::SearchChannel::ORIGINAL;
+    if (channels.translation)
+        r.channels |= tr::SearchChannel::TRANSLATION;
+    // Index has hidden importer’s comments too, the rest is checked anyway
+    if (channels.importersComment)
+        r.channels |= tr::SearchChannel::IMPORTERS_COMMENT;
+    if (channels.authorsComment)
+        r.channels |= tr::SearchChannel::AUTHORS_COMMENT;
+    if (channels.translatorsComment)
+        r.channels |= tr::SearchChannel::TRANSLATORS_COMMENT;
+    return r;
+}
+
+
 FindIssue FindOptions::firstIssue() const
 {
     if (text.isEmpty())
@@ -44,6 +44,7 @@ public:
     bool matchText(const tr::Text&) const override;
     bool matchGroup(const tr::VirtualGroup&) const override;
     std::u8string caption() const override;
+    std::optional<tr::SearchQuery> searchQuery() const override;
 private:
     inline bool matchEntity(const tr::Entity& x) const;
     bool matchChan(bool isEnabled, std::u8string_view channel) const;
@@ -27,7 +27,7 @@ auto toUnsigned(T x) -> std::make_unsigned_t<T>
 template <std::integral T>
 const tr::TrashLine* TrashModel::at (T rw) const {
     if (trash && isRowGood(rw)) {
-        return &trash->data[rw];
+        return &(*trash)[rw];
     } else {
         return nullptr;
     }
@@ -193,7 +193,28 @@ void FmTrash::treeDblClicked(const QModelIndex& index)
 }
 
 
-void FmTrash::exec(tr::Trash& trash, StrObject* obj, TrashChannel channel)
+namespace {
+
+    /// @return  trash line for object: same ID chain, or same original
+    std::optional<size_t> findLine(const tr::Trash& trash, tr::UiObject* current)
+    {
+        if (!current)
+            return std::nullopt;
+        if (auto r = trash.findChain(current->idChain()))
+            return r;
+        if (auto t = current->translatable()) {
+            auto found = trash.findOriginal(t->original);
+            if (!found.empty())
+                return found.back();
+        }
+        return std::nullopt;
+    }
+
+}   // anon namespace
+
+
+void FmTrash::exec(tr::Trash& trash, StrObject* obj, TrashChannel channel,
+                   tr::UiObject* current)
 {
     // Enable-disable OK
     auto btOk = ui->buttonBox->button(QDialogButtonBox::Ok);
@@ -201,7 +222,12 @@ void FmTrash::exec(tr::Trash& trash, StrObject* obj, TrashChannel channel)
     btOk->setEnabled(canAccept);
 
     model.setTrash(trash);
-    if (trash.hasSmth() && !ui->treeAll->currentIndex().isValid()) {
+    if (auto line = findLine(trash, current)) {
+        auto index = model.index(*line, 0);
+        ui->treeAll->setCurrentIndex(index);
+        ui->treeAll->scrollTo(index);
+        ui->treeAll->setFocus();
+    } else if (trash.hasSmth() && !ui->treeAll->currentIndex().isValid()) {
         ui->treeAll->setCurrentIndex(model.index(0, 0));
         ui->treeAll->setFocus();
     }
@@ -211,7 +237,7 @@ void FmTrash::exec(tr::Trash& trash, StrObject* obj, TrashChannel channel)
     if (obj && result) {
         auto index = toUnsigned(ui->treeAll->currentIndex().row());
         if (index < trash.size()) {
-            auto& line = trash.data[index];
+            auto& line = trash[index];
             switch (channel) {
             case TrashChannel::ORIGINAL:
                 obj->set(line.tr.original);
@@ -15,7 +15,8 @@ class FmTrash;
 class StrObject;
 
 namespace tr {
-    struct Trash;
+    class Trash;
+    class UiObject;
     struct TrashLine;
     struct Passport;
 }
@@ -55,6 +56,7 @@ private:
 
     struct TrashDiff {
         /// As we add new items to the end only, diff is enough
+        /// (dropping lines changes passport)
         size_t oldSize = 0, newSize = 0;
         bool isSame = false;
     };
@@ -70,7 +72,9 @@ class FmTrash : public QDialog
 public:
     explicit FmTrash(QWidget *parent = nullptr);
     ~FmTrash() override;
-    void exec(tr::Trash& trash, StrObject* obj, TrashChannel channel);
+    /// @param [in] current  object whose lost text is preselected, if any
+    void exec(tr::Trash& trash, StrObject* obj, TrashChannel channel,
+              tr::UiObject* current = nullptr);
 private:
     Ui::FmTrash *ui;
     TrashModel model;
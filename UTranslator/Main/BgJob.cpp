@@ -0,0 +1,93 @@
+// My header
+#include "BgJob.h"
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+
+// Qt
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QProgressDialog>
+#include <QTimer>
+
+
+namespace {
+
+    /// Dialog’s range: progress may not fit into int
+    constexpr int RANGE = 1000;
+    /// How often we look at progress, ms
+    constexpr int POLL_INTERVAL = 50;
+    /// Quick jobs do not show dialog at all, ms
+    constexpr int MIN_DURATION = 400;
+
+    enum { RET_FINISHED = 0, RET_SHOW = 1 };
+
+}   // anon namespace
+
+
+bool bg::run(QWidget* owner, const QString& caption, const Body& body)
+{
+    tr::AtomicProgress progress;
+    std::atomic<bool> isFinished = false;
+    std::exception_ptr error;
+    std::thread worker([&]() {
+        try {
+            body(progress);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        isFinished.store(true, std::memory_order_release);
+    });
+
+    QEventLoop loop;
+    QTimer timer;
+    QElapsedTimer clock;
+    std::unique_ptr<QProgressDialog> dlg;
+    QObject::connect(&timer, &QTimer::timeout, &loop, [&]() {
+        if (isFinished.load(std::memory_order_acquire)) {
+            loop.exit(RET_FINISHED);
+        } else if (!dlg) {
+            if (clock.elapsed() >= MIN_DURATION)
+                loop.exit(RET_SHOW);
+        } else if (auto nTotal = progress.nTotal(); nTotal != 0) {
+            auto nDone = std::min(progress.nDone(), nTotal);
+            dlg->setValue(static_cast<int>(static_cast<double>(nDone) * RANGE / nTotal));
+        }
+    });
+    clock.start();
+    timer.start(POLL_INTERVAL);
+
+    // Quick job: user input waits till it ends
+    if (loop.exec(QEventLoop::ExcludeUserInputEvents) == RET_SHOW) {
+        dlg = std::make_unique<QProgressDialog>(caption, "Cancel", 0, RANGE, owner);
+        dlg->setWindowModality(Qt::WindowModal);
+        dlg->setAutoReset(false);
+        dlg->setAutoClose(false);
+        dlg->setMinimumDuration(0);
+        QObject::connect(dlg.get(), &QProgressDialog::canceled, &loop, [&]() {
+            progress.cancel();
+            // The dialog hides itself, but body may go on for a while
+            // till it can stop, and the window is still not ours
+            dlg->setLabelText(QString(u8"Cancelling…"));
+            dlg->show();
+        });
+        dlg->show();
+        loop.exec();
+    }
+    timer.stop();
+    worker.join();
+    dlg.reset();
+
+    if (error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const tr::Cancelled&) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// C++
+#include <functional>
+
+// Qt
+#include <QString>
+
+// Project
+#include "TrProgress.h"
+
+class QWidget;
+
+namespace bg {
+
+    using Body = std::function<void(tr::ProgressListener&)>;
+
+    ///
+    ///  Runs a long operation in a worker thread, showing window-modal
+    ///    progress dialog with Cancel button.
+    ///  • GUI thread processes events meanwhile: the window is painted,
+    ///    but user cannot touch it.
+    ///  • Body should not touch widgets, and should not notify them:
+    ///    Qt widgets are single-threaded.
+    ///  • Cancel is cooperative: body checks the listener, and
+    ///    may ignore it when it cannot stop halfway.
+    ///  @return [+] done  [-] cancelled (body threw tr::Cancelled)
+    ///  @throw  whatever body throws, in GUI thread
+    ///
+    bool run(QWidget* owner, const QString& caption, const Body& body);
+
+}   // namespace bg
@@ -7,6 +7,7 @@
 
 // Qt
 #include <QItemSelectionModel>
+#include <QMenu>
 #include <QMessageBox>
 #include <QTimer>
 #include <QShortcut>
@@ -135,6 +136,7 @@ FmMain::FmMain(QWidget *parent)
     connect(ui->acMarkAttention, &QAction::triggered, this, &This::markAttentionCurrObject);
     connect(ui->acDecoder, &QAction::triggered, this, &This::runDecoder);
     connect(ui->acTrash, &QAction::triggered, this, &This::runTrash);
+    connect(ui->acMemory, &QAction::triggered, this, &This::runMemory);
         // Edit — double clicks
         connect(imgBug.origChanged, &DblClickSvgWidget::doubleClicked, this, &This::acceptCurrObjectOrigChanged);
         connect(imgBug.revertOrigChanged, &DblClickSvgWidget::doubleClicked, this, &This::acceptCurrObjectOrigSuppressed);
@@ -341,7 +343,9 @@ void FmMain::selectSmth()
 void FmMain::plantNewProject(std::shared_ptr<tr::Project>&& x)
 {
     project = std::move(x);
+    memory.reset();
     project->setStaticModifyListener(this);
+    wasJournalIntact = project->journal().isIntact();
     treeModel.setProject(project);
     ui->stackMain->setCurrentWidget(ui->pageMain);
     adaptLayout();
@@ -487,10 +491,16 @@ void FmMain::loadOriginalFromBugCache()
         QTextCursor cursor(doc);
         if (bugCache.knownOriginal) {
             origState = OrigState::DIFF;
+            // Long texts (articles etc.): letter-by-letter diff is noise, words are better
+            constexpr size_t MIN_WORD_DIFF = 1000;
+            auto len = std::max(bugCache.knownOriginal->length(), bugCache.original.length());
+            auto granularity = (len >= MIN_WORD_DIFF)
+                    ? qdif::Granularity::WORD : qdif::Granularity::CHAR;
             qdif::write2(cursor,
                          *bugCache.knownOriginal,
                          bugCache.original,
-                         "<font size='-1' style='color:gray;'>== Used to be ==</font>");
+                         "<font size='-1' style='color:gray;'>== Used to be ==</font>",
+                         granularity);
         } else {
             origState = OrigState::SIMPLE;
             qdif::write1(cursor, bugCache.original);
@@ -626,7 +636,12 @@ void FmMain::acceptObject(tr::UiObject& obj, Flags<tr::Bug> bugsToRemove)
     tr::BugCache newCache;
     uiToCache(newCache);
 
+    bool isTranslChanged = (newCache.translation != bugCache.translation);
     auto whatsDone = newCache.copyTo(obj, bugCache, bugsToRemove);
+    if (memory && isTranslChanged) {
+        if (auto t = obj.translatable(); t && t->translation)
+            memory->add(t->original.sv(), t->translation->sv(), tr::MemSource::PROJECT);
+    }
     if (project) {
         if (project->info.canAddFiles()) {
             obj.setIdless(ui->chkIdless->isChecked(), tr::Modify::YES);
@@ -760,6 +775,8 @@ void FmMain::reenable()
     ui->acAcceptChanges->setEnabled(isMainVisible);
     ui->acRevertChanges->setEnabled(isMainVisible);
     ui->acTrash->setEnabled(hasProject);
+    ui->acMemory->setEnabled(isMainVisible && hasProject
+            && project->info.isTranslation());
 
     // Menu: View
     ui->acShowReference->setEnabled(isMainVisible && hasProject
@@ -1009,6 +1026,7 @@ void FmMain::modStateChanged(ModState oldState, ModState newState)
     if (newState == ModState::UNMOD && oldState == ModState::MOD)
         emit treeModel.dataChanged({}, {});
     updateCaption();
+    checkJournal();
 }
 
 
@@ -1029,6 +1047,15 @@ void FmMain::updateCaption()
 }
 
 
+void FmMain::checkJournal()
+{
+    bool isIntact = project && project->journal().isIntact();
+    if (wasJournalIntact && !isIntact)
+        showMessageOverTree(u8"Crash recovery is off till next save");
+    wasJournalIntact = isIntact;
+}
+
+
 bool FmMain::doSaveAs()
 {
     if (!project)
@@ -1054,7 +1081,12 @@ bool FmMain::doSaveAs()
     if (fname.empty())
         return false;
     try {
-        project->save(fname);
+        bool isSaved = runOnProject(QString(u8"Saving…"),
+            [this, &fname](tr::ProgressListener& progress) {
+                project->save(fname, &progress);
+            });
+        if (!isSaved)
+            return false;
         config::history.pushFile(project->fname);
         doBuild();
         return true;
@@ -1092,18 +1124,44 @@ namespace {
 }   // anon namespace
 
 
+bool FmMain::runOnProject(const QString& caption, const bg::Body& body)
+{
+    acceptCurrObjectNone();
+    // Bug timer looks at the tree, let it sleep
+    timerBug->stop();
+    auto lk = treeModel.detach(ui->treeStrings, RememberCurrent::YES);
+    // Listener is GUI → silence it, and catch up afterwards
+    project->setStaticModifyListener(nullptr);
+    auto whatAfter = [this]() {
+        project->setStaticModifyListener(this);
+        updateCaption();
+        checkJournal();
+    };
+    ExecAfter ea(EnableExec::YES, whatAfter);
+    return bg::run(this, caption, body);
+}
+
+
 void FmMain::openFileThrow(std::filesystem::path fname, OpenPlace& rPlace)
 {
     rPlace = OpenPlace::PROJECT;
     dismissUpdateInfo();
     auto prj = tr::Project::make();
-    prj->load(fname);
+    // Current project is not touched, the tree may go on showing it
+    bool isLoaded = bg::run(this, QString(u8"Opening…"),
+        [&prj, &fname](tr::ProgressListener& progress) {
+            prj->load(fname, &progress, tr::LoadMode::EDIT);
+        });
+    if (!isLoaded)
+        return;
     ui->wiFind->close();
     rPlace = OpenPlace::REFERENCE;
 
     auto whatAfter = [&prj, &fname, this]() {
         plantNewProject(std::move(prj));
         config::history.pushFile(std::move(fname));
+        if (project->isModified())
+            showMessageOverTree(u8"Unsaved edits are recovered from journal");
     };
     ExecAfter ea(EnableExec::YES, whatAfter);
     prj->updateReference();
@@ -1194,7 +1252,12 @@ bool FmMain::doSave()
         acceptCurrObjectNone();
         dismissUpdateInfo();
         try {
-            project->save();
+            bool isSaved = runOnProject(QString(u8"Saving…"),
+                [this](tr::ProgressListener& progress) {
+                    project->save(&progress);
+                });
+            if (!isSaved)
+                return false;
             config::history.pushFile(project->fname);
             doBuild();
             return true;
@@ -1343,7 +1406,10 @@ void FmMain::editFileFormat()
 
 void FmMain::findBy(std::unique_ptr<tr::FindCriterion> crit)
 {
-    ts::Finder finder(*crit);
+    std::optional<tr::SearchCandidates> candidates;
+    if (auto query = crit->searchQuery())
+        candidates = project->searchIndex()->find(*project, *query);
+    ts::Finder finder(*crit, candidates ? &*candidates : nullptr);
     project->traverse(finder, tr::WalkOrder::EXACT, tr::EnterMe::NO);
     plantSearchResult(std::move(crit), finder.give());
 }
@@ -1488,7 +1554,21 @@ void FmMain::doBuild()
 {
     if (!project)
         return;
-    project->doBuild({});
+    tr::BuildInfo res;
+    bool isBuilt = runOnProject(QString(u8"Building…"),
+        [this, &res](tr::ProgressListener& progress) {
+            res = project->doBuild({}, 0, tr::Incremental::NO, &progress);
+        });
+    if (isBuilt && !res.isOk()) {
+        QString msg = "Cannot export some files:";
+        for (auto& v : res.errors) {
+            msg += '\n';
+            msg += str::toQ(v.fileId);
+            msg += ": ";
+            msg += QString::fromStdString(v.message);
+        }
+        QMessageBox::warning(this, "Build", msg);
+    }
 }
 
 
@@ -1617,6 +1697,8 @@ bool FmMain::checkSave(std::string_view caption)
     case SAVE:
         return doSave();
     case DISCARD:
+        // Crash recovery should not bring them back
+        project->discardUnsaved();
         return true;
     default:
         return false;
@@ -1701,31 +1783,34 @@ void FmMain::doProjectProps()
 
 void FmMain::updateSyncGroups()
 {
-    auto syncGroups = project->syncGroups();
-    if (syncGroups.empty()) {
+    if (project->syncGroups().empty()) {
         QMessageBox::information(this, "Update data",
                 "This original has no synchronized groups. Nothing to update.");
     } else {
         ui->wiFind->close();
-        std::shared_ptr<tr::Group> thrownGroup;
         updateInfo = tr::UpdateInfo::ZERO;
         try {
-            auto lk = lockAll(RememberCurrent::YES);
-            for (const auto& sg : syncGroups) {
-                thrownGroup = sg;  // throws exception → know which group
-                updateInfo += sg->updateData();
+            tr::SyncUpdateInfo r;
+            { auto lk = lockAll(RememberCurrent::YES);
+                r = project->updateSyncGroups();
             }
+            updateInfo = r.data;
             reflectUpdateInfo();
+            if (!r.isOk()) {
+                QString text;
+                for (auto& v : r.errors) {
+                    if (!text.isEmpty())
+                        text += "\n\n";
+                    text += u8"While updating “";
+                    text += str::toQ(v.group->sync.absPath.filename().u8string());
+                    text += u8"”:\n";
+                    text += str::toQ(v.message);
+                }
+                QMessageBox::critical(this, "Update data", text);
+            }
         } catch (std::exception& e) {
             reflectUpdateInfo();
-            QString text;
-            if (thrownGroup) {
-                text += u8"While updating “";
-                text += str::toQ(thrownGroup->sync.absPath.filename().u8string());
-                text += u8"”:\n";
-            }
-            text += e.what();
-            QMessageBox::critical(this, "Update data", text);
+            QMessageBox::critical(this, "Update data", e.what());
         }
     }
 }
@@ -1743,10 +1828,16 @@ void FmMain::updateOriginal()
     try {
         auto whatExec = [this]{ reflectUpdateInfo(); };
         ExecAfter ex(EnableExec::NO, whatExec);
+        bool isUpdated = runOnProject(QString(u8"Updating original…"),
+            [this](tr::ProgressListener& progress) {
+                updateInfo = project->updateData(tr::TrashMode::FILL, nullptr, &progress);
+            });
+        if (!isUpdated)
+            return;
+        memory.reset();
+        ex.enable();
+        place = UpdatePlace::REFERENCE;
         { auto lk = lockAll(RememberCurrent::YES);
-            updateInfo = project->updateData(tr::TrashMode::FILL);
-            ex.enable();
-            place = UpdatePlace::REFERENCE;
             project->updateReference();
         }
     } catch (std::exception& e) {
@@ -2109,5 +2200,48 @@ void FmMain::runTrash()
         obj = std::make_unique<MemoObject>(ui->memoTranslation);
         channel = TrashChannel::TRANSLATION;
     }
-    fmTrash.ensure(this).exec(project->trash, obj.get(), channel);
+    auto current = treeModel.toObjOr(treeIndex(), nullptr);
+    fmTrash.ensure(this).exec(project->trash, obj.get(), channel, current);
+}
+
+
+void FmMain::runMemory()
+{
+    if (!project || !project->info.isTranslation())
+        return;
+    auto obj = treeModel.toObjOr(treeIndex(), nullptr);
+    auto t = obj ? obj->translatable() : nullptr;
+    if (!t)
+        return;
+    if (!memory) {
+        memory = std::make_unique<tr::TranslMemory>();
+        memory->addProject(*project);
+        memory->build();
+    }
+
+    static constexpr size_t N_SUGGESTIONS = 8;
+    static constexpr int MAX_CAPTION = 80;
+    QMenu menu(this);
+    auto found = memory->find(t->original.sv(), N_SUGGESTIONS);
+    if (found.empty())
+        menu.addAction(QString(u8"No similar texts"))->setEnabled(false);
+    for (auto& v : found) {
+        auto transl = str::toQ(v.translation);
+        auto caption = transl;
+        caption.replace('\n', ' ');
+        if (caption.length() > MAX_CAPTION)
+            caption = caption.left(MAX_CAPTION - 1) + QString(u8"…");
+        caption = QString(u8"%1%\t%2").arg(v.score).arg(caption);
+        if (v.source == tr::MemSource::TRASH)
+            caption += QString(u8" (trash)");
+        auto action = menu.addAction(caption);
+        action->setToolTip(str::toQ(v.original));
+        connect(action, &QAction::triggered, this, [this, transl] {
+            ui->memoTranslation->setPlainText(transl);
+            ui->memoTranslation->setFocus();
+        });
+    }
+    menu.setToolTipsVisible(true);
+    auto memo = ui->memoTranslation;
+    menu.exec(memo->viewport()->mapToGlobal(memo->cursorRect().bottomLeft()));
 }
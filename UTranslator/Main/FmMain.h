@@ -21,11 +21,13 @@
 // No one uses FmMain → you can import EVERYTHING
 #include "TrProject.h"
 #include "TrBugs.h"
+#include "TrMemory.h"
 
 // Project-local
 #include "History.h"
 
 // Main’s parts
+#include "BgJob.h"
 #include "PrjTreeModel.h"
 
 QT_BEGIN_NAMESPACE
@@ -117,6 +119,7 @@ private slots:
     void removeAttentionCurrObject();
     void runDecoder();
     void runTrash();
+    void runMemory();
     // Menu: Go
     void goBack();
     void goNext();
@@ -205,7 +208,11 @@ private:
         tf::SyncInfo syncInfo;
     } loadSetsCache;
     tr::BugCache bugCache;
+    /// Translation memory of project and trash, built by first use
+    std::unique_ptr<tr::TranslMemory> memory;
     std::atomic<bool> isChangingProgrammatically = false;
+    /// Crash-recovery journal of project had all edits last time we saw it
+    bool wasJournalIntact = false;
     QShortcut *shAddGroup = nullptr, *shAddText = nullptr,
               *shMarkAttention = nullptr;
 
@@ -231,6 +238,8 @@ private:
     void reenableOnSelect(tr::UiObject* obj);
     void reenableOnSelect(tr::UiObject& obj) { reenableOnSelect(&obj); }
     void updateCaption();
+    /// Tells once that journal broke off (edit it cannot express)
+    void checkJournal();
     /// Returns parent group for addition, probably calling dialog form
     std::optional<std::shared_ptr<tr::VirtualGroup>> disambigGroup(std::u8string_view title);
     QModelIndex treeIndex();
@@ -260,6 +269,9 @@ private:
     void reflectUpdateInfo();
     void showBugs(Flags<tr::Bug> x);
     [[nodiscard]] PrjTreeModel::LockAll lockAll(RememberCurrent rem);
+    /// Runs body over project in worker thread, tree is detached meanwhile
+    /// @return [+] done  [-] cancelled
+    bool runOnProject(const QString& caption, const bg::Body& body);
     tr::UiObject* acceptCurrObject(Flags<tr::Bug> bugsToRemove);
     void findBy(std::unique_ptr<tr::FindCriterion> crit);
     void setSearchAction(QAction* action, void (FmMain::* func)());
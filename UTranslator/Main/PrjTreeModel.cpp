@@ -147,6 +147,8 @@ PrjTreeModel::LockAll::~LockAll()
 {
     try {
         if (owner) {
+            // Bulk changes may bypass setters
+            owner->display.clear();
             owner->buildColMeanings();
             owner->endResetModel();
             restoreViewState(*owner, view, rem);
@@ -157,6 +159,31 @@ PrjTreeModel::LockAll::~LockAll()
 }
 
 
+PrjTreeModel::DetachAll::DetachAll(
+        PrjTreeModel& x, QTreeView* aView, RememberCurrent aRem)
+    : owner(&x), view(aView), rem(aRem), detached(x.project())
+{
+    saveViewState(x, view, rem);
+    // Model wants some project → empty one, with the same columns
+    auto stub = tr::Project::make();
+    if (detached)
+        stub->info = detached->info;
+    owner->setProject(std::move(stub));
+}
+
+PrjTreeModel::DetachAll::~DetachAll()
+{
+    try {
+        if (owner) {
+            owner->setProject(std::move(detached));
+            restoreViewState(*owner, view, rem);
+        }
+    } catch (...) {
+        std::terminate();   // -warn
+    }
+}
+
+
 ///// PrjTreeModel /////////////////////////////////////////////////////////////
 
 namespace {
@@ -179,6 +206,7 @@ PrjTreeModel::PrjTreeModel()
 void PrjTreeModel::setProject(std::shared_ptr<tr::Project> aProject)
 {
     beginResetModel();
+    display.clear();
     prj = std::move(aProject);
     buildColMeanings();
     endResetModel();
@@ -275,15 +303,24 @@ int PrjTreeModel::columnCount(const QModelIndex &) const
 namespace {
     constexpr QColor BG_MODIFIED { 0xFA, 0xF0, 0xE6 };
 
+    /// Cell shows a line, even the widest screen will not show more
+    constexpr size_t MAX_CELL_LENGTH = 1000;
+
     QString brushLineEnds(const tw::TranslObj& x)
     {
-        auto r = str::toQ(x.str());
+        auto s = x.str();
+        auto shown = tw::cellPrefix(s, MAX_CELL_LENGTH);
+        auto r = str::toQ(shown);
         if (x.mayContainEols()) {
             r.replace('\n', QChar{L'¶'});
         }
+        if (shown.size() != s.size())
+            r += QChar{L'…'};
         return r;
     }
 
+    using Cell = tr::DisplaySlot::Cell;
+
     constexpr QColor fgColorsArr[] = {
         QColor(),               // NORMAL,
         { 0x77, 0x00, 0x00 },   // UNTRANSLATED_CAT — some dark red
@@ -307,13 +344,17 @@ QVariant PrjTreeModel::data(const QModelIndex &index, int role) const
             case PrjColClass::DUMMY:
                 return "????????";
             case PrjColClass::ID:
-                return str::toQ(obj->idColumn());
+                return display.get(*obj, Cell::ID,
+                    [](tr::UiObject& x) { return str::toQ(x.idColumn()); });
             case PrjColClass::ORIGINAL:
-                return brushLineEnds(fly.getOrig(*obj));
+                return display.get(*obj, Cell::ORIGINAL,
+                    [this](tr::UiObject& x) { return brushLineEnds(fly.getOrig(x)); });
             case PrjColClass::REFERENCE:
-                return brushLineEnds(fly.getRef(*obj));
+                return display.get(*obj, Cell::REFERENCE,
+                    [this](tr::UiObject& x) { return brushLineEnds(fly.getRef(x)); });
             case PrjColClass::TRANSLATION:
-                return brushLineEnds(fly.getTransl(*obj));
+                return display.get(*obj, Cell::TRANSLATION,
+                    [this](tr::UiObject& x) { return brushLineEnds(fly.getTransl(x)); });
             }
             UNREACHABLE
         }
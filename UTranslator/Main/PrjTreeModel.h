@@ -108,15 +108,39 @@ public:
         RememberCurrent rem;
     };
 
+    ///  Like LockAll, but the model also lets project go (holds an
+    ///    empty stub), so that view never touches it, e.g. while another
+    ///    thread works on it. Project is swapped back in at once when done.
+    class DetachAll
+    {
+    public:
+        DetachAll(const DetachAll&) = delete;
+        DetachAll(DetachAll&& x) noexcept = delete;
+        DetachAll& operator = (const DetachAll&) = delete;
+        DetachAll& operator = (DetachAll&& x) noexcept = delete;
+
+        ~DetachAll();
+    private:
+        friend class PrjTreeModel;
+        DetachAll(PrjTreeModel& x, QTreeView* aView, RememberCurrent aRem);
+        PrjTreeModel* owner = nullptr;
+        QTreeView* view = nullptr;
+        RememberCurrent rem;
+        std::shared_ptr<tr::Project> detached;
+    };
+
     std::optional<TempProps> checkProps() const;
     [[nodiscard]] LockAll lock(QTreeView* view, RememberCurrent rem)
         { return LockAll(*this, view, rem); }
+    [[nodiscard]] DetachAll detach(QTreeView* view, RememberCurrent rem)
+        { return DetachAll(*this, view, rem); }
 
 private:
     static constexpr int DUMMY_COL = 0; ///< for QAbstractItemModel.parent
     std::shared_ptr<tr::Project> prj;   ///< will hold old project
     SafeVector<PrjColClass> colMeanings;
     mutable tw::Flyweight fly;
+    mutable tw::DisplayCache<QString> display;
 
     void getColMeanings(SafeVector<PrjColClass>& r) const;
     void buildColMeanings();
@@ -2,26 +2,11 @@
 
 #include <QTextCursor>
 
-#include "u_Vector.h"
+#include "u_Diff.h"
 
 namespace qdif {
 
-    struct Pair {
-        std::u32string_view del, ins;
-        bool isCommon = false;
-    };
-    struct SimpleSplit {
-        std::u32string_view commonPrefix, aMid, bMid, commonSuffix;
-    };
-
-    using EditScript = SafeVector<Pair>;
-
-    /// Gets common prefix and suffix, to reduce O(n²) of edit distance algo
-    SimpleSplit simpleSplit(std::u32string_view a, std::u32string_view b);
-
-    /// Gets edit script which turns a to b
-    /// Script consists of Pair’s whose isCommon interleaves true/false.
-    EditScript editScript(std::u32string_view a, std::u32string_view b);
+    using dif::Granularity;
 
     struct FmtLib {
         QTextCharFormat normal;
@@ -41,7 +26,8 @@ namespace qdif {
             QTextCursor& cursor,
             std::u32string_view knownOrig,
             std::u32string_view orig,
-            const QString& htSeparator);
+            const QString& htSeparator,
+            Granularity granularity = Granularity::CHAR);
 
     void write1(QTextCursor& cursor, std::u32string_view text);
 
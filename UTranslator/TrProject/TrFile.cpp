@@ -2,7 +2,10 @@
 #include "TrFile.h"
 
 // Qt
+#include <algorithm>
+#include <limits>
 #include <map>
+#include <numeric>
 #include <unordered_map>
 
 // PugiXML
@@ -11,6 +14,7 @@
 
 // Libs
 #include "u_Strings.h"
+#include "u_BinCatalog.h"
 
 
 using namespace std::string_view_literals;
@@ -19,12 +23,14 @@ using namespace std::string_view_literals;
 const tf::DummyProto tf::DummyProto::INST;
 const tf::IniProto tf::IniProto::INST;
 const tf::UiProto tf::UiProto::INST;
+const tf::BinCatProto tf::BinCatProto::INST;
 tf::Dummy tf::Dummy::INST;
 
 constinit const tf::FormatProto* const tf::allProtos[I_N] {
     &tf::DummyProto::INST,
     &tf::IniProto::INST,
-    &tf::UiProto::INST
+    &tf::UiProto::INST,
+    &tf::BinCatProto::INST
 };
 
 const tf::FormatProto* const (&tf::allWorkingProtos)[I_N - 1]
@@ -73,12 +79,19 @@ std::u8string tf::TextInfo::joinTextId(std::u8string_view sep) const
 std::u8string tf::TextInfo::joinIdToDepth(std::u8string_view sep, size_t depth) const
 {
     std::u8string s;
+    appendIdToDepth(s, sep, depth);
+    return s;
+}
+
+
+void tf::TextInfo::appendIdToDepth(
+        std::u8string& r, std::u8string_view sep, size_t depth) const
+{
     for (size_t i = 0; i < depth; ++i) {
         if (i != 0)
-            s.append(sep);
-        s.append(ids[i]);
+            r.append(sep);
+        r.append(ids[i]);
     }
-    return s;
 }
 
 
@@ -145,23 +158,42 @@ void tf::Ini::doExport(
         const std::filesystem::path&,
         const std::filesystem::path& fname)
 {
-    std::u8string cache;
+    // Lines are built right in the buffer, and it is flushed in large chunks
+    static constexpr size_t BUF_SIZE = 256 * 1024;
     std::ofstream os(fname, std::ios::binary);
+    if (!os.is_open())
+        throw std::logic_error("Cannot open file for writing");
+    std::u8string buf;
+    buf.reserve(BUF_SIZE * 2);
+    auto flush = [&os, &buf]() {
+        os.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+        buf.clear();
+    };
+
     if (textFormat.writeBom)
-        os << bom::u8;
-    auto eol = textFormat.eol();
+        buf.append(str::toU8sv(bom::u8));
+    auto eol = str::toU8sv(textFormat.eol());
     bool isInitial = true;
     while (auto& q = walker.nextText()) {
         if (q.groupChanged()) {
             if (!isInitial)
-                os << eol;
-            os << '[' << str::toSv(q.joinGroupId(multitier.separator)) << ']' << eol;
+                buf.append(eol);
+            buf += '[';
+            q.appendIdToDepth(buf, multitier.separator, q.actualDepth());
+            buf += ']';
+            buf.append(eol);
         }
-        os << str::toSv(q.textId()) << '=';
-        textEscape.write(os, q.text, cache);
-        os << eol;
+        buf.append(q.textId());
+        buf += '=';
+        textEscape.append(buf, q.text);
+        buf.append(eol);
         isInitial = false;
+        if (buf.size() >= BUF_SIZE)
+            flush();
     }
+    flush();
+    if (!os)
+        throw std::logic_error("Cannot write file");
 }
 
 
@@ -181,6 +213,7 @@ namespace {
         const escape::Text& sets;
         tf::MultitierStyle multitierStyle;
         std::u8string comment;
+        std::u8string cache;
     };
 
     void IniImporter::onGroup(std::u8string_view name)
@@ -204,7 +237,7 @@ namespace {
 
     void IniImporter::onVar(std::u8string_view name, std::u8string_view rawValue)
     {
-        auto text = sets.unescape(rawValue);
+        auto text = sets.unescapeSv(rawValue, cache);
         loader.addText(name, text, comment);
         comment.clear();
     }
@@ -218,16 +251,30 @@ namespace {
         }
     }
 
+    /// Reads the whole file into memory, parsers then make no copies
+    std::u8string readWholeFile(const std::filesystem::path& fname)
+    {
+        std::ifstream is(fname, std::ios::binary);
+        streamThrowIf(is, fname);
+        std::u8string r;
+        r.resize(std::filesystem::file_size(fname));
+        is.read(reinterpret_cast<char*>(r.data()), r.size());
+        if (static_cast<size_t>(is.gcount()) != r.size()) {
+            throw std::runtime_error(
+                str::cat("Cannot read file ", str::toSv(fname.filename().u8string())));
+        }
+        return r;
+    }
+
 }   // anon namespace
 
 
 void tf::Ini::doImport(Loader& loader,
             const std::filesystem::path& fname)
 {
-    std::ifstream is(fname);
-    streamThrowIf(is, fname);
+    auto data = readWholeFile(fname);
     IniImporter im(loader, textEscape, multitier);
-    decode::ini(is, im);
+    decode::ini(data, im);
 }
 
 
@@ -257,6 +304,7 @@ namespace {
         escape::Text textEscape;
         tf::MultitierStyle multitier;
         Group* currGroup = nullptr;
+        std::u8string cache;
     };
 
     IniQuery::IniQuery(const escape::Text& te,
@@ -273,7 +321,7 @@ namespace {
         if (!currGroup) {
             currGroup = &data[{}];
         }
-        (*currGroup)[std::u8string{name}] = textEscape.unescape(rawValue);
+        (*currGroup)[std::u8string{name}] = textEscape.unescapeSv(rawValue, cache);
     }
 
     std::optional<tf::QueryResult> IniQuery::query(std::span<std::u8string_view> ids)
@@ -306,10 +354,9 @@ namespace {
 std::unique_ptr<tf::FormatQueryObj> tf::Ini::doImportAsQuery(
             const std::filesystem::path& fname)
 {
-    std::ifstream is(fname);
-    streamThrowIf(is, fname);
+    auto data = readWholeFile(fname);
     auto que = std::make_unique<IniQuery>(textEscape, multitier);
-    decode::ini(is, *que);
+    decode::ini(data, *que);
     return que;
 }
 
@@ -567,3 +614,287 @@ void tf::Ui::doImport(Loader& loader, const std::filesystem::path& fname)
 
     traverseXmlNormal(hUi, ctx);
 }
+
+
+///// BinCatProto //////////////////////////////////////////////////////////////
+
+std::unique_ptr<tf::FileFormat> tf::BinCatProto::make() const
+    { return std::make_unique<BinCat>(); }
+
+std::u8string_view tf::BinCatProto::locDescription() const
+{
+    return u8"Binary file for fast loading: IDs are found right in memory-mapped file, "
+           "w/o any parsing. Reader is header-only u_BinCatalog.h."
+           "<p>Group1.Group2.id1 → String 1";
+}
+
+filedlg::Filter tf::BinCatProto::fileFilter() const
+{ return { L"Binary catalogs", L"*.ucat" }; }
+
+///// BinCat ///////////////////////////////////////////////////////////////////
+
+
+tf::UnifiedSets tf::BinCat::unifiedSets() const
+{
+    return { .multitier = this->multitier };
+}
+
+
+void tf::BinCat::setUnifiedSets(const tf::UnifiedSets& x)
+{
+    multitier = x.multitier;
+}
+
+
+std::string tf::BinCat::bannedIdChars() const
+{
+    if (multitier.separator.length() == 1)
+        return std::string(1, multitier.separator[0]);
+    return {};
+}
+
+
+namespace {
+
+    /// Displacements and slots of minimal perfect hash, see u_BinCatalog.h
+    struct PerfectHash {
+        SafeVector<uint32_t> disp, slots;
+    };
+
+    /// Tries so many seeds per bucket, then gives up
+    constexpr uint32_t MAX_SEED = 1 << 24;
+
+    ///
+    ///  Hash-and-displace: bucket is mix(h, 0) % n, n buckets.
+    ///  Buckets go from larger to smaller, each gets the first seed
+    ///    that puts all its keys into free slots.
+    ///  One-key buckets need no seed, they take the slots left.
+    ///  @param [in] hashes  hashId’s of keys, all different
+    ///
+    PerfectHash buildPerfectHash(std::span<const uint64_t> hashes)
+    {
+        const auto n = static_cast<uint32_t>(hashes.size());
+        PerfectHash r;
+        r.disp.assign(n, 0);
+        r.slots.assign(n, 0);
+        if (n == 0)
+            return r;
+
+        // Counting sort by bucket: bucket b has keys[starts[b]..starts[b + 1])
+        SafeVector<uint32_t> starts(n + 1, 0);
+        SafeVector<uint32_t> bucketOf(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            bucketOf[i] = bincat::mix(hashes[i], 0) % n;
+            ++starts[bucketOf[i] + 1];
+        }
+        std::partial_sum(starts.begin(), starts.end(), starts.begin());
+        SafeVector<uint32_t> keys(n);
+        {   auto pos = starts;
+            for (uint32_t i = 0; i < n; ++i)
+                keys[pos[bucketOf[i]]++] = i;
+        }
+        auto sizeOf = [&starts](uint32_t b) { return starts[b + 1] - starts[b]; };
+
+        SafeVector<uint32_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+            [&sizeOf](uint32_t x, uint32_t y) { return sizeOf(x) > sizeOf(y); });
+
+        SafeVector<bool> isTaken(n, false);
+        SafeVector<uint32_t> places;
+        auto itOrder = order.begin();
+        for (; itOrder != order.end() && sizeOf(*itOrder) > 1; ++itOrder) {
+            auto b = *itOrder;
+            std::span bucketKeys { keys.data() + starts[b], sizeOf(b) };
+            for (uint32_t seed = 1; ; ++seed) {
+                if (seed >= MAX_SEED)
+                    throw std::logic_error("Cannot build perfect hash");
+                places.clear();
+                for (auto k : bucketKeys) {
+                    auto place = static_cast<uint32_t>(bincat::mix(hashes[k], seed) % n);
+                    if (isTaken[place]
+                            || std::find(places.begin(), places.end(), place) != places.end())
+                        break;
+                    places.push_back(place);
+                }
+                if (places.size() == bucketKeys.size()) {
+                    for (size_t i = 0; i < places.size(); ++i) {
+                        isTaken[places[i]] = true;
+                        r.slots[places[i]] = bucketKeys[i];
+                    }
+                    r.disp[b] = seed;
+                    break;
+                }
+            }
+        }
+
+        uint32_t freePlace = 0;
+        for (; itOrder != order.end() && sizeOf(*itOrder) == 1; ++itOrder) {
+            auto b = *itOrder;
+            while (isTaken[freePlace])
+                ++freePlace;
+            isTaken[freePlace] = true;
+            r.slots[freePlace] = keys[starts[b]];
+            r.disp[b] = bincat::DIRECT | freePlace;
+        }
+        return r;
+    }
+
+    template <class T>
+    void writeArray(std::ofstream& os, std::span<const T> x)
+    {
+        os.write(reinterpret_cast<const char*>(x.data()), x.size_bytes());
+    }
+
+}   // anon namespace
+
+
+void tf::BinCat::doExport(
+        Walker& walker,
+        const std::filesystem::path&,
+        const std::filesystem::path& fname)
+{
+    std::u8string blob;
+    auto put = [&blob](std::u8string_view x) {
+        auto r = static_cast<uint32_t>(blob.size());
+        blob.append(x);
+        blob += u8'\0';
+        if (blob.size() > std::numeric_limits<uint32_t>::max())
+            throw std::length_error("Catalog is too large");
+        return r;
+    };
+
+    SafeVector<bincat::Entry> entries;
+    SafeVector<uint64_t> hashes;
+    std::unordered_map<uint64_t, uint32_t> hashToEntry;
+    std::u8string id;
+    while (auto& q = walker.nextText()) {
+        id.clear();
+        q.appendIdToDepth(id, multitier.separator, q.ids.size());
+        auto h = bincat::hashId(id);
+        auto [it, isNew] = hashToEntry.try_emplace(h, entries.size());
+        if (!isNew) {
+            auto& old = entries[it->second];
+            // Duplicate ID → the first one wins, the same as in INI
+            if (std::u8string_view{blob}.substr(old.idOffset, old.idLength) == id)
+                continue;
+            throw std::logic_error(
+                    str::cat("Hash collision, please rename ID ", str::toSv(id)));
+        }
+        if (entries.size() >= bincat::DIRECT)
+            throw std::length_error("Catalog is too large");
+        auto idOffset = put(id);
+        auto textOffset = put(q.text);
+        entries.push_back({
+            .idOffset = idOffset, .idLength = static_cast<uint32_t>(id.length()),
+            .textOffset = textOffset, .textLength = static_cast<uint32_t>(q.text.length()) });
+        hashes.push_back(h);
+    }
+
+    auto hash = buildPerfectHash(hashes);
+
+    bincat::Header header {};
+    std::copy(std::begin(bincat::MAGIC), std::end(bincat::MAGIC), header.magic);
+    header.version = bincat::VERSION;
+    header.byteOrderMark = bincat::BYTE_ORDER_MARK;
+    header.nEntries = entries.size();
+    header.blobSize = blob.size();
+
+    std::ofstream os(fname, std::ios::binary);
+    if (!os.is_open())
+        throw std::logic_error("Cannot open file for writing");
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeArray<uint32_t>(os, hash.disp);
+    writeArray<uint32_t>(os, hash.slots);
+    writeArray<bincat::Entry>(os, entries);
+    writeArray<char8_t>(os, blob);
+    if (!os)
+        throw std::logic_error("Cannot write file");
+}
+
+
+namespace {
+
+    void openThrow(bincat::Catalog& catalog, const std::filesystem::path& fname)
+    {
+        if (!catalog.open(fname)) {
+            throw std::runtime_error(
+                str::cat("Cannot open catalog ", str::toSv(fname.filename().u8string())));
+        }
+    }
+
+    class BinCatQuery final : public tf::FormatQueryObj
+    {
+    public:
+        BinCatQuery(const tf::MultitierStyle& mu) : multitier(mu) {}
+
+        bincat::Catalog catalog;
+        // FormatQueryObj
+        std::optional<tf::QueryResult> query(std::span<std::u8string_view> ids) override;
+    private:
+        tf::MultitierStyle multitier;
+        std::u8string key;
+    };
+
+    std::optional<tf::QueryResult> BinCatQuery::query(std::span<std::u8string_view> ids)
+    {
+        if (ids.empty())
+            return {};
+        key.clear();
+        for (auto& v : ids) {
+            if (&v != &ids.front())
+                key += multitier.separator;
+            key += v;
+        }
+        auto text = catalog.find(key);
+        if (!text)
+            return {};
+        return tf::QueryResult { .text = std::u8string{*text} };
+    }
+
+}   // anon namespace
+
+
+void tf::BinCat::doImport(Loader& loader, const std::filesystem::path& fname)
+{
+    bincat::Catalog catalog;
+    openThrow(catalog, fname);
+
+    std::u8string_view sep = multitier.separator;
+    std::optional<std::u8string_view> currGroup;
+    for (size_t i = 0; i < catalog.size(); ++i) {
+        auto item = catalog.at(i);
+        if (item.id.empty())
+            throw std::runtime_error("Catalog is broken");
+        std::u8string_view groupId, textId = item.id;
+        if (!sep.empty()) {
+            if (auto pos = item.id.rfind(sep); pos != std::u8string_view::npos) {
+                groupId = item.id.substr(0, pos);
+                textId = item.id.substr(pos + sep.length());
+            }
+        }
+        // Texts of a group go in a row, the same as Walker gave them
+        if (groupId != currGroup) {
+            loader.goToGroupAbs(str::splitSv(groupId, sep));
+            currGroup = groupId;
+        }
+        loader.addText(textId, item.text, {});
+    }
+}
+
+
+std::unique_ptr<tf::FormatQueryObj> tf::BinCat::doImportAsQuery(
+            const std::filesystem::path& fname)
+{
+    auto que = std::make_unique<BinCatQuery>(multitier);
+    openThrow(que->catalog, fname);
+    return que;
+}
+
+
+void tf::BinCat::save(pugi::xml_node& node) const
+    { unifiedSave(node); }
+
+
+void tf::BinCat::load(const pugi::xml_node& node)
+    { unifiedLoad(node); }
@@ -78,6 +78,8 @@ namespace tf {
         bool groupChanged() const { return (commonDepth != actualDepth()) || (commonDepth != prevDepth); }
 
         std::u8string joinIdToDepth(std::u8string_view sep, size_t depth) const;
+        /// Same as joinIdToDepth, but appends right to r
+        void appendIdToDepth(std::u8string& r, std::u8string_view sep, size_t depth) const;
         std::u8string joinGroupId(std::u8string_view sep) const;
         std::u8string joinTextId(std::u8string_view sep) const;
         std::u8string_view textId() const { return ids.back(); }
@@ -207,10 +209,62 @@ namespace tf {
         void load(const pugi::xml_node&) override {}
     };
 
+    class BinCatProto : public FormatProto
+    {
+    public:
+        Flags<Fcap> caps() const noexcept override
+            { return Fcap::IMPORT | Fcap::EXPORT | Fcap::NEEDS_ID; }
+        Flags<Usfg> workingSets() const noexcept override
+            { return Usfg::MULTITIER; }
+        std::unique_ptr<FileFormat> make() const override;
+        std::u8string_view locName() const override { return u8"Binary catalog"; }
+        constexpr std::string_view techName() const noexcept override { return "bincat"; }
+        std::u8string_view locDescription() const override;
+        std::u8string_view locSoftware() const override { return u8"Programs that use u_BinCatalog.h"; }
+        std::u8string_view locIdType() const override { return u8"String, multitier"; }
+        const char* iconName() const override { return "bincat"; }
+        filedlg::Filter fileFilter() const override;
+
+        static const BinCatProto INST;
+    };
+
+    ///
+    ///  Binary catalog: IDs joined with multitier separator, texts,
+    ///    and minimal perfect hash over IDs, see u_BinCatalog.h.
+    ///  Made for loading at program’s start: mapped, not parsed.
+    ///
+    class BinCat final : public FileFormat
+    {
+    public:
+        MultitierStyle multitier;
+
+        void doExport(Walker& walker,
+                      const std::filesystem::path&,
+                      const std::filesystem::path& fname) override;
+        void doImport(Loader& loader,
+                      const std::filesystem::path& fname) override;
+        std::unique_ptr<FormatQueryObj> doImportAsQuery(
+            const std::filesystem::path& fname) override;
+
+        std::unique_ptr<FileFormat> clone() override
+            { return std::make_unique<BinCat>(*this); }
+
+        const BinCatProto& proto() const override { return BinCatProto::INST; }
+        UnifiedSets unifiedSets() const override;
+        void setUnifiedSets(const UnifiedSets& x) override;
+
+        std::string bannedIdChars() const override;
+        std::u8string bannedTextSubstring() const override { return {}; }
+        tr::WalkOrder walkOrder() const override { return tr::WalkOrder::ECONOMY; }
+        void save(pugi::xml_node&) const override;
+        void load(const pugi::xml_node&) override;
+    };
+
     enum {
         I_NONE,
         I_INI,
         I_UI,
+        I_BINCAT,
         I_N
     };
     extern const FormatProto* const allProtos[I_N];
@@ -42,18 +42,19 @@ void ts::Result::add(Wp x)
 ///// Finder ///////////////////////////////////////////////////////////////////
 
 
-ts::Finder::Finder(const tr::FindCriterion& aCrit)
-    : crit(aCrit), r(new ts::Result) {}
+ts::Finder::Finder(const tr::FindCriterion& aCrit,
+                   const tr::SearchCandidates* aCandidates)
+    : crit(aCrit), candidates(aCandidates), r(new ts::Result) {}
 
 void ts::Finder::onText(const std::shared_ptr<tr::Text>& x)
 {
-    if (crit.matchText(*x))
+    if (isCandidate(*x) && crit.matchText(*x))
         r->add(x);
 }
 
 void ts::Finder::onEnterGroup(const std::shared_ptr<tr::VirtualGroup>& x)
 {
-    if (crit.matchGroup(*x))
+    if (isCandidate(*x) && crit.matchGroup(*x))
         r->add(x);
 }
 
@@ -42,14 +42,20 @@ namespace ts {  // translation search
     class Finder : public tr::TraverseListener
     {
     public:
-        Finder(const tr::FindCriterion& aCrit);
+        /// @param [in] aCandidates  [+] only these are checked  [0] all are
+        Finder(const tr::FindCriterion& aCrit,
+               const tr::SearchCandidates* aCandidates = nullptr);
         void onText(const std::shared_ptr<tr::Text>&) override;
         void onEnterGroup(const std::shared_ptr<tr::VirtualGroup>&) override;
         std::unique_ptr<ts::Result> give() { return std::move(r); }
         bool isEmpty() const { return r->isEmpty(); }
     private:
         const tr::FindCriterion& crit;
+        const tr::SearchCandidates* candidates;
         std::unique_ptr<Result> r;
+
+        bool isCandidate(const tr::UiObject& x) const
+            { return !candidates || candidates->has(x); }
     };
 
     class ProjectCriterion : public tr::FindCriterion
@@ -0,0 +1,395 @@
+// My header
+#include "TrJournal.h"
+
+// C++
+#include <cstring>
+
+// Libs
+#include "u_Hash.h"
+#include "u_Vector.h"
+
+// Project
+#include "TrProject.h"
+
+
+namespace {
+
+    constexpr char MAGIC[8] { 'U', 'T', 'r', 'a', 'n', 'J', 'n', 'l' };
+    constexpr uint32_t VERSION = 1;
+    /// Raw numbers are written, so another byte order → another format
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    constexpr uint64_t HEADER_SIZE = std::size(MAGIC) + 4 + 4 + 8 + 8;
+    /// Stricter than any real edit, just to avoid bad_alloc on garbage
+    constexpr uint32_t MAX_RECORD = 1u << 30;
+
+    template <class T>
+    void putRaw(std::string& buf, const T& x)
+        { buf.append(reinterpret_cast<const char*>(&x), sizeof(T)); }
+
+    void putField(std::string& buf, std::u8string_view x)
+    {
+        putRaw<uint32_t>(buf, x.size());
+        buf.append(reinterpret_cast<const char*>(x.data()), x.size());
+    }
+
+    /// Reads from payload, every get fails past its end
+    class Reader
+    {
+    public:
+        Reader(std::string_view aData) : data(aData) {}
+
+        template <class T>
+        bool getRaw(T& x)
+        {
+            if (data.size() - pos < sizeof(T))
+                return false;
+            std::memcpy(&x, data.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        }
+
+        bool getField(std::u8string& x)
+        {
+            uint32_t len;
+            if (!getRaw(len) || data.size() - pos < len)
+                return false;
+            x.assign(reinterpret_cast<const char8_t*>(data.data() + pos), len);
+            pos += len;
+            return true;
+        }
+
+        bool isEnd() const noexcept { return pos == data.size(); }
+    private:
+        std::string_view data;
+        size_t pos = 0;
+    };
+
+    uint32_t checksum(std::string_view x)
+    {
+        hash::Fnv64 h;
+        h.addBytes(reinterpret_cast<const unsigned char*>(x.data()), x.size());
+        return static_cast<uint32_t>(h.value());
+    }
+
+    struct Record {
+        tr::JournalOp op = tr::JournalOp::ORIGINAL;
+        tr::ObjType objType = tr::ObjType::TEXT;
+        tr::StoringIdChain chain;
+        std::optional<std::u8string> value;
+    };
+
+    bool parse(std::string_view payload, Record& r)
+    {
+        Reader rd(payload);
+        unsigned char op = 0, objType = 0, hasValue = 0;
+        uint32_t nIds = 0;
+        if (!rd.getRaw(op) || op > static_cast<unsigned char>(tr::JournalOp::REVERT_KNOWN)
+                || !rd.getRaw(objType) || objType > static_cast<unsigned char>(tr::ObjType::TEXT)
+                || !rd.getRaw(hasValue)
+                || !rd.getField(r.chain.fileName)
+                || !rd.getRaw(nIds) || nIds > payload.size())
+            return false;
+        r.op = static_cast<tr::JournalOp>(op);
+        r.objType = static_cast<tr::ObjType>(objType);
+        r.chain.ids.resize(nIds);
+        for (auto& v : r.chain.ids)
+            if (!rd.getField(v))
+                return false;
+        r.value.reset();
+        if (hasValue) {
+            // Not emplace: GCC sees the string half-built then
+            std::u8string value;
+            if (!rd.getField(value))
+                return false;
+            r.value = std::move(value);
+        }
+        return rd.isEnd();
+    }
+
+    std::shared_ptr<tr::UiObject> findObject(tr::Project& prj, const Record& rec)
+    {
+        std::shared_ptr<tr::VirtualGroup> vg = prj.findFile(rec.chain.fileName);
+        auto& ids = rec.chain.ids;
+        if (!vg || ids.empty())
+            return (rec.objType == tr::ObjType::FILE) ? vg : nullptr;
+        for (size_t i = 0; i + 1 < ids.size() && vg; ++i)
+            vg = vg->findGroup(ids[i]);
+        if (!vg)
+            return {};
+        switch (rec.objType) {
+        case tr::ObjType::TEXT:
+            return vg->findText(ids.back());
+        case tr::ObjType::GROUP:
+            return vg->findGroup(ids.back());
+        case tr::ObjType::PROJECT:
+        case tr::ObjType::FILE:;
+        }
+        return {};
+    }
+
+    /// @return  [+] applied  [-] object does not fit
+    bool apply(tr::UiObject& obj, const Record& rec)
+    {
+        // Setters return [-] when nothing changes, that’s OK here
+        auto v = rec.value.value_or(std::u8string{});
+        switch (rec.op) {
+        case tr::JournalOp::ORIGINAL:
+            if (!obj.translatable())
+                return false;
+            obj.setOriginal(v, tr::Modify::NO);
+            return true;
+        case tr::JournalOp::TRANSLATION:
+            if (!obj.translatable())
+                return false;
+            obj.setTranslation(rec.value, tr::Modify::NO);
+            return true;
+        case tr::JournalOp::ID:
+            obj.setId(v, tr::Modify::NO);
+            return true;
+        case tr::JournalOp::AUTHORS_COMMENT:
+            if (!obj.comments())
+                return false;
+            obj.setAuthorsComment(v, tr::Modify::NO);
+            return true;
+        case tr::JournalOp::TRANSLATORS_COMMENT:
+            if (!obj.comments())
+                return false;
+            obj.setTranslatorsComment(v, tr::Modify::NO);
+            return true;
+        case tr::JournalOp::SUPPRESS_KNOWN:
+            obj.suppressKnownOriginal(tr::Modify::NO);
+            return true;
+        case tr::JournalOp::REVERT_KNOWN:
+            obj.revertKnownOriginal(tr::Modify::NO);
+            return true;
+        }
+        return false;
+    }
+
+    tr::Mch channelOf(tr::JournalOp op)
+    {
+        switch (op) {
+        case tr::JournalOp::ID:
+            return tr::Mch::ID;
+        case tr::JournalOp::TRANSLATION:
+            return tr::Mch::TRANSL;
+        case tr::JournalOp::AUTHORS_COMMENT:
+        case tr::JournalOp::TRANSLATORS_COMMENT:
+            return tr::Mch::COMMENT;
+        case tr::JournalOp::ORIGINAL:
+        case tr::JournalOp::SUPPRESS_KNOWN:
+        case tr::JournalOp::REVERT_KNOWN:;
+        }
+        return tr::Mch::ORIG;
+    }
+
+}   // anon namespace
+
+
+std::filesystem::path tr::Journal::fnameFor(const std::filesystem::path& prjFname)
+{
+    auto r = prjFname;
+    r += ".journal";
+    return r;
+}
+
+
+auto tr::Journal::passportOf(const std::filesystem::path& prjFname) -> Passport
+{
+    std::error_code ec;
+    Passport r;
+    r.size = std::filesystem::file_size(prjFname, ec);
+    if (ec)
+        return {};
+    r.time = std::filesystem::last_write_time(prjFname, ec).time_since_epoch().count();
+    return r;
+}
+
+
+void tr::Journal::reset(const std::filesystem::path& prjFname)
+{
+    close();
+    fname = fnameFor(prjFname);
+    passport = passportOf(prjFname);
+    fSize = 0;
+    fState = State::READY;
+}
+
+
+void tr::Journal::start(const std::filesystem::path& prjFname)
+{
+    reset(prjFname);
+    std::error_code ec;
+    std::filesystem::remove(fname, ec);
+}
+
+
+auto tr::Journal::replay(Project& prj, const std::filesystem::path& prjFname) -> ReplayInfo
+{
+    ReplayInfo r;
+    std::ifstream is(fnameFor(prjFname), std::ios::binary);
+    if (!is.is_open()) {
+        reset(prjFname);
+        return r;
+    }
+
+    // Header
+    char magic[std::size(MAGIC)];
+    uint32_t version, bom;
+    Passport filePassport;
+    if (!is.read(magic, std::size(magic))
+            || !std::equal(std::begin(magic), std::end(magic), std::begin(MAGIC))
+            || !is.read(reinterpret_cast<char*>(&version), sizeof(version))
+            || version != VERSION
+            || !is.read(reinterpret_cast<char*>(&bom), sizeof(bom))
+            || bom != BYTE_ORDER_MARK
+            || !is.read(reinterpret_cast<char*>(&filePassport.size), sizeof(filePassport.size))
+            || !is.read(reinterpret_cast<char*>(&filePassport.time), sizeof(filePassport.time))
+            || filePassport != passportOf(prjFname)) {
+        // Garbage, or journal of another version of file;
+        // do not delete: maybe we are just reading the project,
+        // the first edit will overwrite it
+        reset(prjFname);
+        return r;
+    }
+
+    // Records till the end or the first torn one
+    SafeVector<Record> recs;
+    uint64_t pos = HEADER_SIZE;
+    std::string payload;
+    while (true) {
+        uint32_t len = 0, sum = 0;
+        if (!is.read(reinterpret_cast<char*>(&len), sizeof(len)) || len > MAX_RECORD)
+            break;
+        payload.resize(len);
+        if (!is.read(payload.data(), len)
+                || !is.read(reinterpret_cast<char*>(&sum), sizeof(sum))
+                || sum != checksum(payload))
+            break;
+        Record rec;
+        if (!parse(payload, rec))
+            break;
+        pos += sizeof(len) + len + sizeof(sum);
+        recs.push_back(std::move(rec));
+    }
+    is.close();
+
+    reset(prjFname);
+    fSize = pos;
+
+    // Everything in journal is unsaved: save starts it anew
+    for (auto& rec : recs) {
+        r.hasUnsaved = true;
+        auto obj = findObject(prj, rec);
+        if (!obj || !apply(*obj, rec)) {
+            // Does not fit: keep what we have, journal is broken till save
+            fState = State::BROKEN;
+            break;
+        }
+        ++r.nEdits;
+        obj->cache.mod.set(channelOf(rec.op));
+    }
+    return r;
+}
+
+
+bool tr::Journal::ensureOpen()
+{
+    if (fState == State::OPEN)
+        return true;
+    if (fSize == 0) {
+        // New file
+        os.open(fname, std::ios::binary | std::ios::trunc);
+        if (!os.is_open())
+            return false;
+        os.write(MAGIC, std::size(MAGIC));
+        os.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+        os.write(reinterpret_cast<const char*>(&BYTE_ORDER_MARK), sizeof(BYTE_ORDER_MARK));
+        os.write(reinterpret_cast<const char*>(&passport.size), sizeof(passport.size));
+        os.write(reinterpret_cast<const char*>(&passport.time), sizeof(passport.time));
+        os.flush();
+        if (!os)
+            return false;
+        fSize = HEADER_SIZE;
+    } else {
+        // Replayed file: cut torn tail if any
+        std::error_code ec;
+        std::filesystem::resize_file(fname, fSize, ec);
+        if (ec)
+            return false;
+        os.open(fname, std::ios::binary | std::ios::app);
+        if (!os.is_open())
+            return false;
+    }
+    fState = State::OPEN;
+    return true;
+}
+
+
+bool tr::Journal::appendRecord()
+{
+    // buf = length placeholder + payload
+    std::string_view payload = std::string_view{buf}.substr(sizeof(uint32_t));
+    uint32_t len = payload.size();
+    auto sum = checksum(payload);
+    std::memcpy(buf.data(), &len, sizeof(len));
+    putRaw(buf, sum);
+    os.write(buf.data(), buf.size());
+    os.flush();
+    if (!os) {
+        fState = State::BROKEN;
+        return false;
+    }
+    fSize += buf.size();
+    return true;
+}
+
+
+bool tr::Journal::write(UiObject& obj, const JournalEdit& edit)
+{
+    if (!isIntact())
+        return false;
+    if (!ensureOpen()) {
+        fState = State::BROKEN;
+        return false;
+    }
+    auto chain = obj.idChain();
+    if (edit.op == JournalOp::ID) {
+        // Object is found by ID it had
+        if (chain.ids.empty()) {
+            chain.fileName = edit.oldId;
+        } else {
+            chain.ids.back() = edit.oldId;
+        }
+    }
+    buf.clear();
+    putRaw<uint32_t>(buf, 0);
+    putRaw(buf, static_cast<unsigned char>(edit.op));
+    putRaw(buf, static_cast<unsigned char>(obj.objType()));
+    putRaw<unsigned char>(buf, edit.value.has_value());
+    putField(buf, chain.fileName);
+    putRaw<uint32_t>(buf, chain.ids.size());
+    for (auto& v : chain.ids)
+        putField(buf, v);
+    if (edit.value)
+        putField(buf, *edit.value);
+    return appendRecord();
+}
+
+
+void tr::Journal::discardUnsaved()
+{
+    close();
+    if (fname.empty() || fSize == 0)
+        return;
+    std::error_code ec;
+    std::filesystem::remove(fname, ec);
+    fSize = 0;
+}
+
+
+void tr::Journal::close()
+{
+    os.close();
+    fState = State::OFF;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+// C++
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string_view>
+
+namespace tr {
+
+    class UiObject;
+    class Project;
+
+    enum class JournalOp : unsigned char {
+        ORIGINAL, TRANSLATION, ID, AUTHORS_COMMENT, TRANSLATORS_COMMENT,
+        SUPPRESS_KNOWN, REVERT_KNOWN,
+    };
+
+    /// One edit, as setter reports it
+    struct JournalEdit {
+        JournalOp op;
+        std::optional<std::u8string_view> value {};  ///< [nullopt] no translation
+        std::u8string_view oldId {};    ///< ID only: the one before change
+    };
+
+    struct ReplayInfo {
+        size_t nEdits = 0;          ///< # of edits replayed
+        bool hasUnsaved = false;    ///< [+] there were edits, project is modified
+    };
+
+    ///
+    ///  Append-only journal of edits, next to project file;
+    ///    crash recovery only.
+    ///  • Accepted edits are appended and flushed at once.
+    ///  • Project file stays canonical: save always writes it,
+    ///    and starts journal anew. So everything in journal is unsaved.
+    ///  • Header keeps project file’s size and time: journal is replayed
+    ///    only on the file it was started on.
+    ///  • Edits journal cannot express (adding, deleting, moving,
+    ///    file settings, bulk operations) break it till next save.
+    ///  • Each record has its checksum, a torn tail after crash is ignored.
+    ///  • Opened lazily, on first edit; projects that are just read
+    ///    (original, memory, console builder) do not use it at all.
+    ///
+    class Journal
+    {
+    public:
+        /// @return  journal’s file name for project’s file
+        static std::filesystem::path fnameFor(const std::filesystem::path& prjFname);
+
+        /// Project file was just written/loaded: old journal goes away
+        void start(const std::filesystem::path& prjFname);
+        /// Replays journal onto project just loaded from prjFname,
+        ///   using setters w/o modification; starts it if no journal
+        /// @return  what was replayed
+        ReplayInfo replay(Project& prj, const std::filesystem::path& prjFname);
+        /// Appends an edit
+        /// @return [+] written  [-] journal does not work till next save
+        bool write(UiObject& obj, const JournalEdit& edit);
+        /// Something that journal cannot express happened
+        void breakOff() noexcept { fState = State::BROKEN; }
+        /// Drops journal, e.g. when user closes w/o saving
+        void discardUnsaved();
+        /// Stops journaling w/o touching anything, e.g. project is gone
+        void close();
+
+        /// @return [+] all edits are in journal, crash loses nothing
+        bool isIntact() const noexcept
+            { return fState == State::READY || fState == State::OPEN; }
+        /// @return  file size
+        uint64_t nBytes() const noexcept { return fSize; }
+    private:
+        enum class State : unsigned char {
+            OFF,        ///< no project file (new project)
+            READY,      ///< project file known, journal file not opened yet
+            OPEN,       ///< writing
+            BROKEN,     ///< there are edits not in journal
+        };
+        struct Passport {
+            uint64_t size = 0;
+            int64_t time = 0;
+            bool operator == (const Passport&) const = default;
+        };
+
+        State fState = State::OFF;
+        std::filesystem::path fname;
+        Passport passport;
+        std::ofstream os;
+        uint64_t fSize = 0;         ///< [0] no file; otherwise good part of it
+        std::string buf;            ///< record being written
+
+        static Passport passportOf(const std::filesystem::path& prjFname);
+        /// Like start, but w/o deleting
+        void reset(const std::filesystem::path& prjFname);
+        bool ensureOpen();
+        bool appendRecord();
+    };
+
+}   // namespace tr
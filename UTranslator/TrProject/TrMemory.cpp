@@ -0,0 +1,748 @@
+// My header
+#include "TrMemory.h"
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <thread>
+
+// Libs
+#include "mojibake.h"
+#include "u_Hash.h"
+
+// Project
+#include "TrProject.h"
+
+
+namespace {
+
+    /// Three code points, 21 bits each
+    using Key = uint64_t;
+
+    constexpr unsigned MIN_BUCKET_BITS = 10;
+    constexpr unsigned MAX_BUCKET_BITS = 22;
+
+    /// That many candidates per wanted suggestion are checked by Levenshtein,
+    ///   best by # of common trigrams
+    constexpr size_t CHECKS_PER_SUGGESTION = 16;
+    constexpr size_t MIN_CHECKS = 64;
+
+    /// Trigram is frequent if it is in >1/16 of segments of matching length
+    constexpr size_t FREQUENT_SHARE = 16;
+    /// That many rarest trigrams are counted even if frequent
+    constexpr size_t MIN_COUNTED = 3;
+    /// Shorter lists are always counted
+    constexpr size_t CHEAP_LIST = 4096;
+
+    constexpr char MAGIC[8] { 'U', 'T', 'r', 'a', 'n', 'M', 'e', 'm' };
+    constexpr uint32_t VERSION = 1;
+    /// Raw arrays are saved, so another byte order → another format
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    inline uint32_t bucketOf(Key key, unsigned bits)
+    {
+        return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+    }
+
+    ///
+    ///  Fills r with buckets of text’s trigrams, maybe repeating.
+    ///  Code points are case-folded, text is padded with zeroes:
+    ///  n code points → n trigrams, [0 a b] [a b c] … [y z 0]
+    ///
+    void collectRawBuckets(std::u32string_view cps, unsigned bits, SafeVector<uint32_t>& r)
+    {
+        r.clear();
+        if (cps.empty())
+            return;
+        char32_t prev2 = 0;
+        char32_t prev1 = mojibake::simpleCaseFoldCp(cps[0]);
+        for (size_t i = 1; i <= cps.size(); ++i) {
+            char32_t c = (i < cps.size()) ? mojibake::simpleCaseFoldCp(cps[i]) : 0;
+            r.push_back(bucketOf((Key(prev2) << 42) | (Key(prev1) << 21) | Key(c), bits));
+            prev2 = prev1;
+            prev1 = c;
+        }
+    }
+
+    /// Same, sorted and unique
+    void collectBuckets(std::u32string_view cps, unsigned bits, SafeVector<uint32_t>& r)
+    {
+        collectRawBuckets(cps, bits, r);
+        std::sort(r.begin(), r.end());
+        r.erase(std::unique(r.begin(), r.end()), r.end());
+    }
+
+    ///
+    ///  Levenshtein distance over code points, in band |i − j| ≤ maxDist
+    ///  @return  distance, or maxDist + 1 if greater
+    ///
+    unsigned boundedDistance(
+            std::u32string_view a, std::u32string_view b,
+            unsigned maxDist, SafeVector<unsigned>& row)
+    {
+        const unsigned BIG = maxDist + 1;
+        // Common prefix and suffix do not change distance
+        while (!a.empty() && !b.empty() && a.front() == b.front()) {
+            a.remove_prefix(1);
+            b.remove_prefix(1);
+        }
+        while (!a.empty() && !b.empty() && a.back() == b.back()) {
+            a.remove_suffix(1);
+            b.remove_suffix(1);
+        }
+        if (a.size() > b.size())
+            std::swap(a, b);
+        const size_t la = a.size(), lb = b.size();
+        if (lb - la > maxDist)
+            return BIG;
+        if (la == 0)
+            return lb;
+
+        row.assign(lb + 1, BIG);
+        for (size_t j = 0; j <= std::min<size_t>(lb, maxDist); ++j)
+            row[j] = j;
+        for (size_t i = 1; i <= la; ++i) {
+            size_t jLo = (i > maxDist) ? i - maxDist : 1;
+            size_t jHi = std::min<size_t>(lb, i + maxDist);
+            // diag = previous row [jLo − 1], then left of band is out
+            unsigned diag = row[jLo - 1];
+            row[jLo - 1] = (jLo == 1 && i <= maxDist) ? i : BIG;
+            unsigned rowMin = row[jLo - 1];
+            for (size_t j = jLo; j <= jHi; ++j) {
+                unsigned up = row[j];
+                unsigned v = diag + (a[i - 1] != b[j - 1]);
+                v = std::min({ v, up + 1, row[j - 1] + 1, BIG });
+                diag = up;
+                row[j] = v;
+                rowMin = std::min(rowMin, v);
+            }
+            if (rowMin >= BIG)
+                return BIG;
+        }
+        return std::min(row[lb], BIG);
+    }
+
+    template <class T>
+    void writeRaw(std::ostream& os, const T& x)
+        { os.write(reinterpret_cast<const char*>(&x), sizeof(T)); }
+
+    template <class T>
+    bool readRaw(std::istream& is, T& x)
+        { return static_cast<bool>(is.read(reinterpret_cast<char*>(&x), sizeof(T))); }
+
+    template <class Cont>
+    void writeArray(std::ostream& os, const Cont& x)
+    {
+        writeRaw<uint64_t>(os, x.size());
+        os.write(reinterpret_cast<const char*>(x.data()),
+                 x.size() * sizeof(typename Cont::value_type));
+    }
+
+    template <class Cont>
+    bool readArray(std::istream& is, Cont& x, uint64_t maxSize)
+    {
+        uint64_t size;
+        if (!readRaw(is, size) || size > maxSize)
+            return false;
+        x.resize(size);
+        return static_cast<bool>(is.read(reinterpret_cast<char*>(x.data()),
+                 size * sizeof(typename Cont::value_type)));
+    }
+
+    /// Stricter than any real file, just to avoid bad_alloc on garbage
+    constexpr uint64_t MAX_ARRAY = uint64_t(1) << 40;
+
+}   // anon namespace
+
+
+///// TranslMemory::Chunk //////////////////////////////////////////////////////
+
+
+///
+///  Pairs and their index.
+///  Indexed chunk has segments sorted by length, so that postings
+///  (sorted by segment #) are sorted by length too, and length filter
+///  is a binary search in each.
+///
+class tr::TranslMemory::Chunk
+{
+public:
+    struct Segment {
+        uint64_t offset;            ///< original, then translation in pool
+        uint32_t origLength;        ///< in code units
+        uint32_t translLength;      ///< in code units
+        uint32_t nCps;              ///< original’s length in code points
+        MemSource source;
+        unsigned char reserved[3] { 0, 0, 0 };
+    };
+    static_assert(sizeof(Segment) == 24, "Segment is saved as is");
+
+    std::u8string pool;
+    SafeVector<Segment> segments;
+    unsigned bucketBits = 0;        ///< [0] pending chunk, w/o index
+    SafeVector<uint32_t> starts;    ///< bucket → its postings, 2^bucketBits + 1
+    SafeVector<uint32_t> postings;  ///< segment #s, sorted within bucket
+
+    bool isIndexed() const noexcept { return (bucketBits != 0); }
+    std::u8string_view original(const Segment& x) const
+        { return std::u8string_view(pool).substr(x.offset, x.origLength); }
+    std::u8string_view translation(const Segment& x) const
+        { return std::u8string_view(pool).substr(x.offset + x.origLength, x.translLength); }
+
+    void add(std::u8string_view original, std::u8string_view translation,
+             MemSource source);
+    void build();
+    /// @return  first indexed segment whose length ≥ len
+    uint32_t lowerByLength(uint32_t len) const;
+    /// @return [+] arrays are consistent (loaded file is OK)
+    bool isConsistent() const;
+};
+
+
+void tr::TranslMemory::Chunk::add(
+        std::u8string_view original, std::u8string_view translation,
+        MemSource source)
+{
+    if (segments.size() >= UINT32_MAX)
+        throw std::length_error("[TranslMemory] Too many pairs");
+    if (original.length() > UINT32_MAX || translation.length() > UINT32_MAX)
+        throw std::length_error("[TranslMemory] String is too long");
+    Segment& seg = segments.emplace_back();
+    seg.offset = pool.length();
+    seg.origLength = original.length();
+    seg.translLength = translation.length();
+    seg.nCps = mojibake::countCps(original);
+    seg.source = source;
+    pool += original;
+    pool += translation;
+}
+
+
+void tr::TranslMemory::Chunk::build()
+{
+    // Find duplicates by hash, the best source survives
+    SafeVector<std::pair<uint64_t, uint32_t>> hashes;
+    hashes.reserve(segments.size());
+    for (uint32_t i = 0; i < segments.size(); ++i) {
+        hash::Fnv64 h;
+        h.addField(original(segments[i]));
+        h.addField(translation(segments[i]));
+        hashes.emplace_back(h.value(), i);
+    }
+    std::sort(hashes.begin(), hashes.end());
+    std::vector<bool> isDup(segments.size(), false);
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        auto& seg1 = segments[hashes[i].second];
+        if (isDup[hashes[i].second])
+            continue;
+        for (size_t j = i + 1; j < hashes.size() && hashes[j].first == hashes[i].first; ++j) {
+            auto& seg2 = segments[hashes[j].second];
+            if (!isDup[hashes[j].second]
+                    && original(seg1) == original(seg2)
+                    && translation(seg1) == translation(seg2)) {
+                isDup[hashes[j].second] = true;
+                seg1.source = std::min(seg1.source, seg2.source);
+            }
+        }
+    }
+    hashes.clear();
+    hashes.shrink_to_fit();
+
+    // Sort by length (length:index, so stable), and pack pool in that order
+    SafeVector<uint64_t> order;
+    order.reserve(segments.size());
+    for (uint32_t i = 0; i < segments.size(); ++i) {
+        if (!isDup[i])
+            order.push_back((uint64_t(segments[i].nCps) << 32) | i);
+    }
+    std::sort(order.begin(), order.end());
+    std::u8string newPool;
+    SafeVector<Segment> newSegments;
+    newSegments.reserve(order.size());
+    for (auto v : order) {
+        auto i = static_cast<uint32_t>(v);
+        auto& seg = newSegments.emplace_back(segments[i]);
+        seg.offset = newPool.length();
+        newPool.append(pool, segments[i].offset, seg.origLength + seg.translLength);
+    }
+    pool = std::move(newPool);
+    segments = std::move(newSegments);
+
+    // Two passes: count, then fill.
+    // Sorting each segment’s buckets is slow, repeats are skipped
+    // by remembering bucket’s last segment instead.
+    bucketBits = std::clamp<unsigned>(std::bit_width(segments.size()),
+                                      MIN_BUCKET_BITS, MAX_BUCKET_BITS);
+    const size_t nBuckets = size_t(1) << bucketBits;
+    starts.assign(nBuckets + 1, 0);
+    SafeVector<uint32_t> buckets;
+    auto forEachSegment = [this, &buckets](auto&& body) {
+        for (uint32_t i = 0; i < segments.size(); ++i) {
+            auto cps = mojibake::toM<std::u32string>(original(segments[i]));
+            collectRawBuckets(cps, bucketBits, buckets);
+            body(i);
+        }
+    };
+    uint64_t total = 0;
+    {
+        SafeVector<uint32_t> lastSegment(nBuckets, UINT32_MAX);
+        forEachSegment([this, &buckets, &total, &lastSegment](uint32_t iSeg) {
+            for (auto v : buckets) {
+                if (lastSegment[v] != iSeg) {
+                    lastSegment[v] = iSeg;
+                    ++starts[v + 1];
+                    ++total;
+                }
+            }
+        });
+    }
+    if (total > UINT32_MAX)
+        throw std::length_error("[TranslMemory] Too many trigrams");
+    for (size_t i = 1; i <= nBuckets; ++i)
+        starts[i] += starts[i - 1];
+    postings.resize(total);
+    SafeVector<uint32_t> fill(starts.begin(), starts.end() - 1);
+    forEachSegment([this, &buckets, &fill](uint32_t iSeg) {
+        for (auto v : buckets) {
+            auto& pos = fill[v];
+            if (pos == starts[v] || postings[pos - 1] != iSeg)
+                postings[pos++] = iSeg;
+        }
+    });
+}
+
+
+uint32_t tr::TranslMemory::Chunk::lowerByLength(uint32_t len) const
+{
+    auto it = std::partition_point(segments.begin(), segments.end(),
+            [len](const Segment& x) { return x.nCps < len; });
+    return it - segments.begin();
+}
+
+
+bool tr::TranslMemory::Chunk::isConsistent() const
+{
+    if (bucketBits < MIN_BUCKET_BITS || bucketBits > MAX_BUCKET_BITS
+            || starts.size() != (size_t(1) << bucketBits) + 1
+            || starts.front() != 0 || starts.back() != postings.size())
+        return false;
+    if (!std::is_sorted(starts.begin(), starts.end()))
+        return false;
+    uint32_t lastCps = 0;
+    for (auto& v : segments) {
+        if (v.offset > pool.size()
+                || uint64_t(v.origLength) + v.translLength > pool.size() - v.offset
+                || v.nCps < lastCps
+                || v.source > MemSource::OTHER)
+            return false;
+        lastCps = v.nCps;
+    }
+    for (auto v : postings) {
+        if (v >= segments.size())
+            return false;
+    }
+    return true;
+}
+
+
+///// TranslMemory /////////////////////////////////////////////////////////////
+
+
+struct tr::TranslMemory::Query {
+    std::u8string_view text;
+    std::u32string cps;
+    size_t maxCount;
+    unsigned minScore;
+    uint32_t minLength, maxLength;  ///< other lengths cannot reach minScore
+};
+
+
+tr::TranslMemory::TranslMemory() = default;
+tr::TranslMemory::~TranslMemory() = default;
+
+tr::TranslMemory::TranslMemory(std::shared_ptr<const TranslMemory> aBase)
+    : fBase(std::move(aBase)) {}
+
+
+tr::TranslMemory::Chunk& tr::TranslMemory::pendingChunk()
+{
+    if (chunks.empty() || chunks.back()->isIndexed())
+        chunks.push_back(std::make_unique<Chunk>());
+    return *chunks.back();
+}
+
+
+void tr::TranslMemory::add(
+        std::u8string_view original, std::u8string_view translation,
+        MemSource source)
+{
+    if (original.empty() || translation.empty())
+        return;
+    pendingChunk().add(original, translation, source);
+}
+
+
+void tr::TranslMemory::addProject(
+        const Project& prj, MemSource textSource, MemSource trashSource)
+{
+    prj.traverseCTexts([this, textSource](const UiObject&, const Translatable& t) {
+        if (t.translation)
+            add(t.original.sv(), t.translation->sv(), textSource);
+    });
+    for (auto& v : prj.trash)
+        add(v.tr.original.sv(), v.tr.translationSv(), trashSource);
+}
+
+
+void tr::TranslMemory::addProject(const Project& prj)
+{
+    addProject(prj, MemSource::PROJECT, MemSource::TRASH);
+}
+
+
+void tr::TranslMemory::addFile(const std::filesystem::path& fname)
+{
+    auto absName = std::filesystem::weakly_canonical(fname);
+    auto prj = Project::make();
+    prj->load(absName);
+    addProject(*prj, MemSource::OTHER, MemSource::OTHER);
+    auto time = std::filesystem::last_write_time(absName);
+    sourceFiles.push_back(SourceFile {
+            .fname = absName.u8string(),
+            .size = std::filesystem::file_size(absName),
+            .time = time.time_since_epoch().count() });
+}
+
+
+void tr::TranslMemory::build()
+{
+    if (!chunks.empty() && !chunks.back()->isIndexed()) {
+        chunks.back()->build();
+        // All duplicates → nothing to keep
+        if (chunks.back()->segments.empty())
+            chunks.pop_back();
+    }
+}
+
+
+size_t tr::TranslMemory::size() const noexcept
+{
+    size_t r = 0;
+    for (auto& v : chunks)
+        r += v->segments.size();
+    return r;
+}
+
+
+size_t tr::TranslMemory::nPending() const noexcept
+{
+    if (chunks.empty() || chunks.back()->isIndexed())
+        return 0;
+    return chunks.back()->segments.size();
+}
+
+
+void tr::TranslMemory::findHere(const Query& q, SafeVector<MemSuggestion>& r) const
+{
+    SafeVector<unsigned> row;
+    std::u32string candCps;
+    auto check = [&](const Chunk& chunk, const Chunk::Segment& seg) {
+        auto longer = std::max<uint32_t>(seg.nCps, q.cps.length());
+        unsigned maxDist = uint64_t(longer) * (100 - q.minScore) / 100;
+        candCps = mojibake::toM<std::u32string>(chunk.original(seg));
+        auto dist = boundedDistance(q.cps, candCps, maxDist, row);
+        if (dist > maxDist)
+            return;
+        r.push_back(MemSuggestion {
+                .original = chunk.original(seg),
+                .translation = chunk.translation(seg),
+                .score = static_cast<unsigned>(uint64_t(longer - dist) * 100 / longer),
+                .source = seg.source });
+    };
+
+    SafeVector<uint32_t> buckets;
+    SafeVector<uint32_t> touched;
+    SafeVector<std::pair<uint32_t, uint32_t>> counts;  // (# of common, segment)
+    for (auto& pChunk : chunks) {
+        auto& chunk = *pChunk;
+        if (!chunk.isIndexed()) {
+            // Pending: linear scan with length filter
+            for (auto& seg : chunk.segments) {
+                if (seg.nCps >= q.minLength && seg.nCps <= q.maxLength)
+                    check(chunk, seg);
+            }
+            continue;
+        }
+        const uint32_t lo = chunk.lowerByLength(q.minLength);
+        const uint32_t hi = (q.maxLength == UINT32_MAX)
+                ? chunk.segments.size() : chunk.lowerByLength(q.maxLength + 1);
+        if (lo >= hi)
+            continue;
+
+        // Postings of query’s buckets, limited by length
+        collectBuckets(q.cps, chunk.bucketBits, buckets);
+        SafeVector<std::span<const uint32_t>> lists;
+        lists.reserve(buckets.size());
+        for (auto v : buckets) {
+            auto beg = chunk.postings.begin() + chunk.starts[v];
+            auto end = chunk.postings.begin() + chunk.starts[v + 1];
+            beg = std::lower_bound(beg, end, lo);
+            end = std::lower_bound(beg, end, hi);
+            lists.emplace_back(beg, end);
+        }
+        std::sort(lists.begin(), lists.end(),
+                  [](const auto& x, const auto& y) { return x.size() < y.size(); });
+
+        // Common trigrams needed: an edit destroys ≤3 of query’s trigrams,
+        // but when that bound is weak, demand ≈(3s−2) of them, and ≥1.
+        // Dissimilar strings with few common trigrams are lost, that’s OK.
+        const size_t nQ = lists.size();
+        size_t needed = 1;
+        if (q.minScore > 66)
+            needed = std::max<size_t>(needed, (nQ * (3 * q.minScore - 200) + 99) / 100);
+        auto maxDist = uint64_t(q.maxLength == UINT32_MAX ? q.cps.length() : q.maxLength)
+                       * (100 - q.minScore) / 100;
+        if (nQ > 3 * maxDist)
+            needed = std::max<size_t>(needed, nQ - 3 * maxDist);
+        needed = std::min(needed, nQ);
+
+        // Frequent trigrams narrow little and cost much, they are not
+        // counted: candidate still has ≥ needed − nFrequent of others
+        const size_t maxListSize = std::max((hi - lo) / FREQUENT_SHARE, CHEAP_LIST);
+        size_t nCounted = nQ;
+        while (nCounted > MIN_COUNTED && lists[nCounted - 1].size() > maxListSize)
+            --nCounted;
+        needed = (needed > nQ - nCounted) ? needed - (nQ - nCounted) : 1;
+        needed = std::min<size_t>(needed, UINT16_MAX);
+
+        // Count in thread’s own counters, then zero touched ones
+        thread_local SafeVector<uint16_t> counters;
+        if (counters.size() < chunk.segments.size())
+            counters.resize(chunk.segments.size());
+        size_t nHits = 0;
+        for (size_t i = 0; i < nCounted; ++i)
+            nHits += lists[i].size();
+        touched.clear();
+        touched.reserve(nHits);     // no exceptions while counters are dirty
+        for (size_t i = 0; i < nCounted; ++i) {
+            for (auto v : lists[i]) {
+                auto& c = counters[v];
+                if (c == 0)
+                    touched.push_back(v);
+                if (c < UINT16_MAX)
+                    ++c;
+            }
+        }
+        counts.clear();
+        for (auto v : touched) {
+            if (counters[v] >= needed)
+                counts.emplace_back(counters[v], v);
+            counters[v] = 0;
+        }
+
+        // Check the best by trigrams
+        const size_t nChecks = std::max(MIN_CHECKS, q.maxCount * CHECKS_PER_SUGGESTION);
+        if (counts.size() > nChecks) {
+            std::nth_element(counts.begin(), counts.begin() + nChecks, counts.end(),
+                             std::greater<>());
+            counts.resize(nChecks);
+        }
+        for (auto& v : counts)
+            check(chunk, chunk.segments[v.second]);
+    }
+}
+
+
+SafeVector<tr::MemSuggestion> tr::TranslMemory::find(
+        std::u8string_view original, size_t maxCount, unsigned minScore) const
+{
+    SafeVector<MemSuggestion> r;
+    if (original.empty() || maxCount == 0)
+        return r;
+    Query q;
+    q.text = original;
+    q.cps = mojibake::toM<std::u32string>(original);
+    q.maxCount = maxCount;
+    q.minScore = std::min(minScore, 100u);
+    // score ≤ 100·shorter/longer
+    uint64_t len = q.cps.length();
+    q.minLength = (len * q.minScore + 99) / 100;
+    q.maxLength = (q.minScore == 0)
+            ? UINT32_MAX
+            : std::min<uint64_t>(len * 100 / q.minScore, UINT32_MAX - 1);
+
+    for (auto p = this; p; p = p->fBase.get())
+        p->findHere(q, r);
+
+    // Best first; same pair from several chunks → once
+    std::stable_sort(r.begin(), r.end(),
+        [](const MemSuggestion& x, const MemSuggestion& y) {
+            if (x.score != y.score)
+                return (x.score > y.score);
+            return (x.source < y.source);
+        });
+    size_t n = 0;
+    for (size_t i = 0; i < r.size() && n < maxCount; ++i) {
+        auto& v = r[i];
+        bool isSeen = std::any_of(r.begin(), r.begin() + n,
+            [&v](const MemSuggestion& x) {
+                return x.original == v.original && x.translation == v.translation;
+            });
+        if (!isSeen)
+            r[n++] = v;
+    }
+    r.resize(n);
+    return r;
+}
+
+
+size_t tr::TranslMemory::pretranslate(
+        Project& prj, unsigned minScore, unsigned nJobs) const
+{
+    if (!prj.info.isTranslation())
+        return 0;
+
+    // Search in parallel, then change texts in one thread
+    struct Job {
+        UiObject* obj;
+        Translatable* t;
+        std::optional<MemSuggestion> found {};
+    };
+    SafeVector<Job> jobs;
+    prj.traverseTexts([&jobs](UiObject& obj, Translatable& t) {
+        if (!t.translation && !t.original.empty())
+            jobs.push_back(Job { .obj = &obj, .t = &t });
+    });
+    std::atomic<size_t> iNext = 0;
+    auto work = [this, minScore, &jobs, &iNext]() {
+        size_t i;
+        while ((i = iNext++) < jobs.size()) {
+            auto found = find(jobs[i].t->original.sv(), 1, minScore);
+            if (!found.empty())
+                jobs[i].found = found[0];
+        }
+    };
+    if (nJobs == 0)
+        nJobs = std::max(std::thread::hardware_concurrency(), 1u);
+    if (nJobs > jobs.size())
+        nJobs = static_cast<unsigned>(jobs.size());
+    SafeVector<std::thread> threads;
+    for (unsigned i = 1; i < nJobs; ++i)
+        threads.emplace_back(work);
+    work();
+    for (auto& v : threads)
+        v.join();
+
+    size_t r = 0;
+    for (auto& job : jobs) {
+        if (!job.found)
+            continue;
+        if (job.found->score < 100)
+            job.t->forceAttention = true;
+        job.obj->setTranslation(job.found->translation, Modify::YES);
+        ++r;
+    }
+    return r;
+}
+
+
+void tr::TranslMemory::save(const std::filesystem::path& fname)
+{
+    build();
+    std::ofstream os(fname, std::ios::binary | std::ios::trunc);
+    if (!os.is_open())
+        throw std::logic_error("[TranslMemory] Cannot create file");
+    os.write(MAGIC, std::size(MAGIC));
+    writeRaw(os, VERSION);
+    writeRaw(os, BYTE_ORDER_MARK);
+    writeRaw<uint64_t>(os, sourceFiles.size());
+    for (auto& v : sourceFiles) {
+        writeArray(os, v.fname);
+        writeRaw(os, v.size);
+        writeRaw(os, v.time);
+    }
+    writeRaw<uint64_t>(os, chunks.size());
+    for (auto& v : chunks) {
+        writeRaw<uint32_t>(os, v->bucketBits);
+        writeArray(os, v->pool);
+        writeArray(os, v->segments);
+        writeArray(os, v->starts);
+        writeArray(os, v->postings);
+    }
+    os.flush();
+    if (!os)
+        throw std::logic_error("[TranslMemory] Cannot write file");
+}
+
+
+bool tr::TranslMemory::load(const std::filesystem::path& fname)
+{
+    std::ifstream is(fname, std::ios::binary);
+    if (!is.is_open())
+        return false;
+    char magic[std::size(MAGIC)];
+    uint32_t version, bom;
+    if (!is.read(magic, std::size(magic))
+            || !std::equal(std::begin(magic), std::end(magic), std::begin(MAGIC))
+            || !readRaw(is, version) || version != VERSION
+            || !readRaw(is, bom) || bom != BYTE_ORDER_MARK)
+        return false;
+
+    uint64_t n;
+    if (!readRaw(is, n) || n > MAX_ARRAY)
+        return false;
+    SafeVector<SourceFile> newFiles(n);
+    for (auto& v : newFiles) {
+        if (!readArray(is, v.fname, MAX_ARRAY) || !readRaw(is, v.size) || !readRaw(is, v.time))
+            return false;
+    }
+    if (!readRaw(is, n) || n > MAX_ARRAY)
+        return false;
+    SafeVector<std::unique_ptr<Chunk>> newChunks;
+    for (uint64_t i = 0; i < n; ++i) {
+        auto chunk = std::make_unique<Chunk>();
+        uint32_t bits;
+        if (!readRaw(is, bits)
+                || !readArray(is, chunk->pool, MAX_ARRAY)
+                || !readArray(is, chunk->segments, MAX_ARRAY)
+                || !readArray(is, chunk->starts, MAX_ARRAY)
+                || !readArray(is, chunk->postings, MAX_ARRAY))
+            return false;
+        chunk->bucketBits = bits;
+        if (!chunk->isConsistent())
+            return false;
+        newChunks.push_back(std::move(chunk));
+    }
+    chunks = std::move(newChunks);
+    sourceFiles = std::move(newFiles);
+    return true;
+}
+
+
+SafeVector<std::filesystem::path> tr::TranslMemory::files() const
+{
+    SafeVector<std::filesystem::path> r;
+    for (auto& v : sourceFiles)
+        r.emplace_back(v.fname);
+    return r;
+}
+
+
+bool tr::TranslMemory::isUpToDate() const
+{
+    std::error_code ec;
+    for (auto& v : sourceFiles) {
+        std::filesystem::path path(v.fname);
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec || size != v.size)
+            return false;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec || time.time_since_epoch().count() != v.time)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+// C++
+#include <string>
+#include <filesystem>
+#include <memory>
+#include <cstdint>
+
+// Libs
+#include "u_Vector.h"
+
+namespace tr {
+
+    class Project;
+
+    /// Where translation memory took a pair from
+    /// @warning  Order is priority: equal scores → lower source first
+    enum class MemSource : unsigned char {
+        PROJECT,    ///< translated text of current project
+        TRASH,      ///< project’s trash
+        OTHER,      ///< another .utran file
+    };
+
+    struct MemSuggestion {
+        std::u8string_view original, translation;   ///< owned by memory
+        unsigned score = 0;     ///< 0…100, 100 = same original
+        MemSource source = MemSource::OTHER;
+    };
+
+    ///
+    ///  Translation memory: (original → translation) pairs,
+    ///    and fuzzy search of similar originals.
+    ///  • Pairs are added to a pending chunk; build() indexes it.
+    ///    Pending pairs are found too, by linear scan.
+    ///  • Chunk index is trigram CSR: case-folded trigrams hashed into
+    ///    buckets, each bucket is a sorted array of segment #s.
+    ///  • Score is Levenshtein distance over code points,
+    ///    100·(1 − dist/longerLength); trigrams just narrow candidates.
+    ///  • Optional base memory (e.g. loaded from disk) is searched too
+    ///    and shared, so per-project memories are cheap.
+    ///  • find() is const and uses no shared buffers: any # of threads
+    ///    may search at once.
+    ///
+    class TranslMemory
+    {
+    public:
+        static constexpr unsigned DEFAULT_MIN_SCORE = 70;
+
+        TranslMemory();
+        explicit TranslMemory(std::shared_ptr<const TranslMemory> aBase);
+        ~TranslMemory();
+        TranslMemory(const TranslMemory&) = delete;
+        TranslMemory& operator = (const TranslMemory&) = delete;
+
+        /// Adds a pair; empty original or translation are skipped
+        void add(std::u8string_view original, std::u8string_view translation,
+                 MemSource source);
+        /// Adds translated texts of project, and its trash
+        void addProject(const Project& prj);
+        /// Loads .utran file and adds its texts as OTHER
+        /// @throw  whatever Project::load throws
+        void addFile(const std::filesystem::path& fname);
+        /// Indexes pending chunk, dropping duplicate pairs
+        void build();
+
+        /// @return  up to maxCount suggestions, best first
+        ///          (base memory’s included)
+        SafeVector<MemSuggestion> find(
+                std::u8string_view original,
+                size_t maxCount = 5,
+                unsigned minScore = DEFAULT_MIN_SCORE) const;
+
+        /// Fills untranslated texts of translation project with best
+        ///   suggestions, fuzzy ones (score < 100) are marked for attention
+        /// @param [in] nJobs  # of searching threads; [0] as many as CPU has
+        /// @return # of texts filled
+        size_t pretranslate(Project& prj, unsigned minScore = 100,
+                            unsigned nJobs = 1) const;
+
+        /// @return # of pairs, w/o base
+        size_t size() const noexcept;
+        /// @return # of pairs not indexed yet
+        size_t nPending() const noexcept;
+        const std::shared_ptr<const TranslMemory>& base() const noexcept { return fBase; }
+
+        /// Builds and saves to binary file, w/o base
+        /// @throw std::logic_error  cannot write
+        void save(const std::filesystem::path& fname);
+        /// Replaces contents (but not base) with file’s
+        /// @return [+] loaded
+        ///         [-] no file, or it is of another version, or broken
+        bool load(const std::filesystem::path& fname);
+        /// @return  files added by addFile, absolute
+        SafeVector<std::filesystem::path> files() const;
+        /// @return [+] all files added by addFile are the same
+        ///   as when added (size and time)
+        bool isUpToDate() const;
+    private:
+        class Chunk;
+        struct Query;
+        struct SourceFile {
+            std::u8string fname;
+            uint64_t size;
+            int64_t time;
+        };
+
+        std::shared_ptr<const TranslMemory> fBase;
+        SafeVector<std::unique_ptr<Chunk>> chunks;
+        SafeVector<SourceFile> sourceFiles;
+
+        Chunk& pendingChunk();
+        void addProject(const Project& prj, MemSource textSource, MemSource trashSource);
+        void findHere(const Query& q, SafeVector<MemSuggestion>& r) const;
+    };
+
+}   // namespace tr
@@ -0,0 +1,73 @@
+#pragma once
+
+// C++
+#include <atomic>
+#include <stdexcept>
+
+namespace tr {
+
+    /// Thrown by a long operation that was cancelled
+    class Cancelled : public std::runtime_error
+    {
+    public:
+        Cancelled() : std::runtime_error("Cancelled") {}
+    };
+
+    ///
+    ///  Progress of a long operation (load, update, save, build),
+    ///    and its cancellation.
+    ///  • Called from the thread that runs the operation,
+    ///    or from several threads if it is parallel.
+    ///  • Units are the operation’s own: bytes when loading,
+    ///    files when updating, saving and building.
+    ///  • Operations check cancellation until they start to change
+    ///    something irreversibly, and ignore it then.
+    ///
+    class ProgressListener     // interface
+    {
+    public:
+        /// @param [in] nTotal  [0] unknown
+        virtual void onProgress(size_t nDone, size_t nTotal) = 0;
+        /// @return [+] operation should stop
+        virtual bool isCancelled() const = 0;
+        virtual ~ProgressListener() = default;
+    };
+
+    ///  Thread-safe listener; whoever shows progress polls it
+    class AtomicProgress final : public ProgressListener
+    {
+    public:
+        void onProgress(size_t nDone, size_t nTotal) override
+        {
+            fTotal.store(nTotal, std::memory_order_relaxed);
+            fDone.store(nDone, std::memory_order_relaxed);
+        }
+        bool isCancelled() const override
+            { return fIsCancelled.load(std::memory_order_relaxed); }
+        void cancel() noexcept { fIsCancelled.store(true, std::memory_order_relaxed); }
+        size_t nDone() const noexcept { return fDone.load(std::memory_order_relaxed); }
+        size_t nTotal() const noexcept { return fTotal.load(std::memory_order_relaxed); }
+    private:
+        std::atomic<size_t> fDone = 0, fTotal = 0;
+        std::atomic<bool> fIsCancelled = false;
+    };
+
+    /// Reports progress if listener is present
+    /// @throw Cancelled
+    inline void reportProgress(ProgressListener* x, size_t nDone, size_t nTotal)
+    {
+        if (x) {
+            x->onProgress(nDone, nTotal);
+            if (x->isCancelled())
+                throw Cancelled();
+        }
+    }
+
+    /// @throw Cancelled
+    inline void checkCancelled(const ProgressListener* x)
+    {
+        if (x && x->isCancelled())
+            throw Cancelled();
+    }
+
+}   // namespace tr
@@ -2,9 +2,20 @@
 
 // C++
 #include <stdexcept>
+#include <fstream>
+#include <atomic>
+#include <charconv>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
 
 // Libs
 #include "u_Strings.h"
+#include "u_Hash.h"
+#include "u_XmlSax.h"
+#include "u_MappedFile.h"
 
 // Pugixml
 #include "pugixml.hpp"
@@ -12,6 +23,7 @@
 
 // Project
 #include "TrFile.h"
+#include "TrSnapshot.h"
 
 
 using namespace std::string_view_literals;
@@ -68,15 +80,65 @@ std::shared_ptr<const tr::FileInfo> tr::Traversable::inheritedFileInfo() const
     return {};
 }
 
+///// SyncFingerprint //////////////////////////////////////////////////////////
+
+
+std::string tr::SyncFingerprint::toString() const
+{
+    if (!*this)
+        return {};
+    uint64_t nums[] { source.size, static_cast<uint64_t>(source.time), source.hash, tree };
+    std::string r;
+    char buf[20];
+    for (auto v : nums) {
+        if (!r.empty())
+            r += '-';
+        auto res = std::to_chars(std::begin(buf), std::end(buf), v, 16);
+        r.append(buf, res.ptr);
+    }
+    return r;
+}
+
+
+tr::SyncFingerprint tr::SyncFingerprint::parse(std::string_view x) noexcept
+{
+    uint64_t nums[4];
+    auto p = x.data(), end = p + x.size();
+    for (size_t i = 0; i < std::size(nums); ++i) {
+        if (i != 0) {
+            if (p == end || *p != '-')
+                return {};
+            ++p;
+        }
+        auto res = std::from_chars(p, end, nums[i], 16);
+        if (res.ec != std::errc{})
+            return {};
+        p = res.ptr;
+    }
+    if (p != end)
+        return {};
+    return { .source { .size = nums[0], .time = static_cast<int64_t>(nums[1]), .hash = nums[2] },
+             .tree = nums[3] };
+}
+
+
 ///// Entity ///////////////////////////////////////////////////////////////////
 
 
 bool tr::Entity::setId(std::u8string_view x, tr::Modify wantModify)
 {
     if (id != x) {
+        std::u8string oldId = id.str();
+        updateSearchIndex(SearchChannel::ID, oldId, x);
         id = x;
+        cache.display.drop(Mch::ID);
+        auto pnt = parent();
+        if (auto vg = std::dynamic_pointer_cast<VirtualGroup>(pnt))
+            vg->reindexChild(*this, oldId);
+        if (auto b = pnt ? batch() : nullptr)
+            b->onChildId(*pnt, x);
         if (wantModify != Modify::NO) {
-            doModify(Mch::ID);
+            doModify(Mch::ID, { .op = JournalOp::ID, .value = x, .oldId = oldId });
         }
         return true;
     } else {
@@ -97,7 +159,8 @@ namespace {
             std::u8string_view text,
             tr::WrCache& cache)
     {
-        const char8_t* data = text.data();
+        // Empty ArenaString has null data, and empty translation is OK
+        const char8_t* data = text.empty() ? u8"" : text.data();
         const char8_t* end = data + text.length();
 
         auto node = root.append_child(name);
@@ -130,7 +193,7 @@ namespace {
     void writeTextInTagIf(
             pugi::xml_node root,
             const char* name,
-            const std::u8string& text,
+            std::u8string_view text,
             tr::WrCache& cache)
     {
         if (!text.empty())
@@ -270,6 +333,43 @@ void tr::Entity::entityStealDataFrom(
 }
 
 
+namespace {
+
+    /// Strings are mostly the same → do not copy them
+    void assignIfChanged(str::ArenaString& to, const str::ArenaString& from)
+    {
+        if (to != from)
+            to = from;
+    }
+
+}   // anon namespace
+
+
+void tr::Entity::entityMergeFrom(const Entity& x, const MergeContext& ctx)
+{
+    state = ObjState::STAYING;
+    // Caches are the same as x’s copy would have, UI state is mine
+    if (ctx.isSrcTemp) {
+        cache.mod = x.cache.mod;
+    } else {
+        cache.mod.clear();
+    }
+    cache.searchSlot.reset();
+    cache.display = {};
+
+    // *this is HAND-EDITED, x is EXTERNAL SOFTWARE, see entityStealDataFrom
+    assignIfChanged(comm.importers, x.comm.importers);
+    switch (ctx.orig) {
+    case tf::StealOrig::STEAL:
+        break;
+    case tf::StealOrig::KEEP:
+    case tf::StealOrig::KEEP_WARN:
+        assignIfChanged(comm.authors, x.comm.authors);
+    }
+    // Translator’s comment is mine
+}
+
+
 ///// GroupLoader //////////////////////////////////////////////////////////////
 
 
@@ -358,35 +458,37 @@ std::shared_ptr<tr::UiObject> tr::VirtualGroup::child(size_t i) const
 
 
 std::shared_ptr<tr::Text> tr::VirtualGroup::addText(
-        std::u8string id, std::u8string original,
+        std::u8string_view id, std::u8string_view original,
         Modify wantModify)
 {
     auto index = nChildren();
     auto r = std::make_shared<Text>(fSelf, index, PassKey{});
     r->fSelf = r;
-    r->id = std::move(id);
-    r->tr.original = std::move(original);
+    r->id = id;
+    r->tr.original = original;
     if (wantModify != Modify::NO) {
         doModify(Mch::META);
     }
     children.push_back(r);
-    cascadeDropStats();
+    indexChild(index);
+    onChildAdded(id);
     return r;
 }
 
 
 std::shared_ptr<tr::Group> tr::VirtualGroup::addGroup(
-        std::u8string id, Modify wantModify)
+        std::u8string_view id, Modify wantModify)
 {
     auto index = nChildren();
     auto r = std::make_shared<Group>(fSelf.lock(), index, PassKey{});
     r->fSelf = r;
-    r->id = std::move(id);
+    r->id = id;
     if (wantModify != Modify::NO) {
         doModify(Mch::META);
     }
     children.push_back(r);
-    cascadeDropStats();
+    indexChild(index);
+    onChildAdded(id);
     return r;
 }
 
@@ -405,9 +507,15 @@ std::shared_ptr<tr::UiObject> tr::VirtualGroup::extractChild(
     if (i >= children.size())
         return {};
     auto r = children[i];
+    auto b = batch();
+    if (b) {
+        // Shifting index is O(n) as well → rebuild on next find
+        dropChildIndex();
+    } else {
+        unindexChild(i);
+    }
     children.erase(children.begin() + i);
-    recache();
-    cascadeDropStats();
+    onChildErased(b);
     if (wantModify != Modify::NO)
         doModify(Mch::META);
     return r;
@@ -439,6 +547,8 @@ void tr::VirtualGroup::readCommentsAndChildren(
             }
         }
     }
+    // IDs were assigned after adding
+    dropChildIndex();
 }
 
 
@@ -479,20 +589,152 @@ void tr::VirtualGroup::traverse(
 
 void tr::VirtualGroup::doSwapChildren(size_t index1, size_t index2)
 {
-    if (index1 < children.size() && index2 < children.size())
+    if (index1 < children.size() && index2 < children.size()) {
         std::swap(children[index1], children[index2]);
+        if (fIndex.isBuilt) {
+            auto fix = [this, index1, index2](size_t k) {
+                auto& v = children[k];
+                if (!v)
+                    return;
+                if (auto map = indexMap(*v)) {
+                    auto it = map->find(v->id);
+                    if (it != map->end()
+                            && (it->second == index1 || it->second == index2))
+                        it->second = k;
+                }
+            };
+            // Lower one last: if IDs are the same, it wins
+            fix(std::max(index1, index2));
+            fix(std::min(index1, index2));
+        }
+    }
 }
 
 
-std::shared_ptr<tr::Group> tr::VirtualGroup::findGroup(std::u8string_view id)
+auto tr::VirtualGroup::indexMap(const Entity& x) -> ChildIndex::Map*
 {
-    for (auto& v : children) {
-        if (auto vg = std::dynamic_pointer_cast<tr::Group>(v)) {
-            if (vg->id == id)
-                return vg;
+    switch (x.objType()) {
+    case ObjType::TEXT:
+        return &fIndex.texts;
+    case ObjType::GROUP:
+        return &fIndex.groups;
+    case ObjType::PROJECT:
+    case ObjType::FILE:;    // They never happen inside VirtualGroup
+    }
+    return nullptr;
+}
+
+
+void tr::VirtualGroup::ensureChildIndex()
+{
+    if (fIndex.isBuilt)
+        return;
+    fIndex.clear();
+    fIndex.isBuilt = true;
+    for (size_t i = 0; i < children.size(); ++i)
+        indexChild(i);
+}
+
+
+void tr::VirtualGroup::indexChild(size_t i)
+{
+    if (!fIndex.isBuilt)
+        return;
+    auto& v = children[i];
+    if (!v)
+        return;
+    if (auto map = indexMap(*v)) {
+        auto [it, isNew] = map->try_emplace(v->id.str(), i);
+        if (!isNew && i < it->second)
+            it->second = i;
+    }
+}
+
+
+void tr::VirtualGroup::unindexChild(size_t i)
+{
+    if (!fIndex.isBuilt)
+        return;
+    if (auto& v = children[i]) {
+        if (auto map = indexMap(*v)) {
+            if (auto it = map->find(v->id);
+                    it != map->end() && it->second == i) {
+                map->erase(it);
+                // Maybe there’s one more child with the same ID
+                for (size_t j = i + 1; j < children.size(); ++j) {
+                    auto& w = children[j];
+                    if (w && w->objType() == v->objType() && w->id == v->id) {
+                        map->emplace(w->id, j);
+                        break;
+                    }
+                }
+            }
         }
     }
-    return {};
+    // Child i will be erased → shift everything above
+    for (auto* map : { &fIndex.texts, &fIndex.groups }) {
+        for (auto& [_, index] : *map) {
+            if (index > i)
+                --index;
+        }
+    }
+}
+
+
+void tr::VirtualGroup::reindexChild(const Entity& x, std::u8string_view oldId)
+{
+    if (!fIndex.isBuilt)
+        return;
+    size_t i = x.cache.index;
+    if (i >= children.size() || children[i].get() != &x) {
+        // Somehow lost → just rebuild on next find
+        fIndex.clear();
+        return;
+    }
+    auto map = indexMap(x);
+    if (!map)
+        return;
+    if (auto it = map->find(oldId); it != map->end() && it->second == i) {
+        map->erase(it);
+        for (size_t j = i + 1; j < children.size(); ++j) {
+            auto& w = children[j];
+            if (w && w->objType() == x.objType() && w->id == oldId) {
+                map->emplace(w->id, j);
+                break;
+            }
+        }
+    }
+    indexChild(i);
+}
+
+
+size_t tr::VirtualGroup::findIndexed(
+        ChildIndex::Map& map, ObjType type, std::u8string_view id)
+{
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        ensureChildIndex();
+        auto it = map.find(id);
+        if (it == map.end())
+            break;
+        auto i = it->second;
+        if (i < children.size()) {
+            auto& v = children[i];
+            if (v && v->objType() == type && v->id == id)
+                return i;
+        }
+        // Stale index → rebuild and try again
+        fIndex.clear();
+    }
+    return children.size();
+}
+
+
+std::shared_ptr<tr::Group> tr::VirtualGroup::findGroup(std::u8string_view id)
+{
+    auto i = findIndexed(fIndex.groups, ObjType::GROUP, id);
+    if (i >= children.size())
+        return {};
+    return std::static_pointer_cast<tr::Group>(children[i]);
 }
 
 
@@ -504,13 +746,11 @@ std::shared_ptr<tr::Text> tr::VirtualGroup::findText(std::u8string_view id)
 
 tr::FindPText tr::VirtualGroup::findPText(std::u8string_view id)
 {
-    for (auto& v : children) {
-        if (auto vg = std::dynamic_pointer_cast<tr::Text>(v)) {
-            if (vg->id == id)
-                return { &v, vg };
-        }
-    }
-    return {};
+    auto i = findIndexed(fIndex.texts, ObjType::TEXT, id);
+    if (i >= children.size())
+        return {};
+    auto& v = children[i];
+    return { &v, std::static_pointer_cast<tr::Text>(v) };
 }
 
 
@@ -519,6 +759,11 @@ void tr::VirtualGroup::loadText(
         const std::filesystem::path& fname,
         tf::Existing existing)
 {
+    // Loader overwrites existing texts directly
+    auto prj = project();
+    if (prj)
+        prj->searchIndex()->clear();
+    Batch batch(prj);
     GroupLoader loader(fSelf.lock(), existing);
     fmt.doImport(loader, fname);
 }
@@ -591,9 +836,7 @@ tr::UpdateInfo tr::VirtualGroup::vgStealDataFrom(
                 continue;
             if (auto* tr = w->translatable()) {
                 if (tr->translation) {
-                    auto& lastTrash = ctx.trash->data.emplace_back();
-                    lastTrash.chain = w->idChain();
-                    lastTrash.tr = *tr;
+                    ctx.trash->add(w->idChain(), *tr);
                 }
             }
         }
@@ -603,6 +846,134 @@ tr::UpdateInfo tr::VirtualGroup::vgStealDataFrom(
 }
 
 
+namespace {
+
+    constexpr size_t NO_PAIR = std::numeric_limits<size_t>::max();
+
+    template <class T>
+    bool isSameKey(const T* x, const T* y)
+        { return x && y && x->objType() == y->objType() && x->id == y->id; }
+
+    ///  Pairs children of the same type and ID: k’th such child of x
+    ///    goes with k’th one of mine.
+    ///  Children usually go in the same order → just walk them together,
+    ///    the rest are sorted by type/ID and merge-joined.
+    ///  @return  for each x’s child: index in mine, or NO_PAIR
+    template <class T>
+    SafeVector<size_t> pairChildren(
+            const SafeVector<std::shared_ptr<T>>& mine,
+            const SafeVector<std::shared_ptr<T>>& x)
+    {
+        SafeVector<size_t> r(x.size(), NO_PAIR);
+        auto nCommon = std::min(mine.size(), x.size());
+        size_t iStart = 0;
+        for (; iStart < nCommon; ++iStart) {
+            if (!isSameKey(mine[iStart].get(), x[iStart].get()))
+                break;
+            r[iStart] = iStart;
+        }
+        if (iStart == mine.size() || iStart == x.size())
+            return r;
+
+        struct Key {
+            tr::ObjType type;
+            std::u8string_view id;
+            size_t index;   // unique → k’th goes with k’th
+            auto operator <=> (const Key&) const = default;
+        };
+        auto collect = [iStart](const SafeVector<std::shared_ptr<T>>& v) {
+            SafeVector<Key> r;
+            r.reserve(v.size() - iStart);
+            for (size_t i = iStart; i < v.size(); ++i) {
+                if (auto& p = v[i])
+                    r.push_back({ p->objType(), p->id, i });
+            }
+            std::sort(r.begin(), r.end());
+            return r;
+        };
+        auto myKeys = collect(mine);
+        auto xKeys = collect(x);
+        auto p = myKeys.begin();
+        for (auto& k : xKeys) {
+            while (p != myKeys.end()
+                   && std::tie(p->type, p->id) < std::tie(k.type, k.id))
+                ++p;
+            if (p == myKeys.end())
+                break;
+            if (p->type == k.type && p->id == k.id) {
+                r[k.index] = p->index;
+                ++p;
+            }
+        }
+        return r;
+    }
+
+}   // anon namespace
+
+
+tr::UpdateInfo tr::VirtualGroup::vgMergeFrom(
+        const VirtualGroup& x, const MergeContext& ctx)
+{
+    entityMergeFrom(x, ctx);
+    tr::UpdateInfo r;
+    auto pairs = pairChildren(children, x.children);
+    auto old = std::move(children);
+    children.clear();
+    children.reserve(x.children.size());
+    dropChildIndex();
+
+    for (size_t i = 0; i < x.children.size(); ++i) {
+        auto& w = x.children[i];
+        if (!w)
+            continue;
+        if (auto iOld = pairs[i]; iOld != NO_PAIR) {
+            // Stays!
+            auto& v = children.emplace_back(std::move(old[iOld]));
+            switch (v->objType()) {
+            case tr::ObjType::PROJECT:
+            case tr::ObjType::FILE:  // They never happen inside VirtualGroup
+                break;
+            case tr::ObjType::GROUP:
+                r += static_cast<Group&>(*v).mergeFrom(
+                            static_cast<const Group&>(*w), ctx);
+                break;
+            case tr::ObjType::TEXT:
+                r.changed += static_cast<Text&>(*v).mergeFrom(
+                            static_cast<const Text&>(*w), ctx);
+                break;
+            }
+        } else {
+            // Added!
+            std::shared_ptr<Entity> v;
+            if (ctx.isSrcTemp) {
+                v = children.emplace_back(w);
+            } else if (!(v = vgCopyChild(*w))) {
+                continue;
+            }
+            v->removeTranslChannel();
+            v->state = ObjState::ADDED;
+            v->markChildrenAsAddedToday();
+            r += v->addedInfo(CascadeDropCache::NO);
+        }
+    }
+
+    // The rest are deleted, fill trash
+    for (auto& v : old) {
+        if (!v)
+            continue;
+        r.deleted += v->deletedInfo(CascadeDropCache::NO);
+        if (ctx.trash && v->objType() == ObjType::TEXT) {
+            auto& tr = static_cast<Text&>(*v).tr;
+            if (tr.translation) {
+                ctx.trash->add(v->idChain(), tr);
+            }
+        }
+    }
+    recache();
+    return r;
+}
+
+
 void tr::VirtualGroup::vgStealReferenceFrom(VirtualGroup& x)
 {
     for (auto& v : children) {
@@ -631,6 +1002,38 @@ void tr::VirtualGroup::vgStealReferenceFrom(VirtualGroup& x)
 }
 
 
+void tr::VirtualGroup::vgCopyFrom(const VirtualGroup& x)
+{
+    comm = x.comm;
+    for (auto& v : x.children)
+        vgCopyChild(*v);
+}
+
+
+std::shared_ptr<tr::Entity> tr::VirtualGroup::vgCopyChild(const Entity& x)
+{
+    switch (x.objType()) {
+    case tr::ObjType::PROJECT:
+    case tr::ObjType::FILE:  // They never happen inside VirtualGroup
+        break;
+    case tr::ObjType::GROUP: {
+            auto& xGroup = static_cast<const Group&>(x);
+            auto group = addGroup(xGroup.id, Modify::NO);
+            if (xGroup.sync.format)
+                group->sync.format = xGroup.sync.format->clone();
+            group->sync.absPath = xGroup.sync.absPath;
+            group->sync.info = xGroup.sync.info;
+            group->sync.fingerprint = xGroup.sync.fingerprint;
+            group->vgCopyFrom(xGroup);
+            return group;
+        }
+    case tr::ObjType::TEXT:
+        return static_cast<const Text&>(x).clone(fSelf.lock(), nullptr, Modify::NO);
+    }
+    return nullptr;
+}
+
+
 void tr::VirtualGroup::collectSyncGroups(
         std::vector<std::shared_ptr<tr::Group>>& r)
 {
@@ -693,45 +1096,46 @@ tr::Group::Group(
 }
 
 
-namespace {
-
-    void writeFormat(pugi::xml_node parent, tf::FileFormat* format)
-    {
-        if (format) {
-            auto hFormat = parent.append_child("format");
-            hFormat.append_attribute("name") = format->proto().techName().data();  // Tech names are const, so OK
-            format->save(hFormat);
-        }
+void tr::writeFormat(pugi::xml_node parent, tf::FileFormat* format)
+{
+    if (format) {
+        auto hFormat = parent.append_child("format");
+        hFormat.append_attribute("name") = format->proto().techName().data();  // Tech names are const, so OK
+        format->save(hFormat);
     }
+}
 
-    std::unique_ptr<tf::FileFormat> readFormat(pugi::xml_node parent)
-    {
-        if (auto nodeFormat = parent.child("format")) {
-            std::string_view sName = nodeFormat.attribute("name").as_string();
-            if (!sName.empty()) {
-                for (auto v : tf::allWorkingProtos) {
-                    if (v->techName() == sName) {
-                        auto format = v->make();
-                        format->load(nodeFormat);
-                        return format;
-                    }
+
+std::unique_ptr<tf::FileFormat> tr::readFormat(pugi::xml_node parent)
+{
+    if (auto nodeFormat = parent.child("format")) {
+        std::string_view sName = nodeFormat.attribute("name").as_string();
+        if (!sName.empty()) {
+            for (auto v : tf::allWorkingProtos) {
+                if (v->techName() == sName) {
+                    auto format = v->make();
+                    format->load(nodeFormat);
+                    return format;
                 }
             }
         }
-        return {};
     }
+    return {};
 }
 
+
 void tr::Group::writeToXml(pugi::xml_node& root, WrCache& c) const
 {
     auto node = root.append_child("group");
-        node.append_attribute("id") = str::toC(id);
+        node.append_attribute("id") = str::toC(id.c_str());
     if (sync) {
         auto hSync = node.append_child("sync");
         hSync.append_attribute("text-owner") =
                 tf::textOwnerNames[static_cast<int>(sync.info.textOwner)];
         hSync.append_attribute("fname") =
                 str::toC(c.toRelPath(sync.absPath).u8string());
+        if (sync.fingerprint)
+            hSync.append_attribute("fingerprint") = sync.fingerprint.toString().c_str();
         writeFormat(hSync, sync.format.get());
     }
     writeCommentsAndChildren(node, c);
@@ -746,6 +1150,7 @@ void tr::Group::readFromXml(const pugi::xml_node& node, const ReadContext& ctx)
                     hSync.attribute("text-owner").as_string(),
                     tf::textOwnerNames, tf::TextOwner::ME);
         sync.absPath = ctx.toAbsPath(hSync.attribute("fname").as_string());
+        sync.fingerprint = SyncFingerprint::parse(hSync.attribute("fingerprint").as_string());
         sync.format = readFormat(hSync);
     }
     readCommentsAndChildren(node, ctx);
@@ -776,6 +1181,7 @@ std::shared_ptr<tr::Group> tr::Group::clone(
         const IdLib* idlib,
         tr::Modify wantModify) const
 {
+    Batch batch(parent->project());
     auto newId = cloneIdT<ObjType::GROUP>(*parent, idlib, this);
     auto newGroup = parent->addGroup(newId, Modify::NO);
     for (auto& v : children) {
@@ -833,36 +1239,136 @@ void tr::Group::updateParent(const std::shared_ptr<VirtualGroup>& x)
 }
 
 
+tr::UpdateInfo tr::Group::mergeFrom(const Group& x, const MergeContext& ctx)
+{
+    // Sync settings are original’s
+    sync.format = x.sync.format ? x.sync.format->clone() : nullptr;
+    sync.absPath = x.sync.absPath;
+    sync.info = x.sync.info;
+    sync.fingerprint = x.sync.fingerprint;
+    return vgMergeFrom(x, ctx);
+}
+
+
 tr::UpdateInfo tr::Group::updateData()
+{
+    return applySync(importSync());
+}
+
+
+namespace {
+
+    enum : unsigned char { SYNC_END = 0xFF };
+
+    void addSyncEntity(hash::Fnv64& h, const tr::Entity& x)
+    {
+        h.addField(x.id.sv());
+        h.addField(x.comm.importers.sv());
+        h.addField(x.comm.authors.sv());
+    }
+
+    /// What update can change, in children’s order
+    void addSyncChildren(hash::Fnv64& h, const tr::VirtualGroup& x)
+    {
+        for (auto& v : x.children) {
+            h.addNum(static_cast<unsigned char>(v->objType()));
+            addSyncEntity(h, *v);
+            switch (v->objType()) {
+            case tr::ObjType::TEXT: {
+                    auto& t = static_cast<const tr::Text&>(*v).tr;
+                    h.addField(t.original.sv());
+                    h.addNum(t.knownOriginal.text.has_value());
+                    if (t.knownOriginal.text)
+                        h.addField(t.knownOriginal.text->sv());
+                } break;
+            case tr::ObjType::GROUP:
+                addSyncChildren(h, static_cast<const tr::Group&>(*v));
+                break;
+            case tr::ObjType::PROJECT:
+            case tr::ObjType::FILE:  // They never happen inside VirtualGroup
+                break;
+            }
+        }
+        h.addNum(SYNC_END);
+    }
+
+}   // anon namespace
+
+
+uint64_t tr::Group::syncTreeHash() const
+{
+    hash::Fnv64 h;
+    // Sync settings: as they are saved to project
+    h.addNum(static_cast<unsigned char>(sync.info.textOwner));
+    h.addField(sync.absPath.u8string());
+    pugi::xml_document doc;
+    writeFormat(doc, sync.format.get());
+    std::ostringstream os;
+    doc.save(os, "", pugi::format_raw);
+    h.addField(os.str());
+    // Update clears group’s own translator’s comment as well
+    addSyncEntity(h, *this);
+    h.addField(comm.translators.sv());
+    addSyncChildren(h, *this);
+    // 0 is “never updated”
+    return std::max<uint64_t>(h.value(), 1);
+}
+
+
+tr::SyncImport tr::Group::importSync() const
 {
     if (!sync)
         return {};
-    auto prj = project();
+    auto file = fFile.lock();
+    auto prj = file ? file->project() : nullptr;
     if (!prj)
-        throw std::logic_error("[updateData] Somehow no project");
+        throw std::logic_error("[importSync] Somehow no project");
 
     switch (prj->info.type) {
     case tr::PrjType::ORIGINAL:
-        return updateData_Original();
+        break;
     case tr::PrjType::FULL_TRANSL:
         return {};
     }
-    throw std::logic_error("[updateData] Strange project type");
+
+    SyncImport r;
+    // Source’s fingerprint goes BEFORE import: changed meanwhile → import again
+    if (mf::MappedFile source(sync.absPath); source.isOpen()) {
+        r.fingerprint.source = snapshot::passportOf(sync.absPath, source.sv());
+        r.fingerprint.tree = syncTreeHash();
+        if (r.fingerprint == sync.fingerprint)
+            return {};
+    }
+
+    r.tempPrj = tr::Project::make();
+    auto tempFile = r.tempPrj->addFile(u8"tempfile", tr::Modify::NO);
+    r.tempGroup = tempFile->addGroup(id, tr::Modify::NO);
+
+    static constexpr auto NOMATTER = tf::Existing::OVERWRITE;
+    r.tempGroup->loadText(*sync.format, sync.absPath, NOMATTER);
+    return r;
 }
 
 
-tr::UpdateInfo tr::Group::updateData_Original()
+tr::UpdateInfo tr::Group::applySync(SyncImport&& x)
 {
-    auto savedParent = fParentGroup.lock();
-
-    auto tempPrj = tr::Project::make();
-    auto tempFile = tempPrj->addFile(u8"tempfile", tr::Modify::NO);
-    auto tempGroup = tempFile->addGroup(id, tr::Modify::NO);
+    if (!x.tempGroup)
+        return {};
+    auto prj = project();
+    if (!prj)
+        throw std::logic_error("[applySync] Somehow no project");
 
-    static constexpr auto NOMATTER = tf::Existing::OVERWRITE;
-    tempGroup->loadText(*sync.format, sync.absPath, NOMATTER );
+    auto savedParent = fParentGroup.lock();
+    // Temporary project dies right here, while it’s in cache
+    auto tempPrj = std::move(x.tempPrj);
+    auto tempGroup = std::move(x.tempGroup);
 
+    // Journal cannot express that
+    prj->modify();
     std::swap(this->children, tempGroup->children);
+    this->dropChildIndex();
+    prj->searchIndex()->clear();
+    tempGroup->dropChildIndex();
     this->removeTranslChannel();
 
     StealContext ctx {
@@ -875,7 +1381,15 @@ tr::UpdateInfo tr::Group::updateData_Original()
 
     // Stats will always be funked up!
     updateParent(savedParent);
-    stats(StatsMode::ALL_CHILDREN, CascadeDropCache::YES);
+    parallelStats(CascadeDropCache::YES);
+
+    if (x.fingerprint.source != snapshot::Passport{}) {
+        sync.fingerprint.source = x.fingerprint.source;
+        sync.fingerprint.tree = syncTreeHash();
+    } else {
+        // Format imported what we could not map → do not know
+        sync.fingerprint = {};
+    }
     return r;
 }
 
@@ -909,7 +1423,7 @@ std::shared_ptr<tr::Project> tr::Text::project()
 void tr::Text::writeToXml(pugi::xml_node& root, WrCache& c) const
 {
     auto node = root.append_child("text");
-        node.append_attribute("id") = str::toC(id);
+        node.append_attribute("id") = str::toC(id.c_str());
         if (tr.forceAttention) {
             node.append_attribute("force-attention") = true;
         }
@@ -988,9 +1502,19 @@ tr::AttentionMode tr::Text::attentionMode() const
 
 
 const tr::Stats& tr::Text::stats(StatsMode, CascadeDropCache cascade)
+{
+    auto prj = project();
+    return recountStats(prj ? &prj->info : nullptr, cascade);
+}
+
+
+const tr::Stats& tr::Text::recountStats(
+        const PrjInfo* prjInfo, CascadeDropCache cascade)
 {
     Stats r;
-    switch (attentionMode()) {
+    // No project → big troubles, same as attentionMode()
+    auto mode = prjInfo ? tr.attentionMode(*prjInfo) : AttentionMode::CALM;
+    switch (mode) {
     case AttentionMode::BACKGROUND:
         r.text.nBackground = 1;
         break;
@@ -1092,6 +1616,61 @@ tr::UpdateInfo::ByState tr::Text::stealDataFrom(
 }
 
 
+tr::UpdateInfo::ByState tr::Text::mergeFrom(
+        const Text& x, const MergeContext& ctx)
+{
+    UpdateInfo::ByState r;
+    entityMergeFrom(x, ctx);
+    // Translation and forced attention are mine, reference is x’s
+    tr.reference = x.tr.reference;
+    tr.trashState = x.tr.trashState;
+
+    // Build stats
+    const bool isOrigChanged = (tr.original != x.tr.original);
+    tr.wasChangedToday |= (x.tr.wasChangedToday || isOrigChanged);
+    if (isOrigChanged && ctx.orig != tf::StealOrig::STEAL) {
+        if (tr.translation) {
+            r.nTranslated = 1;
+        } else {
+            r.nUntranslated = 1;
+        }
+    }
+
+    // Same cases as in stealDataFrom, but *this is HAND-EDITED
+    switch (ctx.orig) {
+    case tf::StealOrig::KEEP:
+        tr.knownOriginal.reset();
+        if (isOrigChanged)
+            tr.original = x.tr.original;
+        break;
+
+    case tf::StealOrig::STEAL:  // originals stay in place
+        break;
+
+    case tf::StealOrig::KEEP_WARN:
+        // Known original stays unless suppressed
+        if (!tr.knownOriginal)
+            tr.knownOriginal.reset();
+        if (isOrigChanged) {
+            if (auto ko = tr.knownOriginal.active()) {  // HAVE known original — maybe remove?
+                if (*ko == x.tr.original) {
+                    tr.knownOriginal.reset();
+                }
+            } else {       // HAVE NO known original — maybe add?
+                if (tr.translation) {  // But add only if have translation
+                    tr.knownOriginal.text = std::move(tr.original);
+                    tr.knownOriginal.isSuppressed = false;
+                }
+            }
+            tr.original = x.tr.original;
+        }
+        break;
+    }
+
+    return r;
+}
+
+
 void tr::Text::stealReferenceFrom(Text& x)
 {
     this->tr.reference = std::move(x.tr.translation);
@@ -1131,7 +1710,7 @@ std::shared_ptr<tr::UiObject> tr::File::parent() const
 void tr::File::writeToXml(pugi::xml_node& root, WrCache& c) const
 {
     auto node = root.append_child("file");
-        node.append_attribute("name") = str::toC(id);
+        node.append_attribute("name") = str::toC(id.c_str());
         node.append_attribute("idless") = info.isIdless;
         if (!info.origPath.empty())
             node.append_attribute("orig-path") = str::toC(info.origPath.u8string());
@@ -1194,11 +1773,28 @@ tr::UpdateInfo tr::File::stealDataFrom(
 }
 
 
-void tr::File::stealReferenceFrom(tr::File& x)
+tr::UpdateInfo tr::File::mergeFrom(const File& x, const MergeContext& ctx)
 {
-    vgStealReferenceFrom(x);
-}
-
+    info.format = x.info.format.clone();
+    info.isIdless = x.info.isIdless;
+    switch (ctx.orig) {
+    case tf::StealOrig::STEAL:
+        // *this is hand-edited, see stealDataFrom
+        break;
+    case tf::StealOrig::KEEP:
+    case tf::StealOrig::KEEP_WARN:
+        info.origPath = x.info.origPath;
+    }
+    // Translation path is mine
+    return vgMergeFrom(x, ctx);
+}
+
+
+void tr::File::stealReferenceFrom(tr::File& x)
+{
+    vgStealReferenceFrom(x);
+}
+
 
 void tr::File::updateParents(const std::shared_ptr<Project>& x)
 {
@@ -1211,60 +1807,73 @@ void tr::File::updateParents(const std::shared_ptr<Project>& x)
 
 namespace {
 
-    class FileWalker final :
-            public tf::Walker, private tr::TraverseListener
+    ///  Streams texts right from the tree: explicit stack of groups,
+    ///  no precollecting, no shared_ptr copies
+    class FileWalker final : public tf::Walker
     {
     public:
-        FileWalker(tr::File& file,
+        FileWalker(const tr::File& file,
                    tr::WalkChannel aChannel,
-                   tr::WalkOrder order,
+                   tr::WalkOrder aOrder,
                    bool aWantPseudoLoc);
         const tf::TextInfo& nextText() override;
     private:
-        struct DepthInfo {
-            int commonDepth = 0, newDepth = 0;
-            std::shared_ptr<const tr::Text> text = nullptr;
+        struct Frame {
+            const tr::VirtualGroup* group;
+            size_t index = 0;
+            /// ECONOMY order: [-] texts are going [+] subgroups are going
+            bool isGroupPass = false;
         };
 
         tr::WalkChannel channel;
-        SafeVector<DepthInfo> texts;
-        size_t index = 0;
+        tr::WalkOrder order;
         bool wantPseudoLoc = true;
-        DepthInfo depthInfo;
+        SafeVector<Frame> stack;    ///< [0] is file, its depth is 0
+        int commonDepth = 0;
         tf::TextInfo textInfo;
         std::u8string pseudoLoced;
 
-        void onEnterGroup(const std::shared_ptr<tr::VirtualGroup>& x) override;
-        void onLeaveGroup(const std::shared_ptr<tr::VirtualGroup>& x) override;
-        void onText(const std::shared_ptr<tr::Text>& x) override;
+        /// @return  next text, or null; stack is positioned at its group
+        const tr::Text* findNextText();
         std::u8string_view pseudoLoc(std::u8string_view s);
     };
 
-    void FileWalker::onEnterGroup(const std::shared_ptr<tr::VirtualGroup>&)
+    FileWalker::FileWalker(
+            const tr::File& file, tr::WalkChannel aChannel, tr::WalkOrder aOrder,
+            bool aWantPseudoLoc)
+        : channel(aChannel), order(aOrder), wantPseudoLoc(aWantPseudoLoc)
     {
-        ++depthInfo.newDepth;
+        stack.push_back({ .group = &file });
     }
 
-    void FileWalker::onLeaveGroup(const std::shared_ptr<tr::VirtualGroup>&)
+    const tr::Text* FileWalker::findNextText()
     {
-        if ((--depthInfo.newDepth) < depthInfo.commonDepth) {
-            depthInfo.commonDepth = depthInfo.newDepth;
+        while (!stack.empty()) {
+            auto& frame = stack.back();
+            auto& children = frame.group->children;
+            if (frame.index >= children.size()) {
+                if (order == tr::WalkOrder::ECONOMY && !frame.isGroupPass) {
+                    // First texts, then subgroups
+                    frame.isGroupPass = true;
+                    frame.index = 0;
+                    continue;
+                }
+                stack.pop_back();
+                int depth = static_cast<int>(stack.size()) - 1;
+                if (depth >= 0 && depth < commonDepth)
+                    commonDepth = depth;
+                continue;
+            }
+            auto* child = children[frame.index++].get();
+            bool isText = (child->objType() == tr::ObjType::TEXT);
+            if (order == tr::WalkOrder::ECONOMY && isText == frame.isGroupPass)
+                continue;
+            if (isText)
+                return static_cast<const tr::Text*>(child);
+            // frame is invalidated here!
+            stack.push_back({ .group = static_cast<const tr::VirtualGroup*>(child) });
         }
-    }
-
-    void FileWalker::onText(const std::shared_ptr<tr::Text>& x)
-    {
-        auto& v = texts.emplace_back(depthInfo);
-        v.text = x;
-        depthInfo.commonDepth = depthInfo.newDepth;
-    }
-
-    FileWalker::FileWalker(
-            tr::File& file, tr::WalkChannel aChannel, tr::WalkOrder order,
-            bool aWantPseudoLoc)
-        : channel(aChannel), wantPseudoLoc(aWantPseudoLoc)
-    {
-        file.traverse(*this, order, tr::EnterMe::NO);
+        return nullptr;
     }
 
     std::u8string_view FileWalker::pseudoLoc(std::u8string_view s)
@@ -1284,32 +1893,30 @@ namespace {
         // Shift depth
         textInfo.prevDepth = textInfo.actualDepth();        // 1. prevDepth
 
-        if (index >= texts.size()) {
+        auto text = findNextText();
+        if (!text) {
             // End?
             textInfo.commonDepth = 0;
             textInfo.ids.clear();
         } else {
             // OK
-            auto& di = texts[index++];
-            textInfo.commonDepth = di.commonDepth;          // 2. commonDepth
-            auto depth = di.newDepth;
+            auto depth = stack.size() - 1;
+            textInfo.commonDepth = commonDepth;             // 2. commonDepth
 
             // Set IDs, assign text ID
             textInfo.ids.resize(depth + 1);                 // 3. ids
-            textInfo.ids.back() = di.text->id;
-
-            // Assign rest IDs from depth to commonDepth
-            auto pText = di.text->parent();
-            while (depth > di.commonDepth) {
-                if (!pText)
-                    throw std::logic_error("[FileWalker.nextText] File was destroyed somehow");
-                textInfo.ids[--depth] = pText->idColumn();
-                pText = pText->parent();
+            textInfo.ids.back() = text->id;
+
+            // Assign rest IDs from commonDepth to depth,
+            // those below commonDepth are left from previous text
+            for (size_t i = commonDepth; i < depth; ++i) {
+                textInfo.ids[i] = stack[i + 1].group->id;
             }
+            commonDepth = depth;
 
             // Assign fixed text
-            textInfo.original = di.text->tr.original;       // 4. original
-            textInfo.translation = di.text->tr.translationSv(); // 5. translation
+            textInfo.original = text->tr.original;          // 4. original
+            textInfo.translation = text->tr.translationSv(); // 5. translation
             // Assign text of channel
             switch (channel) {                              // 6. text
             case tr::WalkChannel::ORIGINAL:
@@ -1317,7 +1924,7 @@ namespace {
                 textInfo.isFallbackLocale = false;
                 break;
             case tr::WalkChannel::TRANSLATION:
-                if (di.text->tr.translation) {
+                if (text->tr.translation) {
                     textInfo.text = textInfo.translation;
                     textInfo.isFallbackLocale = false;
                 } else {
@@ -1362,7 +1969,7 @@ std::shared_ptr<tr::File> tr::Project::addFile(
         doModify(Mch::META);
     }
     files.push_back(r);
-    cascadeDropStats();
+    onChildAdded(name);
     return r;
 }
 
@@ -1391,8 +1998,7 @@ std::shared_ptr<tr::UiObject> tr::Project::extractChild(
         return {};
     auto r = files[i];
     files.erase(files.begin() + i);
-    recache();
-    cascadeDropStats();
+    onChildErased(batch());
     if (wantModify != Modify::NO)
         doModify(Mch::META);
     return r;
@@ -1408,24 +2014,57 @@ bool tr::Project::unmodify(Forced forced)
 }
 
 
-void tr::Project::save()
+bool tr::Project::modify(Forced forced)
+{
+    if (fBatch) {
+        fBatch->onModify();
+        return false;
+    }
+    // Listener learns that journal broke off, even if already modified
+    if (fJournal.isIntact())
+        forced = Forced::YES;
+    fJournal.breakOff();
+    return SimpleModifiable::modify(forced);
+}
+
+
+void tr::Project::journalModify(UiObject& obj, const JournalEdit& edit)
 {
-    saveCopy(fname);
+    // Batch modifies project once, journal cannot express that
+    if (fBatch) {
+        fBatch->onModify();
+        return;
+    }
+    fJournal.write(obj, edit);
+    SimpleModifiable::modify();
+}
+
+
+void tr::Project::save(ProgressListener* progress)
+{
+    saveCopy(fname, progress);
+    // Journal is in file now
+    fJournal.start(fname);
     unmodify(Forced::YES);
 }
 
 
-void tr::Project::save(const std::filesystem::path& aFname)
+void tr::Project::save(const std::filesystem::path& aFname, ProgressListener* progress)
 {
-    saveCopy(aFname);
+    saveCopy(aFname, progress);
+    // Old file keeps what was saved to it
+    if (aFname != fname)
+        fJournal.discardUnsaved();
     fname = aFname;
+    fJournal.start(fname);
     unmodify(Forced::YES);
 }
 
 
 void tr::Project::writeToXml(
         pugi::xml_node& doc,
-        const std::filesystem::path& basePath) const
+        const std::filesystem::path& basePath,
+        ProgressListener* progress) const
 {
     auto root = doc.append_child("ut");
     root.append_attribute("type") = prjTypeNames[info.type];
@@ -1452,8 +2091,9 @@ void tr::Project::writeToXml(
                 nodeTransl.append_attribute("pseudoloc") = hasPseudoloc;
             }
     }
-    for (auto& file : files) {
-        file->writeToXml(root, c);
+    for (size_t i = 0; i < files.size(); ++i) {
+        reportProgress(progress, i, files.size());
+        files[i]->writeToXml(root, c);
     }
 }
 
@@ -1494,13 +2134,16 @@ void tr::Project::readFromXml(
 }
 
 
-void tr::Project::saveCopy(const std::filesystem::path& aFname) const
+void tr::Project::saveCopy(
+        const std::filesystem::path& aFname, ProgressListener* progress) const
 {
     pugi::xml_document doc;
     auto declaration = doc.append_child(pugi::node_declaration);
         declaration.append_attribute("version") = "1.0";
         declaration.append_attribute("encoding") = "utf-8";
-    writeToXml(doc, aFname.parent_path());
+    writeToXml(doc, aFname.parent_path(), progress);
+    // Disk is not touched yet → last chance to cancel
+    reportProgress(progress, files.size(), files.size());
     doc.save_file(aFname.c_str(), " ", pugi::format_indent | pugi::format_write_bom);
 }
 
@@ -1515,14 +2158,511 @@ void tr::Project::load(
 }
 
 
-void tr::Project::load(const std::filesystem::path& aFname)
+///// StreamLoader /////////////////////////////////////////////////////////////
+
+
+namespace {
+
+    ///  Collects text in tag the same way parseTextInTag does:
+    ///  either <p>paragraphs</p>, or text and <br>s
+    class TagText
+    {
+    public:
+        void start();
+        void onStart(std::string_view name);
+        /// @return [+] tag itself ended
+        bool onEnd();
+        void onText(std::string_view text);
+        std::u8string_view result() const { return (nParas > 0) ? paras : old; }
+    private:
+        std::u8string old, paras, para;
+        size_t nParas = 0;
+        int depth = 0;
+        bool isInPara = false;
+    };
+
+    void TagText::start()
+    {
+        old.clear();
+        paras.clear();
+        nParas = 0;
+        depth = 0;
+        isInPara = false;
+    }
+
+    void TagText::onStart(std::string_view name)
+    {
+        ++depth;
+        if (depth == 1) {
+            if (name == "p"sv) {
+                isInPara = true;
+                para.clear();
+            } else if (name == "br"sv) {
+                old += '\n';
+            }
+        } else if (depth == 2 && isInPara && name == "br"sv) {
+            para += '\n';
+        }
+    }
+
+    bool TagText::onEnd()
+    {
+        if (depth == 0)
+            return true;
+        if (depth == 1 && isInPara) {
+            if (nParas > 0)
+                paras += '\n';
+            paras += para;
+            ++nParas;
+            isInPara = false;
+        }
+        --depth;
+        return false;
+    }
+
+    void TagText::onText(std::string_view text)
+    {
+        if (depth == 0) {
+            old += str::toU8sv(text);
+        } else if (depth == 1 && isInPara) {
+            para += str::toU8sv(text);
+        }
+    }
+
+    ///
+    ///  Builds project right as tags arrive, w/o DOM.
+    ///  Mirrors Project/File/Group/Text::readFromXml.
+    ///  On anything unusual throws sax::Error → caller falls back to DOM,
+    ///    and DOM reports errors.
+    ///
+    class StreamLoader final : public sax::Callback
+    {
+    public:
+        StreamLoader(tr::Project& aPrj, const std::filesystem::path& basePath,
+                     std::string_view aData, tr::ProgressListener* aProgress)
+            : prj(aPrj), ctx { .info = aPrj.info, .baseDir = basePath },
+              data(aData), progress(aProgress) {}
+        void onStart(std::string_view name, const sax::Attrs& attrs) override;
+        void onEnd(std::string_view name) override;
+        void onText(std::string_view text) override;
+        void finish();
+    private:
+        enum class Kind : unsigned char { DOC, ROOT, INFO, FILE, GROUP, TEXT, SYNC };
+        /// Children that are read once, first one wins
+        enum : unsigned {
+            ONCE_INFO = 1, ONCE_ORIG = 2, ONCE_REF = 4, ONCE_TRANSL = 8,
+            ONCE_IM_CMT = 16, ONCE_AU_CMT = 32, ONCE_TR_CMT = 64,
+            ONCE_KNOWN_ORIG = 128, ONCE_FORMAT = 256, ONCE_SYNC = 512 };
+        struct Level {
+            Kind kind;
+            unsigned once = 0;
+            std::shared_ptr<tr::VirtualGroup> group {};
+            std::shared_ptr<tr::Text> text {};
+        };
+
+        /// Progress is reported every N texts
+        static constexpr unsigned PROGRESS_STEP = 4096;
+
+        tr::Project& prj;
+        tr::ReadContext ctx;
+        std::string_view data;
+        tr::ProgressListener* progress;
+        unsigned nTexts = 0;
+        SafeVector<Level> stack { Level { .kind = Kind::DOC } };
+        int skipDepth = 0;
+        // Text in tag
+        bool isInTagText = false;
+        TagText tagText;
+        str::ArenaString* tagTarget = nullptr;
+        std::optional<str::ArenaString>* tagOptTarget = nullptr;
+        // Format: tiny DOM, as formats read themselves from pugixml
+        std::unique_ptr<pugi::xml_document> formatDoc;
+        pugi::xml_node formatNode;
+        int formatDepth = 0;
+        tr::VirtualGroup* formatOwner = nullptr;
+
+        [[noreturn]] static void fail(const char* what) { throw sax::Error(what); }
+        /// @return [+] first time
+        static bool once(Level& level, unsigned what);
+        void startTagText(str::ArenaString* target);
+        void startTagText(std::optional<str::ArenaString>* target);
+        /// Sets ID; entity’s strings are then borrowed from arena
+        void adopt(tr::Entity& entity, std::string_view id);
+        /// @return [+] name is comment; it is either read or skipped then
+        bool startComment(Level& level, std::string_view name);
+        void startFormat(std::string_view name, const sax::Attrs& attrs,
+                         tr::VirtualGroup* owner);
+        void startInfoChild(std::string_view name, const sax::Attrs& attrs);
+        void startGroupChild(std::string_view name, const sax::Attrs& attrs);
+        void startTextChild(std::string_view name);
+        /// @param [in] name  tag name, points into data
+        void reportProgress(std::string_view name);
+    };
+
+    bool StreamLoader::once(Level& level, unsigned what)
+    {
+        if (level.once & what)
+            return false;
+        level.once |= what;
+        return true;
+    }
+
+    void StreamLoader::startTagText(str::ArenaString* target)
+    {
+        tagTarget = target;
+        tagOptTarget = nullptr;
+        isInTagText = true;
+        tagText.start();
+    }
+
+    void StreamLoader::startTagText(std::optional<str::ArenaString>* target)
+    {
+        tagTarget = nullptr;
+        tagOptTarget = target;
+        isInTagText = true;
+        tagText.start();
+    }
+
+    void StreamLoader::adopt(tr::Entity& entity, std::string_view id)
+    {
+        entity.arena = prj.arena;
+        prj.arena->put(entity.id, str::toU8sv(id));
+    }
+
+    bool StreamLoader::startComment(Level& level, std::string_view name)
+    {
+        auto& entity = level.group
+                ? static_cast<tr::Entity&>(*level.group)
+                : static_cast<tr::Entity&>(*level.text);
+        if (name == "im-cmt"sv) {
+            if (once(level, ONCE_IM_CMT))
+                startTagText(&entity.comm.importers);
+            return true;
+        } else if (name == "au-cmt"sv) {
+            if (once(level, ONCE_AU_CMT))
+                startTagText(&entity.comm.authors);
+            return true;
+        } else if (name == "tr-cmt"sv) {
+            if (ctx.info.isTranslation() && once(level, ONCE_TR_CMT))
+                startTagText(&entity.comm.translators);
+            return true;
+        }
+        return false;
+    }
+
+    void StreamLoader::startFormat(
+            std::string_view name, const sax::Attrs& attrs,
+            tr::VirtualGroup* owner)
+    {
+        if (!formatDoc) {
+            // 1st level: new document
+            formatDoc = std::make_unique<pugi::xml_document>();
+            formatNode = *formatDoc;
+            formatOwner = owner;
+            formatDepth = 0;
+        }
+        ++formatDepth;
+        formatNode = formatNode.append_child(std::string{name}.c_str());
+        for (auto& v : attrs.items) {
+            formatNode.append_attribute(std::string{v.name}.c_str())
+                    = std::string{v.value}.c_str();
+        }
+    }
+
+    void StreamLoader::startInfoChild(std::string_view name, const sax::Attrs& attrs)
+    {
+        auto& level = stack.back();
+        auto& info = prj.info;
+        if (name == "orig"sv) {
+            if (once(level, ONCE_ORIG)) {
+                info.orig.lang = attrs.value("lang", "en");
+                if (info.hasOriginalPath()) {
+                    info.orig.absPath = ctx.toAbsPath(attrs.value("fname"));
+                }
+            }
+        } else if (name == "ref"sv) {
+            if (once(level, ONCE_REF) && info.canHaveReference()) {
+                info.ref.absPath = ctx.toAbsPath(attrs.value("fname"));
+            }
+        } else if (name == "transl"sv) {
+            if (once(level, ONCE_TRANSL) && info.isTranslation()) {
+                info.transl.lang = attrs.rqValue(name, "lang");
+                if (attrs.asBool("pseudoloc", false)) {
+                    info.transl.pseudoloc = tr::PrjInfo::Transl::Pseudoloc::DFLT;
+                } else {
+                    info.transl.pseudoloc = tr::PrjInfo::Transl::Pseudoloc::OFF;
+                }
+            }
+        }
+        skipDepth = 1;
+    }
+
+    void StreamLoader::reportProgress(std::string_view name)
+    {
+        tr::reportProgress(progress, name.data() - data.data(), data.size());
+    }
+
+    void StreamLoader::startGroupChild(std::string_view name, const sax::Attrs& attrs)
+    {
+        auto& level = stack.back();
+        if (name == "text"sv) {
+            auto text = level.group->addText({}, {}, tr::Modify::NO);
+            adopt(*text, attrs.rqValue(name, "id"));
+            text->tr.forceAttention = attrs.asBool("force-attention", false);
+            text->tr.knownOriginal.isSuppressed = false;  // is not stored in file
+            stack.push_back({ .kind = Kind::TEXT, .text = std::move(text) });
+            if (progress && ++nTexts % PROGRESS_STEP == 0)
+                reportProgress(name);
+        } else if (name == "group"sv) {
+            auto group = level.group->addGroup({}, tr::Modify::NO);
+            adopt(*group, attrs.rqValue(name, "id"));
+            stack.push_back({ .kind = Kind::GROUP, .group = std::move(group) });
+        } else if (startComment(level, name)) {
+            if (!isInTagText)
+                skipDepth = 1;
+        } else if (name == "format"sv && level.kind == Kind::FILE) {
+            if (once(level, ONCE_FORMAT)) {
+                startFormat(name, attrs, level.group.get());
+            } else {
+                skipDepth = 1;
+            }
+        } else if (name == "sync"sv && level.kind == Kind::GROUP) {
+            if (once(level, ONCE_SYNC)) {
+                auto& group = static_cast<tr::Group&>(*level.group);
+                group.sync.info.textOwner = parseEnumDef(
+                            std::string{attrs.value("text-owner")}.c_str(),
+                            tf::textOwnerNames, tf::TextOwner::ME);
+                group.sync.absPath = ctx.toAbsPath(attrs.value("fname"));
+                group.sync.fingerprint = tr::SyncFingerprint::parse(attrs.value("fingerprint"));
+                stack.push_back({ .kind = Kind::SYNC, .group = level.group });
+            } else {
+                skipDepth = 1;
+            }
+        } else {
+            skipDepth = 1;
+        }
+    }
+
+    void StreamLoader::startTextChild(std::string_view name)
+    {
+        auto& level = stack.back();
+        auto& text = *level.text;
+        if (startComment(level, name)) {
+            // do nothing, startComment did everything
+        } else if (name == "orig"sv) {
+            if (once(level, ONCE_ORIG))
+                startTagText(&text.tr.original);
+        } else if (ctx.info.type == tr::PrjType::FULL_TRANSL) {
+            if (name == "known-orig"sv) {
+                if (once(level, ONCE_KNOWN_ORIG))
+                    startTagText(&text.tr.knownOriginal.text);
+            } else if (name == "transl"sv) {
+                if (once(level, ONCE_TRANSL))
+                    startTagText(&text.tr.translation);
+            }
+        }
+        if (!isInTagText)
+            skipDepth = 1;
+    }
+
+    void StreamLoader::onStart(std::string_view name, const sax::Attrs& attrs)
+    {
+        if (skipDepth > 0) {
+            ++skipDepth;
+            return;
+        }
+        if (isInTagText) {
+            tagText.onStart(name);
+            return;
+        }
+        if (formatDoc) {
+            startFormat(name, attrs, nullptr);
+            return;
+        }
+        auto& level = stack.back();
+        switch (level.kind) {
+        case Kind::DOC:
+            if (name != "ut"sv)
+                fail("Tag <> needs child <ut>");
+            prj.info.type = parseEnumRq<tr::PrjType>(
+                        std::string{attrs.rqValue(name, "type")}.c_str(),
+                        tr::prjTypeNames.cArray());
+            stack.push_back({ .kind = Kind::ROOT });
+            break;
+        case Kind::ROOT:
+            if (name == "info"sv) {
+                if (once(level, ONCE_INFO)) {
+                    stack.push_back({ .kind = Kind::INFO });
+                } else {
+                    skipDepth = 1;
+                }
+            } else if (name == "file"sv) {
+                // We write <info> first, and files depend on it
+                if (!(level.once & ONCE_INFO))
+                    fail("<file> before <info>");
+                auto file = prj.addFile({}, tr::Modify::NO);
+                adopt(*file, attrs.value("name"));
+                file->info.isIdless = attrs.asBool("idless", false);
+                file->info.origPath = str::toU8sv(attrs.value("orig-path"));
+                file->info.translPath = str::toU8sv(attrs.value("transl-path"));
+                stack.push_back({ .kind = Kind::FILE, .group = std::move(file) });
+            } else {
+                skipDepth = 1;
+            }
+            break;
+        case Kind::INFO:
+            startInfoChild(name, attrs);
+            break;
+        case Kind::FILE:
+        case Kind::GROUP:
+            startGroupChild(name, attrs);
+            break;
+        case Kind::TEXT:
+            startTextChild(name);
+            break;
+        case Kind::SYNC:
+            if (name == "format"sv && once(level, ONCE_FORMAT)) {
+                startFormat(name, attrs, level.group.get());
+            } else {
+                skipDepth = 1;
+            }
+            break;
+        }
+    }
+
+    void StreamLoader::onEnd(std::string_view)
+    {
+        if (skipDepth > 0) {
+            --skipDepth;
+            return;
+        }
+        if (isInTagText) {
+            if (tagText.onEnd()) {
+                isInTagText = false;
+                if (tagTarget) {
+                    prj.arena->put(*tagTarget, tagText.result());
+                } else if (tagOptTarget) {
+                    prj.arena->put(tagOptTarget->emplace(), tagText.result());
+                }
+            }
+            return;
+        }
+        if (formatDoc) {
+            formatNode = formatNode.parent();
+            if (--formatDepth == 0) {
+                auto format = tr::readFormat(*formatDoc);
+                switch (stack.back().kind) {
+                case Kind::FILE:
+                    static_cast<tr::File&>(*formatOwner).info.format = std::move(format);
+                    break;
+                case Kind::SYNC:
+                    static_cast<tr::Group&>(*formatOwner).sync.format = std::move(format);
+                    break;
+                default:
+                    fail("Format is in strange place");
+                }
+                formatDoc.reset();
+                formatOwner = nullptr;
+            }
+            return;
+        }
+        auto& level = stack.back();
+        switch (level.kind) {
+        case Kind::DOC:
+            fail("Closing document");
+        case Kind::INFO: {
+                auto& info = prj.info;
+                if (!(level.once & ONCE_ORIG))
+                    fail("Tag <info> needs child <orig>");
+                if (info.isTranslation() && !(level.once & ONCE_TRANSL))
+                    fail("Tag <info> needs child <transl>");
+            } break;
+        case Kind::FILE:
+        case Kind::GROUP:
+            // IDs were assigned after adding
+            level.group->dropChildIndex();
+            break;
+        case Kind::ROOT:
+            if (!(level.once & ONCE_INFO))
+                fail("Tag <ut> needs child <info>");
+            break;
+        case Kind::TEXT:
+        case Kind::SYNC:
+            break;
+        }
+        stack.pop_back();
+    }
+
+    void StreamLoader::onText(std::string_view text)
+    {
+        if (isInTagText && skipDepth == 0)
+            tagText.onText(text);
+    }
+
+    void StreamLoader::finish()
+    {
+        if (stack.size() != 1)
+            fail("Unfinished document");
+    }
+
+}   // anon namespace
+
+
+void tr::Project::loadSax(
+        std::string_view data, const std::filesystem::path& basePath,
+        ProgressListener* progress)
+{
+    clear();
+    arena = std::make_shared<str::StringArena>();
+    StreamLoader loader(*this, basePath, data, progress);
+    sax::parse(data, loader);
+    loader.finish();
+    tr::reportProgress(progress, data.size(), data.size());
+}
+
+
+void tr::Project::loadDom(const std::filesystem::path& aFname)
 {
     pugi::xml_document doc;
     auto result = doc.load_file(aFname.c_str(),
                 pugi::parse_default | pugi::parse_ws_pcdata);
     xmlThrowIf(result, aFname.u8string());
     load(doc, aFname.parent_path());
+}
+
+
+void tr::Project::load(
+        const std::filesystem::path& aFname, ProgressListener* progress,
+        LoadMode mode)
+{
+    mf::MappedFile xml(aFname);
+    if (!xml.isOpen()) {
+        // DOM reports errors
+        loadDom(aFname);
+    } else {
+        auto passport = snapshot::passportOf(aFname, xml.sv());
+        if (!snapshot::load(*this, aFname, passport, progress)) {
+            try {
+                loadSax(xml.sv(), aFname.parent_path(), progress);
+            } catch (const sax::Error&) {
+                // Streaming reader does not understand something → DOM,
+                // it also reports errors better
+                loadDom(aFname);
+                checkCancelled(progress);
+            }
+            // Projects just read may lie anywhere, even in read-only dirs
+            if (mode != LoadMode::READ)
+                snapshot::save(*this, aFname, passport);
+        }
+    }
     fname = aFname;
+    if (mode == LoadMode::EDIT) {
+        if (fJournal.replay(*this, fname).hasUnsaved)
+            SimpleModifiable::modify();
+    } else {
+        // Journal belongs to whoever edits that file
+        fJournal.close();
+    }
 }
 
 
@@ -1572,7 +2712,148 @@ tr::WalkChannel tr::Project::walkChannel() const
 }
 
 
-void tr::Project::doBuild(const std::filesystem::path& destDir)
+namespace {
+
+    struct BuildJob {
+        tr::File* file;
+        tf::FileFormat* format;
+        std::filesystem::path fnExisting, fnExported, dirExported;
+        std::optional<std::string> error {};
+        uint64_t hash = 0;
+        bool isSkipped = false;
+    };
+
+    std::string errorMessage(const std::exception& e)
+    {
+        std::string r = e.what();
+        if (r.empty())
+            r = "Unknown error";
+        return r;
+    }
+
+    /// @return [+] format reads the file it writes
+    bool isInPlace(const BuildJob& job)
+    {
+        return job.format->proto().caps().have(tf::Fcap::NEEDS_FILE)
+                && job.fnExisting == job.fnExported;
+    }
+
+    /// @return [+] some file is written/read by several jobs,
+    ///             and their order matters
+    bool haveCollisions(const SafeVector<BuildJob>& jobs)
+    {
+        std::set<std::filesystem::path> paths;
+        for (auto& job : jobs) {
+            if (!paths.insert(job.fnExported).second)
+                return true;
+            if (job.format->proto().caps().have(tf::Fcap::NEEDS_FILE)
+                    && job.fnExisting != job.fnExported
+                    && !paths.insert(job.fnExisting).second)
+                return true;
+        }
+        return false;
+    }
+
+    ///  Build manifest: file name → hash of everything its export depends on.
+    ///  One per project in each directory exported to.
+    ///  Text file, lines are “hash  filename”.
+    using Manifest = std::map<std::u8string, uint64_t, std::less<>>;
+    /// Bump when export of some format changes
+    constexpr std::string_view MANIFEST_VERSION = "utbuild-1";
+
+    Manifest readManifest(const std::filesystem::path& fname)
+    {
+        Manifest r;
+        std::ifstream is(fname, std::ios::binary);
+        if (!is.is_open())
+            return r;
+        std::string line;
+        while (std::getline(is, line)) {
+            // 16 hex digits, 2 spaces, name
+            if (line.length() < 19 || line[16] != ' ' || line[17] != ' ')
+                continue;
+            uint64_t hash;
+            auto [_, ec] = str::fromChars(
+                        std::string_view(line).substr(0, 16), hash, 16);
+            if (ec != std::errc())
+                continue;
+            r[std::u8string(str::toU8sv(std::string_view(line).substr(18)))] = hash;
+        }
+        return r;
+    }
+
+    void writeManifest(const std::filesystem::path& fname, const Manifest& manifest)
+    {
+        std::ofstream os(fname, std::ios::binary);
+        if (!os.is_open())
+            throw std::logic_error("Cannot write build manifest");
+        char buf[20];
+        for (auto& [name, hash] : manifest) {
+            snprintf(buf, std::size(buf), "%016llx  ",
+                     static_cast<unsigned long long>(hash));
+            os << buf << str::toSv(name) << '\n';
+        }
+        if (!os)
+            throw std::logic_error("Cannot write build manifest");
+    }
+
+    /// @return  hash of everything file’s export depends on:
+    ///          walked texts, channel, format settings, pseudoloc,
+    ///          existing file if format needs it
+    /// @warning  In-place export changes existing file, rehash after it
+    uint64_t hashExportInputs(
+            const BuildJob& job, tr::WalkChannel channel, bool wantPseudoLoc)
+    {
+        hash::Fnv64 h;
+        h.addField(MANIFEST_VERSION);
+        h.addNum(static_cast<uint64_t>(channel));
+        h.addNum(wantPseudoLoc);
+
+        // Format settings: as they are saved to project
+        pugi::xml_document doc;
+        tr::writeFormat(doc, job.format);
+        std::ostringstream os;
+        doc.save(os, "", pugi::format_raw);
+        h.addField(os.str());
+
+        // Existing file, if format uses it
+        if (isInPlace(job)) {
+            // Export writes it, so time always changes; contents are the
+            // same as export left them, unless someone edited the file
+            h.addField(job.fnExisting.u8string());
+            mf::MappedFile file(job.fnExisting);
+            h.addNum(file.isOpen());
+            h.addField(file.sv());
+        } else if (job.format->proto().caps().have(tf::Fcap::NEEDS_FILE)) {
+            h.addField(job.fnExisting.u8string());
+            std::error_code ec;
+            auto size = std::filesystem::file_size(job.fnExisting, ec);
+            h.addNum(ec ? 0 : size);
+            auto time = std::filesystem::last_write_time(job.fnExisting, ec);
+            h.addNum(ec ? 0 : time.time_since_epoch().count());
+        }
+
+        // Texts: right as exporter sees them
+        FileWalker walker(*job.file, channel, job.format->walkOrder(), wantPseudoLoc);
+        while (auto& q = walker.nextText()) {
+            h.addNum(q.commonDepth);
+            h.addNum(q.ids.size());
+            for (auto& v : q.ids)
+                h.addField(v);
+            h.addField(q.text);
+            h.addField(q.original);
+            h.addField(q.translation);
+            h.addNum(q.isFallbackLocale);
+        }
+        return h.value();
+    }
+
+}   // anon namespace
+
+
+tr::BuildInfo tr::Project::doBuild(
+        const std::filesystem::path& destDir, unsigned nJobs,
+        Incremental incremental, ProgressListener* progress)
 {
     auto fullName = fname;
     auto saveDir = fullName.parent_path();
@@ -1580,9 +2861,10 @@ void tr::Project::doBuild(const std::filesystem::path& destDir)
     auto subdir = L"build-" + stem.wstring();
     auto defaultExportDir = saveDir / subdir;
 
+    SafeVector<BuildJob> jobs;
     for (auto& file : files) {
         if (auto format = file->exportableFormat()) {
-            std::filesystem::path fnAsked = file->id;
+            std::filesystem::path fnAsked = file->id.sv();
             // Get export filename:
             // • bare filename → save/build-xxx/filename.ext
             // • filename w/path component → save/path/finename.ext
@@ -1609,16 +2891,129 @@ void tr::Project::doBuild(const std::filesystem::path& destDir)
                 dirExported = destDir;
                 fnExported = dirExported / fnExisting.filename();
             }
-            try {
-                std::filesystem::create_directories(dirExported);
-                FileWalker walker(*file, walkChannel(), format->walkOrder(),
-                                  info.wantPseudoLoc());
-                format->doExport(walker, fnExisting, fnExported);
-            } catch (...) {
-                /// @todo [bug, #45] We hide errors here
+            jobs.push_back({
+                    .file = file.get(), .format = format,
+                    .fnExisting = std::move(fnExisting),
+                    .fnExported = std::move(fnExported),
+                    .dirExported = std::move(dirExported) });
+        }
+    }
+
+    // Directories: serially, several files usually share one
+    for (auto& job : jobs) {
+        try {
+            std::filesystem::create_directories(job.dirExported);
+        } catch (const std::exception& e) {
+            job.error = errorMessage(e);
+        }
+    }
+
+    // Manifests: read before threads start, then they are read-only
+    auto manifestName = stem.u8string();
+    if (manifestName.empty())
+        manifestName = u8"project";
+    manifestName += u8".utbuild";
+    std::map<std::filesystem::path, Manifest> oldManifests;
+    if (incremental != Incremental::NO) {
+        for (auto& job : jobs) {
+            auto [it, isNew] = oldManifests.try_emplace(job.dirExported);
+            if (isNew)
+                it->second = readManifest(job.dirExported / manifestName);
+        }
+    }
+
+    // Files: in parallel, each thread takes the next job
+    auto channel = walkChannel();
+    auto wantPseudoLoc = info.wantPseudoLoc();
+    auto exportOne = [&oldManifests, channel, wantPseudoLoc, incremental](BuildJob& job) {
+        if (job.error)
+            return;
+        try {
+            if (incremental != Incremental::NO) {
+                job.hash = hashExportInputs(job, channel, wantPseudoLoc);
+                auto& manifest = oldManifests.find(job.dirExported)->second;
+                auto it = manifest.find(job.fnExported.filename().u8string());
+                if (it != manifest.end() && it->second == job.hash
+                        && std::filesystem::exists(job.fnExported)) {
+                    job.isSkipped = true;
+                    return;
+                }
             }
+            FileWalker walker(*job.file, channel, job.format->walkOrder(),
+                              wantPseudoLoc);
+            job.format->doExport(walker, job.fnExisting, job.fnExported);
+            if (incremental != Incremental::NO && isInPlace(job))
+                job.hash = hashExportInputs(job, channel, wantPseudoLoc);
+        } catch (const std::exception& e) {
+            job.error = errorMessage(e);
+        } catch (...) {
+            job.error = "Unknown error";
+        }
+    };
+    std::atomic<size_t> iNext = 0, nFinished = 0;
+    auto work = [&jobs, &iNext, &nFinished, &exportOne, progress]() {
+        size_t i;
+        while ((!progress || !progress->isCancelled())
+               && (i = iNext++) < jobs.size()) {
+            exportOne(jobs[i]);
+            auto n = ++nFinished;
+            if (progress)
+                progress->onProgress(n, jobs.size());
+        }
+    };
+
+    if (nJobs == 0)
+        nJobs = std::max(std::thread::hardware_concurrency(), 1u);
+    if (nJobs > jobs.size())
+        nJobs = static_cast<unsigned>(jobs.size());
+    if (haveCollisions(jobs))
+        nJobs = 1;
+    if (nJobs <= 1) {
+        work();
+    } else {
+        SafeVector<std::thread> threads;
+        threads.reserve(nJobs - 1);
+        for (unsigned i = 1; i < nJobs; ++i)
+            threads.emplace_back(work);
+        work();
+        for (auto& v : threads)
+            v.join();
+    }
+    // Some jobs were not even started
+    if (nFinished != jobs.size())
+        throw Cancelled();
+
+    BuildInfo r;
+    std::map<std::filesystem::path, Manifest> newManifests;
+    for (auto& job : jobs) {
+        if (job.error) {
+            r.errors.push_back({
+                    .fileId = job.file->id.str(),
+                    .fname = job.fnExported,
+                    .message = std::move(*job.error) });
+            continue;
+        }
+        if (job.isSkipped) {
+            ++r.nSkipped;
+        } else {
+            ++r.nExported;
+        }
+        if (incremental != Incremental::NO) {
+            newManifests[job.dirExported][job.fnExported.filename().u8string()]
+                    = job.hash;
         }
     }
+
+    for (auto& [dir, manifest] : newManifests) {
+        auto fname = dir / manifestName;
+        try {
+            writeManifest(fname, manifest);
+        } catch (const std::exception& e) {
+            r.errors.push_back({ .fileId = {}, .fname = fname,
+                                 .message = errorMessage(e) });
+        }
+    }
+    return r;
 }
 
 
@@ -1655,13 +3050,15 @@ void tr::Project::updateReference()
 }
 
 
-tr::UpdateInfo tr::Project::updateData(TrashMode mode)
+tr::UpdateInfo tr::Project::updateData(
+        TrashMode mode, const Project* original, ProgressListener* progress,
+        UpdateEngine engine)
 {
     switch (info.type) {
     case tr::PrjType::ORIGINAL:
         return { .isOriginal = true };
     case tr::PrjType::FULL_TRANSL:
-        return updateData_FullTransl(mode);
+        return updateData_FullTransl(mode, original, progress, engine);
     }
     throw std::logic_error("[updateData] Strange project type");
 }
@@ -1681,7 +3078,11 @@ tr::UpdateInfo tr::Project::stealDataFrom(tr::Project& x, const StealContext& ct
     for (auto& v : files)
         v->state = ObjState::ADDED;
     // Try to steal
-    for (auto& v : files) {
+    for (size_t i = 0; i < files.size(); ++i) {
+        // Cannot stop halfway, just report
+        if (ctx.progress)
+            ctx.progress->onProgress(i, files.size());
+        auto& v = files[i];
         if (auto xFile = x.findFile(v->id)) {
             v->state = ObjState::STAYING;   // stays!
             r += v->stealDataFrom(*xFile, this, ctx);
@@ -1699,6 +3100,43 @@ tr::UpdateInfo tr::Project::stealDataFrom(tr::Project& x, const StealContext& ct
 }
 
 
+tr::UpdateInfo tr::Project::mergeFrom(
+        const tr::Project& x, const MergeContext& ctx, ProgressListener* progress)
+{
+    tr::UpdateInfo r;
+    auto pairs = pairChildren(files, x.files);
+    auto old = std::move(files);
+    files.clear();
+    files.reserve(x.files.size());
+
+    for (size_t i = 0; i < x.files.size(); ++i) {
+        // Cannot stop halfway, just report
+        if (progress)
+            progress->onProgress(i, x.files.size());
+        auto& w = x.files[i];
+        if (!w)
+            continue;
+        if (auto iOld = pairs[i]; iOld != NO_PAIR) {
+            auto& v = files.emplace_back(std::move(old[iOld]));
+            r += v->mergeFrom(*w, ctx);
+        } else {
+            auto v = ctx.isSrcTemp ? files.emplace_back(w) : addFileCopy(*w);
+            v->removeTranslChannel();
+            v->state = ObjState::ADDED;
+            r += v->addedInfo(CascadeDropCache::NO);
+        }
+    }
+
+    // Stats
+    for (auto& v : old) {
+        if (v)
+            r.deleted += v->deletedInfo(CascadeDropCache::NO);
+    }
+    recache();
+    return r;
+}
+
+
 void tr::Project::stealReferenceFrom(tr::Project& x)
 {
     // Try to steal
@@ -1710,28 +3148,87 @@ void tr::Project::stealReferenceFrom(tr::Project& x)
 }
 
 
-tr::UpdateInfo tr::Project::updateData_FullTransl(TrashMode mode)
+tr::UpdateInfo tr::Project::updateData_FullTransl(
+        TrashMode mode, const Project* original, ProgressListener* progress,
+        UpdateEngine engine)
 {
-    auto tempPrj = tr::Project::make();
-    tempPrj->load(this->info.orig.absPath);
-    // Info and fname are left intact
-    std::swap(this->files, tempPrj->files);
+    // Merge reads ready original directly, w/o copying
+    std::shared_ptr<Project> tempPrj;
+    if (!original || engine == UpdateEngine::STEAL) {
+        tempPrj = tr::Project::make();
+        if (original) {
+            tempPrj->copyFrom(*original);
+        } else {
+            tempPrj->load(this->info.orig.absPath, progress);
+        }
+    }
+    auto& src = tempPrj ? *tempPrj : *original;
+    // Point of no return: from here on we change the project
+    checkCancelled(progress);
+    // Journal cannot express that
+    fJournal.breakOff();
+    fSearchIndex.clear();
     // Copy original language
-    if (!tempPrj->info.orig.lang.empty())
-        this->info.orig.lang = tempPrj->info.orig.lang;
-    this->removeTranslChannel();    // Do not forget, we swapped!
-    StealContext ctx {
-        .orig = tf::StealOrig::KEEP_WARN,
-        .trash = (mode == TrashMode::FILL) ? &this->trash : nullptr,
-    };
-    auto r = this->stealDataFrom(*tempPrj, ctx);
+    if (!src.info.orig.lang.empty())
+        this->info.orig.lang = src.info.orig.lang;
+    auto trashToFill = (mode == TrashMode::FILL) ? &this->trash : nullptr;
+    if (trashToFill)
+        trashToFill->newGeneration();
+
+    UpdateInfo r;
+    switch (engine) {
+    case UpdateEngine::MERGE: {
+            MergeContext ctx {
+                .orig = tf::StealOrig::KEEP_WARN,
+                .trash = trashToFill,
+                .isSrcTemp = static_cast<bool>(tempPrj),
+            };
+            r = this->mergeFrom(src, ctx, progress);
+        } break;
+    case UpdateEngine::STEAL: {
+            // Info and fname are left intact
+            std::swap(this->files, tempPrj->files);
+            this->removeTranslChannel();    // Do not forget, we swapped!
+            StealContext ctx {
+                .orig = tf::StealOrig::KEEP_WARN,
+                .trash = trashToFill,
+                .progress = progress,
+            };
+            r = this->stealDataFrom(*tempPrj, ctx);
+        } break;
+    }
+
+    if (trashToFill)
+        trashToFill->applyLimits();
     // Stats will always be funked up!
     updateParents();
-    stats(StatsMode::ALL_CHILDREN, CascadeDropCache::NO);
+    parallelStats(CascadeDropCache::NO);
     return r;
 }
 
 
+void tr::Project::copyFrom(const Project& x)
+{
+    info = x.info;
+    files.clear();
+    fSearchIndex.clear();
+    for (auto& v : x.files)
+        addFileCopy(*v);
+}
+
+
+std::shared_ptr<tr::File> tr::Project::addFileCopy(const File& x)
+{
+    auto file = addFile(x.id, Modify::NO);
+    file->info.format = x.info.format.clone();
+    file->info.origPath = x.info.origPath;
+    file->info.translPath = x.info.translPath;
+    file->info.isIdless = x.info.isIdless;
+    file->vgCopyFrom(x);
+    return file;
+}
+
+
 void tr::Project::updateParents()
 {
     auto that = fSelf.lock();
@@ -1750,6 +3247,90 @@ std::vector<std::shared_ptr<tr::Group>> tr::Project::syncGroups()
 }
 
 
+namespace {
+
+    struct SyncJob {
+        std::shared_ptr<tr::Group> group;
+        tr::SyncImport imported;
+        std::optional<std::string> error;
+    };
+
+}   // anon namespace
+
+
+tr::SyncUpdateInfo tr::Project::updateSyncGroups(
+        unsigned nJobs, ProgressListener* progress)
+{
+    SafeVector<SyncJob> jobs;
+    for (auto& v : syncGroups())
+        jobs.push_back({ .group = std::move(v), .imported {}, .error {} });
+
+    // Import: in parallel, each thread takes the next group.
+    // Groups are independent, as synchronized ones do not nest,
+    //   and the tree is just read.
+    auto importOne = [](SyncJob& job) {
+        try {
+            job.imported = job.group->importSync();
+        } catch (const std::exception& e) {
+            job.error = errorMessage(e);
+        } catch (...) {
+            job.error = "Unknown error";
+        }
+    };
+    std::atomic<size_t> iNext = 0, nFinished = 0;
+    auto work = [&jobs, &iNext, &nFinished, &importOne, progress]() {
+        size_t i;
+        while ((!progress || !progress->isCancelled())
+               && (i = iNext++) < jobs.size()) {
+            importOne(jobs[i]);
+            auto n = ++nFinished;
+            if (progress)
+                progress->onProgress(n, jobs.size());
+        }
+    };
+
+    if (nJobs == 0)
+        nJobs = std::max(std::thread::hardware_concurrency(), 1u);
+    if (nJobs > jobs.size())
+        nJobs = static_cast<unsigned>(jobs.size());
+    if (nJobs <= 1) {
+        work();
+    } else {
+        SafeVector<std::thread> threads;
+        threads.reserve(nJobs - 1);
+        for (unsigned i = 1; i < nJobs; ++i)
+            threads.emplace_back(work);
+        work();
+        for (auto& v : threads)
+            v.join();
+    }
+    // Some groups were not even imported; the tree is intact
+    if (nFinished != jobs.size())
+        throw Cancelled();
+
+    // Apply: in order, on this thread
+    SyncUpdateInfo r;
+    for (auto& job : jobs) {
+        if (!job.error) {
+            if (!job.imported.tempGroup) {
+                ++r.nSkipped;
+                continue;
+            }
+            try {
+                r.data += job.group->applySync(std::move(job.imported));
+                ++r.nUpdated;
+                continue;
+            } catch (const std::exception& e) {
+                job.error = errorMessage(e);
+            }
+        }
+        r.errors.push_back({ .group = std::move(job.group),
+                             .message = std::move(*job.error) });
+    }
+    return r;
+}
+
+
 void tr::Project::markChildrenAsAddedToday()
 {
     for (auto& v : files) {
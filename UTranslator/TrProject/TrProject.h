@@ -4,10 +4,13 @@
 #include <memory>
 #include <optional>
 #include <filesystem>
+#include <unordered_map>
 
 // Translator
 #include "TrDefines.h"
 #include "TrVirtuals.h"
+#include "TrProgress.h"
+#include "TrSnapshot.h"
 #include "Modifiable.h"
 
 // Libs
@@ -129,9 +132,92 @@ namespace tr {
 
     enum class TrashMode : unsigned char { LEAVE, FILL };
 
+    /// What Project::load does besides loading
+    enum class LoadMode : unsigned char {
+        READ,   ///< just read: original, reference, memory, console builder;
+                ///<   fresh snapshot is used, nothing is written
+        CACHE,  ///< just read, but stale snapshot is rewritten (console, opt-in)
+        EDIT    ///< user opened it to edit: stale snapshot is rewritten,
+                ///<   journal is replayed
+    };
+
+    /// How translation is updated from original
+    enum class UpdateEngine : unsigned char {
+        MERGE,  ///< existing objects are updated in place, see Project::mergeFrom
+        STEAL   ///< new tree is built, and translations are stolen into it;
+                ///<   slower, kept as a reference for MERGE
+    };
+
+    /// [+] Skip files whose inputs did not change since the last build
+    enum class Incremental : unsigned char { NO, YES };
+
+    struct BuildInfo {
+        struct Error {
+            std::u8string fileId;
+            std::filesystem::path fname;
+            std::string message;
+        };
+        size_t nExported = 0;
+        size_t nSkipped = 0;    ///< unchanged, incremental build only
+        SafeVector<Error> errors;
+
+        bool isOk() const noexcept { return errors.empty(); }
+    };
+
+    ///
+    ///  What synchronized group was updated from last time: source file,
+    ///    and the group right after update (structure, originals,
+    ///    importer’s/author’s comments, sync settings).
+    ///  Both are the same → update would change nothing, and is skipped.
+    ///  Translations are not hashed: update keeps them anyway.
+    ///
+    struct SyncFingerprint {
+        snapshot::Passport source;
+        uint64_t tree = 0;     ///< [0] never updated
+
+        bool operator == (const SyncFingerprint&) const = default;
+        explicit operator bool() const noexcept { return (tree != 0); }
+        /// @return  4 hex numbers: size-time-hash-tree; [empty] never updated
+        std::string toString() const;
+        /// @return  [empty] bad string, group will be just updated
+        static SyncFingerprint parse(std::string_view x) noexcept;
+    };
+
+    ///
+    ///  Synchronized group’s source, imported but not applied yet,
+    ///    see Group::importSync
+    ///
+    struct SyncImport {
+        std::shared_ptr<Project> tempPrj;   ///< owns tempGroup
+        std::shared_ptr<Group> tempGroup;   ///< [0] nothing to apply
+        SyncFingerprint fingerprint;        ///< tree is the one before update
+    };
+
+    struct SyncUpdateInfo {
+        struct Error {
+            std::shared_ptr<Group> group;
+            std::string message;
+        };
+        UpdateInfo data;
+        size_t nUpdated = 0;
+        size_t nSkipped = 0;    ///< source and group are unchanged
+        SafeVector<Error> errors;
+
+        bool isOk() const noexcept { return errors.empty(); }
+    };
+
     struct StealContext {
         tf::StealOrig orig;
         Trash* trash;
+        ProgressListener* progress = nullptr;  ///< files stolen, cannot cancel
+    };
+
+    struct MergeContext {
+        tf::StealOrig orig;
+        Trash* trash;
+        /// [+] source is temporary: its objects are taken, not copied,
+        ///     and it is garbage afterwards
+        bool isSrcTemp = false;
     };
 
     struct ReadContext {
@@ -145,12 +231,19 @@ namespace tr {
             { return toAbsPath(str::toU8sv(x)); }
     };
 
+    /// Writes <format> child, if format is present
+    void writeFormat(pugi::xml_node parent, tf::FileFormat* format);
+    /// @return  format from <format> child, [0] no/unknown format
+    std::unique_ptr<tf::FileFormat> readFormat(pugi::xml_node parent);
+
     class Entity : public Traversable
     {
     public:
-        std::u8string id;               ///< Identifier of group or string
+        str::ArenaString id;            ///< Identifier of group or string
         Comments comm;
         ObjState state = ObjState::STAYING;
+        /// Keeps alive strings borrowed from project’s arena on load
+        std::shared_ptr<const str::StringArena> arena;
 
         std::u8string_view idColumn() const override { return id; }
         Comments* comments() override { return &comm; }
@@ -179,6 +272,8 @@ namespace tr {
         void readComments(const pugi::xml_node& node, const PrjInfo& info);
         void entityRemoveTranslChannel();
         void entityStealDataFrom(Entity& x, UiObject* myParent, const StealContext& ctx);
+        /// Same as entityStealDataFrom, but *this stays in place
+        void entityMergeFrom(const Entity& x, const MergeContext& ctx);
     };
 
     struct FindPText {
@@ -187,6 +282,12 @@ namespace tr {
         explicit operator bool () const { return place; }
     };
 
+    /// Transparent hash: u8string-keyed maps are searched by u8string_view
+    struct IdHash : public std::hash<std::u8string_view> {
+        using is_transparent = void;
+        using std::hash<std::u8string_view>::operator();
+    };
+
     class VirtualGroup : public Entity, protected Self<VirtualGroup>
     {
     private:
@@ -196,6 +297,8 @@ namespace tr {
 
         size_t nChildren() const noexcept override { return children.size(); };
         std::shared_ptr<UiObject> child(size_t i) const override;
+        UiObject* childRaw(size_t i) const noexcept override
+            { return (i < children.size()) ? children[i].get() : nullptr; }
         std::shared_ptr<UiObject> extractChild(size_t i, Modify wantModify) override;
         void traverse(
                 TraverseListener& x, tr::WalkOrder order, EnterMe enterMe) override;
@@ -203,10 +306,10 @@ namespace tr {
         using Super::Super;
 
         std::shared_ptr<Text> addText(
-                std::u8string id, std::u8string original,
+                std::u8string_view id, std::u8string_view original,
                 Modify wantModify);
         std::shared_ptr<Group> addGroup(
-                std::u8string id, Modify wantModify);
+                std::u8string_view id, Modify wantModify);
         std::shared_ptr<Project> project() override;
         std::shared_ptr<VirtualGroup> nearestGroup() override { return fSelf.lock(); }
         void loadText(
@@ -216,8 +319,12 @@ namespace tr {
         std::shared_ptr<Group> findGroup(std::u8string_view id);
         std::shared_ptr<Text> findText(std::u8string_view id);
         FindPText findPText(std::u8string_view id);
-        void clearChildren() override { children.clear(); cascadeDropStats(); }
+        void clearChildren() override
+            { children.clear(); fIndex.clear(); cascadeDropStats(); }
         std::shared_ptr<UiObject> selfUi() override { return fSelf.lock(); }
+        /// Drops ID index, call when children were changed bypassing
+        ///   VirtualGroup’s own functions (e.g. swapped with other group’s)
+        void dropChildIndex() { fIndex.clear(); }
         void collectSyncGroups(std::vector<std::shared_ptr<tr::Group>>& r);
         void markChildrenAsAddedToday() override;
         void traverseTexts(const EvText&) override;
@@ -232,7 +339,37 @@ namespace tr {
         tr::UpdateInfo vgStealDataFrom(
                 VirtualGroup& x, UiObject* myParent, const StealContext& ctx);
         void vgStealReferenceFrom(VirtualGroup& x);
+        /// Updates children in place from x’s, the order becomes x’s:
+        ///   matching children are updated, the rest are added/removed
+        /// @return  added, deleted and CHANGED data
+        tr::UpdateInfo vgMergeFrom(const VirtualGroup& x, const MergeContext& ctx);
+        /// Deep copy of comments and children, IDs are kept
+        void vgCopyFrom(const VirtualGroup& x);
+        /// Adds a deep copy of x in the end, ID is kept
+        /// @return  the copy, [0] x cannot be a child
+        std::shared_ptr<Entity> vgCopyChild(const Entity& x);
         void vgUpdateChildrensParents(const std::shared_ptr<VirtualGroup>& that);
+    private:
+        friend class Entity;
+        ///  ID → index in children, separately for texts and groups.
+        ///  Built lazily on first find, then kept in sync by add/extract/swap/setId.
+        ///  Index is validated on find, so stale entries only cost a rebuild.
+        ///  If several children have the same ID, the first one is indexed.
+        struct ChildIndex {
+            using Map = std::unordered_map<std::u8string, size_t, IdHash, std::equal_to<>>;
+            Map texts, groups;
+            bool isBuilt = false;
+
+            void clear() { texts.clear(); groups.clear(); isBuilt = false; }
+        } fIndex;
+
+        ChildIndex::Map* indexMap(const Entity& x);
+        void ensureChildIndex();
+        /// @return  index of child, or children.size() if not found
+        size_t findIndexed(ChildIndex::Map& map, ObjType type, std::u8string_view id);
+        void indexChild(size_t i);
+        void unindexChild(size_t i);
+        void reindexChild(const Entity& x, std::u8string_view oldId);
     };
 
     class Text final : public Entity, protected Self<Text>
@@ -245,6 +382,7 @@ namespace tr {
         ObjType objType() const noexcept override { return ObjType::TEXT; }
         size_t nChildren() const noexcept override { return 0; };
         std::shared_ptr<UiObject> child(size_t) const override { return {}; }
+        UiObject* childRaw(size_t) const noexcept override { return nullptr; }
         std::shared_ptr<UiObject> parent() const override { return fParentGroup.lock(); }
         Pair<VirtualGroup> additionParents() override { return fParentGroup.lock(); }
         Translatable* translatable() override { return &tr; }
@@ -266,6 +404,8 @@ namespace tr {
         AttentionMode attentionMode() const;
         void clearChildren() override {}
         const Stats& stats(StatsMode mode, CascadeDropCache cascade) override;
+        const Stats& recountStats(
+                const PrjInfo* prjInfo, CascadeDropCache cascade) override;
         std::shared_ptr<UiObject> selfUi() override { return fSelf.lock(); }
         void removeTranslChannel() override;
         void markChildrenAsAddedToday() override { tr.wasChangedToday = true; }
@@ -274,6 +414,9 @@ namespace tr {
         ///  @return  CHANGED data
         UpdateInfo::ByState stealDataFrom(
                 Text& x, UiObject* myParent, const StealContext& ctx);
+        ///  Same as stealDataFrom, but *this stays, and x’s original comes
+        ///  @return  CHANGED data
+        UpdateInfo::ByState mergeFrom(const Text& x, const MergeContext& ctx);
         void stealReferenceFrom(Text& x);
     protected:
         std::shared_ptr<Entity> vclone(
@@ -295,6 +438,7 @@ namespace tr {
             std::unique_ptr<tf::FileFormat> format;
             std::filesystem::path absPath;
             tf::SyncInfo info;
+            SyncFingerprint fingerprint;
             explicit operator bool() const { return static_cast<bool>(format); }
         } sync;
 
@@ -320,16 +464,27 @@ namespace tr {
         void removeTranslChannel() override { vgRemoveTranslChannel(); }
         UpdateInfo stealDataFrom(Group& x, UiObject* myParent, const StealContext& ctx)
             { return vgStealDataFrom(x, myParent, ctx); }
+        UpdateInfo mergeFrom(const Group& x, const MergeContext& ctx);
         void stealReferenceFrom(Group& x) { return vgStealReferenceFrom(x); }
+        /// Same as applySync(importSync())
         UpdateInfo updateData();
+        /// Reads synchronized group’s source into temporary project.
+        /// Thread-safe if nobody writes to the tree meanwhile:
+        ///   the group is just read.
+        /// @return  [!tempGroup] not synchronized, not an original,
+        ///          or source and group are unchanged since last update
+        /// @throw  format’s errors
+        SyncImport importSync() const;
+        /// Puts what importSync read into the tree; main thread only
+        UpdateInfo applySync(SyncImport&& x);
+        /// @return  fingerprint of group’s present state, see SyncFingerprint
+        uint64_t syncTreeHash() const;
     protected:
         void updateParent(const std::shared_ptr<VirtualGroup>& x) override;
     private:
         friend class tr::File;
         std::weak_ptr<File> fFile;
         std::weak_ptr<VirtualGroup> fParentGroup;
-
-        UpdateInfo updateData_Original();
     };
 
     enum class FileMode : unsigned char { HOSTED, EXTERNAL };
@@ -366,6 +521,7 @@ namespace tr {
         constexpr FileMode mode() const noexcept { return FileMode::HOSTED; }
         tf::FileFormat* exportableFormat() noexcept;        
         UpdateInfo stealDataFrom(File& x, UiObject* myParent, const StealContext& ctx);
+        UpdateInfo mergeFrom(const File& x, const MergeContext& ctx);
         void stealReferenceFrom(File& x);
         void updateParents(const std::shared_ptr<Project>& x);
     protected:
@@ -385,6 +541,8 @@ namespace tr {
         std::filesystem::path fname;
         SafeVector<std::shared_ptr<File>> files;
         Trash trash;
+        /// Storage for strings of loaded project, shared with entities
+        std::shared_ptr<str::StringArena> arena;
 
         /// @brief addTestOriginal
         ///   Adds a few files and strings that will serve as test original
@@ -403,15 +561,23 @@ namespace tr {
         std::shared_ptr<File> file() override { return {}; }
         size_t nChildren() const noexcept override { return files.size(); };
         std::shared_ptr<UiObject> child(size_t i) const override;
+        UiObject* childRaw(size_t i) const noexcept override
+            { return (i < files.size()) ? files[i].get() : nullptr; }
         std::shared_ptr<UiObject> parent() const override { return {}; }
         std::u8string_view idColumn() const override { return {}; }
         std::shared_ptr<Project> project() override { return fSelf.lock(); }
         Pair<VirtualGroup> additionParents() override { return {}; }
         std::shared_ptr<UiObject> extractChild(size_t i, Modify wantModify) override;
+        /// @param [in] progress  files written; may be null
+        /// @throw Cancelled
         void writeToXml(
                 pugi::xml_node&,
-                const std::filesystem::path& basePath) const;
+                const std::filesystem::path& basePath,
+                ProgressListener* progress = nullptr) const;
         bool unmodify(Forced forced) override;
+        /// Modification that journal cannot express
+        bool modify(Forced forced = Forced::NO) override;
+        void journalModify(UiObject& obj, const JournalEdit& edit) override;
         void traverse(TraverseListener& x, tr::WalkOrder order, EnterMe enterMe) override;
         std::shared_ptr<VirtualGroup> nearestGroup() override { return {}; }
         void removeTranslChannel() override;
@@ -419,19 +585,48 @@ namespace tr {
         void traverseTexts(const EvText&) override;
         void traverseCTexts(const EvCText&) const override;
         const PrjInfo& prjInfo() const override { return info; }
+        SearchIndex* searchIndex() override { return &fSearchIndex; }
+        Batch* activeBatch() const override { return fBatch; }
         void updateParents();
 
-        void save();
-        void save(const std::filesystem::path& aFname);
-        void saveCopy(const std::filesystem::path& aFname) const;
+        /// @param [in] progress  files written; cancellation is checked
+        ///                       until writing to disk; may be null
+        /// @throw Cancelled  nothing is written, project is still modified
+        void save(ProgressListener* progress = nullptr);
+        void save(const std::filesystem::path& aFname,
+                  ProgressListener* progress = nullptr);
+        void saveCopy(const std::filesystem::path& aFname,
+                      ProgressListener* progress = nullptr) const;
+        /// User closes project w/o saving: edits leave journal
+        void discardUnsaved() { fJournal.discardUnsaved(); }
+        const Journal& journal() const { return fJournal; }
         void readFromXml(
                 const pugi::xml_node& node,
                 const std::filesystem::path& basePath);
         void load(
                 const pugi::xml_document& doc,
                 const std::filesystem::path& basePath);
-        void load(const std::filesystem::path& aFname);
-        void doBuild(const std::filesystem::path& destDir);
+        /// Uses binary snapshot if it is fresh
+        /// @param [in] progress  bytes read; may be null
+        /// @param [in] mode  [CACHE, EDIT] writes snapshot if it is stale
+        ///                   [EDIT] also replays journal, if it has edits,
+        ///                   project is modified
+        /// @throw Cancelled  project is half-loaded then
+        void load(const std::filesystem::path& aFname,
+                  ProgressListener* progress = nullptr,
+                  LoadMode mode = LoadMode::READ);
+        /// Exports all exportable files
+        /// @param [in] destDir  [empty] default place
+        /// @param [in] nJobs    # of threads; [0] as many as CPU has
+        /// @param [in] incremental  [+] use build manifest stored next to
+        ///                  exported files, and skip unchanged ones
+        /// @param [in] progress  files done; may be null
+        /// @return  # of files exported/skipped, and errors of the rest
+        /// @throw Cancelled  files already exported stay, build manifest
+        ///                   is not written
+        BuildInfo doBuild(const std::filesystem::path& destDir, unsigned nJobs = 1,
+                          Incremental incremental = Incremental::NO,
+                          ProgressListener* progress = nullptr);
         WalkChannel walkChannel() const;
 
         // Adds a file in the end of project
@@ -443,9 +638,30 @@ namespace tr {
 
         std::u8string shownFname(std::u8string_view fallback);
 
-        UpdateInfo updateData(TrashMode mode);
+        /// @param [in] original  [+] already loaded original, is copied
+        ///                      [0] load from info.orig.absPath
+        /// @param [in] progress  bytes of original loaded, then files
+        ///                      updated; may be null
+        /// @throw Cancelled  only while original is loaded,
+        ///                   the project is intact then
+        UpdateInfo updateData(TrashMode mode, const Project* original = nullptr,
+                              ProgressListener* progress = nullptr,
+                              UpdateEngine engine = UpdateEngine::MERGE);
         void updateReference();
+        /// Deep copy of info and files, w/o trash;
+        ///   e.g. to share one original among translations
+        void copyFrom(const Project& x);
         tr::UpdateInfo stealDataFrom(tr::Project& x, const StealContext& ctx);
+        /// Updates files in place from original x in one pass:
+        ///   objects of the same type and ID are paired (k’th same ID in x
+        ///   goes with k’th one here), and their translations stay where
+        ///   they are; the order becomes x’s.
+        /// Gives the same as stealDataFrom from a tree whose translation
+        ///   channel is removed, except duplicate IDs of groups/files:
+        ///   they are paired the same way as texts.
+        /// @param [in] progress  files merged; may be null
+        tr::UpdateInfo mergeFrom(const tr::Project& x, const MergeContext& ctx,
+                                 ProgressListener* progress = nullptr);
         void stealReferenceFrom(tr::Project& x);
         std::shared_ptr<tr::File> findFile(std::u8string_view aId);
 
@@ -461,15 +677,40 @@ namespace tr {
                 : Project(std::forward<T>(x)...) {}
 
         std::vector<std::shared_ptr<Group>> syncGroups();
+        /// Updates all synchronized groups: unchanged ones are skipped,
+        ///   sources are imported in parallel, then applied one by one
+        /// @param [in] nJobs     # of threads; [0] as many as CPU has
+        /// @param [in] progress  groups imported; may be null
+        /// @return  what changed, and errors of failed groups
+        ///          (the rest are updated anyway)
+        /// @throw Cancelled  only while importing, the tree is intact then
+        SyncUpdateInfo updateSyncGroups(
+                unsigned nJobs = 0, ProgressListener* progress = nullptr);
     protected:        
         void doSwapChildren(size_t index1, size_t index2) override;
+        void setActiveBatch(Batch* x) override { fBatch = x; }
     private:
         /// Ctors are private, use make!
         Project() = default;
         Project(const Project&) = delete;
         Project(Project&&) = default;
         Project(PrjInfo&& aInfo) noexcept : info(std::move(aInfo)) {}
-        UpdateInfo updateData_FullTransl(TrashMode mode);
+        UpdateInfo updateData_FullTransl(
+                TrashMode mode, const Project* original, ProgressListener* progress,
+                UpdateEngine engine);
+        /// Adds a deep copy of x in the end, the same way as copyFrom
+        std::shared_ptr<File> addFileCopy(const File& x);
+        /// Streaming load, w/o DOM
+        /// @param [in] data  file’s contents
+        /// @throw sax::Error  when the reader cannot handle the file
+        void loadSax(std::string_view data, const std::filesystem::path& basePath,
+                     ProgressListener* progress);
+        /// DOM load, fallback for loadSax
+        void loadDom(const std::filesystem::path& aFname);
+
+        SearchIndex fSearchIndex;
+        Journal fJournal;
+        Batch* fBatch = nullptr;
     };
 
     ///  To prevent TrFinder from including everywhere
@@ -479,6 +720,8 @@ namespace tr {
         virtual bool matchText(const tr::Text&) const = 0;
         virtual bool matchGroup(const tr::VirtualGroup&) const { return false; }
         virtual std::u8string caption() const = 0;
+        /// @return  [+] text search that search index can narrow
+        virtual std::optional<SearchQuery> searchQuery() const { return std::nullopt; }
         virtual ~FindCriterion() = default;
     };
 
@@ -0,0 +1,258 @@
+// My header
+#include "TrSearchIndex.h"
+
+// C++
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+// Libs
+#include "mojibake.h"
+
+// Translation
+#include "TrVirtuals.h"
+
+
+namespace {
+
+    /// Entry = slot << CHANNEL_SHIFT | channel #
+    constexpr unsigned CHANNEL_SHIFT = 3;
+    constexpr uint32_t CHANNEL_MASK = (1u << CHANNEL_SHIFT) - 1;
+    constexpr uint32_t MAX_SLOT = UINT32_MAX >> CHANNEL_SHIFT;
+
+    inline uint32_t channelNo(tr::SearchChannel x)
+        { return std::countr_zero(static_cast<unsigned>(x)); }
+
+    /// Calls body(channel, text) for all channels object has
+    template <class Body>
+    void forEachChannel(tr::UiObject& x, const Body& body)
+    {
+        body(tr::SearchChannel::ID, x.idColumn());
+        if (auto t = x.translatable()) {
+            body(tr::SearchChannel::ORIGINAL, t->original.sv());
+            body(tr::SearchChannel::TRANSLATION, t->translationSv());
+        }
+        if (auto c = x.comments()) {
+            body(tr::SearchChannel::IMPORTERS_COMMENT, c->importers.sv());
+            body(tr::SearchChannel::AUTHORS_COMMENT, c->authors.sv());
+            body(tr::SearchChannel::TRANSLATORS_COMMENT, c->translators.sv());
+        }
+    }
+
+    template <class Vec, class T>
+    bool insertSorted(Vec& x, T value)
+    {
+        // Building index → always here
+        if (x.empty() || x.back() < value) {
+            x.push_back(value);
+            return true;
+        }
+        auto it = std::lower_bound(x.begin(), x.end(), value);
+        if (it != x.end() && *it == value)
+            return false;
+        x.insert(it, value);
+        return true;
+    }
+
+    template <class Vec, class T>
+    bool eraseSorted(Vec& x, T value)
+    {
+        auto it = std::lower_bound(x.begin(), x.end(), value);
+        if (it == x.end() || *it != value)
+            return false;
+        x.erase(it);
+        return true;
+    }
+
+}   // anon namespace
+
+
+///// SearchCandidates /////////////////////////////////////////////////////////
+
+
+bool tr::SearchCandidates::has(const UiObject& x) const
+{
+    if (!index->isIndexed(x))
+        return true;
+    auto slot = x.cache.searchSlot.v;
+    return (slot >= slots.size() || slots[slot]);
+}
+
+
+///// SearchIndex //////////////////////////////////////////////////////////////
+
+
+void tr::SearchIndex::clear()
+{
+    postings.clear();
+    badChannels.clear();
+    owners.clear();
+    fNEntries = 0;
+    fIsBuilt = false;
+}
+
+
+bool tr::SearchIndex::isIndexed(const UiObject& x) const
+{
+    auto slot = x.cache.searchSlot.v;
+    return (slot < owners.size() && owners[slot] == &x);
+}
+
+
+bool tr::SearchIndex::collectKeys(std::u8string_view text)
+{
+    bool isValid = mojibake::isValid(text);
+    // Bad characters are skipped here
+    mojibake::simpleCaseFold(text, folded);
+    keys.clear();
+    for (size_t i = 2; i < folded.size(); ++i) {
+        keys.push_back((Key(folded[i - 2]) << 42)
+                     | (Key(folded[i - 1]) << 21)
+                     |  Key(folded[i]));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return isValid;
+}
+
+
+void tr::SearchIndex::addChannel(Entry entry, std::u8string_view text)
+{
+    if (text.empty())
+        return;
+    bool isValid = collectKeys(text);
+    for (auto key : keys) {
+        if (insertSorted(postings[key], entry))
+            ++fNEntries;
+    }
+    if (!isValid)
+        insertSorted(badChannels, entry);
+}
+
+
+void tr::SearchIndex::removeChannel(Entry entry, std::u8string_view text)
+{
+    if (text.empty())
+        return;
+    bool isValid = collectKeys(text);
+    for (auto key : keys) {
+        auto it = postings.find(key);
+        if (it != postings.end() && eraseSorted(it->second, entry)) {
+            --fNEntries;
+            if (it->second.empty())
+                postings.erase(it);
+        }
+    }
+    if (!isValid)
+        eraseSorted(badChannels, entry);
+}
+
+
+void tr::SearchIndex::addObject(UiObject& x)
+{
+    if (owners.size() > MAX_SLOT)
+        throw std::length_error("[SearchIndex] Too many objects");
+    auto slot = static_cast<uint32_t>(owners.size());
+    x.cache.searchSlot.v = slot;
+    owners.push_back(&x);
+    forEachChannel(x, [this, slot](SearchChannel channel, std::u8string_view text) {
+        addChannel((slot << CHANNEL_SHIFT) | channelNo(channel), text);
+    });
+    for (size_t i = 0; i < x.nChildren(); ++i) {
+        if (auto ch = x.childRaw(i))
+            addObject(*ch);
+    }
+}
+
+
+void tr::SearchIndex::build(UiObject& root)
+{
+    clear();
+    addObject(root);
+    // Postings are built by push_back, do not keep their reserve
+    for (auto& v : postings)
+        v.second.shrink_to_fit();
+    fIsBuilt = true;
+}
+
+
+void tr::SearchIndex::update(
+        UiObject& x, SearchChannel channel,
+        std::u8string_view was, std::u8string_view now)
+{
+    if (!isIndexed(x))
+        return;
+    Entry entry = (x.cache.searchSlot.v << CHANNEL_SHIFT) | channelNo(channel);
+    removeChannel(entry, was);
+    addChannel(entry, now);
+}
+
+
+std::optional<tr::SearchCandidates> tr::SearchIndex::find(
+        UiObject& root, const SearchQuery& query)
+{
+    if (!fIsBuilt)
+        build(root);
+
+    collectKeys(query.text);
+    if (keys.empty())
+        return std::nullopt;
+
+    // Find postings, rarest trigrams first
+    SafeVector<const Posting*> lists;
+    for (auto key : keys) {
+        auto it = postings.find(key);
+        if (it == postings.end()) {
+            // Some trigram is nowhere
+            lists.clear();
+            break;
+        }
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const Posting* x, const Posting* y) { return x->size() < y->size(); });
+
+    // Intersect: the same channel of the same object should have all
+    auto channels = query.channels.numeric();
+    auto isChannelWanted = [channels](Entry x) {
+        return (channels >> (x & CHANNEL_MASK)) & 1;
+    };
+    SafeVector<Entry> entries;
+    if (!lists.empty()) {
+        for (auto v : *lists[0]) {
+            if (isChannelWanted(v))
+                entries.push_back(v);
+        }
+        for (size_t i = 1; i < lists.size() && !entries.empty(); ++i) {
+            auto& list = *lists[i];
+            auto it = list.begin();
+            size_t n = 0;
+            for (auto v : entries) {
+                it = std::lower_bound(it, list.end(), v);
+                if (it == list.end())
+                    break;
+                if (*it == v)
+                    entries[n++] = v;
+            }
+            entries.resize(n);
+        }
+    }
+
+    SearchCandidates r;
+    r.index = this;
+    r.slots.assign(owners.size(), false);
+    auto mark = [&r](Entry x) {
+        auto&& bit = r.slots[x >> CHANNEL_SHIFT];
+        if (!bit) {
+            bit = true;
+            ++r.fSize;
+        }
+    };
+    for (auto v : entries)
+        mark(v);
+    for (auto v : badChannels) {
+        if (isChannelWanted(v))
+            mark(v);
+    }
+    return r;
+}
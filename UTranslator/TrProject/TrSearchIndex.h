@@ -0,0 +1,136 @@
+#pragma once
+
+// C++
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+
+// Libs
+#include "u_TypedFlags.h"
+#include "u_Vector.h"
+
+namespace tr {
+
+    class UiObject;
+    class SearchIndex;
+
+    /// Text channel that can be found
+    enum class SearchChannel : unsigned char {
+        ID                  = 1,
+        ORIGINAL            = 2,
+        TRANSLATION         = 4,
+        IMPORTERS_COMMENT   = 8,
+        AUTHORS_COMMENT     = 16,
+        TRANSLATORS_COMMENT = 32,
+    };
+    DEFINE_ENUM_OPS(SearchChannel)
+
+    ///
+    ///  Object’s place in search index.
+    ///  Ctors and op= make unindexed object: copy has another address,
+    ///    and assignment may change texts behind index’s back.
+    ///
+    class SearchSlot
+    {
+    public:
+        SearchSlot() noexcept = default;
+        SearchSlot(const SearchSlot&) noexcept {}
+        SearchSlot& operator = (const SearchSlot&) noexcept
+            { reset(); return *this; }
+
+        explicit operator bool() const noexcept { return (v != NONE); }
+        void reset() noexcept { v = NONE; }
+    private:
+        friend class SearchIndex;
+        friend class SearchCandidates;
+        static constexpr uint32_t NONE = UINT32_MAX;
+        uint32_t v = NONE;
+    };
+
+    struct SearchQuery {
+        std::u8string text;
+        Flags<SearchChannel> channels;
+    };
+
+    ///
+    ///  Objects that may match some query, others surely do not.
+    ///  Candidates should still be checked by the query’s owner.
+    ///
+    class SearchCandidates
+    {
+    public:
+        /// @return [+] x may match, check it
+        ///         (objects unknown to index always may)
+        bool has(const UiObject& x) const;
+        /// @return # of indexed candidates
+        size_t size() const noexcept { return fSize; }
+    private:
+        friend class SearchIndex;
+        const SearchIndex* index = nullptr;
+        std::vector<bool> slots;
+        size_t fSize = 0;
+    };
+
+    ///
+    ///  Trigram index over all searchable channels of a project.
+    ///  • Trigrams are made of case-folded code points, so one index
+    ///    serves both case-sensitive and case-insensitive search.
+    ///  • Built lazily by the first search.
+    ///  • UiObject::set* keep it up to date; bulk operations
+    ///    (loading texts, updating data, tools) just clear it.
+    ///  • Objects added since build are unknown to index, and always
+    ///    are candidates.
+    ///
+    class SearchIndex
+    {
+    public:
+        /// Forgets everything, index will be rebuilt on next search
+        void clear();
+        bool isBuilt() const noexcept { return fIsBuilt; }
+
+        /// Builds index if needed, then finds candidates
+        /// @return [+] candidates
+        ///         [0] query is too short to narrow anything, check all
+        std::optional<SearchCandidates> find(
+                UiObject& root, const SearchQuery& query);
+
+        /// Called by mutators right BEFORE changing x’s channel
+        void update(UiObject& x, SearchChannel channel,
+                    std::u8string_view was, std::u8string_view now);
+
+        /// @return [+] x is in index
+        bool isIndexed(const UiObject& x) const;
+        /// @return # of objects in index
+        size_t nObjects() const noexcept { return owners.size(); }
+        /// @return # of (trigram, object, channel) entries
+        size_t nEntries() const noexcept { return fNEntries; }
+    private:
+        /// slot * 8 + channel #
+        using Entry = uint32_t;
+        /// Three code points, 21 bits each
+        using Key = uint64_t;
+        using Posting = SafeVector<Entry>;
+
+        std::unordered_map<Key, Posting> postings;
+        /// Channels with bad UTF-8: their trigrams are not reliable,
+        /// so they always are candidates
+        Posting badChannels;
+        SafeVector<const UiObject*> owners;
+        size_t fNEntries = 0;
+        bool fIsBuilt = false;
+
+        // Buffers reused between calls
+        std::u32string folded;
+        SafeVector<Key> keys;
+
+        void build(UiObject& root);
+        void addObject(UiObject& x);
+        void addChannel(Entry entry, std::u8string_view text);
+        void removeChannel(Entry entry, std::u8string_view text);
+        /// Fills keys: sorted unique trigrams of text
+        /// @return [+] text is valid UTF-8
+        bool collectKeys(std::u8string_view text);
+    };
+
+}   // namespace tr
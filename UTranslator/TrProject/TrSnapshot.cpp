@@ -0,0 +1,520 @@
+// My header
+#include "TrSnapshot.h"
+
+// C++
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// Libs
+#include "u_Hash.h"
+#include "u_MappedFile.h"
+#include "u_Vector.h"
+
+// Pugixml
+#include "pugixml.hpp"
+
+// Project
+#include "TrProject.h"
+
+
+namespace {
+
+    constexpr std::array<char, 8> MAGIC { 'U', 'T', 'r', 'a', 'n', 'S', 'n', 'p' };
+    constexpr uint32_t VERSION = 2;
+    /// Raw numbers are written, so another byte order → another format
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    /// Progress is reported every N nodes
+    constexpr uint32_t PROGRESS_STEP = 4096;
+
+    ///
+    ///  File: Header, Node[nNodes], StrRef[nStrings], blob.
+    ///  Nodes go in tree order: FILE and GROUP are closed by END,
+    ///    INFO is the first one.
+    ///
+    struct Header {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t byteOrderMark;
+        tr::snapshot::Passport passport;
+        uint64_t fileSize;      ///< whole snapshot, to find torn ones
+        uint32_t nNodes;
+        uint32_t nStrings;
+        uint64_t blobSize;
+    };
+    static_assert(sizeof(Header) == 64);
+
+    enum class Kind : unsigned char { INFO, FILE, GROUP, TEXT, END };
+
+    /// Flags, by kind
+    enum : unsigned char {
+        F_PSEUDOLOC = 1,                            // info
+        F_IDLESS = 1,                               // file
+        F_SYNC = 1,                                 // group
+        F_FORCE_ATTENTION = 1, F_KNOWN_ORIG = 2, F_TRANSL = 4,  // text
+    };
+
+    /// Node’s strings, by kind
+    enum : unsigned {
+        S_ORIG_LANG = 0, S_ORIG_FNAME = 1, S_REF_FNAME = 2, S_TRANSL_LANG = 3,  // info
+        S_ID = 0, S_IM_CMT = 4, S_AU_CMT = 5, S_TR_CMT = 6,     // entity
+        S_ORIG_PATH = 1, S_TRANSL_PATH = 2, S_FORMAT = 3,       // file
+        S_SYNC_FNAME = 1, S_SYNC_FORMAT = 2, S_SYNC_FP = 3,     // group
+        S_ORIG = 1, S_KNOWN_ORIG = 2, S_TRANSL = 3,             // text
+        N_STRINGS = 7
+    };
+
+    struct Node {
+        Kind kind;
+        unsigned char flags = 0;
+        unsigned char extra = 0;    ///< PrjType, TextOwner
+        unsigned char reserved = 0;
+        uint32_t s[N_STRINGS] {};   ///< indexes in string table, [0] empty
+    };
+    static_assert(sizeof(Node) == 32);
+
+    /// Piece of blob, null follows it
+    struct StrRef {
+        uint32_t offset, length;
+    };
+
+    /// FNV-style, but 8 bytes at a time: XML is hashed on every load
+    uint64_t hashOf(std::string_view x)
+    {
+        uint64_t h = hash::Fnv64::BASIS;
+        size_t i = 0;
+        for (; i + 8 <= x.size(); i += 8) {
+            uint64_t word;
+            std::memcpy(&word, x.data() + i, 8);
+            h = std::rotl((h ^ word) * hash::Fnv64::PRIME, 31);
+        }
+        hash::Fnv64 tail;
+        tail.addBytes(reinterpret_cast<const unsigned char*>(x.data() + i), x.size() - i);
+        return h ^ tail.value();
+    }
+
+    ///// Writer ///////////////////////////////////////////////////////////////
+
+    class Writer
+    {
+    public:
+        Writer(std::filesystem::path aBaseDir) : baseDir(std::move(aBaseDir)) {}
+        void addProject(const tr::Project& prj);
+        void write(std::ostream& os, const tr::snapshot::Passport& passport) const;
+    private:
+        std::filesystem::path baseDir;
+        SafeVector<Node> nodes;
+        SafeVector<StrRef> strings { StrRef { 0, 0 } };
+        std::u8string blob { u8'\0' };
+
+        uint32_t str(std::u8string_view x);
+        uint32_t relPath(const std::filesystem::path& x);
+        uint32_t format(tf::FileFormat* x);
+        void addEntity(Node& node, const tr::Entity& x);
+        void addChildren(const tr::VirtualGroup& x);
+    };
+
+    uint32_t Writer::str(std::u8string_view x)
+    {
+        if (x.empty())
+            return 0;
+        if (blob.size() + x.size() >= UINT32_MAX || strings.size() >= UINT32_MAX)
+            throw std::length_error("Snapshot is too big");
+        strings.push_back({ static_cast<uint32_t>(blob.size()),
+                            static_cast<uint32_t>(x.size()) });
+        blob += x;
+        blob += u8'\0';
+        return strings.size() - 1;
+    }
+
+    uint32_t Writer::relPath(const std::filesystem::path& x)
+    {
+        if (x.empty())
+            return 0;
+        return str(std::filesystem::proximate(x, baseDir).u8string());
+    }
+
+    uint32_t Writer::format(tf::FileFormat* x)
+    {
+        if (!x)
+            return 0;
+        pugi::xml_document doc;
+        tr::writeFormat(doc, x);
+        std::ostringstream os;
+        doc.save(os, "", pugi::format_raw | pugi::format_no_declaration);
+        return str(str::toU8sv(os.str()));
+    }
+
+    void Writer::addEntity(Node& node, const tr::Entity& x)
+    {
+        node.s[S_ID] = str(x.id);
+        node.s[S_IM_CMT] = str(x.comm.importers);
+        node.s[S_AU_CMT] = str(x.comm.authors);
+        node.s[S_TR_CMT] = str(x.comm.translators);
+    }
+
+    void Writer::addChildren(const tr::VirtualGroup& x)
+    {
+        for (auto& v : x.children) {
+            Node node { .kind = Kind::TEXT };
+            addEntity(node, *v);
+            switch (v->objType()) {
+            case tr::ObjType::TEXT: {
+                    auto& t = static_cast<const tr::Text&>(*v).tr;
+                    node.s[S_ORIG] = str(t.original);
+                    if (t.forceAttention)
+                        node.flags |= F_FORCE_ATTENTION;
+                    if (t.knownOriginal.text) {
+                        node.flags |= F_KNOWN_ORIG;
+                        node.s[S_KNOWN_ORIG] = str(*t.knownOriginal.text);
+                    }
+                    if (t.translation) {
+                        node.flags |= F_TRANSL;
+                        node.s[S_TRANSL] = str(*t.translation);
+                    }
+                    nodes.push_back(node);
+                } break;
+            case tr::ObjType::GROUP: {
+                    auto& g = static_cast<const tr::Group&>(*v);
+                    node.kind = Kind::GROUP;
+                    if (g.sync) {
+                        node.flags |= F_SYNC;
+                        node.extra = static_cast<unsigned char>(g.sync.info.textOwner);
+                        node.s[S_SYNC_FNAME] = relPath(g.sync.absPath);
+                        node.s[S_SYNC_FORMAT] = format(g.sync.format.get());
+                        node.s[S_SYNC_FP] = str(str::toU8sv(g.sync.fingerprint.toString()));
+                    }
+                    nodes.push_back(node);
+                    addChildren(g);
+                    nodes.push_back({ .kind = Kind::END });
+                } break;
+            case tr::ObjType::PROJECT:
+            case tr::ObjType::FILE:
+                throw std::logic_error("[Snapshot] Strange child");
+            }
+        }
+    }
+
+    void Writer::addProject(const tr::Project& prj)
+    {
+        auto& info = prj.info;
+        Node nodeInfo { .kind = Kind::INFO,
+                        .extra = static_cast<unsigned char>(info.type) };
+        nodeInfo.s[S_ORIG_LANG] = str(str::toU8sv(info.orig.lang));
+        nodeInfo.s[S_ORIG_FNAME] = relPath(info.orig.absPath);
+        nodeInfo.s[S_REF_FNAME] = relPath(info.ref.absPath);
+        nodeInfo.s[S_TRANSL_LANG] = str(str::toU8sv(info.transl.lang));
+        if (info.transl.pseudoloc.isOn())
+            nodeInfo.flags |= F_PSEUDOLOC;
+        nodes.push_back(nodeInfo);
+
+        for (auto& file : prj.files) {
+            Node node { .kind = Kind::FILE };
+            addEntity(node, *file);
+            if (file->info.isIdless)
+                node.flags |= F_IDLESS;
+            node.s[S_ORIG_PATH] = str(file->info.origPath.u8string());
+            node.s[S_TRANSL_PATH] = str(file->info.translPath.u8string());
+            node.s[S_FORMAT] = format(file->info.format.get());
+            nodes.push_back(node);
+            addChildren(*file);
+            nodes.push_back({ .kind = Kind::END });
+        }
+        if (nodes.size() >= UINT32_MAX)
+            throw std::length_error("Snapshot is too big");
+    }
+
+    void Writer::write(std::ostream& os, const tr::snapshot::Passport& passport) const
+    {
+        Header header {
+            .magic = MAGIC,
+            .version = VERSION,
+            .byteOrderMark = BYTE_ORDER_MARK,
+            .passport = passport,
+            .fileSize = sizeof(Header) + nodes.size() * sizeof(Node)
+                        + strings.size() * sizeof(StrRef) + blob.size(),
+            .nNodes = static_cast<uint32_t>(nodes.size()),
+            .nStrings = static_cast<uint32_t>(strings.size()),
+            .blobSize = blob.size(),
+        };
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        os.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(Node));
+        os.write(reinterpret_cast<const char*>(strings.data()), strings.size() * sizeof(StrRef));
+        os.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+    }
+
+    ///// Loader ///////////////////////////////////////////////////////////////
+
+    class BadSnapshot : public std::runtime_error
+    {
+    public:
+        BadSnapshot() : std::runtime_error("Bad snapshot") {}
+    };
+
+    ///
+    ///  Builds project right from mapped snapshot.
+    ///  Strings are copied to project’s arena with one block,
+    ///    entities then borrow them.
+    ///
+    class Loader
+    {
+    public:
+        Loader(tr::Project& aPrj, const std::filesystem::path& basePath,
+               std::string_view aData, tr::ProgressListener* aProgress)
+            : prj(aPrj), ctx { .info = aPrj.info, .baseDir = basePath },
+              data(aData), progress(aProgress) {}
+        /// @return [+] loaded  [-] stale snapshot
+        /// @throw BadSnapshot, Cancelled
+        bool run(const tr::snapshot::Passport& passport);
+    private:
+        tr::Project& prj;
+        tr::ReadContext ctx;
+        std::string_view data;
+        tr::ProgressListener* progress;
+        Header header;
+        const char* strRefs = nullptr;
+        std::u8string_view blob;
+
+        [[noreturn]] static void fail() { throw BadSnapshot(); }
+        Node node(uint32_t i) const;
+        std::u8string_view str(uint32_t i) const;
+        void borrow(str::ArenaString& target, uint32_t i) const
+            { prj.arena->borrow(target, str(i)); }
+        std::filesystem::path absPath(uint32_t i) const
+            { return ctx.toAbsPath(std::filesystem::path(str(i))); }
+        std::unique_ptr<tf::FileFormat> format(uint32_t i) const;
+        void readInfo(const Node& x);
+        void readEntity(tr::Entity& entity, const Node& x);
+        void readText(tr::VirtualGroup& parent, const Node& x);
+    };
+
+    Node Loader::node(uint32_t i) const
+    {
+        Node r;
+        std::memcpy(&r, data.data() + sizeof(Header) + i * sizeof(Node), sizeof(Node));
+        return r;
+    }
+
+    std::u8string_view Loader::str(uint32_t i) const
+    {
+        if (i >= header.nStrings)
+            fail();
+        StrRef ref;
+        std::memcpy(&ref, strRefs + i * sizeof(StrRef), sizeof(StrRef));
+        if (ref.offset >= blob.size() || ref.length >= blob.size() - ref.offset
+                || blob[ref.offset + ref.length] != 0)
+            fail();
+        return blob.substr(ref.offset, ref.length);
+    }
+
+    std::unique_ptr<tf::FileFormat> Loader::format(uint32_t i) const
+    {
+        auto s = str(i);
+        if (s.empty())
+            return {};
+        pugi::xml_document doc;
+        if (!doc.load_buffer(s.data(), s.size(),
+                    pugi::parse_default | pugi::parse_ws_pcdata))
+            fail();
+        return tr::readFormat(doc);
+    }
+
+    void Loader::readInfo(const Node& x)
+    {
+        auto& info = prj.info;
+        if (x.kind != Kind::INFO || x.extra >= ec::size<tr::PrjType>())
+            fail();
+        info.type = static_cast<tr::PrjType>(x.extra);
+        info.orig.lang = str::toSv(str(x.s[S_ORIG_LANG]));
+        if (info.hasOriginalPath())
+            info.orig.absPath = absPath(x.s[S_ORIG_FNAME]);
+        if (info.canHaveReference())
+            info.ref.absPath = absPath(x.s[S_REF_FNAME]);
+        if (info.isTranslation()) {
+            info.transl.lang = str::toSv(str(x.s[S_TRANSL_LANG]));
+            info.transl.pseudoloc = (x.flags & F_PSEUDOLOC)
+                    ? tr::PrjInfo::Transl::Pseudoloc::DFLT
+                    : tr::PrjInfo::Transl::Pseudoloc::OFF;
+        }
+    }
+
+    void Loader::readEntity(tr::Entity& entity, const Node& x)
+    {
+        entity.arena = prj.arena;
+        borrow(entity.id, x.s[S_ID]);
+        borrow(entity.comm.importers, x.s[S_IM_CMT]);
+        borrow(entity.comm.authors, x.s[S_AU_CMT]);
+        borrow(entity.comm.translators, x.s[S_TR_CMT]);
+    }
+
+    void Loader::readText(tr::VirtualGroup& parent, const Node& x)
+    {
+        auto text = parent.addText({}, {}, tr::Modify::NO);
+        readEntity(*text, x);
+        auto& t = text->tr;
+        borrow(t.original, x.s[S_ORIG]);
+        t.forceAttention = (x.flags & F_FORCE_ATTENTION);
+        t.knownOriginal.isSuppressed = false;  // is not stored in file
+        if (x.flags & F_KNOWN_ORIG)
+            borrow(t.knownOriginal.text.emplace(), x.s[S_KNOWN_ORIG]);
+        if (x.flags & F_TRANSL)
+            borrow(t.translation.emplace(), x.s[S_TRANSL]);
+    }
+
+    bool Loader::run(const tr::snapshot::Passport& passport)
+    {
+        if (data.size() < sizeof(Header))
+            return false;
+        std::memcpy(&header, data.data(), sizeof(Header));
+        if (header.magic != MAGIC
+                || header.version != VERSION
+                || header.byteOrderMark != BYTE_ORDER_MARK
+                || header.passport != passport)
+            return false;
+        // 32-bit counts → no overflow here
+        uint64_t blobPos = sizeof(Header) + uint64_t{header.nNodes} * sizeof(Node)
+                         + uint64_t{header.nStrings} * sizeof(StrRef);
+        if (header.fileSize != data.size()
+                || blobPos + header.blobSize != data.size()
+                || header.nNodes == 0 || header.nStrings == 0)
+            fail();
+        strRefs = data.data() + blobPos - header.nStrings * sizeof(StrRef);
+
+        prj.clear();
+        prj.arena = std::make_shared<str::StringArena>();
+        blob = prj.arena->putBlock(str::toU8sv(data.substr(blobPos)));
+
+        readInfo(node(0));
+        // Project is the bottom: files are its children
+        SafeVector<std::shared_ptr<tr::VirtualGroup>> stack;
+        for (uint32_t i = 1; i < header.nNodes; ++i) {
+            if (progress && i % PROGRESS_STEP == 0) {
+                tr::reportProgress(progress,
+                        passport.size * i / header.nNodes, passport.size);
+            }
+            auto x = node(i);
+            switch (x.kind) {
+            case Kind::FILE: {
+                    if (!stack.empty())
+                        fail();
+                    auto file = prj.addFile({}, tr::Modify::NO);
+                    readEntity(*file, x);
+                    file->info.isIdless = (x.flags & F_IDLESS);
+                    file->info.origPath = str(x.s[S_ORIG_PATH]);
+                    file->info.translPath = str(x.s[S_TRANSL_PATH]);
+                    file->info.format = format(x.s[S_FORMAT]);
+                    stack.push_back(std::move(file));
+                } break;
+            case Kind::GROUP: {
+                    if (stack.empty())
+                        fail();
+                    auto group = stack.back()->addGroup({}, tr::Modify::NO);
+                    readEntity(*group, x);
+                    if (x.flags & F_SYNC) {
+                        if (x.extra >= tf::TextOwner_N)
+                            fail();
+                        group->sync.info.textOwner = static_cast<tf::TextOwner>(x.extra);
+                        group->sync.absPath = absPath(x.s[S_SYNC_FNAME]);
+                        group->sync.format = format(x.s[S_SYNC_FORMAT]);
+                        group->sync.fingerprint = tr::SyncFingerprint::parse(
+                                    str::toSv(str(x.s[S_SYNC_FP])));
+                    }
+                    stack.push_back(std::move(group));
+                } break;
+            case Kind::TEXT:
+                if (stack.empty())
+                    fail();
+                readText(*stack.back(), x);
+                break;
+            case Kind::END:
+                if (stack.empty())
+                    fail();
+                // IDs were assigned after adding
+                stack.back()->dropChildIndex();
+                stack.pop_back();
+                break;
+            case Kind::INFO:
+            default:
+                fail();
+            }
+        }
+        if (!stack.empty())
+            fail();
+        tr::reportProgress(progress, passport.size, passport.size);
+        return true;
+    }
+
+}   // anon namespace
+
+
+std::filesystem::path tr::snapshot::fnameFor(const std::filesystem::path& prjFname)
+{
+    auto r = prjFname;
+    r += ".snapshot";
+    return r;
+}
+
+
+auto tr::snapshot::passportOf(
+        const std::filesystem::path& fname, std::string_view data) -> Passport
+{
+    std::error_code ec;
+    Passport r;
+    r.size = data.size();
+    r.time = std::filesystem::last_write_time(fname, ec).time_since_epoch().count();
+    r.hash = hashOf(data);
+    return r;
+}
+
+
+bool tr::snapshot::load(
+        Project& prj, const std::filesystem::path& prjFname,
+        const Passport& passport, ProgressListener* progress)
+{
+    mf::MappedFile file(fnameFor(prjFname));
+    if (!file.isOpen())
+        return false;
+    try {
+        Loader loader(prj, prjFname.parent_path(), file.sv(), progress);
+        return loader.run(passport);
+    } catch (const Cancelled&) {
+        throw;
+    } catch (const std::exception&) {
+        // Bad snapshot, or format inside is bad
+        return false;
+    }
+}
+
+
+void tr::snapshot::save(
+        const Project& prj, const std::filesystem::path& prjFname,
+        const Passport& passport) noexcept
+{
+    auto fname = fnameFor(prjFname);
+    auto tmpName = fname;
+    tmpName += ".tmp";
+    std::error_code ec;
+    try {
+        Writer writer(prjFname.parent_path());
+        writer.addProject(prj);
+        {
+            std::ofstream os(tmpName, std::ios::binary | std::ios::trunc);
+            if (!os.is_open())
+                return;
+            writer.write(os, passport);
+            os.close();
+            if (!os) {
+                std::filesystem::remove(tmpName, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(tmpName, fname, ec);
+        if (ec)
+            std::filesystem::remove(tmpName, ec);
+    } catch (const std::exception&) {
+        // Just a cache, and XML is loaded already
+        std::filesystem::remove(tmpName, ec);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+// C++
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace tr {
+
+    class Project;
+    class ProgressListener;
+
+    ///
+    ///  Binary snapshot of project, next to its XML: string table +
+    ///    flat node array, loaded w/o any parsing.
+    ///  • XML is canonical, snapshot is just a cache: it is written on load
+    ///    from XML (only for projects opened to edit, or when asked)
+    ///    and used while XML’s size, time and hash are the same.
+    ///  • Missing, stale or bad snapshot → XML is parsed, snapshot is rebuilt.
+    ///  • Stores what XML stores, relative paths as well: the project
+    ///    may be moved together with snapshot.
+    ///  • Written via temporary file: nobody sees half-written snapshot.
+    ///
+    namespace snapshot {
+
+        /// What XML it was made of; also used for other files,
+        ///   e.g. sources of synchronized groups
+        struct Passport {
+            uint64_t size = 0;
+            int64_t time = 0;
+            uint64_t hash = 0;
+            bool operator == (const Passport&) const = default;
+        };
+
+        /// @return  snapshot’s file name for project’s file
+        std::filesystem::path fnameFor(const std::filesystem::path& prjFname);
+        /// @param [in] data  file’s contents
+        Passport passportOf(const std::filesystem::path& fname, std::string_view data);
+
+        /// Loads project from snapshot if it is made of XML with that passport
+        /// @param [in] progress  XML’s bytes, as if it were parsed; may be null
+        /// @return [+] loaded  [-] no/stale/bad snapshot, project is garbage
+        ///         then and should be loaded from XML
+        /// @throw Cancelled
+        bool load(Project& prj, const std::filesystem::path& prjFname,
+                  const Passport& passport, ProgressListener* progress);
+        /// Writes snapshot of project just loaded from XML;
+        ///   errors are ignored, snapshot is just a cache
+        void save(const Project& prj, const std::filesystem::path& prjFname,
+                  const Passport& passport) noexcept;
+
+    }   // namespace snapshot
+
+}   // namespace tr
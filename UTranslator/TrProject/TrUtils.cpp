@@ -122,6 +122,7 @@ void tr::extractOriginal(Project& prj, const eo::Sets& sets)
 {
     ExtractOriginal listener(sets);
     prj.traverse(listener, WalkOrder::ECONOMY, EnterMe::NO);
+    prj.searchIndex()->clear();
     prj.removeTranslChannel();
     prj.info.switchToOriginal(extractOriginalChannel[sets.text]);
     prj.fname.clear();
@@ -169,6 +170,7 @@ void tr::switchOriginalAndTranslation(Project& prj, const eo::Sets2& sets)
 {
     SwitchOriginalAndTranslation listener(sets);
     prj.traverse(listener, WalkOrder::ECONOMY, EnterMe::NO);
+    prj.searchIndex()->clear();
     prj.info.switchOriginalAndTranslation(sets.origPath);
     prj.fname.clear();
     prj.modify();
@@ -201,7 +203,7 @@ void tr::resetKnownOriginal(Project& prj)
     ResetKnownOriginals listener;
     prj.traverse(listener, WalkOrder::ECONOMY, EnterMe::NO);
     if (listener.count() != 0) {
-        prj.stats(StatsMode::ALL_CHILDREN, CascadeDropCache::NO);
+        prj.parallelStats(CascadeDropCache::NO);
         prj.modify();
     }
 }
@@ -251,6 +253,7 @@ namespace {
     {
         if (twIsEligible(text, ext.tr.original, sets)) {
             text.tr.translation = std::move(ext.tr.original);
+            text.cache.display.drop(tr::Mch::TRANSL);
             ++stats.nTextsTouched;
         }
     }
@@ -295,7 +298,8 @@ namespace {
     void twUpdateByStats(tr::Project& prj, TwStats& stats)
     {
         if (stats.nTextsTouched != 0) {
-            prj.stats(tr::StatsMode::ALL_CHILDREN, tr::CascadeDropCache::NO);
+            prj.searchIndex()->clear();
+            prj.parallelStats(tr::CascadeDropCache::NO);
             prj.modify();
         }
     }
@@ -425,6 +429,7 @@ namespace {
         if (auto response = qry->query(ids)) {
             if (twIsEligible(*x, response->text, sets)) {
                 x->tr.translation = std::u8string{response->text};
+                x->cache.display.drop(tr::Mch::TRANSL);
                 ++stats.nTextsTouched;
             }
         }
@@ -443,7 +448,7 @@ void tr::translateWithLockit(Project& prj, const tw::Sets& sets)
         auto format = file->ownFileFormat();
         if (!format || !*format)
             continue;
-        auto qry = (*format)->doImportAsQuery(sets.origPath / file->id);
+        auto qry = (*format)->doImportAsQuery(sets.origPath / file->id.sv());
         if (!qry) {
             throw std::logic_error(
                 loc::Fmt("File '{1}' cannot import a query object for some reason")
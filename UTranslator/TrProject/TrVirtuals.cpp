@@ -1,8 +1,13 @@
 // My header
 #include "TrVirtuals.h"
 
+// C++
+#include <mutex>
+#include <thread>
+
 // Libs
 #include "mojibake.h"
+#include "u_Hash.h"
 #include "u_Strings.h"
 
 
@@ -140,11 +145,21 @@ tr::Stats& tr::Stats::operator += (const Stats& x)
 void tr::UiObject::doModify(Mch ch)
 {
     cache.mod.set(ch);
+    cache.display.drop(ch);
     if (auto p = vproject())
         p->modify();
 }
 
 
+void tr::UiObject::doModify(Mch ch, const JournalEdit& edit)
+{
+    cache.mod.set(ch);
+    cache.display.drop(ch);
+    if (auto p = vproject())
+        p->journalModify(*this, edit);
+}
+
+
 void tr::UiObject::recache()
 {
     auto nc = nChildren();
@@ -176,21 +191,48 @@ void tr::UiObject::recursiveUnmodify()
 }
 
 
-std::u8string tr::UiObject::makeId(
-        std::u8string_view prefix,
-        std::u8string_view suffix) const
-{
-    auto nc = nChildren();
-    size_t newIndex = 0;
-    for (size_t i = 0; i < nc; ++i) {
-        auto ch = child(i);
-        auto sNumber = str::remainderSv(ch->idColumn(), prefix, suffix);
+namespace {
+
+    /// @return  [+] ID is prefix+number+suffix
+    std::optional<size_t> numberOfId(
+            std::u8string_view id,
+            std::u8string_view prefix,
+            std::u8string_view suffix)
+    {
+        auto sNumber = str::remainderSv(id, prefix, suffix);
         size_t num = 0;
         auto chars = str::fromChars(sNumber, num);
-        if (chars.ec == std::errc() && num >= newIndex) {
-            newIndex = num + 1;
+        if (chars.ec != std::errc())
+            return std::nullopt;
+        return num;
+    }
+
+    /// @return  number above all children’s
+    size_t freeNumber(
+            const tr::UiObject& parent,
+            std::u8string_view prefix,
+            std::u8string_view suffix)
+    {
+        auto nc = parent.nChildren();
+        size_t r = 0;
+        for (size_t i = 0; i < nc; ++i) {
+            auto num = numberOfId(parent.child(i)->idColumn(), prefix, suffix);
+            if (num && *num >= r)
+                r = *num + 1;
         }
+        return r;
     }
+
+}   // anon namespace
+
+
+std::u8string tr::UiObject::makeId(
+        std::u8string_view prefix,
+        std::u8string_view suffix) const
+{
+    auto b = batch();
+    size_t newIndex = b ? b->takeNumber(*this, prefix, suffix)
+                        : freeNumber(*this, prefix, suffix);
     char buf[30];
     auto sIndex = str::toCharsU8(buf, newIndex);
 
@@ -206,10 +248,12 @@ bool tr::UiObject::setOriginal(std::u8string_view x, tr::Modify wantModify)
 {
     if (auto t = translatable()) {
         if (t->original != x) {
+            updateSearchIndex(SearchChannel::ORIGINAL, t->original, x);
             t->original = x;
+            cache.display.drop(Mch::ORIG);
             stats(StatsMode::ALL_CHILDREN, CascadeDropCache::YES);
             if (wantModify != Modify::NO) {
-                doModify(Mch::ORIG);
+                doModify(Mch::ORIG, { .op = JournalOp::ORIGINAL, .value = x });
             }
             return true;
         }
@@ -265,10 +309,13 @@ bool tr::UiObject::setTranslation(
 {
     if (auto t = translatable()) {
         if (t->translation != x) {
+            updateSearchIndex(SearchChannel::TRANSLATION,
+                              t->translationSv(), x.value_or(std::u8string_view{}));
             t->translation = x;
+            cache.display.drop(Mch::TRANSL);
             stats(StatsMode::ALL_CHILDREN, CascadeDropCache::YES);
             if (wantModify != Modify::NO) {
-                doModify(Mch::TRANSL);
+                doModify(Mch::TRANSL, { .op = JournalOp::TRANSLATION, .value = x });
             }
             return true;
         }
@@ -283,7 +330,7 @@ bool tr::UiObject::suppressKnownOriginal(tr::Modify wantModify)
         if (t->knownOriginal) {  // op bool here
             t->knownOriginal.isSuppressed = true;
             if (wantModify != Modify::NO) {
-                doModify(Mch::ORIG);
+                doModify(Mch::ORIG, { .op = JournalOp::SUPPRESS_KNOWN });
             }
             return true;
         }
@@ -298,7 +345,7 @@ bool tr::UiObject::revertKnownOriginal(tr::Modify wantModify)
         if (t->knownOriginal.isActuallySuppressed()) {
             t->knownOriginal.isSuppressed = false;
             if (wantModify != Modify::NO) {
-                doModify(Mch::ORIG);
+                doModify(Mch::ORIG, { .op = JournalOp::REVERT_KNOWN });
             }
             return true;
         }
@@ -311,9 +358,10 @@ bool tr::UiObject::setAuthorsComment(std::u8string_view x, tr::Modify wantModify
 {
     if (auto c = comments()) {
         if (c->authors != x) {
+            updateSearchIndex(SearchChannel::AUTHORS_COMMENT, c->authors, x);
             c->authors = x;
             if (wantModify != Modify::NO) {
-                doModify(Mch::COMMENT);
+                doModify(Mch::COMMENT, { .op = JournalOp::AUTHORS_COMMENT, .value = x });
             }
             return true;
         }
@@ -326,9 +374,10 @@ bool tr::UiObject::setTranslatorsComment(std::u8string_view x, tr::Modify wantMo
 {
     if (auto c = comments()) {
         if (c->translators != x) {
+            updateSearchIndex(SearchChannel::TRANSLATORS_COMMENT, c->translators, x);
             c->translators = x;
             if (wantModify != Modify::NO) {
-                doModify(Mch::COMMENT);
+                doModify(Mch::COMMENT, { .op = JournalOp::TRANSLATORS_COMMENT, .value = x });
             }
             return true;
         }
@@ -368,20 +417,83 @@ bool tr::UiObject::moveDown(UiObject* aChild)
 }
 
 
+tr::Batch* tr::UiObject::batch() const
+{
+    auto prj = vproject();
+    return prj ? prj->activeBatch() : nullptr;
+}
+
+
+void tr::UiObject::onChildAdded(std::u8string_view id)
+{
+    if (auto b = batch()) {
+        b->onChildId(*this, id);
+        b->onChildrenChanged(*this, false);
+    } else {
+        doCascadeDropStats();
+    }
+}
+
+
+void tr::UiObject::onChildErased(Batch* batch)
+{
+    if (batch) {
+        batch->onChildrenChanged(*this, true);
+    } else {
+        recache();
+        doCascadeDropStats();
+    }
+}
+
+
 void tr::UiObject::cascadeDropStats()
 {
-    cache.stats.reset();
+    if (auto b = batch()) {
+        b->onChildrenChanged(*this, false);
+    } else {
+        doCascadeDropStats();
+    }
+}
+
+
+void tr::UiObject::doCascadeDropStats()
+{
+    // No stats → nothing was shown from them
+    if (cache.stats) {
+        cache.stats.reset();
+        cache.display.drop(Mch::TRANSL);
+    }
     for (auto q = parent(); q; q = q->parent()) {
         q->cache.stats.reset();
+        q->cache.display.drop(Mch::TRANSL);
+    }
+}
+
+
+void tr::UiObject::updateSearchIndex(
+        SearchChannel channel, std::u8string_view was, std::u8string_view now)
+{
+    // Never indexed → nothing to update
+    if (!cache.searchSlot)
+        return;
+    auto prj = vproject();
+    if (auto index = prj ? prj->searchIndex() : nullptr) {
+        index->update(*this, channel, was, now);
+    } else {
+        // Out of project: its index will never see that change
+        cache.searchSlot.reset();
     }
 }
 
 
 const tr::Stats& tr::UiObject::resetCacheIf(const Stats& r, CascadeDropCache cascade)
 {
-    if (cascade != CascadeDropCache::NO) {
-        if (!cache.stats || *cache.stats != r) {
+    if (!cache.stats || *cache.stats != r) {
+        if (cascade != CascadeDropCache::NO) {
             cascadeDropStats();
+        } else if (cache.stats) {
+            // Groups show stats in translation column
+            cache.display.drop(Mch::TRANSL);
         }
     }
     cache.stats = r;
@@ -533,15 +645,17 @@ const tr::Stats& tr::UiObject::stats(StatsMode mode, CascadeDropCache cascade)
     if (cache.stats && mode == StatsMode::CACHED)
         return *cache.stats;
 
-    if (mode == StatsMode::ME_ONLY)
-        mode = StatsMode::CACHED;
+    if (mode == StatsMode::ALL_CHILDREN) {
+        auto prj = vproject();
+        return recountStats(prj ? &prj->prjInfo() : nullptr, cascade);
+    }
 
     Stats r;
     r.isGroup = true;
     for (size_t i = 0; i < nChildren(); ++i) {
-        auto ch = child(i);
+        auto ch = childRaw(i);
         if (ch) {
-            auto& chst = ch->stats(mode, CascadeDropCache::NO);
+            auto& chst = ch->stats(StatsMode::CACHED, CascadeDropCache::NO);
             r += chst;
         }
     }
@@ -550,6 +664,120 @@ const tr::Stats& tr::UiObject::stats(StatsMode mode, CascadeDropCache cascade)
 }
 
 
+const tr::Stats& tr::UiObject::recountStats(
+        const PrjInfo* prjInfo, CascadeDropCache cascade)
+{
+    Stats r;
+    r.isGroup = true;
+    for (size_t i = 0; i < nChildren(); ++i) {
+        auto ch = childRaw(i);
+        if (ch) {
+            auto& chst = ch->recountStats(prjInfo, CascadeDropCache::NO);
+            r += chst;
+        }
+    }
+
+    return resetCacheIf(r, cascade);
+}
+
+
+namespace {
+
+    /// Jobs are unequal, so let threads balance them
+    constexpr size_t JOBS_PER_THREAD = 4;
+
+    ///  Subtree split for parallel stats
+    struct StatsSplit {
+        /// Subtrees computed in threads, totally
+        SafeVector<tr::UiObject*> jobs;
+        /// Objects above jobs; each one’s children are either jobs,
+        /// or texts, or its followers here
+        SafeVector<tr::UiObject*> inner;
+
+        void addChildren(tr::UiObject& x);
+        void split(tr::UiObject& root, size_t nWanted);
+    };
+
+    void StatsSplit::addChildren(tr::UiObject& x)
+    {
+        inner.push_back(&x);
+        for (size_t i = 0; i < x.nChildren(); ++i) {
+            // Texts are computed together with parent
+            auto ch = x.childRaw(i);
+            if (ch && ch->objType() != tr::ObjType::TEXT)
+                jobs.push_back(ch);
+        }
+    }
+
+    void StatsSplit::split(tr::UiObject& root, size_t nWanted)
+    {
+        addChildren(root);
+        // Split the largest job while there are few jobs
+        while (jobs.size() < nWanted) {
+            auto it = std::ranges::max_element(jobs, {},
+                    [](tr::UiObject* x) { return x->nChildren(); });
+            if (it == jobs.end() || (*it)->nChildren() < 2)
+                break;
+            auto job = *it;
+            jobs.erase(it);
+            addChildren(*job);
+        }
+    }
+
+}   // anon namespace
+
+
+const tr::Stats& tr::UiObject::parallelStats(
+        CascadeDropCache cascade, unsigned nThreads)
+{
+    if (nThreads == 0)
+        nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto prj = vproject();
+    auto prjInfo = prj ? &prj->prjInfo() : nullptr;
+    if (nThreads == 1)
+        return recountStats(prjInfo, cascade);
+
+    StatsSplit split;
+    split.split(*this, nThreads * JOBS_PER_THREAD);
+    if (split.jobs.size() < 2)
+        return recountStats(prjInfo, cascade);
+
+    // Jobs: each thread writes caches of its own subtrees only
+    std::atomic<size_t> iNext = 0;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto work = [&]() {
+        size_t i;
+        while ((i = iNext++) < split.jobs.size()) {
+            try {
+                split.jobs[i]->recountStats(prjInfo, CascadeDropCache::NO);
+            } catch (...) {
+                std::lock_guard lk(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+    };
+    if (nThreads > split.jobs.size())
+        nThreads = static_cast<unsigned>(split.jobs.size());
+    SafeVector<std::thread> threads;
+    for (unsigned i = 1; i < nThreads; ++i)
+        threads.emplace_back(work);
+    work();
+    for (auto& v : threads)
+        v.join();
+    if (error)
+        std::rethrow_exception(error);
+
+    // Merge: children are cached now, from bottom to top
+    for (size_t i = split.inner.size(); i > 1; ) {
+        --i;
+        split.inner[i]->stats(StatsMode::ME_ONLY, CascadeDropCache::NO);
+    }
+    return stats(StatsMode::ME_ONLY, cascade);
+}
+
+
 tr::StoringIdChain tr::UiObject::idChain()
 {
     StoringIdChain r;
@@ -564,4 +792,249 @@ tr::StoringIdChain tr::UiObject::idChain()
     }
     std::ranges::reverse(r.ids);
     return r;
-}
\ No newline at end of file
+}
+
+///// Trash ////////////////////////////////////////////////////////////////////
+
+namespace {
+
+    uint64_t chainHash(const tr::StoringIdChain& x)
+    {
+        hash::Fnv64 h;
+        h.addField(std::u8string_view{x.fileName});
+        for (auto& v : x.ids)
+            h.addField(std::u8string_view{v});
+        return h.value();
+    }
+
+    uint64_t originalHash(std::u8string_view x)
+    {
+        hash::Fnv64 h;
+        h.addField(x);
+        return h.value();
+    }
+
+}   // anon namespace
+
+
+std::optional<size_t> tr::Trash::findSame(
+        uint64_t chainHash, const StoringIdChain& chain,
+        const Translatable& tr) const
+{
+    auto [beg, end] = byChain.equal_range(chainHash);
+    for (auto p = beg; p != end; ++p) {
+        auto& line = fData[p->second];
+        if (line.chain == chain
+                && line.tr.original.sv() == tr.original.sv()
+                && line.tr.translation.has_value() == tr.translation.has_value()
+                && line.tr.translationSv() == tr.translationSv())
+            return p->second;
+    }
+    return std::nullopt;
+}
+
+
+void tr::Trash::index(uint32_t i)
+{
+    auto& line = fData[i];
+    byChain.emplace(chainHash(line.chain), i);
+    byOriginal.emplace(originalHash(line.tr.original), i);
+}
+
+
+bool tr::Trash::add(const StoringIdChain& chain, const Translatable& tr)
+{
+    if (auto i = findSame(chainHash(chain), chain, tr)) {
+        auto& line = fData[*i];
+        line.tr = tr;
+        line.generation = fGeneration;
+        return false;
+    }
+    if (fData.size() >= std::numeric_limits<uint32_t>::max())
+        throw std::length_error("Trash is too big");
+    auto& line = fData.emplace_back();
+    line.chain = chain;
+    line.tr = tr;
+    line.generation = fGeneration;
+    index(fData.size() - 1);
+    return true;
+}
+
+
+std::optional<size_t> tr::Trash::findChain(const StoringIdChain& chain) const
+{
+    std::optional<size_t> r;
+    auto [beg, end] = byChain.equal_range(chainHash(chain));
+    for (auto p = beg; p != end; ++p) {
+        auto& line = fData[p->second];
+        if (line.chain != chain)
+            continue;
+        if (!r || line.generation > fData[*r].generation
+               || (line.generation == fData[*r].generation && p->second > *r))
+            r = p->second;
+    }
+    return r;
+}
+
+
+SafeVector<size_t> tr::Trash::findOriginal(std::u8string_view original) const
+{
+    SafeVector<size_t> r;
+    auto [beg, end] = byOriginal.equal_range(originalHash(original));
+    for (auto p = beg; p != end; ++p) {
+        if (fData[p->second].tr.original.sv() == original)
+            r.push_back(p->second);
+    }
+    std::ranges::sort(r);
+    return r;
+}
+
+
+size_t tr::Trash::applyLimits()
+{
+    SafeVector<bool> isDropped(fData.size(), false);
+    size_t nLeft = fData.size();
+    if (limits.maxAge != 0) {
+        for (size_t i = 0; i < fData.size(); ++i) {
+            if (fGeneration - fData[i].generation >= limits.maxAge) {
+                isDropped[i] = true;
+                --nLeft;
+            }
+        }
+    }
+    if (limits.maxLines != 0 && nLeft > limits.maxLines) {
+        // Oldest generations first, then earliest added
+        SafeVector<uint32_t> order;
+        order.reserve(nLeft);
+        for (size_t i = 0; i < fData.size(); ++i)
+            if (!isDropped[i])
+                order.push_back(i);
+        std::ranges::stable_sort(order, {},
+                [this](uint32_t i) { return fData[i].generation; });
+        for (size_t i = 0, n = nLeft - limits.maxLines; i < n; ++i)
+            isDropped[order[i]] = true;
+        nLeft = limits.maxLines;
+    }
+
+    size_t nDropped = fData.size() - nLeft;
+    if (nDropped == 0)
+        return 0;
+    size_t iDest = 0;
+    for (size_t i = 0; i < fData.size(); ++i) {
+        if (!isDropped[i]) {
+            if (iDest != i)
+                fData[iDest] = std::move(fData[i]);
+            ++iDest;
+        }
+    }
+    fData.resize(nLeft);
+    byChain.clear();
+    byOriginal.clear();
+    for (size_t i = 0; i < fData.size(); ++i)
+        index(i);
+    // Lines are not just added → a new trash for UI
+    passport = std::make_shared<Passport>();
+    return nDropped;
+}
+
+
+void tr::Trash::clear()
+{
+    fData.clear();
+    byChain.clear();
+    byOriginal.clear();
+    passport = std::make_shared<Passport>();
+}
+
+
+///// Batch ////////////////////////////////////////////////////////////////////
+
+
+tr::Batch::Batch(std::shared_ptr<VirtualProject> aPrj)
+{
+    // Nested batch does nothing, the outer one collects everything
+    if (aPrj && !aPrj->activeBatch()) {
+        fProject = std::move(aPrj);
+        fProject->setActiveBatch(this);
+    }
+}
+
+
+tr::Batch::~Batch()
+{
+    try {
+        commit();
+    } catch (...) {
+        // Dtor may run during unwinding, nothing to do with it here;
+        // the tree is recached anyway, only notification is lost
+    }
+}
+
+
+void tr::Batch::commit()
+{
+    if (!fProject)
+        return;
+    // From now on changes go right to the tree
+    auto prj = std::move(fProject);
+    prj->setActiveBatch(nullptr);
+    for (auto& v : fChanged) {
+        if (v.wantRecache)
+            v.obj->recache();
+        v.obj->doCascadeDropStats();
+    }
+    fChanged.clear();
+    fChangedIndex.clear();
+    fNextNumbers.clear();
+    if (std::exchange(fIsModified, false))
+        prj->modify();
+}
+
+
+void tr::Batch::onChildrenChanged(UiObject& parent, bool wantRecache)
+{
+    auto [it, isNew] = fChangedIndex.try_emplace(&parent, fChanged.size());
+    if (isNew) {
+        auto obj = parent.selfUi();
+        if (!obj) {
+            // Somehow not shared → cannot keep it until commit
+            fChangedIndex.erase(it);
+            if (wantRecache)
+                parent.recache();
+            parent.doCascadeDropStats();
+            return;
+        }
+        fChanged.push_back({ .obj = std::move(obj), .wantRecache = wantRecache });
+    } else {
+        fChanged[it->second].wantRecache |= wantRecache;
+    }
+}
+
+
+void tr::Batch::onChildId(const UiObject& parent, std::u8string_view id)
+{
+    for (auto& v : fNextNumbers) {
+        if (v.parent == &parent) {
+            auto num = numberOfId(id, v.prefix, v.suffix);
+            if (num && *num >= v.value)
+                v.value = *num + 1;
+        }
+    }
+}
+
+
+size_t tr::Batch::takeNumber(
+        const UiObject& parent,
+        std::u8string_view prefix, std::u8string_view suffix)
+{
+    for (auto& v : fNextNumbers) {
+        if (v.parent == &parent && v.prefix == prefix && v.suffix == suffix)
+            return v.value++;
+    }
+    auto r = freeNumber(parent, prefix, suffix);
+    fNextNumbers.push_back({ .parent = &parent,
+                             .prefix = std::u8string{prefix},
+                             .suffix = std::u8string{suffix},
+                             .value = r + 1 });
+    return r;
+}
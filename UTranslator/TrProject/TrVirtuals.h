@@ -3,15 +3,19 @@
 // STL
 #include <optional>
 #include <atomic>
+#include <unordered_map>
 
 // Translation
 #include "TrDefines.h"
 #include "TrFileDefines.h"
 #include "Modifiable.h"
+#include "TrSearchIndex.h"
+#include "TrJournal.h"
 
 // Libs
 #include "function_ref.hpp"
 #include "u_Vector.h"
+#include "u_StringArena.h"
 
 namespace tr {
 
@@ -54,7 +58,7 @@ namespace tr {
     };
 
     struct Comments {
-        std::u8string importers, authors, translators;
+        str::ArenaString importers, authors, translators;
 
         /// @return author’s comment if it’s present, importer’s otherwise
         ///         (we prioritize: importer’s < author’s)
@@ -64,7 +68,7 @@ namespace tr {
         /// @return importer’s comment if it’s visible (no author’s)
         ///         e.g. as a search channel
         std::u8string_view importersIfVisible() const noexcept
-            { return authors.empty() ? importers : std::u8string_view{}; }
+            { return authors.empty() ? importers.sv() : std::u8string_view{}; }
 
         void removeTranslChannel() { translators.clear(); }
     };
@@ -85,9 +89,9 @@ namespace tr {
     };
 
     struct Translatable {
-        std::u8string original;     ///< Current original string
+        str::ArenaString original;     ///< Current original string
         struct KnownOriginal {  ///< Known original string we translated (never == original!)
-            std::optional<std::u8string> text;
+            std::optional<str::ArenaString> text;
             /// [+] known original is suppressed
             /// @warning  Not saved! The program saves just lack of known
             bool isSuppressed = false;
@@ -105,16 +109,16 @@ namespace tr {
             bool isActuallySuppressed() const noexcept { return text && isSuppressed; }
         } knownOriginal;
 
-        std::optional<std::u8string>
+        std::optional<str::ArenaString>
                     reference,      ///< Reference string in other language (see PrjInfo.canHaveReference)
                     translation;    ///< Translation for known original (if present) or original
         bool forceAttention = false;
         bool wasChangedToday = false;  ///< [+] today = since load
         TrashState trashState = TrashState::NONE;
         std::u8string_view referenceSv() const
-            { return reference ? *reference : std::u8string_view(); }
+            { return reference ? reference->sv() : std::u8string_view(); }
         std::u8string_view translationSv() const
-            { return translation ? *translation : std::u8string_view(); }
+            { return translation ? translation->sv() : std::u8string_view(); }
         AttentionMode attentionMode(const tr::PrjInfo& prjInfo) const;
         AttentionMode baseAttentionMode(const tr::PrjInfo& prjInfo) const;
 
@@ -156,6 +160,7 @@ namespace tr {
     struct StoringIdChain {
         std::u8string fileName;
         std::vector<std::u8string> ids;
+        bool operator == (const StoringIdChain&) const = default;
     };
 
     /// A simple object intended for checking: are we working
@@ -165,15 +170,61 @@ namespace tr {
     struct TrashLine {
         StoringIdChain chain;
         Translatable tr;
+        unsigned generation = 0;    ///< trash’s generation when added or met again
     };
 
-    struct Trash {
-        SafeVector<TrashLine> data;
+    /// Off by default: lines are dropped only if someone opts in
+    struct TrashLimits {
+        size_t maxLines = 0;        ///< [0] unlimited
+        unsigned maxAge = 0;        ///< in generations (updates); [0] unlimited
+    };
+
+    ///
+    ///  Translated texts lost by updates.
+    ///  • Identical lines (same ID chain, original and translation)
+    ///    are stored once; meeting a line again renews it.
+    ///  • Indexed by ID chain and by original, both hashed.
+    ///  • Every update is a generation; applyLimits() drops old lines.
+    ///  • Lines are added to the end only; if some are dropped,
+    ///    passport changes.
+    ///
+    class Trash
+    {
+    public:
         std::shared_ptr<Passport> passport = std::make_shared<Passport>();
+        TrashLimits limits;
 
-        bool isEmpty() const noexcept { return data.empty(); }
+        bool isEmpty() const noexcept { return fData.empty(); }
         bool hasSmth() const noexcept { return !isEmpty(); }
-        size_t size() const noexcept { return data.size(); }
+        size_t size() const noexcept { return fData.size(); }
+        const TrashLine& operator [] (size_t i) const { return fData[i]; }
+        auto begin() const noexcept { return fData.begin(); }
+        auto end() const noexcept { return fData.end(); }
+
+        /// Adds a line, or renews identical one
+        /// @return [+] added
+        bool add(const StoringIdChain& chain, const Translatable& tr);
+        /// @return  newest line with this ID chain
+        std::optional<size_t> findChain(const StoringIdChain& chain) const;
+        /// @return  lines with this original, oldest first
+        SafeVector<size_t> findOriginal(std::u8string_view original) const;
+
+        unsigned generation() const noexcept { return fGeneration; }
+        /// Call before update
+        void newGeneration() noexcept { ++fGeneration; }
+        /// Drops lines beyond limits, oldest first
+        /// @return # of lines dropped
+        size_t applyLimits();
+        void clear();
+    private:
+        SafeVector<TrashLine> fData;
+        std::unordered_multimap<uint64_t, uint32_t> byChain, byOriginal;
+        unsigned fGeneration = 0;
+
+        void index(uint32_t i);
+        std::optional<size_t> findSame(
+                uint64_t chainHash, const StoringIdChain& chain,
+                const Translatable& tr) const;
     };
 
     enum class Modify : unsigned char { NO, YES };
@@ -269,10 +320,67 @@ namespace tr {
     };
 
 
+    ///
+    ///  UI’s cache of object’s rendered cells (see tw::DisplayCache):
+    ///    the object just knows its slot, and which cells are still valid.
+    ///  • Setters and doModify drop cells by modification channel,
+    ///    cascadeDropStats drops translation (groups show stats there).
+    ///  • Reference has no channel: it changes along with the whole
+    ///    project, and UI resets then.
+    ///  • Copy is empty, like SearchSlot.
+    ///
+    class DisplaySlot
+    {
+    public:
+        enum class Cell : unsigned char { ID, ORIGINAL, REFERENCE, TRANSLATION };
+        static constexpr int Cell_N = static_cast<int>(Cell::TRANSLATION) + 1;
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        /// Slot in UI’s cache; it may be taken by another object since
+        uint32_t index = NONE;
+
+        DisplaySlot() noexcept = default;
+        DisplaySlot(const DisplaySlot&) noexcept {}
+        DisplaySlot& operator = (const DisplaySlot&) noexcept
+            { index = NONE; validCells = 0; return *this; }
+
+        bool isValid(Cell x) const noexcept { return validCells & bit(x); }
+        void validate(Cell x) noexcept { validCells |= bit(x); }
+        void drop(Mch ch) noexcept
+        {
+            auto v = static_cast<unsigned>(ch);
+            if (v & static_cast<unsigned>(Mch::ID))
+                validCells &= ~bit(Cell::ID);
+            if (v & static_cast<unsigned>(Mch::ORIG))
+                validCells &= ~bit(Cell::ORIGINAL);
+            if (v & static_cast<unsigned>(Mch::TRANSL))
+                validCells &= ~bit(Cell::TRANSLATION);
+        }
+        void dropAll() noexcept { validCells = 0; }
+    private:
+        unsigned char validCells = 0;
+        static constexpr unsigned char bit(Cell x) noexcept
+            { return 1u << static_cast<int>(x); }
+    };
+
+
+    class Batch;
+
     class VirtualProject : virtual public Modifiable    // interface
     {
     public:
         virtual const PrjInfo& prjInfo() const = 0;
+        /// @return  search index, or null if none
+        virtual SearchIndex* searchIndex() { return nullptr; }
+        /// Modifies by an edit that journal can express
+        virtual void journalModify(UiObject&, const JournalEdit&) { modify(); }
+        /// @return  bulk changes in progress, or null
+        virtual Batch* activeBatch() const { return nullptr; }
+    protected:
+        friend class Batch;
+        /// Batch starts [+] or commits [0]; a project that cannot
+        ///   defer anything just ignores it
+        virtual void setActiveBatch(Batch*) {}
     };
 
 
@@ -283,6 +391,8 @@ namespace tr {
             int index = -1;             ///< index in tree
             Mod mod;
             std::optional<Stats> stats;
+            SearchSlot searchSlot;
+            DisplaySlot display;
             struct TreeUi {
                 ExpandState expandState = ExpandState::UNKNOWN;
                 std::weak_ptr<UiObject> currObject {};
@@ -295,6 +405,8 @@ namespace tr {
         virtual std::shared_ptr<UiObject> parent() const = 0;
         virtual size_t nChildren() const noexcept = 0;
         virtual std::shared_ptr<UiObject> child(size_t i) const = 0;
+        /// Same as child, w/o refcounting: for hot loops over the tree
+        virtual UiObject* childRaw(size_t i) const noexcept = 0;
         virtual std::u8string_view idColumn() const = 0;
         virtual std::shared_ptr<const FileInfo> inheritedFileInfo() const = 0;
         virtual std::shared_ptr<FileInfo> ownFileInfo() { return {}; }
@@ -302,7 +414,8 @@ namespace tr {
         virtual bool setId(std::u8string_view, tr::Modify) { return false; }
         /// Deletes i’th child
         /// @return extracted child
-        /// @warning  Because of recache, complexity is O(n)
+        /// @warning  Because of recache, complexity is O(n);
+        ///           in Batch recache goes to commit
         virtual std::shared_ptr<UiObject> extractChild(size_t, Modify) { return {}; }
         virtual void traverseTexts(const EvText&) = 0;
         virtual void traverseCTexts(const EvCText&) const = 0;
@@ -336,6 +449,16 @@ namespace tr {
         /// Gets statistics, can use cache
         /// @warning Should work with nulls instead of some objects!
         virtual const Stats& stats(StatsMode mode, CascadeDropCache cascade);
+        /// Same as stats(ALL_CHILDREN), but project info is got once
+        ///   by caller and passed down, rather than looked up by each text
+        /// @param [in] prjInfo  nullptr if object is out of project
+        virtual const Stats& recountStats(
+                const PrjInfo* prjInfo, CascadeDropCache cascade);
+        /// Same as stats(ALL_CHILDREN), but files and large groups
+        ///   are computed in several threads, then merged.
+        /// Fills the same caches as serial version.
+        /// @param [in] nThreads  0 = as many as CPU has
+        const Stats& parallelStats(CascadeDropCache cascade, unsigned nThreads = 0);
         UpdateInfo addedInfo(CascadeDropCache cascade);
         UpdateInfo::ByState deletedInfo(CascadeDropCache cascade);
 
@@ -379,6 +502,8 @@ namespace tr {
         std::shared_ptr<UiObject> extract(Modify wantModify);
         /// Adds statistics about a single object (not children)
         void doModify(Mch ch);
+        /// Same, and the edit goes to project’s journal
+        void doModify(Mch ch, const JournalEdit& edit);
         bool canMoveUp(const UiObject* aChild) const;
         bool canMoveDown(const UiObject* aChild) const;
         bool moveUp(UiObject* aChild);
@@ -406,8 +531,80 @@ namespace tr {
         /// Exchanges child[i] and child[i+1]
         virtual void doSwapChildren(size_t index1, size_t index2) = 0;
         const Stats& resetCacheIf(const Stats& r, CascadeDropCache cascade);
+        /// Drops my and parents’ stats; in batch — on commit
         void cascadeDropStats();
+        /// Same, right now
+        void doCascadeDropStats();
+        /// @return  bulk changes of my project, or null
+        Batch* batch() const;
+        /// Child was added: drops stats, in batch — once on commit
+        void onChildAdded(std::u8string_view id);
+        /// Child was erased: recaches indexes and drops stats,
+        ///   in batch — once on commit
+        void onChildErased(Batch* batch);
+        /// Tells project’s search index that some channel will change
+        void updateSearchIndex(SearchChannel channel,
+                std::u8string_view was, std::u8string_view now);
         void uiStealDataFrom(UiObject& x, UiObject* myParent);
+    private:
+        friend class Batch;
+    };
+
+
+    ///
+    ///  Bulk changes of project, RAII: while batch lives,
+    ///  • adding/extracting children drops stats once per parent, on commit;
+    ///  • extracting does not recache siblings’ indexes, parent is
+    ///    recached on commit;
+    ///  • project is modified once on commit, rather than on every change;
+    ///  • makeId remembers next free number per parent, prefix and suffix.
+    ///  Batches nest, the outermost one commits.
+    ///  @warning  Until commit, stats of changed parents are stale,
+    ///            and so are cache.index’es of siblings after
+    ///            an extracted child → extract from the end.
+    ///
+    class Batch
+    {
+    public:
+        /// @param [in] aPrj  [0] out of project, batch does nothing
+        explicit Batch(std::shared_ptr<VirtualProject> aPrj);
+        Batch(const Batch&) = delete;
+        Batch& operator = (const Batch&) = delete;
+        /// Commits too, best-effort: never throws
+        ~Batch();
+
+        /// Does what was deferred, then batch is inactive.
+        /// Dtor commits as well: the tree is consistent even
+        ///   after exception.
+        /// @throw  whatever project’s modify listener throws
+        void commit();
+        /// @return [+] outermost batch, not committed yet
+        bool isActive() const noexcept { return static_cast<bool>(fProject); }
+
+        /// Parent’s children were added/erased
+        void onChildrenChanged(UiObject& parent, bool wantRecache);
+        /// Project was modified
+        void onModify() noexcept { fIsModified = true; }
+        /// Parent’s child got this ID
+        void onChildId(const UiObject& parent, std::u8string_view id);
+        /// @return  free number for makeId, it’s taken from now on
+        size_t takeNumber(const UiObject& parent,
+                          std::u8string_view prefix, std::u8string_view suffix);
+    private:
+        struct Changed {
+            std::shared_ptr<UiObject> obj;
+            bool wantRecache;
+        };
+        struct NextNumber {
+            const UiObject* parent;
+            std::u8string prefix, suffix;
+            size_t value;
+        };
+        std::shared_ptr<VirtualProject> fProject;
+        SafeVector<Changed> fChanged;
+        std::unordered_map<const UiObject*, size_t> fChangedIndex;
+        SafeVector<NextNumber> fNextNumbers;
+        bool fIsModified = false;
     };
 
 }   // namespace tr
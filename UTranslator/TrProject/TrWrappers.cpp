@@ -106,3 +106,18 @@ auto tw::Flyweight::getOrig(tr::UiObject& x) -> const TranslObj&
         return NoString::INST;
     }
 }
+
+
+std::u8string_view tw::cellPrefix(std::u8string_view x, size_t maxCps)
+{
+    size_t nCps = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        // Count leading bytes only
+        if ((static_cast<unsigned char>(x[i]) & 0xC0) != 0x80) {
+            if (nCps == maxCps)
+                return x.substr(0, i);
+            ++nCps;
+        }
+    }
+    return x;
+}
@@ -80,4 +80,155 @@ namespace tw {
         TranslStats trStats;
     };
 
+    ///
+    ///  @return  prefix of x, at most maxCps code points long,
+    ///           cut at code point boundary
+    ///  Scans only that prefix, so huge texts cost nothing.
+    ///
+    std::u8string_view cellPrefix(std::u8string_view x, size_t maxCps);
+
+    ///
+    ///  Cache of rendered cells, so that scrolling and repainting a tree
+    ///    do not convert the same strings again and again.
+    ///  • Object keeps its slot and valid cells (tr::DisplaySlot),
+    ///    and drops them on changes itself.
+    ///  • Memory is capped; least recently used entries go away
+    ///    (CLOCK algorithm).
+    ///  • Slot may outlive the cache, or be taken by another object:
+    ///    entry knows its owner, so stale slots just miss.
+    ///  @tparam Str  QString in UI, anything with size() and value_type in tests
+    ///
+    template <class Str>
+    class DisplayCache
+    {
+    public:
+        using Cell = tr::DisplaySlot::Cell;
+        static constexpr size_t DEFAULT_MAX_BYTES = 32 << 20;
+
+        explicit DisplayCache(size_t aMaxBytes = DEFAULT_MAX_BYTES) noexcept
+            : maxBytes(aMaxBytes) {}
+
+        /// @param [in] render  Str(tr::UiObject&), called on miss
+        template <class Render>
+        const Str& get(tr::UiObject& obj, Cell cell, const Render& render);
+
+        /// Call when the whole project is changed or gone
+        void clear() noexcept;
+
+        size_t nBytes() const noexcept { return fBytes; }
+        size_t nEntries() const noexcept { return entries.size() - freeList.size(); }
+    private:
+        struct Entry {
+            const tr::UiObject* owner = nullptr;
+            Str strings[tr::DisplaySlot::Cell_N];
+            size_t nBytes = 0;
+            bool isRecent = false;
+        };
+        size_t maxBytes;
+        size_t fBytes = 0;
+        std::vector<Entry> entries;
+        std::vector<uint32_t> freeList;
+        size_t hand = 0;
+
+        static size_t bytesOf(const Str& x) noexcept
+            { return x.size() * sizeof(typename Str::value_type); }
+        uint32_t allocate(const tr::UiObject& owner);
+        void release(Entry& x) noexcept;
+        void shrink(uint32_t keep) noexcept;
+    };
+
 }   // namespace tw
+
+
+template <class Str> template <class Render>
+const Str& tw::DisplayCache<Str>::get(
+        tr::UiObject& obj, Cell cell, const Render& render)
+{
+    auto& slot = obj.cache.display;
+    if (slot.index >= entries.size() || entries[slot.index].owner != &obj) {
+        slot.index = allocate(obj);
+        slot.dropAll();
+    }
+    auto& entry = entries[slot.index];
+    entry.isRecent = true;
+    auto& s = entry.strings[static_cast<int>(cell)];
+    if (!slot.isValid(cell)) {
+        auto oldBytes = bytesOf(s);
+        s = render(obj);
+        auto newBytes = bytesOf(s);
+        entry.nBytes = entry.nBytes + newBytes - oldBytes;
+        fBytes = fBytes + newBytes - oldBytes;
+        slot.validate(cell);
+        if (fBytes > maxBytes)
+            shrink(slot.index);
+    }
+    // shrink never moves entries
+    return s;
+}
+
+
+template <class Str>
+void tw::DisplayCache<Str>::clear() noexcept
+{
+    entries.clear();
+    freeList.clear();
+    fBytes = 0;
+    hand = 0;
+}
+
+
+template <class Str>
+uint32_t tw::DisplayCache<Str>::allocate(const tr::UiObject& owner)
+{
+    uint32_t r;
+    if (!freeList.empty()) {
+        r = freeList.back();
+        freeList.pop_back();
+    } else {
+        if (entries.size() >= tr::DisplaySlot::NONE)
+            throw std::length_error("[DisplayCache.allocate] Too many entries");
+        r = entries.size();
+        entries.emplace_back();
+        // So that release() never throws
+        freeList.reserve(entries.size());
+    }
+    auto& entry = entries[r];
+    entry.owner = &owner;
+    entry.nBytes = sizeof(Entry);
+    fBytes += sizeof(Entry);
+    return r;
+}
+
+
+template <class Str>
+void tw::DisplayCache<Str>::release(Entry& x) noexcept
+{
+    fBytes -= x.nBytes;
+    for (auto& s : x.strings)
+        s = Str{};
+    x.owner = nullptr;
+    x.nBytes = 0;
+    x.isRecent = false;
+    freeList.push_back(&x - entries.data());
+}
+
+
+template <class Str>
+void tw::DisplayCache<Str>::shrink(uint32_t keep) noexcept
+{
+    // Two rounds: the 1st one may just clear recent flags
+    for (size_t nSteps = entries.size() * 2;
+            fBytes > maxBytes && nSteps != 0; --nSteps) {
+        if (hand >= entries.size())
+            hand = 0;
+        auto& entry = entries[hand];
+        if (entry.owner && hand != keep) {
+            if (entry.isRecent) {
+                entry.isRecent = false;
+            } else {
+                release(entry);
+            }
+        }
+        ++hand;
+    }
+}
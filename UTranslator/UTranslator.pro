@@ -20,13 +20,18 @@ SOURCES += \
     ../Libs/Qt/DirectionalToolTip/BalloonTip.cpp \
     ../Libs/Qt/ElidedLabel.cpp \
     ../Libs/SelfMade/L10n/LocFmt.cpp \
+    ../Libs/SelfMade/Mojibake/cpp/auto_casefold.cpp \
+    ../Libs/SelfMade/Mojibake/cpp/simd.cpp \
     ../Libs/SelfMade/Qt/QtMultiRadio.cpp \
     ../Libs/SelfMade/Qt/RememberWindow.cpp \
     ../Libs/SelfMade/i_OpenSave.cpp \
     ../Libs/SelfMade/u_OpenSaveStrings.cpp \
+    ../Libs/SelfMade/u_XmlSax.cpp \
     ../Libs/SelfMade/u_XmlUtils.cpp \
     ../Libs/SelfMade/Strings/u_Decoders.cpp \
+    ../Libs/SelfMade/Strings/u_Diff.cpp \
     ../Libs/SelfMade/Strings/u_Qstrings.cpp \
+    ../Libs/SelfMade/Strings/u_StringArena.cpp \
     ../Libs/SelfMade/Strings/u_Strings.cpp \
     FmAboutFormat.cpp \
     FmDisambigPair.cpp \
@@ -36,6 +41,7 @@ SOURCES += \
     FmProjectSettings.cpp \
     FmTrash.cpp \
     History.cpp \
+    Main/BgJob.cpp \
     Main/DiffBrowser.cpp \
     Main/FmMain.cpp \
     Main/PrjTreeModel.cpp \
@@ -53,7 +59,11 @@ SOURCES += \
     TrProject/TrFile.cpp \
     TrProject/TrFileDefines.cpp \
     TrProject/TrFinder.cpp \
+    TrProject/TrJournal.cpp \
+    TrProject/TrMemory.cpp \
     TrProject/TrProject.cpp \
+    TrProject/TrSearchIndex.cpp \
+    TrProject/TrSnapshot.cpp \
     TrProject/TrUtils.cpp \
     TrProject/TrVirtuals.cpp \
     TrProject/TrWrappers.cpp \
@@ -79,13 +89,19 @@ HEADERS += \
     ../Libs/SelfMade/Qt/RememberWindow.h \
     ../Libs/SelfMade/i_OpenSave.h \
     ../Libs/SelfMade/u_Array.h \
+    ../Libs/SelfMade/u_BinCatalog.h \
     ../Libs/SelfMade/u_EcArray.h \
+    ../Libs/SelfMade/u_Hash.h \
+    ../Libs/SelfMade/u_MappedFile.h \
     ../Libs/SelfMade/u_OpenSaveStrings.h \
     ../Libs/SelfMade/u_TypedFlags.h \
     ../Libs/SelfMade/u_Uptr.h \
+    ../Libs/SelfMade/u_XmlSax.h \
     ../Libs/SelfMade/u_XmlUtils.h \
     ../Libs/SelfMade/Strings/u_Decoders.h \
+    ../Libs/SelfMade/Strings/u_Diff.h \
     ../Libs/SelfMade/Strings/u_Qstrings.h \
+    ../Libs/SelfMade/Strings/u_StringArena.h \
     ../Libs/SelfMade/Strings/u_Strings.h \
     FmAboutFormat.h \
     FmDisambigPair.h \
@@ -95,6 +111,7 @@ HEADERS += \
     FmProjectSettings.h \
     FmTrash.h \
     History.h \
+    Main/BgJob.h \
     Main/DiffBrowser.h \
     Main/FmMain.h \
     Main/PrjTreeModel.h \
@@ -112,7 +129,12 @@ HEADERS += \
     TrProject/TrFile.h \
     TrProject/TrFileDefines.h \
     TrProject/TrFinder.h \
+    TrProject/TrJournal.h \
+    TrProject/TrMemory.h \
+    TrProject/TrProgress.h \
     TrProject/TrProject.h \
+    TrProject/TrSearchIndex.h \
+    TrProject/TrSnapshot.h \
     TrProject/TrUtils.h \
     TrProject/TrVirtuals.h \
     TrProject/TrWrappers.h \
@@ -0,0 +1,71 @@
+#pragma once
+
+///
+///  Files and directories shared by unit tests
+///
+
+// C++
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+// Project
+#include "TrJournal.h"
+#include "TrSnapshot.h"
+
+namespace ut {
+
+    /// Directory removed in dtor
+    class TempDir
+    {
+    public:
+        TempDir(const char* name)
+            : path(std::filesystem::temp_directory_path() / name)
+        {
+            std::filesystem::remove_all(path);
+            std::filesystem::create_directories(path);
+        }
+        ~TempDir() { std::filesystem::remove_all(path); }
+        const std::filesystem::path path;
+    };
+
+    /// Project file removed in ctor and dtor, along with its journal and snapshot
+    class TempFile
+    {
+    public:
+        TempFile(const char* name)
+            : path(std::filesystem::temp_directory_path() / name)
+            { clean(); }
+        ~TempFile() { clean(); }
+        const std::filesystem::path path;
+    private:
+        void clean()
+        {
+            std::filesystem::remove(path);
+            std::filesystem::remove(tr::Journal::fnameFor(path));
+            std::filesystem::remove(tr::snapshot::fnameFor(path));
+        }
+    };
+
+    inline std::string readFile(const std::filesystem::path& fname)
+    {
+        std::ifstream is(fname, std::ios::binary);
+        return { std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>() };
+    }
+
+    inline void writeFile(const std::filesystem::path& fname, std::string_view data)
+    {
+        std::ofstream os(fname, std::ios::binary);
+        os.write(data.data(), data.size());
+    }
+
+#ifndef UTRANSLATOR_SAMPLES
+    #error UTRANSLATOR_SAMPLES should be defined in UnitTest.pro
+#endif
+
+    /// Sample projects that come with the program
+    inline std::filesystem::path samplesDir()
+        { return std::filesystem::path(UTRANSLATOR_SAMPLES).lexically_normal(); }
+
+}   // namespace ut
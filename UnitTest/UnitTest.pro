@@ -9,25 +9,85 @@ win32-g++: {
     LIBS += -static -lpthread
 }
 
+# Sample projects, wherever the shadow build is
+DEFINES += UTRANSLATOR_SAMPLES=\\\"$$PWD/../Samples/Features\\\"
+
 SOURCES += \
     ../Libs/GoogleTest/src/gtest-all.cc \
     ../Libs/GoogleTest/src/gtest_main.cc \
+    ../Libs/PugiXml/pugixml.cpp \
+    ../Libs/SelfMade/L10n/LocFmt.cpp \
+    ../Libs/SelfMade/Mojibake/cpp/auto_casefold.cpp \
+    ../Libs/SelfMade/Mojibake/cpp/simd.cpp \
+    ../Libs/SelfMade/Strings/u_StringArena.cpp \
     ../Libs/SelfMade/Strings/u_Strings.cpp \
     ../Libs/SelfMade/Strings/u_Decoders.cpp \
+    ../Libs/SelfMade/Strings/u_Diff.cpp \
+    ../Libs/SelfMade/u_XmlSax.cpp \
+    ../Libs/SelfMade/u_XmlUtils.cpp \
+    ../UTranslator/TrProject/Modifiable.cpp \
+    ../UTranslator/TrProject/TrDefines.cpp \
+    ../UTranslator/TrProject/TrFile.cpp \
+    ../UTranslator/TrProject/TrFileDefines.cpp \
+    ../UTranslator/TrProject/TrJournal.cpp \
+    ../UTranslator/TrProject/TrMemory.cpp \
+    ../UTranslator/TrProject/TrProject.cpp \
+    ../UTranslator/TrProject/TrSearchIndex.cpp \
+    ../UTranslator/TrProject/TrSnapshot.cpp \
+    ../UTranslator/TrProject/TrVirtuals.cpp \
+    ../UTranslator/TrProject/TrWrappers.cpp \
+    test_Batch.cpp \
+    test_BinCatalog.cpp \
+    test_Build.cpp \
+    test_ChildIndex.cpp \
     test_DecodeBr.cpp \
     test_DecodeCpp.cpp \
     test_DecodeIni.cpp \
     test_DecodeQuoted.cpp \
     test_DetectBom.cpp \
+    test_Diff.cpp \
+    test_DisplayCache.cpp \
     test_EscapeCpp.cpp \
-    test_EscapeText.cpp
+    test_EscapeText.cpp \
+    test_Ini.cpp \
+    test_Journal.cpp \
+    test_Load.cpp \
+    test_LocFmt.cpp \
+    test_Memory.cpp \
+    test_Mojibake.cpp \
+    test_Progress.cpp \
+    test_Save.cpp \
+    test_SearchIndex.cpp \
+    test_Snapshot.cpp \
+    test_Stats.cpp \
+    test_StringArena.cpp \
+    test_SyncGroups.cpp \
+    test_Trash.cpp \
+    test_UpdateMerge.cpp \
+    test_Walker.cpp
 
 HEADERS += \
-    ../Libs/SelfMade/Strings/u_Decoders.h
+    TempFiles.h \
+    ../Libs/SelfMade/Strings/u_Decoders.h \
+    ../Libs/SelfMade/Strings/u_Diff.h \
+    ../Libs/SelfMade/Strings/u_StringArena.h \
+    ../UTranslator/TrProject/TrJournal.h \
+    ../UTranslator/TrProject/TrMemory.h \
+    ../UTranslator/TrProject/TrProgress.h \
+    ../UTranslator/TrProject/TrProject.h \
+    ../UTranslator/TrProject/TrSearchIndex.h \
+    ../UTranslator/TrProject/TrSnapshot.h \
+    ../UTranslator/TrProject/TrVirtuals.h \
+    ../UTranslator/TrProject/TrWrappers.h
 
 INCLUDEPATH += \
+    ../Libs \
     ../Libs/GoogleTest \
     ../Libs/GoogleTest/include \
+    ../Libs/MagicEnum \
+    ../Libs/PugiXml \
     ../Libs/SelfMade \
+    ../Libs/SelfMade/L10n \
+    ../Libs/SelfMade/Mojibake \
     ../Libs/SelfMade/Strings \
     ../UTranslator/TrProject
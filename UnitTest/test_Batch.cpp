@@ -0,0 +1,282 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <chrono>
+#include <iostream>
+#include <optional>
+
+
+namespace {
+
+    std::shared_ptr<tr::Group> makeGroup(tr::Project& prj)
+    {
+        auto file = prj.addFile(u8"f", tr::Modify::NO);
+        return file->addGroup(u8"g", tr::Modify::NO);
+    }
+
+    /// Adds texts “prefix0”…, original = ID
+    void addTexts(tr::VirtualGroup& group, std::u8string_view prefix, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i) {
+            auto id = std::u8string{prefix} + str::toU8(std::to_string(i));
+            group.addText(id, id, tr::Modify::NO);
+        }
+    }
+
+    /// Checks cache.index of all children, and ID index
+    void expectConsistent(tr::VirtualGroup& group)
+    {
+        for (size_t i = 0; i < group.children.size(); ++i) {
+            auto& child = *group.children[i];
+            EXPECT_EQ(static_cast<int>(i), child.cache.index);
+            auto found = (child.objType() == tr::ObjType::TEXT)
+                    ? std::shared_ptr<tr::Entity>(group.findText(child.idColumn()))
+                    : group.findGroup(child.idColumn());
+            EXPECT_EQ(&child, found.get());
+        }
+    }
+
+    class ThrowingListener final : public ModListener
+    {
+    public:
+        void modStateChanged(ModState, ModState) override
+            { throw std::runtime_error("Listener failed"); }
+    };
+
+}   // anon namespace
+
+
+///
+///  Stats are dropped once on commit, and correct after it
+///
+TEST (Batch, Stats)
+{
+    auto prj = tr::Project::make();
+    auto group = makeGroup(*prj);
+    addTexts(*group, u8"a", 3);
+    auto& stats = prj->stats(tr::StatsMode::CACHED, tr::CascadeDropCache::YES);
+    EXPECT_EQ(3u, stats.text.nTotal());
+
+    {
+        tr::Batch batch(prj);
+        EXPECT_TRUE(batch.isActive());
+        EXPECT_EQ(&batch, prj->activeBatch());
+        addTexts(*group, u8"b", 5);
+        group->addGroup(u8"sub", tr::Modify::NO);
+        group->extractChild(0, tr::Modify::NO);
+    }
+    EXPECT_EQ(nullptr, prj->activeBatch());
+    auto& stats2 = prj->stats(tr::StatsMode::CACHED, tr::CascadeDropCache::YES);
+    EXPECT_EQ(7u, stats2.text.nTotal());
+    EXPECT_EQ(3u, stats2.nGroups);   // file, group, subgroup
+    expectConsistent(*group);
+}
+
+
+///
+///  Extraction from the end in a batch, indexes are recached on commit
+///
+TEST (Batch, Extract)
+{
+    auto prj = tr::Project::make();
+    auto group = makeGroup(*prj);
+    addTexts(*group, u8"t", 10);
+
+    tr::Batch batch(prj);
+    for (size_t i = 9; i >= 3; i -= 2) {
+        auto obj = group->extractChild(i, tr::Modify::NO);
+        ASSERT_TRUE(obj);
+    }
+    EXPECT_EQ(6u, group->children.size());
+    // ID index is right even in batch
+    EXPECT_FALSE(group->findText(u8"t9"));
+    EXPECT_TRUE(group->findText(u8"t8"));
+    batch.commit();
+    EXPECT_FALSE(batch.isActive());
+
+    expectConsistent(*group);
+    std::u8string_view expected[] { u8"t0", u8"t1", u8"t2", u8"t4", u8"t6", u8"t8" };
+    ASSERT_EQ(std::size(expected), group->children.size());
+    for (size_t i = 0; i < std::size(expected); ++i)
+        EXPECT_EQ(expected[i], group->children[i]->idColumn());
+}
+
+
+///
+///  makeId in a batch: increasing numbers, IDs added meanwhile are respected
+///
+TEST (Batch, MakeId)
+{
+    auto prj = tr::Project::make();
+    auto group = makeGroup(*prj);
+    group->addText(u8"id3", {}, tr::Modify::NO);
+
+    tr::Batch batch(prj);
+    auto id1 = group->makeId(u8"id", {});
+    EXPECT_EQ(u8"id4", id1);
+    group->addText(id1, {}, tr::Modify::NO);
+    EXPECT_EQ(u8"id5", group->makeId(u8"id", {}));
+    // Number is taken even if ID is not used
+    EXPECT_EQ(u8"id6", group->makeId(u8"id", {}));
+    // Added by hand
+    group->addText(u8"id10", {}, tr::Modify::NO);
+    EXPECT_EQ(u8"id11", group->makeId(u8"id", {}));
+    // Renamed
+    auto text = group->addText(u8"x", {}, tr::Modify::NO);
+    text->setId(u8"id20", tr::Modify::NO);
+    EXPECT_EQ(u8"id21", group->makeId(u8"id", {}));
+    // Other prefix and suffix
+    EXPECT_EQ(u8"id0.txt", group->makeId(u8"id", u8".txt"));
+    EXPECT_EQ(u8"id1.txt", group->makeId(u8"id", u8".txt"));
+    batch.commit();
+
+    // W/o batch makeId searches again
+    EXPECT_EQ(u8"id21", group->makeId(u8"id", {}));
+    EXPECT_EQ(u8"id0.txt", group->makeId(u8"id", u8".txt"));
+}
+
+
+///
+///  Nested batch does nothing, outer one commits;
+///    project is modified once, on commit
+///
+TEST (Batch, Nested)
+{
+    auto prj = tr::Project::make();
+    auto group = makeGroup(*prj);
+    prj->unmodify(Forced::YES);
+    {
+        tr::Batch outer(prj);
+        {
+            tr::Batch inner(prj);
+            EXPECT_FALSE(inner.isActive());
+            EXPECT_EQ(&outer, prj->activeBatch());
+            addTexts(*group, u8"t", 3);
+            group->addText(u8"m", {}, tr::Modify::YES);
+        }
+        EXPECT_EQ(&outer, prj->activeBatch());
+        EXPECT_FALSE(prj->isModified());
+        group->extractChild(0, tr::Modify::YES);
+        EXPECT_FALSE(prj->isModified());
+    }
+    EXPECT_TRUE(prj->isModified());
+    EXPECT_EQ(3u, prj->stats(tr::StatsMode::CACHED, tr::CascadeDropCache::YES).text.nTotal());
+    expectConsistent(*group);
+
+    // Nothing modified → nothing happens
+    prj->unmodify(Forced::YES);
+    {
+        tr::Batch batch(prj);
+        addTexts(*group, u8"u", 2);
+    }
+    EXPECT_FALSE(prj->isModified());
+}
+
+
+///
+///  Commit throws what modify throws, dtor does not
+///
+TEST (Batch, DtorNoThrow)
+{
+    auto prj = tr::Project::make();
+    auto group = makeGroup(*prj);
+    ThrowingListener listener;
+    prj->setStaticModifyListener(&listener);
+
+    {   tr::Batch batch(prj);
+        group->addText(u8"a", u8"a", tr::Modify::YES);
+        EXPECT_THROW(batch.commit(), std::runtime_error);
+        EXPECT_FALSE(batch.isActive());
+    }
+    EXPECT_TRUE(prj->isModified());
+    prj->setStaticModifyListener(nullptr);
+    prj->unmodify(Forced::NO);
+    prj->setStaticModifyListener(&listener);
+
+    EXPECT_NO_THROW({
+        tr::Batch batch(prj);
+        group->addText(u8"b", u8"b", tr::Modify::YES);
+    });
+    EXPECT_EQ(nullptr, prj->activeBatch());
+    EXPECT_TRUE(prj->isModified());
+    expectConsistent(*group);
+    EXPECT_EQ(2u, prj->stats(tr::StatsMode::CACHED, tr::CascadeDropCache::YES).text.nTotal());
+    prj->setStaticModifyListener(nullptr);
+}
+
+
+///
+///  Clone goes through batch, and gives the same
+///
+TEST (Batch, Clone)
+{
+    auto prj = tr::Project::make();
+    auto group = makeGroup(*prj);
+    addTexts(*group, u8"t", 5);
+    auto sub = group->addGroup(u8"sub", tr::Modify::NO);
+    addTexts(*sub, u8"s", 3);
+
+    auto copy = group->clone(group->file(), nullptr, tr::Modify::YES);
+    ASSERT_TRUE(copy);
+    EXPECT_EQ(nullptr, prj->activeBatch());
+    EXPECT_TRUE(prj->isModified());
+    ASSERT_EQ(group->children.size(), copy->children.size());
+    expectConsistent(*copy);
+    auto copySub = copy->findGroup(u8"sub");
+    ASSERT_TRUE(copySub);
+    expectConsistent(*copySub);
+    EXPECT_EQ(16u, prj->stats(tr::StatsMode::CACHED, tr::CascadeDropCache::YES).text.nTotal());
+}
+
+
+///
+///  Bulk changes with and w/o batch,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (Batch, DISABLED_Benchmark)
+{
+    constexpr size_t N = 20'000;
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    auto run = [](bool wantBatch) {
+        auto prj = tr::Project::make();
+        auto group = makeGroup(*prj);
+        auto sub = group->addGroup(u8"sub", tr::Modify::NO);
+        std::optional<tr::Batch> batch;
+        if (wantBatch)
+            batch.emplace(prj);
+        // Stats are cached, and dropped on every change
+        prj->stats(tr::StatsMode::CACHED, tr::CascadeDropCache::YES);
+        auto start = Clock::now();
+        for (size_t i = 0; i < N; ++i)
+            sub->addText(sub->makeId(u8"id", {}), {}, tr::Modify::YES);
+        if (batch)
+            batch->commit();
+        auto addTime = Ms(Clock::now() - start).count();
+
+        if (wantBatch)
+            batch.emplace(prj);
+        start = Clock::now();
+        // Every 2nd child, from the beginning: the worst case for recache
+        for (size_t i = 0; i < N / 2; ++i)
+            sub->extractChild(i, tr::Modify::YES);
+        if (batch)
+            batch->commit();
+        auto extractTime = Ms(Clock::now() - start).count();
+        EXPECT_EQ(N / 2, sub->children.size());
+        expectConsistent(*sub);
+        return std::pair { addTime, extractTime };
+    };
+    auto [plainAdd, plainExtract] = run(false);
+    auto [batchAdd, batchExtract] = run(true);
+    std::cout << N << " texts\n"
+              << "makeId+add, no batch: " << plainAdd << " ms\n"
+              << "makeId+add, batch: " << batchAdd << " ms\n"
+              << "extract, no batch: " << plainExtract << " ms\n"
+              << "extract, batch: " << batchExtract << " ms\n";
+}
@@ -0,0 +1,319 @@
+// What we test
+#include "u_BinCatalog.h"
+#include "TrFile.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+// Libs
+#include "pugixml.hpp"
+#include "u_Strings.h"
+
+// Project
+#include "TrProject.h"
+
+
+namespace {
+
+    /// Exports file of project into dir, as Build does
+    /// @return  exported file’s name
+    std::filesystem::path build(tr::Project& prj, const std::filesystem::path& dir)
+    {
+        auto info = prj.doBuild(dir);
+        EXPECT_TRUE(info.isOk());
+        return dir / prj.files.at(0)->id.sv();
+    }
+
+    /// Project: one catalog file with groups, nested groups, root texts
+    std::shared_ptr<tr::Project> makeProject(std::u8string_view fileId = u8"lang.ucat")
+    {
+        auto prj = tr::Project::make();
+        auto file = prj->addFile(fileId, tr::Modify::NO);
+        file->info.format = tf::BinCatProto::INST.make();
+        file->addText(u8"root", u8"Root text", tr::Modify::NO);
+        auto menu = file->addGroup(u8"Menu", tr::Modify::NO);
+        menu->addText(u8"Open", u8"Open…", tr::Modify::NO);
+        menu->addText(u8"Save", u8"Save", tr::Modify::NO);
+        menu->addText(u8"Empty", u8"", tr::Modify::NO);
+        auto sub = menu->addGroup(u8"Recent", tr::Modify::NO);
+        sub->addText(u8"Clear", u8"Clear list\nof files", tr::Modify::NO);
+        return prj;
+    }
+
+    /// Records what format loads, as “Group.Group.id=text”
+    class RecordingLoader final : public tf::Loader
+    {
+    public:
+        SafeVector<std::u8string> texts;
+
+        void goToRoot() override { group.clear(); }
+        bool goUp() override { return false; }
+        void goToGroupRel(std::u8string_view groupId) override
+            { group += groupId; group += '.'; }
+        void addText(std::u8string_view textId,
+                     std::u8string_view original,
+                     std::u8string_view) override
+            { texts.push_back(str::cat(group, textId, u8"=", original)); }
+    private:
+        std::u8string group;
+    };
+
+}   // anon namespace
+
+
+///
+///  Every ID is found, the rest is not
+///
+TEST (BinCatalog, Lookup)
+{
+    ut::TempDir dir("utranslator_test_bincat");
+    auto fname = build(*makeProject(), dir.path);
+
+    bincat::Catalog cat(fname);
+    ASSERT_TRUE(cat.isOpen());
+    EXPECT_EQ(5u, cat.size());
+    EXPECT_EQ(u8"Root text", cat.find(u8"root"));
+    EXPECT_EQ(u8"Open…", cat.find(u8"Menu.Open"));
+    EXPECT_EQ(u8"Save", cat.find(u8"Menu.Save"));
+    EXPECT_EQ(u8"", cat.find(u8"Menu.Empty"));
+    EXPECT_EQ(u8"Clear list\nof files", cat.find(u8"Menu.Recent.Clear"));
+    // Text is null-terminated
+    EXPECT_EQ(0, cat.find(u8"Menu.Save")->data()[4]);
+
+    EXPECT_FALSE(cat.find(u8"Open"));
+    EXPECT_FALSE(cat.find(u8"Menu"));
+    EXPECT_FALSE(cat.find(u8"Menu.Open."));
+    EXPECT_FALSE(cat.find(u8""));
+
+    // Export order
+    EXPECT_EQ(u8"root", cat.at(0).id);
+    EXPECT_EQ(u8"Menu.Recent.Clear", cat.at(4).id);
+    EXPECT_EQ(u8"", cat.at(5).id);
+}
+
+
+///
+///  Many IDs: hash is perfect and minimal, everything is found
+///
+TEST (BinCatalog, Many)
+{
+    constexpr unsigned N = 20'000;
+    ut::TempDir dir("utranslator_test_bincat");
+    auto prj = tr::Project::make();
+    auto file = prj->addFile(u8"lang.ucat", tr::Modify::NO);
+    tf::MultitierStyle multitier;
+    multitier.separator = u8"::";
+    auto format = std::make_unique<tf::BinCat>();
+    format->multitier = multitier;
+    file->info.format = std::move(format);
+    for (unsigned i = 0; i < N; ++i) {
+        auto s = str::toU8(std::to_string(i));
+        auto group = (i % 50 == 0) ? file->addGroup(u8"g" + s, tr::Modify::NO)
+                                   : file->findGroup(u8"g" + str::toU8(std::to_string(i / 50 * 50)));
+        group->addText(u8"t" + s, u8"Text " + s, tr::Modify::NO);
+    }
+    auto fname = build(*prj, dir.path);
+
+    bincat::Catalog cat(fname);
+    ASSERT_EQ(N, cat.size());
+    for (unsigned i = 0; i < N; ++i) {
+        auto s = str::toU8(std::to_string(i));
+        auto id = str::cat(u8"g", str::toU8(std::to_string(i / 50 * 50)), u8"::t", s);
+        ASSERT_EQ(u8"Text " + s, cat.find(id)) << str::toSv(id);
+        ASSERT_FALSE(cat.find(id + u8"x"));
+    }
+}
+
+
+///
+///  Import brings the same tree, query is translate-with-lockit’s way
+///
+TEST (BinCatalog, ImportQuery)
+{
+    ut::TempDir dir("utranslator_test_bincat");
+    auto fname = build(*makeProject(), dir.path);
+    tf::BinCat format;
+
+    RecordingLoader loader;
+    format.doImport(loader, fname);
+    SafeVector<std::u8string> expected {
+        u8"root=Root text",
+        u8"Menu.Open=Open…",
+        u8"Menu.Save=Save",
+        u8"Menu.Empty=",
+        u8"Menu.Recent.Clear=Clear list\nof files" };
+    EXPECT_EQ(expected, loader.texts);
+
+    auto que = format.doImportAsQuery(fname);
+    SafeVector<std::u8string_view> ids { u8"Menu", u8"Recent", u8"Clear" };
+    auto r = que->query(ids);
+    ASSERT_TRUE(r);
+    EXPECT_EQ(u8"Clear list\nof files", r->text);
+    ids = { u8"root" };
+    EXPECT_EQ(u8"Root text", que->query(ids)->text);
+    ids = { u8"Menu", u8"Clear" };
+    EXPECT_FALSE(que->query(ids));
+    ids = {};
+    EXPECT_FALSE(que->query(ids));
+}
+
+
+///
+///  Empty catalog is OK; garbage is not opened, or found nothing in
+///
+TEST (BinCatalog, EmptyGarbage)
+{
+    ut::TempDir dir("utranslator_test_bincat");
+    auto prj = tr::Project::make();
+    prj->addFile(u8"empty.ucat", tr::Modify::NO)->info.format = tf::BinCatProto::INST.make();
+    auto fnEmpty = build(*prj, dir.path);
+    bincat::Catalog cat(fnEmpty);
+    EXPECT_TRUE(cat.isOpen());
+    EXPECT_EQ(0u, cat.size());
+    EXPECT_FALSE(cat.find(u8"a"));
+
+    auto fname = build(*makeProject(), dir.path);
+    auto data = ut::readFile(fname);
+    auto bad = dir.path / "bad.ucat";
+    tf::BinCat format;
+
+    // Torn
+    ut::writeFile(bad, std::string_view(data).substr(0, data.size() - 1));
+    EXPECT_FALSE(cat.open(bad));
+    EXPECT_FALSE(cat.find(u8"root"));
+    RecordingLoader loader;
+    EXPECT_THROW(format.doImport(loader, bad), std::runtime_error);
+    EXPECT_THROW(format.doImportAsQuery(bad), std::runtime_error);
+    EXPECT_THROW(format.doImportAsQuery(dir.path / "missing.ucat"), std::runtime_error);
+
+    ut::writeFile(bad, "garbage");
+    EXPECT_FALSE(cat.open(bad));
+
+    // Tables are broken → no crash, nothing or something found
+    for (size_t i = sizeof(bincat::Header); i < data.size(); i += 3)
+        data[i] = '\xFF';
+    ut::writeFile(bad, data);
+    ASSERT_TRUE(cat.open(bad));
+    EXPECT_FALSE(cat.find(u8"Menu.Open"));
+    EXPECT_EQ(u8"", cat.at(1).id);
+    EXPECT_THROW(format.doImport(loader, bad), std::runtime_error);
+}
+
+
+///
+///  Settings are saved, separator is banned in IDs
+///
+TEST (BinCatalog, Settings)
+{
+    tf::BinCat format;
+    format.multitier.separator = u8"/";
+    EXPECT_EQ("/", format.bannedIdChars());
+
+    pugi::xml_document doc;
+    auto node = doc.append_child("format");
+    format.save(node);
+    tf::BinCat loaded;
+    loaded.load(node);
+    EXPECT_EQ(u8"/", loaded.multitier.separator);
+    EXPECT_EQ(&tf::BinCatProto::INST, tf::allProtos[tf::I_BINCAT]);
+}
+
+
+///
+///  Startup and lookup: INI query vs. catalog,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (BinCatalog, DISABLED_Benchmark)
+{
+    constexpr unsigned N_TEXTS = 20'000;
+    constexpr unsigned N_LOOKUPS = 1'000'000;
+    constexpr int N_RUNS = 5;
+    ut::TempDir dir("utranslator_test_bincat");
+    auto prj = tr::Project::make();
+    auto fileCat = prj->addFile(u8"lang.ucat", tr::Modify::NO);
+    fileCat->info.format = tf::BinCatProto::INST.make();
+    auto fileIni = prj->addFile(u8"lang.ini", tr::Modify::NO);
+    auto ini = std::make_unique<tf::Ini>();
+    ini->textEscape.space = escape::SpaceMode::DELIMITED;
+    fileIni->info.format = std::move(ini);
+    SafeVector<SafeVector<std::u8string>> ids;
+    for (unsigned i = 0; i < N_TEXTS; ++i) {
+        auto s = str::toU8(std::to_string(i));
+        auto gs = str::toU8(std::to_string(i / 40 * 40));
+        auto text = u8"Open file " + s + u8"? “Cancel” to return.";
+        for (auto& file : { fileCat, fileIni }) {
+            auto group = (i % 40 == 0) ? file->addGroup(u8"Group" + s, tr::Modify::NO)
+                                       : file->findGroup(u8"Group" + gs);
+            group->addText(u8"Text" + s, text, tr::Modify::NO);
+        }
+        ids.push_back({ u8"Group" + gs, u8"Text" + s });
+    }
+    auto info = prj->doBuild(dir.path);
+    ASSERT_TRUE(info.isOk());
+    auto fnCat = dir.path / "lang.ucat";
+    auto fnIni = dir.path / "lang.ini";
+
+    std::mt19937 rng(42);
+    SafeVector<unsigned> order(N_LOOKUPS);
+    for (auto& v : order)
+        v = rng() % N_TEXTS;
+    SafeVector<std::u8string> joined;
+    for (auto& v : ids)
+        joined.push_back(str::cat(v[0], u8".", v[1]));
+
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    auto best = [](auto&& body) {
+        double r = 1e100;
+        for (int i = 0; i < N_RUNS; ++i) {
+            auto start = Clock::now();
+            body();
+            r = std::min(r, Ms(Clock::now() - start).count());
+        }
+        return r;
+    };
+
+    // Startup
+    auto iniOpen = best([&] { fileIni->info.format->doImportAsQuery(fnIni); });
+    auto catOpen = best([&] { bincat::Catalog cat(fnCat); ASSERT_TRUE(cat.isOpen()); });
+
+    // Lookup
+    auto iniQuery = fileIni->info.format->doImportAsQuery(fnIni);
+    auto catQuery = fileCat->info.format->doImportAsQuery(fnCat);
+    bincat::Catalog cat(fnCat);
+    size_t nFound = 0;
+    auto lookupQuery = [&](tf::FormatQueryObj& que) {
+        return best([&] {
+            SafeVector<std::u8string_view> q(2);
+            for (auto i : order) {
+                q[0] = ids[i][0];
+                q[1] = ids[i][1];
+                nFound += que.query(q).has_value();
+            }
+        });
+    };
+    auto iniLookup = lookupQuery(*iniQuery);
+    auto catQueryLookup = lookupQuery(*catQuery);
+    auto catLookup = best([&] {
+        for (auto i : order)
+            nFound += cat.find(joined[i]).has_value();
+    });
+    EXPECT_EQ(N_LOOKUPS * N_RUNS * 3, nFound);
+
+    auto ns = [](double ms) { return ms * 1e6 / N_LOOKUPS; };
+    std::cout << N_TEXTS << " texts: INI " << std::filesystem::file_size(fnIni)
+              << " bytes, catalog " << std::filesystem::file_size(fnCat) << " bytes\n"
+              << "Startup: INI query " << iniOpen << " ms, catalog " << catOpen << " ms\n"
+              << "Lookup: INI query " << ns(iniLookup) << " ns, catalog query "
+              << ns(catQueryLookup) << " ns, catalog " << ns(catLookup) << " ns\n";
+}
@@ -0,0 +1,251 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <filesystem>
+#include <map>
+
+// Project
+#include "TrFile.h"
+
+
+namespace {
+
+    std::u8string numbered(std::u8string_view prefix, unsigned n)
+        { return std::u8string{prefix} + str::toU8(std::to_string(n)); }
+
+    /// Translation: INI files with different settings, and a catalog
+    std::shared_ptr<tr::Project> makeProject()
+    {
+        constexpr unsigned N_INI = 8;
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        prj->info.orig.lang = "en";
+        prj->info.transl.lang = "ru";
+        for (unsigned i = 0; i < N_INI; ++i) {
+            auto file = prj->addFile(numbered(u8"file", i) + u8".ini", tr::Modify::NO);
+            auto ini = std::make_unique<tf::Ini>();
+            ini->textFormat.writeBom = (i % 2 != 0);
+            ini->textEscape.space = (i % 3 == 0)
+                    ? escape::SpaceMode::DELIMITED : escape::SpaceMode::BARE;
+            file->info.format = std::move(ini);
+            for (unsigned j = 0; j < 5; ++j) {
+                auto group = file->addGroup(numbered(u8"g", j), tr::Modify::NO);
+                for (unsigned k = 0; k < 100; ++k) {
+                    auto text = group->addText(numbered(u8"t", k),
+                            numbered(u8" Original\nline #", k), tr::Modify::NO);
+                    if (k % 3 != 0)
+                        text->tr.translation = numbered(u8"Перевод #", k);
+                }
+            }
+        }
+        auto cat = prj->addFile(u8"lang.ucat", tr::Modify::NO);
+        cat->info.format = tf::BinCatProto::INST.make();
+        cat->addText(u8"t", u8"Text", tr::Modify::NO);
+        return prj;
+    }
+
+    ///  Format that updates existing file: keeps its 1st line,
+    ///    then writes “id=text” lines
+    class InPlaceProto final : public tf::FormatProto
+    {
+    public:
+        Flags<tf::Fcap> caps() const noexcept override
+            { return tf::Fcap::EXPORT | tf::Fcap::NEEDS_FILE; }
+        Flags<tf::Usfg> workingSets() const noexcept override { return {}; }
+        std::unique_ptr<tf::FileFormat> make() const override;
+        std::u8string_view locName() const override { return u8"In place"; }
+        constexpr std::string_view techName() const noexcept override { return "inplace"; }
+        std::u8string_view locDescription() const override { return {}; }
+        std::u8string_view locSoftware() const override { return {}; }
+        std::u8string_view locIdType() const override { return {}; }
+        filedlg::Filter fileFilter() const override { return {}; }
+        static const InPlaceProto INST;
+    };
+
+    class InPlace final : public tf::FileFormat
+    {
+    public:
+        void doExport(
+                tf::Walker& walker,
+                const std::filesystem::path& fnExisting,
+                const std::filesystem::path& fnExported) override
+        {
+            auto old = ut::readFile(fnExisting);
+            auto header = old.substr(0, old.find('\n'));
+            if (header.empty())
+                throw std::logic_error("No existing file");
+            std::string r = header + '\n';
+            while (auto& q = walker.nextText()) {
+                r += str::toSv(q.textId());
+                r += '=';
+                r += str::toSv(q.text);
+                r += '\n';
+            }
+            ut::writeFile(fnExported, r);
+        }
+        const InPlaceProto& proto() const override { return InPlaceProto::INST; }
+        std::unique_ptr<tf::FileFormat> clone() override
+            { return std::make_unique<InPlace>(*this); }
+        tr::WalkOrder walkOrder() const override { return tr::WalkOrder::EXACT; }
+        void save(pugi::xml_node&) const override {}
+        void load(const pugi::xml_node&) override {}
+    };
+
+    const InPlaceProto InPlaceProto::INST;
+
+    std::unique_ptr<tf::FileFormat> InPlaceProto::make() const
+        { return std::make_unique<InPlace>(); }
+
+    /// @return  names of files in dir, and their contents
+    std::map<std::filesystem::path, std::string> readDir(const std::filesystem::path& dir)
+    {
+        std::map<std::filesystem::path, std::string> r;
+        for (auto& entry : std::filesystem::directory_iterator(dir))
+            r[entry.path().filename()] = ut::readFile(entry.path());
+        return r;
+    }
+
+}   // anon namespace
+
+
+///
+///  Parallel build gives the same files as serial one
+///
+TEST (Build, Parallel)
+{
+    ut::TempDir dir("utranslator_test_build");
+    auto prj = makeProject();
+    prj->save(dir.path / "prj.utran");
+
+    auto serial = prj->doBuild(dir.path / "1", 1);
+    EXPECT_TRUE(serial.isOk());
+    EXPECT_EQ(prj->files.size(), serial.nExported);
+    auto expected = readDir(dir.path / "1");
+    EXPECT_EQ(prj->files.size(), expected.size());
+
+    for (unsigned nJobs : { 2u, 4u, 0u }) {
+        SCOPED_TRACE(nJobs);
+        auto subdir = dir.path / numbered(u8"jobs", nJobs);
+        auto parallel = prj->doBuild(subdir, nJobs);
+        EXPECT_TRUE(parallel.isOk());
+        EXPECT_EQ(serial.nExported, parallel.nExported);
+        EXPECT_EQ(expected, readDir(subdir));
+    }
+}
+
+
+///
+///  Errors of some files do not stop others
+///
+TEST (Build, Errors)
+{
+    ut::TempDir dir("utranslator_test_build");
+    auto prj = makeProject();
+    prj->save(dir.path / "prj.utran");
+    // Directory in place of file
+    std::filesystem::create_directories(dir.path / "out" / "file3.ini");
+
+    auto info = prj->doBuild(dir.path / "out", 4);
+    ASSERT_EQ(1u, info.errors.size());
+    EXPECT_EQ(u8"file3.ini", info.errors[0].fileId);
+    EXPECT_EQ(prj->files.size() - 1, info.nExported);
+    EXPECT_TRUE(std::filesystem::is_regular_file(dir.path / "out" / "file4.ini"));
+}
+
+
+///
+///  Incremental build skips what did not change
+///
+TEST (Build, Incremental)
+{
+    ut::TempDir dir("utranslator_test_build");
+    auto prj = makeProject();
+    prj->save(dir.path / "prj.utran");
+    auto out = dir.path / "out";
+    auto nFiles = prj->files.size();
+    auto build = [&] {
+        auto r = prj->doBuild(out, 2, tr::Incremental::YES);
+        EXPECT_TRUE(r.isOk());
+        EXPECT_EQ(nFiles, r.nExported + r.nSkipped);
+        return r.nExported;
+    };
+
+    EXPECT_EQ(nFiles, build());
+    EXPECT_TRUE(std::filesystem::is_regular_file(out / "prj.utbuild"));
+    EXPECT_EQ(0u, build());
+
+    // Text
+    prj->files[2]->findGroup(u8"g1")->findText(u8"t1")->tr.translation = u8"New";
+    EXPECT_EQ(1u, build());
+    EXPECT_EQ(0u, build());
+
+    // Format settings
+    dynamic_cast<tf::Ini&>(*prj->files[5]->info.format).textFormat.writeBom ^= true;
+    EXPECT_EQ(1u, build());
+
+    // Exported file is gone
+    std::filesystem::remove(out / "file6.ini");
+    EXPECT_EQ(1u, build());
+    EXPECT_EQ(0u, build());
+
+    // Pseudo-localization
+    prj->info.transl.pseudoloc = tr::PrjInfo::Transl::Pseudoloc::DFLT;
+    EXPECT_EQ(nFiles, build());
+    EXPECT_EQ(0u, build());
+
+    // Channel
+    prj->info.type = tr::PrjType::ORIGINAL;
+    EXPECT_EQ(nFiles, build());
+    EXPECT_EQ(0u, build());
+
+    // Non-incremental build ignores manifest
+    EXPECT_EQ(nFiles, prj->doBuild(out, 2).nExported);
+}
+
+
+///
+///  Format that updates existing file in place:
+///    export changes the file, still skipped next time
+///
+TEST (Build, IncrementalInPlace)
+{
+    ut::TempDir dir("utranslator_test_build");
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::ORIGINAL;
+    auto file = prj->addFile(u8"form.txt", tr::Modify::NO);
+    file->info.format = InPlaceProto::INST.make();
+    file->addText(u8"t1", u8"One", tr::Modify::NO);
+    prj->save(dir.path / "prj.uorig");
+    // Bare name, no dest. dir → build-prj/form.txt is both read and written
+    auto fname = dir.path / "build-prj" / "form.txt";
+    std::filesystem::create_directories(fname.parent_path());
+    ut::writeFile(fname, "Header\nold=Old\n");
+
+    auto build = [&] {
+        auto r = prj->doBuild({}, 1, tr::Incremental::YES);
+        EXPECT_TRUE(r.isOk());
+        return r.nExported;
+    };
+    EXPECT_EQ(1u, build());
+    EXPECT_EQ("Header\nt1=One\n", ut::readFile(fname));
+    EXPECT_EQ(0u, build());
+
+    // Someone edited the file
+    ut::writeFile(fname, "Other header\n");
+    EXPECT_EQ(1u, build());
+    EXPECT_EQ("Other header\nt1=One\n", ut::readFile(fname));
+    EXPECT_EQ(0u, build());
+
+    // Text
+    file->findText(u8"t1")->tr.original = u8"Uno";
+    EXPECT_EQ(1u, build());
+    EXPECT_EQ("Other header\nt1=Uno\n", ut::readFile(fname));
+    EXPECT_EQ(0u, build());
+}
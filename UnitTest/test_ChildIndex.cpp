@@ -0,0 +1,140 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <chrono>
+#include <iostream>
+
+
+namespace {
+
+    std::u8string numbered(std::u8string_view prefix, size_t n)
+        { return std::u8string{prefix} + str::toU8(std::to_string(n)); }
+
+    std::shared_ptr<tr::Group> makeGroup(tr::Project& prj)
+    {
+        auto file = prj.addFile(u8"f", tr::Modify::NO);
+        return file->addGroup(u8"g", tr::Modify::NO);
+    }
+
+    /// What findText did before ID index
+    tr::Text* linearFindText(tr::VirtualGroup& group, std::u8string_view id)
+    {
+        for (auto& v : group.children) {
+            if (v->objType() == tr::ObjType::TEXT && v->id == id)
+                return static_cast<tr::Text*>(v.get());
+        }
+        return nullptr;
+    }
+
+}   // anon namespace
+
+
+///
+///  Lookup follows adding, renaming and extracting
+///
+TEST (ChildIndex, Simple)
+{
+    auto prj = tr::Project::make();
+    auto group = makeGroup(*prj);
+    auto t1 = group->addText(u8"a", {}, tr::Modify::NO);
+    auto g1 = group->addGroup(u8"a", tr::Modify::NO);
+    auto t2 = group->addText(u8"b", {}, tr::Modify::NO);
+    EXPECT_EQ(t1, group->findText(u8"a"));
+    EXPECT_EQ(g1, group->findGroup(u8"a"));
+    EXPECT_EQ(t2, group->findText(u8"b"));
+    EXPECT_FALSE(group->findGroup(u8"b"));
+    EXPECT_FALSE(group->findText(u8"c"));
+
+    t2->setId(u8"c", tr::Modify::NO);
+    EXPECT_FALSE(group->findText(u8"b"));
+    EXPECT_EQ(t2, group->findText(u8"c"));
+
+    group->extractChild(0, tr::Modify::NO);
+    EXPECT_FALSE(group->findText(u8"a"));
+    EXPECT_EQ(g1, group->findGroup(u8"a"));
+    EXPECT_EQ(t2, group->findText(u8"c"));
+}
+
+
+///
+///  Repeating IDs: the first child wins, as with linear search
+///
+TEST (ChildIndex, Repeating)
+{
+    auto prj = tr::Project::make();
+    auto group = makeGroup(*prj);
+    auto t1 = group->addText(u8"a", {}, tr::Modify::NO);
+    auto t2 = group->addText(u8"a", {}, tr::Modify::NO);
+    EXPECT_EQ(t1, group->findText(u8"a"));
+
+    group->extractChild(0, tr::Modify::NO);
+    EXPECT_EQ(t2, group->findText(u8"a"));
+}
+
+
+///
+///  100k texts in one group: lookup and update,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (ChildIndex, DISABLED_Benchmark)
+{
+    constexpr size_t N = 100'000;
+    constexpr size_t N_LINEAR = 1'000;
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    auto makeOrig = [](bool isNew) {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::ORIGINAL;
+        auto group = makeGroup(*prj);
+        for (size_t i = 0; i < N; ++i) {
+            auto orig = numbered(u8"Original #", i);
+            if (isNew && i % 20 == 3)
+                orig += u8" changed";
+            group->addText(numbered(u8"t", i), orig, tr::Modify::NO);
+        }
+        return prj;
+    };
+    auto orig = makeOrig(false);
+    auto group = orig->findFile(u8"f")->findGroup(u8"g");
+    SafeVector<std::u8string> ids;
+    for (size_t i = 0; i < N; ++i)
+        ids.push_back(numbered(u8"t", (i * 7919) % N));
+
+    // Index is built on the first lookup
+    auto start = Clock::now();
+    size_t nFound = 0;
+    for (auto& id : ids)
+        nFound += static_cast<bool>(group->findText(id));
+    auto indexTime = Ms(Clock::now() - start).count();
+    EXPECT_EQ(N, nFound);
+
+    start = Clock::now();
+    nFound = 0;
+    for (size_t i = 0; i < N_LINEAR; ++i)
+        nFound += static_cast<bool>(linearFindText(*group, ids[i]));
+    auto linearTime = Ms(Clock::now() - start).count() * (N / N_LINEAR);
+    EXPECT_EQ(N_LINEAR, nFound);
+
+    // Translation updated from old original, then from new one
+    auto newOrig = makeOrig(true);
+    auto transl = tr::Project::make();
+    transl->info.type = tr::PrjType::FULL_TRANSL;
+    start = Clock::now();
+    transl->updateData(tr::TrashMode::FILL, orig.get());
+    auto update1 = Ms(Clock::now() - start).count();
+    start = Clock::now();
+    auto info = transl->updateData(tr::TrashMode::FILL, newOrig.get());
+    auto update2 = Ms(Clock::now() - start).count();
+    EXPECT_EQ(N / 20, info.changed.nTotal());
+
+    std::cout << N << " texts in one group\n"
+              << "Lookup of every text, index: " << indexTime << " ms\n"
+              << "Lookup of every text, linear (extrapolated): " << linearTime << " ms\n"
+              << "Update, new translation: " << update1 << " ms\n"
+              << "Update, 5% originals changed: " << update2 << " ms\n";
+}
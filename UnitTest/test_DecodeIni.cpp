@@ -46,7 +46,7 @@ namespace {
         s.push_back('\n');
     }
 
-    std::u8string runTest(std::string_view x)
+    std::u8string runStream(std::string_view x)
     {
         MyCb r;
         std::istringstream is(std::string{x});
@@ -54,6 +54,24 @@ namespace {
         return r.s;
     }
 
+    std::u8string runBuffer(std::string_view x)
+    {
+        MyCb r;
+        // Copy: nothing should go beyond the buffer
+        std::u8string data(x.begin(), x.end());
+        decode::ini(data, r);
+        return r.s;
+    }
+
+    /// Runs both stream and buffer versions, they should be the same
+    std::u8string runTest(std::string_view x)
+    {
+        auto r1 = runStream(x);
+        auto r2 = runBuffer(x);
+        EXPECT_EQ(r1, r2);
+        return r1;
+    }
+
 }   // anon namespace
 
 
@@ -78,7 +96,10 @@ TEST (DecodeIni, BadBom)
 {
     std::string_view ini = "\xFF\xFE" "Alpha=  Bravo  ";
     EXPECT_THROW(
-        { runTest(ini); },
+        { runStream(ini); },
+        std::logic_error);
+    EXPECT_THROW(
+        { runBuffer(ini); },
         std::logic_error);
 }
 
@@ -149,3 +170,24 @@ TEST (DecodeIni, TrimGroup)
               "g:G3\n"
               "g:G4]-\n", r);
 }
+
+
+///
+///  CR LF, trailing LF does not give empty line
+///
+TEST (DecodeIni, CrLf)
+{
+    std::string_view ini =
+            "[G1]\r\n"
+            "1=2\r\n"
+            "\r\n"
+            ";c\r\n"
+            "3=4 \r\n";
+    auto r = runTest(ini);
+    EXPECT_EQ(
+            u8"g:G1\n"
+              "v:1=2\n"
+              "e\n"
+              "c:c\n"
+              "v:3=4 \n", r);
+}
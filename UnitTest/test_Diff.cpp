@@ -0,0 +1,265 @@
+// What we test
+#include "u_Diff.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <chrono>
+#include <iostream>
+#include <random>
+
+
+namespace {
+
+    using Rng = std::mt19937;
+
+    unsigned upTo(Rng& rng, unsigned n)
+        { return std::uniform_int_distribution<unsigned>(0, n)(rng); }
+
+    std::u32string randomString(Rng& rng, size_t length, std::u32string_view alphabet)
+    {
+        std::u32string r;
+        for (size_t i = 0; i < length; ++i)
+            r += alphabet[upTo(rng, alphabet.length() - 1)];
+        return r;
+    }
+
+    /// Some random dels, inses and changes
+    std::u32string randomEdit(Rng& rng, std::u32string_view x, unsigned nEdits,
+                              std::u32string_view alphabet)
+    {
+        std::u32string r { x };
+        for (unsigned i = 0; i < nEdits; ++i) {
+            auto pos = upTo(rng, r.length());
+            auto len = upTo(rng, 5);
+            switch (upTo(rng, 2)) {
+            case 0: r.erase(pos, len); break;
+            case 1: r.insert(pos, randomString(rng, len + 1, alphabet)); break;
+            default: r.replace(pos, len, randomString(rng, len, alphabet));
+            }
+        }
+        return r;
+    }
+
+    struct ScriptInfo {
+        size_t nCommon = 0, nDel = 0, nIns = 0;
+    };
+
+    /// Checks that script turns a into b, and common/changed interleave
+    ScriptInfo checkScript(const dif::EditScript& es,
+                           std::u32string_view a, std::u32string_view b)
+    {
+        ScriptInfo r;
+        std::u32string ra, rb;
+        for (size_t i = 0; i < es.size(); ++i) {
+            auto& v = es[i];
+            if (i != 0) {
+                EXPECT_NE(es[i - 1].isCommon, v.isCommon) << "Pair " << i;
+            }
+            ra += v.del;
+            if (v.isCommon) {
+                // Common: del, sometimes repeated in ins
+                if (!v.ins.empty()) {
+                    EXPECT_EQ(v.del, v.ins) << "Pair " << i;
+                }
+                rb += v.del;
+                r.nCommon += v.del.length();
+            } else {
+                EXPECT_FALSE(v.del.empty() && v.ins.empty()) << "Pair " << i;
+                rb += v.ins;
+                r.nDel += v.del.length();
+                r.nIns += v.ins.length();
+            }
+        }
+        EXPECT_EQ(a, ra);
+        EXPECT_EQ(b, rb);
+        return r;
+    }
+
+    dif::EditScript dpScript(std::u32string_view a, std::u32string_view b)
+    {
+        dif::EditScript r;
+        dif::detail::appendDpScript(r, a, b);
+        return r;
+    }
+
+    dif::EditScript myersScript(std::u32string_view a, std::u32string_view b)
+    {
+        dif::EditScript r;
+        dif::detail::appendMyersScript(r, a, b);
+        return r;
+    }
+
+    constexpr std::u32string_view ABC = U"abc";
+    constexpr std::u32string_view TEXT_CHARS = U"abcdefghij   ,.";
+
+}   // anon namespace
+
+
+///
+///  Short strings: weighted DP and Myers give the same texts.
+///  Both stick small common spans to changes, so one case may go either way;
+///  in total Myers should change no more than DP
+///
+TEST (Diff, ShortDpMyers)
+{
+    size_t nDpChanged = 0, nMyersChanged = 0;
+    for (unsigned seed = 1; seed <= 2000; ++seed) {
+        SCOPED_TRACE(seed);
+        Rng rng(seed);
+        auto a = randomString(rng, upTo(rng, 20), ABC);
+        auto b = randomEdit(rng, a, 1 + upTo(rng, 3), ABC);
+        auto dp = checkScript(dpScript(a, b), a, b);
+        auto myers = checkScript(myersScript(a, b), a, b);
+        nDpChanged += dp.nDel + dp.nIns;
+        nMyersChanged += myers.nDel + myers.nIns;
+    }
+    EXPECT_LE(nMyersChanged, nDpChanged);
+}
+
+
+///
+///  One changed span: the same script
+///
+TEST (Diff, ShortSameScript)
+{
+    auto check = [](std::u32string_view a, std::u32string_view b) {
+        auto dp = dpScript(a, b);
+        auto myers = myersScript(a, b);
+        ASSERT_EQ(dp.size(), myers.size());
+        for (size_t i = 0; i < dp.size(); ++i) {
+            EXPECT_EQ(dp[i].isCommon, myers[i].isCommon);
+            EXPECT_EQ(dp[i].del, myers[i].del);
+            EXPECT_EQ(dp[i].ins, myers[i].ins);
+        }
+    };
+    check(U"Alpha", U"Alpha Bravo");
+    check(U"Alpha Bravo", U"Bravo");
+    check(U"Alpha Bravo Charlie", U"Alpha Delta Charlie");
+    check(U"Alpha Bravo", U"Alpha Charlie Bravo");
+    check(U"", U"Alpha");
+    check(U"Alpha", U"");
+}
+
+
+///
+///  Long strings go to Myers, script is still right
+///
+TEST (Diff, LongValid)
+{
+    for (unsigned seed = 1; seed <= 20; ++seed) {
+        SCOPED_TRACE(seed);
+        Rng rng(seed);
+        auto a = randomString(rng, 5000 + upTo(rng, 20000), TEXT_CHARS);
+        auto b = randomEdit(rng, a, upTo(rng, 500), TEXT_CHARS);
+        checkScript(dif::editScript(a, b), a, b);
+        checkScript(dif::editScript(a, b, dif::Granularity::WORD), a, b);
+    }
+    // Totally unrelated
+    Rng rng(1);
+    auto a = randomString(rng, 20000, ABC);
+    auto b = randomString(rng, 30000, ABC);
+    ASSERT_LT(dif::DP_MAX_CELLS, a.length() * b.length());
+    checkScript(dif::editScript(a, b), a, b);
+}
+
+
+///
+///  Below 2×MYERS_MIN_COST script is minimal, above it’s just right
+///
+TEST (Diff, MyersCutoff)
+{
+    // All chars unique → every edit costs the same
+    constexpr size_t N = 40000;
+    std::u32string a;
+    for (size_t i = 0; i < N; ++i)
+        a += static_cast<char32_t>(0x10000 + i);
+    // k chars deleted, k others inserted, 8 chars apart
+    auto edit = [&a](size_t k) {
+        std::u32string b;
+        for (size_t i = 0; i < N; ++i) {
+            if (i % 8 == 0 && i / 8 < k) {
+                if (i % 16 == 0) {
+                    b += static_cast<char32_t>(0x20000 + i);
+                    b += a[i];
+                }   // else deleted
+            } else {
+                b += a[i];
+            }
+        }
+        return b;
+    };
+    constexpr size_t K_MINIMAL = dif::MYERS_MIN_COST * 2 - 2;
+    auto b = edit(K_MINIMAL);
+    auto r = checkScript(myersScript(a, b), a, b);
+    EXPECT_EQ(K_MINIMAL / 2, r.nDel);
+    EXPECT_EQ(K_MINIMAL / 2, r.nIns);
+    EXPECT_EQ(N - K_MINIMAL / 2, r.nCommon);
+
+    // Way above: not necessarily minimal, still right
+    constexpr size_t K_BIG = dif::MYERS_MIN_COST * 16;
+    b = edit(K_BIG);
+    r = checkScript(myersScript(a, b), a, b);
+    EXPECT_LE(K_BIG / 2, r.nDel);
+    EXPECT_GE(K_BIG, r.nDel);
+}
+
+
+///
+///  Words differ as a whole
+///
+TEST (Diff, Words)
+{
+    std::u32string_view a = U"The quick brown fox jumps";
+    std::u32string_view b = U"The quick bright fox jumped";
+    auto es = dif::editScript(a, b, dif::Granularity::WORD);
+    checkScript(es, a, b);
+    ASSERT_EQ(4u, es.size());
+    EXPECT_EQ(U"The quick ", es[0].del);
+    EXPECT_EQ(U"brown", es[1].del);
+    EXPECT_EQ(U"bright", es[1].ins);
+    EXPECT_EQ(U" fox ", es[2].del);
+    EXPECT_EQ(U"jumps", es[3].del);
+    EXPECT_EQ(U"jumped", es[3].ins);
+}
+
+
+///
+///  Long texts, DP vs Myers, chars vs words,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (Diff, DISABLED_Benchmark)
+{
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    auto time = [](auto body) {
+        auto start = Clock::now();
+        body();
+        return Ms(Clock::now() - start).count();
+    };
+
+    Rng rng(1);
+    {
+        auto a = randomString(rng, 3000, TEXT_CHARS);
+        auto b = randomEdit(rng, a, 50, TEXT_CHARS);
+        auto split = dif::simpleSplit(a, b);
+        auto tDp = time([&] { dpScript(split.aMid, split.bMid); });
+        auto tMyers = time([&] { myersScript(split.aMid, split.bMid); });
+        std::cout << "n=3k, 50 edits: DP " << tDp << " ms, Myers " << tMyers << " ms\n";
+    }
+    struct Case { size_t n; unsigned nEdits; };
+    for (auto [n, nEdits] : { Case{ 10'000, 50 }, Case{ 30'000, 500 }, Case{ 100'000, 500 } }) {
+        auto a = randomString(rng, n, TEXT_CHARS);
+        auto b = randomEdit(rng, a, nEdits, TEXT_CHARS);
+        auto tChar = time([&] { dif::editScript(a, b); });
+        auto tWord = time([&] { dif::editScript(a, b, dif::Granularity::WORD); });
+        std::cout << "n=" << n / 1000 << "k, " << nEdits << " edits: "
+                  << tChar << " ms, words " << tWord << " ms\n";
+    }
+    auto a = randomString(rng, 100'000, TEXT_CHARS);
+    auto b = randomString(rng, 100'000, TEXT_CHARS);
+    auto tChar = time([&] { dif::editScript(a, b); });
+    auto tWord = time([&] { dif::editScript(a, b, dif::Granularity::WORD); });
+    std::cout << "n=100k, unrelated: " << tChar << " ms, words " << tWord << " ms\n";
+}
@@ -0,0 +1,247 @@
+// What we test
+#include "TrWrappers.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <chrono>
+#include <iostream>
+
+// Libs
+#include "Mojibake/mojibake.h"
+
+
+namespace {
+
+    using Cell = tr::DisplaySlot::Cell;
+    using Cache = tw::DisplayCache<std::u16string>;
+
+    constexpr tw::L10n L10N { .untranslated = u8"untranslated", .emptyString = u8"empty" };
+    constexpr size_t MAX_CELL_LENGTH = 1000;
+
+    /// Does the same as tree model, std::u16string instead of QString
+    std::u16string brushLineEnds(const tw::TranslObj& x)
+    {
+        auto s = x.str();
+        auto shown = tw::cellPrefix(s, MAX_CELL_LENGTH);
+        auto r = mojibake::toM<std::u16string>(shown);
+        if (x.mayContainEols()) {
+            for (auto& c : r)
+                if (c == u'\n')
+                    c = u'¶';
+        }
+        if (shown.size() != s.size())
+            r += u'…';
+        return r;
+    }
+
+    /// Renders cells and counts calls
+    class Renderer
+    {
+    public:
+        Renderer() { fly.setL10n(L10N); }
+
+        std::u16string operator () (tr::UiObject& obj, Cell cell)
+        {
+            ++nCalls;
+            switch (cell) {
+            case Cell::ID: return mojibake::toM<std::u16string>(obj.idColumn());
+            case Cell::ORIGINAL: return brushLineEnds(fly.getOrig(obj));
+            case Cell::REFERENCE: return brushLineEnds(fly.getRef(obj));
+            case Cell::TRANSLATION: return brushLineEnds(fly.getTransl(obj));
+            }
+            __builtin_unreachable();
+        }
+
+        const std::u16string& get(Cache& cache, tr::UiObject& obj, Cell cell)
+        {
+            return cache.get(obj, cell,
+                    [this, cell](tr::UiObject& x) { return (*this)(x, cell); });
+        }
+
+        size_t nCalls = 0;
+    private:
+        tw::Flyweight fly;
+    };
+
+    std::shared_ptr<tr::Project> makeProject()
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        return prj;
+    }
+
+}   // anon namespace
+
+
+///
+///  Prefix is cut at code point boundary
+///
+TEST (DisplayCache, CellPrefix)
+{
+    EXPECT_EQ(u8"abc", tw::cellPrefix(u8"abcdef", 3));
+    EXPECT_EQ(u8"abc", tw::cellPrefix(u8"abc", 3));
+    EXPECT_EQ(u8"abc", tw::cellPrefix(u8"abc", 10));
+    EXPECT_EQ(u8"", tw::cellPrefix(u8"abc", 0));
+    EXPECT_EQ(u8"Юн", tw::cellPrefix(u8"Юникод", 2));
+    EXPECT_EQ(u8"a😀", tw::cellPrefix(u8"a😀b", 2));
+}
+
+
+///
+///  Second request is a hit, changes drop their cells only
+///
+TEST (DisplayCache, Invalidate)
+{
+    auto prj = makeProject();
+    auto file = prj->addFile(u8"f", tr::Modify::NO);
+    auto group = file->addGroup(u8"g", tr::Modify::NO);
+    auto text = group->addText(u8"t", u8"line1\nline2", tr::Modify::NO);
+    Cache cache;
+    Renderer r;
+
+    EXPECT_EQ(u"line1¶line2", r.get(cache, *text, Cell::ORIGINAL));
+    EXPECT_EQ(u"untranslated", r.get(cache, *text, Cell::TRANSLATION));
+    EXPECT_EQ(u"0 / 1", r.get(cache, *group, Cell::TRANSLATION));
+    EXPECT_EQ(u"t", r.get(cache, *text, Cell::ID));
+    EXPECT_EQ(4u, r.nCalls);
+    EXPECT_EQ(2u, cache.nEntries());
+
+    r.get(cache, *text, Cell::ORIGINAL);
+    r.get(cache, *text, Cell::TRANSLATION);
+    r.get(cache, *group, Cell::TRANSLATION);
+    EXPECT_EQ(4u, r.nCalls);
+
+    // Modify::NO is still a change; group’s stats are changed too
+    text->setTranslation(u8"transl", tr::Modify::NO);
+    EXPECT_EQ(u"line1¶line2", r.get(cache, *text, Cell::ORIGINAL));
+    EXPECT_EQ(4u, r.nCalls);
+    EXPECT_EQ(u"transl", r.get(cache, *text, Cell::TRANSLATION));
+    EXPECT_EQ(u"1 / 1", r.get(cache, *group, Cell::TRANSLATION));
+    EXPECT_EQ(6u, r.nCalls);
+
+    text->setOriginal(u8"orig", tr::Modify::YES);
+    EXPECT_EQ(u"orig", r.get(cache, *text, Cell::ORIGINAL));
+    EXPECT_EQ(u"t", r.get(cache, *text, Cell::ID));
+    EXPECT_EQ(7u, r.nCalls);
+
+    text->setId(u8"t1", tr::Modify::YES);
+    EXPECT_EQ(u"t1", r.get(cache, *text, Cell::ID));
+    EXPECT_EQ(8u, r.nCalls);
+
+    // Clear: everything again, stale slots just miss
+    cache.clear();
+    EXPECT_EQ(0u, cache.nBytes());
+    EXPECT_EQ(u"1 / 1", r.get(cache, *group, Cell::TRANSLATION));
+    EXPECT_EQ(u"transl", r.get(cache, *text, Cell::TRANSLATION));
+    EXPECT_EQ(10u, r.nCalls);
+}
+
+
+///
+///  Long texts are cut
+///
+TEST (DisplayCache, Long)
+{
+    auto prj = makeProject();
+    auto file = prj->addFile(u8"f", tr::Modify::NO);
+    std::u8string s(MAX_CELL_LENGTH + 5, u8'a');
+    auto text = file->addText(u8"t", s, tr::Modify::NO);
+    Cache cache;
+    Renderer r;
+    auto& cell = r.get(cache, *text, Cell::ORIGINAL);
+    EXPECT_EQ(MAX_CELL_LENGTH + 1, cell.size());
+    EXPECT_EQ(u'…', cell.back());
+}
+
+
+///
+///  Memory is capped, evicted objects are rendered again
+///
+TEST (DisplayCache, Cap)
+{
+    constexpr unsigned N_TEXTS = 1000;
+    constexpr size_t MAX_BYTES = 20'000;
+    auto prj = makeProject();
+    auto file = prj->addFile(u8"f", tr::Modify::NO);
+    for (unsigned i = 0; i < N_TEXTS; ++i) {
+        auto s = str::toU8(std::to_string(i));
+        file->addText(u8"t" + s, u8"original " + s, tr::Modify::NO);
+    }
+    Cache cache(MAX_BYTES);
+    Renderer r;
+    for (unsigned i = 0; i < N_TEXTS; ++i) {
+        auto s = mojibake::toM<std::u16string>(std::to_string(i));
+        EXPECT_EQ(u"original " + s, r.get(cache, *file->child(i), Cell::ORIGINAL));
+        EXPECT_LE(cache.nBytes(), MAX_BYTES);
+    }
+    EXPECT_EQ(N_TEXTS, r.nCalls);
+    EXPECT_LT(cache.nEntries(), N_TEXTS);
+    EXPECT_GT(cache.nEntries(), 0u);
+
+    // The last one is still here, the first one is evicted
+    r.get(cache, *file->child(N_TEXTS - 1), Cell::ORIGINAL);
+    EXPECT_EQ(N_TEXTS, r.nCalls);
+    EXPECT_EQ(u"original 0", r.get(cache, *file->child(0), Cell::ORIGINAL));
+    EXPECT_EQ(N_TEXTS + 1, r.nCalls);
+    EXPECT_LE(cache.nBytes(), MAX_BYTES);
+}
+
+
+///
+///  Scrolling and repainting 100k rows, run with --gtest_also_run_disabled_tests
+///
+TEST (DisplayCache, DISABLED_Benchmark)
+{
+    constexpr unsigned N_TEXTS = 100'000;
+    constexpr unsigned N_VISIBLE = 50;
+    constexpr unsigned SCROLL_STEP = 3;
+    /// Qt asks a cell several times per repaint
+    constexpr unsigned N_ASKS = 2;
+    constexpr Cell CELLS[] { Cell::ID, Cell::ORIGINAL, Cell::TRANSLATION };
+
+    auto prj = makeProject();
+    auto file = prj->addFile(u8"f", tr::Modify::NO);
+    for (unsigned i = 0; i < N_TEXTS; ++i) {
+        auto s = str::toU8(std::to_string(i));
+        auto text = file->addText(u8"t" + s,
+                u8"Открыть файл " + s + u8"? «Отмена» — вернуться.\nOpen file?",
+                tr::Modify::NO);
+        if (i % 3 != 0)
+            text->setTranslation(u8"Ouvrir le fichier " + s + u8" ?", tr::Modify::NO);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto scroll = [&](auto&& askCell) {
+        auto start = Clock::now();
+        size_t dummy = 0;
+        // Scroll down and back up: a user reads and returns
+        for (int pass = 0; pass < 2; ++pass) {
+            for (unsigned top = 0; top + N_VISIBLE <= N_TEXTS; top += SCROLL_STEP) {
+                unsigned row0 = (pass == 0) ? top : N_TEXTS - N_VISIBLE - top;
+                for (unsigned row = row0; row < row0 + N_VISIBLE; ++row) {
+                    auto& obj = *file->child(row);
+                    for (auto cell : CELLS)
+                        for (unsigned k = 0; k < N_ASKS; ++k)
+                            dummy += askCell(obj, cell).size();
+                }
+            }
+        }
+        std::chrono::duration<double, std::milli> time = Clock::now() - start;
+        EXPECT_NE(0u, dummy);
+        return time.count();
+    };
+
+    Renderer r;
+    auto uncached = scroll([&r](tr::UiObject& obj, Cell cell) { return r(obj, cell); });
+    auto nUncached = r.nCalls;
+
+    Cache cache;
+    r.nCalls = 0;
+    auto cached = scroll([&](tr::UiObject& obj, Cell cell) -> const std::u16string&
+                            { return r.get(cache, obj, cell); });
+    std::cout << "Uncached: " << uncached << " ms, " << nUncached << " renders\n"
+              << "Cached: " << cached << " ms, " << r.nCalls << " renders, "
+              << cache.nBytes() / 1024 << " KiB\n";
+}
@@ -288,3 +288,28 @@ TEST(EscapeCpp, QuotesSpacesQuoted)
     auto r = escape::cppSv(data, cache, 'Q', escape::Spaces::YES, Enquote::YES);
     expectCached(u8R"("\s \"alpha\" \Q bravo \s")", r, cache);
 }
+
+
+///// Append C++ ///////////////////////////////////////////////////////////////
+
+///
+///  Should append, and give the same as cppSv
+///
+TEST(AppendCpp, SameAsCppSv)
+{
+    const char8_t* data[] {
+        u8"", u8" ", u8"a", u8"  ", u8"alpha   bravo",
+        u8"alpha" "\n" "bravo" "\\" "charlie",
+        u8"  \"alpha\" \n bravo  " };
+    for (auto x : data) {
+        for (auto spaces : { escape::Spaces::NO, escape::Spaces::YES }) {
+            for (auto enquote : { Enquote::NO, Enquote::YES }) {
+                std::u8string cache;
+                auto exp = escape::cppSv(x, cache, 'Q', spaces, enquote);
+                std::u8string r = u8"prefix";
+                escape::appendCpp(r, x, 'Q', spaces, enquote);
+                EXPECT_EQ(u8"prefix" + std::u8string{exp}, r);
+            }
+        }
+    }
+}
@@ -19,3 +19,72 @@ TEST (ET_WriteQuoted, Quoted)
     escape::Text::writeQuoted(os, u8R"("Alpha" Bravo)");
     EXPECT_EQ(R"("""Alpha"" Bravo")", os.str());
 }
+
+
+TEST (ET_Append, Banned)
+{
+    escape::Text t;
+    std::u8string r = u8"x=";
+    t.append(r, u8"Alpha\nBravo");
+    EXPECT_EQ(u8"x=Alpha\nBravo", r);
+}
+
+
+TEST (ET_Append, SpecifiedQuoted)
+{
+    escape::Text t;
+    t.lineBreak = escape::LineBreakMode::SPECIFIED_TEXT;
+    t.lineBreakText = u8"<\"br\">";
+    t.space = escape::SpaceMode::QUOTED;
+    std::u8string r = u8"x=";
+    t.append(r, u8"\"Alpha\"\nBravo");
+    EXPECT_EQ(u8R"(x="""Alpha""<""br"">Bravo")", r);
+}
+
+
+TEST (ET_Append, CDelimited)
+{
+    escape::Text t;
+    t.lineBreak = escape::LineBreakMode::C_LF;
+    t.space = escape::SpaceMode::DELIMITED;
+    std::u8string r = u8"x=";
+    t.append(r, u8"Alpha\nBravo\\ ");
+    EXPECT_EQ(u8R"(x=Alpha\nBravo\\ |)", r);
+}
+
+
+TEST (ET_UnescapeSv, NothingToDo)
+{
+    escape::Text t;
+    t.lineBreak = escape::LineBreakMode::C_LF;
+    t.space = escape::SpaceMode::QUOTED;
+    std::u8string cache;
+    std::u8string_view x = u8" \"Alpha Bravo\" ";
+    auto r = t.unescapeSv(x, cache);
+    EXPECT_EQ(u8"Alpha Bravo", r);
+    EXPECT_EQ(x.data() + 2, r.data());
+}
+
+
+TEST (ET_UnescapeSv, SpecifiedQuoted)
+{
+    escape::Text t;
+    t.lineBreak = escape::LineBreakMode::SPECIFIED_TEXT;
+    t.lineBreakText = u8"<\"br\">";
+    t.space = escape::SpaceMode::QUOTED;
+    std::u8string cache;
+    auto r = t.unescapeSv(u8R"("""Alpha""<""br"">Bravo")", cache);
+    EXPECT_EQ(u8"\"Alpha\"\nBravo", r);
+    EXPECT_EQ(r, t.unescape(u8R"("""Alpha""<""br"">Bravo")"));
+}
+
+
+TEST (ET_UnescapeSv, CDelimited)
+{
+    escape::Text t;
+    t.lineBreak = escape::LineBreakMode::C_LF;
+    t.space = escape::SpaceMode::DELIMITED;
+    std::u8string cache;
+    auto r = t.unescapeSv(u8R"(Alpha\nBravo\\ |)", cache);
+    EXPECT_EQ(u8"Alpha\nBravo\\ ", r);
+}
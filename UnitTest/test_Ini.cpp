@@ -0,0 +1,139 @@
+// What we test
+#include "TrFile.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <chrono>
+#include <iostream>
+
+// Project
+#include "TrProject.h"
+
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using Sec = std::chrono::duration<double>;
+
+    std::u8string numbered(std::u8string_view prefix, unsigned n)
+        { return std::u8string{prefix} + str::toU8(std::to_string(n)); }
+
+    struct IniMode {
+        const char* name;
+        escape::LineBreakMode lineBreak;
+        escape::SpaceMode space;
+        tf::TextLineBreakStyle eol;
+    };
+
+    constexpr IniMode INI_MODES[] {
+        { "BANNED, bare, LF", escape::LineBreakMode::BANNED,
+                escape::SpaceMode::BARE, tf::TextLineBreakStyle::LF },
+        { "C_LF, slash-space, CRLF", escape::LineBreakMode::C_LF,
+                escape::SpaceMode::SLASH_SPACE, tf::TextLineBreakStyle::CRLF },
+        { "SPECIFIED_TEXT, quoted, LF", escape::LineBreakMode::SPECIFIED_TEXT,
+                escape::SpaceMode::QUOTED, tf::TextLineBreakStyle::LF },
+    };
+
+    /// One INI file of nGroups × nTexts lines:
+    ///   spaces to escape, every 4th text has a line break
+    std::shared_ptr<tr::Project> makeProject(unsigned nGroups, unsigned nTexts)
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::ORIGINAL;
+        auto file = prj->addFile(u8"big.ini", tr::Modify::NO);
+        file->info.format = tf::IniProto::INST.make();
+        for (unsigned i = 0; i < nGroups; ++i) {
+            auto group = file->addGroup(numbered(u8"Group", i), tr::Modify::NO);
+            for (unsigned j = 0; j < nTexts; ++j) {
+                auto text = numbered(u8" Some text of moderate length, #", j);
+                if (j % 4 == 0)
+                    text += u8"\nsecond line ";
+                group->addText(numbered(u8"text", j), text, tr::Modify::NO);
+            }
+        }
+        return prj;
+    }
+
+    void setMode(tr::Project& prj, const IniMode& mode)
+    {
+        auto& ini = dynamic_cast<tf::Ini&>(*prj.files.at(0)->info.format);
+        ini.textEscape.lineBreak = mode.lineBreak;
+        ini.textEscape.space = mode.space;
+        ini.textFormat.lineBreakStyle = mode.eol;
+    }
+
+    ///  Counts what importer gives
+    class CountingLoader final : public tf::Loader
+    {
+    public:
+        size_t nTexts = 0, nBytes = 0;
+
+        void goToRoot() override {}
+        bool goUp() override { return false; }
+        void goToGroupRel(std::u8string_view) override {}
+        void addText(std::u8string_view,
+                     std::u8string_view original,
+                     std::u8string_view) override
+            { ++nTexts;  nBytes += original.size(); }
+    };
+
+}   // anon namespace
+
+
+///
+///  Export of a 1M-line INI,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (IniExport, DISABLED_Benchmark)
+{
+    constexpr int N_RUNS = 3;
+    ut::TempDir dir("utranslator_bench_ini");
+    auto prj = makeProject(1000, 1000);
+    for (auto& mode : INI_MODES) {
+        setMode(*prj, mode);
+        double best = 1e30;
+        for (int i = 0; i < N_RUNS; ++i) {
+            auto start = Clock::now();
+            EXPECT_TRUE(prj->doBuild(dir.path).isOk());
+            best = std::min(best, Sec(Clock::now() - start).count());
+        }
+        auto size = std::filesystem::file_size(dir.path / "big.ini");
+        std::cout << mode.name << ": " << size / best / 1e6 << " MB/s ("
+                  << size / 1e6 << " MB)\n";
+    }
+}
+
+
+///
+///  Import of the same INI,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (IniImport, DISABLED_Benchmark)
+{
+    constexpr int N_RUNS = 3;
+    ut::TempDir dir("utranslator_bench_ini");
+    auto prj = makeProject(1000, 1000);
+    auto fname = dir.path / "big.ini";
+    for (auto& mode : INI_MODES) {
+        setMode(*prj, mode);
+        ASSERT_TRUE(prj->doBuild(dir.path).isOk());
+        auto& format = *prj->files.at(0)->info.format;
+        double best = 1e30;
+        size_t nTexts = 0;
+        for (int i = 0; i < N_RUNS; ++i) {
+            CountingLoader loader;
+            auto start = Clock::now();
+            format.doImport(loader, fname);
+            best = std::min(best, Sec(Clock::now() - start).count());
+            nTexts = loader.nTexts;
+        }
+        auto size = std::filesystem::file_size(fname);
+        std::cout << mode.name << ": " << size / best / 1e6 << " MB/s, "
+                  << best * 1e3 << " ms (" << nTexts << " texts)\n";
+    }
+}
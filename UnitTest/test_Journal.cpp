@@ -0,0 +1,278 @@
+// What we test
+#include "TrProject.h"
+#include "TrSnapshot.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+
+namespace {
+
+    /// Saves translation project with N texts to fname
+    void makeProject(const std::filesystem::path& fname, unsigned nTexts = 10)
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        auto file = prj->addFile(u8"f", tr::Modify::NO);
+        auto group = file->addGroup(u8"g", tr::Modify::NO);
+        for (unsigned i = 0; i < nTexts; ++i) {
+            auto s = str::toU8(std::to_string(i));
+            group->addText(u8"t" + s, u8"orig" + s, tr::Modify::NO);
+        }
+        prj->save(fname);
+    }
+
+    std::shared_ptr<tr::Project> load(
+            const std::filesystem::path& fname,
+            tr::LoadMode mode = tr::LoadMode::EDIT)
+    {
+        auto prj = tr::Project::make();
+        prj->load(fname, nullptr, mode);
+        return prj;
+    }
+
+    std::shared_ptr<tr::Group> group(tr::Project& prj)
+        { return prj.findFile(u8"f")->findGroup(u8"g"); }
+
+    std::shared_ptr<tr::Text> text(tr::Project& prj, std::u8string_view id)
+        { return group(prj)->findText(id); }
+
+    class CountingListener final : public ModListener
+    {
+    public:
+        unsigned nCalls = 0;
+        void modStateChanged(ModState, ModState) override { ++nCalls; }
+    };
+
+}   // anon namespace
+
+
+///
+///  Edits are replayed after crash, project is modified then
+///
+TEST (Journal, Crash)
+{
+    ut::TempFile file("utranslator_test_journal.utran");
+    makeProject(file.path);
+    {
+        auto prj = load(file.path);
+        EXPECT_FALSE(prj->isModified());
+        text(*prj, u8"t1")->setTranslation(u8"one", tr::Modify::YES);
+        text(*prj, u8"t2")->setTranslation(u8"two", tr::Modify::YES);
+        text(*prj, u8"t2")->setTranslation(std::nullopt, tr::Modify::YES);
+        text(*prj, u8"t3")->setId(u8"t3a", tr::Modify::YES);
+        text(*prj, u8"t3a")->setTranslation(u8"three", tr::Modify::YES);
+        group(*prj)->setTranslatorsComment(u8"comment", tr::Modify::YES);
+        group(*prj)->setId(u8"g1", tr::Modify::YES);
+        prj->findFile(u8"f")->findGroup(u8"g1")->setId(u8"g", tr::Modify::YES);
+        prj->findFile(u8"f")->setId(u8"f1", tr::Modify::YES);
+        prj->findFile(u8"f1")->setId(u8"f", tr::Modify::YES);
+        // Edits w/o modification are not journaled
+        text(*prj, u8"t4")->setTranslation(u8"four", tr::Modify::NO);
+        EXPECT_TRUE(prj->journal().isIntact());
+        // Crash: project is just dropped
+    }
+    auto prj = load(file.path);
+    EXPECT_TRUE(prj->isModified());
+    EXPECT_EQ(u8"one", text(*prj, u8"t1")->tr.translationSv());
+    EXPECT_TRUE(text(*prj, u8"t1")->cache.mod.has(tr::Mch::TRANSL));
+    EXPECT_FALSE(text(*prj, u8"t2")->tr.translation);
+    EXPECT_FALSE(text(*prj, u8"t3"));
+    EXPECT_EQ(u8"three", text(*prj, u8"t3a")->tr.translationSv());
+    EXPECT_FALSE(text(*prj, u8"t4")->tr.translation);
+    EXPECT_EQ(u8"comment", group(*prj)->comm.translators);
+    EXPECT_FALSE(text(*prj, u8"t5")->cache.mod.has(tr::Mch::TRANSL));
+
+    // Full save compacts: no journal, the same data
+    prj->save();
+    EXPECT_FALSE(std::filesystem::exists(tr::Journal::fnameFor(file.path)));
+    auto prj2 = load(file.path);
+    EXPECT_FALSE(prj2->isModified());
+    EXPECT_EQ(u8"three", text(*prj2, u8"t3a")->tr.translationSv());
+}
+
+
+///
+///  Save always writes project file; discard drops journal
+///
+TEST (Journal, SaveDiscard)
+{
+    ut::TempFile file("utranslator_test_journal.utran");
+    makeProject(file.path);
+    auto jname = tr::Journal::fnameFor(file.path);
+    {
+        auto prj = load(file.path);
+        text(*prj, u8"t1")->setTranslation(u8"one", tr::Modify::YES);
+        EXPECT_TRUE(std::filesystem::exists(jname));
+        prj->save();
+        EXPECT_FALSE(prj->isModified());
+        EXPECT_FALSE(std::filesystem::exists(jname));
+        text(*prj, u8"t2")->setTranslation(u8"two", tr::Modify::YES);
+        prj->discardUnsaved();
+        EXPECT_FALSE(std::filesystem::exists(jname));
+    }
+    // Saved edit is in project file itself, w/o any journal
+    auto prj = load(file.path, tr::LoadMode::READ);
+    EXPECT_FALSE(prj->isModified());
+    EXPECT_EQ(u8"one", text(*prj, u8"t1")->tr.translationSv());
+    EXPECT_FALSE(text(*prj, u8"t2")->tr.translation);
+}
+
+
+///
+///  Projects that are just read ignore journal, and do not write it
+///
+TEST (Journal, ReadOnly)
+{
+    ut::TempFile file("utranslator_test_journal.utran");
+    makeProject(file.path);
+    auto jname = tr::Journal::fnameFor(file.path);
+    {
+        auto prj = load(file.path);
+        text(*prj, u8"t1")->setTranslation(u8"one", tr::Modify::YES);
+    }
+    auto jsize = std::filesystem::file_size(jname);
+    {
+        auto prj = load(file.path, tr::LoadMode::READ);
+        EXPECT_FALSE(prj->isModified());
+        EXPECT_FALSE(text(*prj, u8"t1")->tr.translation);
+        text(*prj, u8"t2")->setTranslation(u8"two", tr::Modify::YES);
+        EXPECT_EQ(jsize, std::filesystem::file_size(jname));
+    }
+    // Crash recovery still works for the one who edits
+    auto prj = load(file.path);
+    EXPECT_TRUE(prj->isModified());
+    EXPECT_EQ(u8"one", text(*prj, u8"t1")->tr.translationSv());
+    EXPECT_FALSE(text(*prj, u8"t2")->tr.translation);
+}
+
+
+///
+///  Edits journal cannot express break it till save
+///
+TEST (Journal, Broken)
+{
+    ut::TempFile file("utranslator_test_journal.utran");
+    makeProject(file.path);
+    auto prj = load(file.path);
+    text(*prj, u8"t1")->setTranslation(u8"one", tr::Modify::YES);
+    // Already modified, still UI learns that journal broke off
+    CountingListener listener;
+    prj->setStaticModifyListener(&listener);
+    group(*prj)->addText(u8"new", u8"new", tr::Modify::YES);
+    EXPECT_FALSE(prj->journal().isIntact());
+    EXPECT_EQ(1u, listener.nCalls);
+    text(*prj, u8"t2")->setTranslation(u8"two", tr::Modify::YES);
+    EXPECT_TRUE(prj->isModified());
+    prj->setStaticModifyListener(nullptr);
+
+    // Crash now: what was journaled before break
+    {
+        auto prj2 = load(file.path);
+        EXPECT_TRUE(prj2->isModified());
+        EXPECT_EQ(u8"one", text(*prj2, u8"t1")->tr.translationSv());
+        EXPECT_FALSE(text(*prj2, u8"new"));
+        EXPECT_FALSE(text(*prj2, u8"t2")->tr.translation);
+    }
+
+    prj->save();
+    EXPECT_TRUE(prj->journal().isIntact());
+    auto prj3 = load(file.path);
+    EXPECT_FALSE(prj3->isModified());
+    EXPECT_TRUE(text(*prj3, u8"new"));
+    EXPECT_EQ(u8"two", text(*prj3, u8"t2")->tr.translationSv());
+}
+
+
+///
+///  Torn tail is ignored and cut; journal of another file is ignored
+///
+TEST (Journal, Garbage)
+{
+    ut::TempFile file("utranslator_test_journal.utran");
+    makeProject(file.path);
+    auto jname = tr::Journal::fnameFor(file.path);
+    {
+        auto prj = load(file.path);
+        text(*prj, u8"t1")->setTranslation(u8"one", tr::Modify::YES);
+        text(*prj, u8"t2")->setTranslation(u8"two", tr::Modify::YES);
+    }
+    // Cut the last record in the middle
+    std::filesystem::resize_file(jname, std::filesystem::file_size(jname) - 3);
+    {
+        auto prj = load(file.path);
+        EXPECT_EQ(u8"one", text(*prj, u8"t1")->tr.translationSv());
+        EXPECT_FALSE(text(*prj, u8"t2")->tr.translation);
+        text(*prj, u8"t3")->setTranslation(u8"three", tr::Modify::YES);
+    }
+    {
+        auto prj = load(file.path);
+        EXPECT_EQ(u8"one", text(*prj, u8"t1")->tr.translationSv());
+        EXPECT_FALSE(text(*prj, u8"t2")->tr.translation);
+        EXPECT_EQ(u8"three", text(*prj, u8"t3")->tr.translationSv());
+    }
+
+    // Project file changed by someone else → journal is not for it
+    ut::TempFile backup("utranslator_test_journal.bak");
+    std::filesystem::copy_file(jname, backup.path);
+    makeProject(file.path, 11);
+    std::filesystem::copy_file(backup.path, jname);
+    auto prj = load(file.path);
+    EXPECT_FALSE(prj->isModified());
+    EXPECT_FALSE(text(*prj, u8"t1")->tr.translation);
+    EXPECT_TRUE(text(*prj, u8"t10"));
+    // First edit overwrites it
+    text(*prj, u8"t1")->setTranslation(u8"uno", tr::Modify::YES);
+    auto prj2 = load(file.path);
+    EXPECT_EQ(u8"uno", text(*prj2, u8"t1")->tr.translationSv());
+}
+
+
+///
+///  Speed of full save and of journaled edit,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (Journal, DISABLED_Benchmark)
+{
+    constexpr unsigned N_TEXTS = 100'000;
+    constexpr unsigned N_EDITS = 1000;
+    ut::TempFile file("utranslator_test_journal.utran");
+    makeProject(file.path, N_TEXTS);
+    auto prj = load(file.path);
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    prj->save();
+    std::chrono::duration<double, std::milli> fullTime = Clock::now() - start;
+
+    // Setter itself recounts group’s stats, so measure it alone too
+    auto grp = group(*prj);
+    auto edit = [&](std::u8string_view value, tr::Modify wantModify) {
+        auto start = Clock::now();
+        for (unsigned i = 0; i < N_EDITS; ++i)
+            grp->child(i * (N_TEXTS / N_EDITS))->setTranslation(value, wantModify);
+        std::chrono::duration<double, std::milli> time = Clock::now() - start;
+        return time.count() / N_EDITS;
+    };
+    auto setterTime = edit(u8"setter", tr::Modify::NO);
+    auto journalTime = edit(u8"transl", tr::Modify::YES);
+
+    start = Clock::now();
+    auto prj2 = load(file.path);
+    std::chrono::duration<double, std::milli> loadTime = Clock::now() - start;
+    EXPECT_EQ(u8"transl", group(*prj2)->child(0)->translatable()->translationSv());
+
+    std::cout << N_TEXTS << " texts: full save " << fullTime.count() << " ms, "
+              << "setter alone " << setterTime << " ms, "
+              << "journaled edit " << journalTime << " ms, "
+              << "load with " << N_EDITS << " edits replayed " << loadTime.count()
+              << " ms, journal " << prj->journal().nBytes() << " bytes\n";
+}
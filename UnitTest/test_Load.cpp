@@ -0,0 +1,275 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+// Libs
+#include "pugixml.hpp"
+#include "u_XmlSax.h"
+
+
+///
+///  Differential tests: streaming loader gives the same as DOM one
+///
+
+namespace {
+
+    using Rng = std::mt19937;
+
+    bool chance(Rng& rng, unsigned percent)
+        { return std::uniform_int_distribution<unsigned>(0, 99)(rng) < percent; }
+
+    unsigned upTo(Rng& rng, unsigned n)
+        { return std::uniform_int_distribution<unsigned>(0, n)(rng); }
+
+    std::u8string numbered(std::u8string_view prefix, unsigned n)
+        { return std::u8string{prefix} + str::toU8(std::to_string(n)); }
+
+    /// Pieces that XML escapes, normalizes or keeps as is
+    std::u8string randomString(Rng& rng)
+    {
+        static constexpr std::u8string_view PIECES[] {
+            u8"a", u8"Word", u8"Слово", u8"😀", u8" ", u8"  ", u8"\t",
+            u8"\n", u8"\r\n", u8"<", u8">", u8"&", u8"&amp;", u8"\"", u8"'",
+            u8"]]>", u8"<br>", u8"<![CDATA[x]]>",
+        };
+        std::u8string r;
+        for (auto n = upTo(rng, 6); n != 0; --n)
+            r += PIECES[upTo(rng, std::size(PIECES) - 1)];
+        return r;
+    }
+
+    void fillComments(tr::Comments& comm, Rng& rng)
+    {
+        if (chance(rng, 20))
+            comm.importers = randomString(rng);
+        if (chance(rng, 20))
+            comm.authors = randomString(rng);
+        if (chance(rng, 20))
+            comm.translators = randomString(rng);
+    }
+
+    void fillGroup(tr::VirtualGroup& group, Rng& rng, int depth)
+    {
+        for (auto n = upTo(rng, 8); n != 0; --n) {
+            if (depth < 3 && chance(rng, 20)) {
+                auto sub = group.addGroup(numbered(u8"g", upTo(rng, 100)), tr::Modify::NO);
+                fillComments(sub->comm, rng);
+                fillGroup(*sub, rng, depth + 1);
+            } else {
+                auto text = group.addText(randomString(rng), randomString(rng), tr::Modify::NO);
+                fillComments(text->comm, rng);
+                if (chance(rng, 50))
+                    text->tr.translation = randomString(rng);
+                if (chance(rng, 10))
+                    text->tr.knownOriginal.text = randomString(rng);
+                text->tr.forceAttention = chance(rng, 10);
+            }
+        }
+    }
+
+    std::shared_ptr<tr::Project> makeRandomProject(Rng& rng)
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = chance(rng, 50) ? tr::PrjType::ORIGINAL : tr::PrjType::FULL_TRANSL;
+        prj->info.orig.lang = "en";
+        prj->info.transl.lang = "ru";
+        for (auto n = upTo(rng, 3); n != 0; --n) {
+            auto file = prj->addFile(numbered(u8"file", upTo(rng, 100)), tr::Modify::NO);
+            file->info.origPath = randomString(rng);
+            fillComments(file->comm, rng);
+            fillGroup(*file, rng, 0);
+        }
+        return prj;
+    }
+
+    std::shared_ptr<tr::Project> loadDom(const std::filesystem::path& fname)
+    {
+        pugi::xml_document doc;
+        auto result = doc.load_file(fname.c_str(),
+                    pugi::parse_default | pugi::parse_ws_pcdata);
+        EXPECT_TRUE(result) << result.description();
+        auto prj = tr::Project::make();
+        prj->load(doc, fname.parent_path());
+        return prj;
+    }
+
+    /// Streaming loader, unless it falls back to DOM
+    std::shared_ptr<tr::Project> loadAuto(const std::filesystem::path& fname)
+    {
+        auto prj = tr::Project::make();
+        prj->load(fname);
+        return prj;
+    }
+
+    /// @return [+] strings are borrowed from arena, i.e. streaming loader worked
+    bool isStreamed(const tr::Project& prj)
+        { return !prj.files.empty() && prj.files[0]->id.isBorrowed(); }
+
+    /// Loads fname both ways and compares what they save
+    void expectSameLoad(const std::filesystem::path& fname, const std::filesystem::path& tmpDir)
+    {
+        auto sax = loadAuto(fname);
+        auto dom = loadDom(fname);
+        if (!sax->files.empty()) {
+            EXPECT_TRUE(isStreamed(*sax));
+        }
+        EXPECT_FALSE(isStreamed(*dom));
+        sax->saveCopy(tmpDir / "sax.xml");
+        dom->saveCopy(tmpDir / "dom.xml");
+        EXPECT_EQ(ut::readFile(tmpDir / "dom.xml"), ut::readFile(tmpDir / "sax.xml"));
+    }
+
+}   // anon namespace
+
+
+///
+///  Samples load the same
+///
+TEST (Load, Samples)
+{
+    auto srcDir = ut::samplesDir();
+    ASSERT_TRUE(std::filesystem::is_directory(srcDir)) << "No samples in " << srcDir;
+    ut::TempDir dir("utranslator_test_load_samples");
+
+    size_t nProjects = 0;
+    for (auto& entry : std::filesystem::recursive_directory_iterator(srcDir)) {
+        auto ext = entry.path().extension();
+        if (ext != ".utran" && ext != ".uorig")
+            continue;
+        SCOPED_TRACE(entry.path().string());
+        expectSameLoad(entry.path(), dir.path);
+        ++nProjects;
+    }
+    EXPECT_LE(3u, nProjects);
+}
+
+
+///
+///  Random projects load the same
+///
+TEST (Load, Random)
+{
+    ut::TempDir dir("utranslator_test_load_random");
+    auto fname = dir.path / "prj.utran";
+    for (unsigned seed = 1; seed <= 300; ++seed) {
+        SCOPED_TRACE(seed);
+        Rng rng(seed);
+        makeRandomProject(rng)->save(fname);
+        expectSameLoad(fname, dir.path);
+    }
+}
+
+
+///
+///  What streaming loader does not understand goes to DOM
+///
+TEST (Load, Fallback)
+{
+    ut::TempDir dir("utranslator_test_load_fallback");
+    auto fname = dir.path / "prj.uorig";
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::ORIGINAL;
+    prj->addFile(u8"f", tr::Modify::NO)->addText(u8"t", u8"Text", tr::Modify::NO);
+    prj->save(fname);
+    auto xml = ut::readFile(fname);
+    auto pos = xml.find("<ut");
+    ASSERT_NE(std::string::npos, pos);
+    xml.insert(pos, "<!DOCTYPE ut>\n");
+    ut::writeFile(fname, xml);
+
+    auto loaded = loadAuto(fname);
+    EXPECT_FALSE(isStreamed(*loaded));
+    ASSERT_TRUE(loaded->findFile(u8"f"));
+    auto text = loaded->findFile(u8"f")->findText(u8"t");
+    ASSERT_TRUE(text);
+    EXPECT_EQ(u8"Text", text->tr.original);
+}
+
+
+///
+///  Broken XML: error comes from DOM
+///
+TEST (Load, Broken)
+{
+    ut::TempDir dir("utranslator_test_load_broken");
+    auto fname = dir.path / "prj.uorig";
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::ORIGINAL;
+    prj->addFile(u8"f", tr::Modify::NO)->addText(u8"t", u8"Text", tr::Modify::NO);
+    prj->save(fname);
+    auto xml = ut::readFile(fname);
+    ut::writeFile(fname, std::string_view(xml).substr(0, xml.size() / 2));
+
+    try {
+        loadAuto(fname);
+        FAIL() << "Broken file loaded";
+    } catch (const sax::Error& e) {
+        FAIL() << "Streaming loader error leaked: " << e.what();
+    } catch (const std::exception& e) {
+        EXPECT_NE(std::string::npos, std::string(e.what()).find("Cannot load"));
+    }
+}
+
+
+///
+///  Load of a large project, streaming vs DOM,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (Load, DISABLED_Benchmark)
+{
+    constexpr unsigned N_FILES = 20;
+    constexpr unsigned N_GROUPS = 50;
+    constexpr unsigned N_TEXTS = 200;
+    constexpr int N_RUNS = 3;
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    ut::TempDir dir("utranslator_bench_load");
+    auto fname = dir.path / "prj.utran";
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        for (unsigned i = 0; i < N_FILES; ++i) {
+            auto file = prj->addFile(numbered(u8"file", i), tr::Modify::NO);
+            for (unsigned j = 0; j < N_GROUPS; ++j) {
+                auto group = file->addGroup(numbered(u8"g", j), tr::Modify::NO);
+                for (unsigned k = 0; k < N_TEXTS; ++k) {
+                    auto text = group->addText(numbered(u8"t", k),
+                            numbered(u8"Some original text\nwith two lines #", k),
+                            tr::Modify::NO);
+                    text->tr.translation = numbered(u8"Некий перевод #", k);
+                    if (k % 10 == 0)
+                        text->comm.authors = u8"Author’s comment";
+                }
+            }
+        }
+        prj->save(fname);
+    }
+
+    auto time = [&](auto load) {
+        double best = 1e30;
+        for (int i = 0; i < N_RUNS; ++i) {
+            auto start = Clock::now();
+            auto prj = load(fname);
+            best = std::min(best, Ms(Clock::now() - start).count());
+        }
+        return best;
+    };
+    auto saxTime = time(loadAuto);
+    auto domTime = time(loadDom);
+    std::cout << N_FILES * N_GROUPS * N_TEXTS << " texts, "
+              << std::filesystem::file_size(fname) / 1'000'000.0 << " MB\n"
+              << "Streaming: " << saxTime << " ms\n"
+              << "DOM: " << domTime << " ms\n";
+}
@@ -0,0 +1,285 @@
+// What we test
+#include "LocFmt.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <chrono>
+#include <iostream>
+
+
+namespace {
+
+    /// Russian cardinals: 1 файл (one), 2 файла (few), 5 файлов (many)
+    class RuRule final : public loc::PluralRule
+    {
+    public:
+        loc::Plural ofUint(unsigned long long n) const override
+        {
+            auto n10 = n % 10, n100 = n % 100;
+            if (n10 == 1 && n100 != 11)
+                return loc::Plural::ONE;
+            if (n10 >= 2 && n10 <= 4 && (n100 < 12 || n100 > 14))
+                return loc::Plural::FEW;
+            return loc::Plural::MANY;
+        }
+    };
+
+    class RuLocale final : public loc::Locale
+    {
+    public:
+        const loc::PluralRule& cardinalRule() const override { return rule; }
+    private:
+        RuRule rule;
+    };
+
+    /// 0 is custom A, the rest is OTHER
+    class CustomRule final : public loc::PluralRule
+    {
+    public:
+        loc::Plural ofUint(unsigned long long n) const override
+            { return (n == 0) ? loc::Plural::A : loc::Plural::OTHER; }
+    };
+
+    class CustomLocale final : public loc::Locale
+    {
+    public:
+        const loc::PluralRule& cardinalRule() const override { return rule; }
+    private:
+        CustomRule rule;
+    };
+
+    const RuLocale ru;
+    const CustomLocale custom;
+
+    template <class... Args>
+    std::u8string viaFmt(const loc::Locale& lc, std::u8string_view tmpl, const Args&... args)
+    {
+        loc::Fmt<char8_t> fmt(lc, tmpl);
+        (fmt.eat(args), ...);
+        return std::move(fmt).str();
+    }
+
+    template <class... Args>
+    void expectSame(const loc::Locale& lc, std::u8string_view tmpl, const Args&... args)
+    {
+        EXPECT_EQ(viaFmt(lc, tmpl, args...), loc::Tmpl(tmpl).str(lc, args...))
+                << str::toSv(tmpl);
+    }
+
+    constexpr std::u8string_view TEMPLATES[] {
+        u8"",
+        u8"Plain text",
+        u8"{1}",
+        u8"a{1}b",
+        u8"{1} and {1}",
+        u8"{{1}} {{ }} {1}",
+        u8"lone {",
+        u8"incomplete {1 {{ rest",
+        u8"{x}{0}{}",
+        u8"{99999999999}",
+        u8"{1|one=# file|many=# files}",
+        u8"{1|one=# файл|few=# файла|many=# файлов}",
+        u8"{1| one = # file |many=# files}",
+        u8"{1|other=#!}",
+        u8"{1|rest=# things|one=one thing}",
+        u8"{1|zero=none|other=#}",
+        u8"{1|two=two|many=many}",
+        u8"{1|one=|many=# items}",
+        u8"{1|one=#/#|many=#-#-#}",
+        u8"{1|one=a{#b{{c{|d{}e|many=x{=y}",
+        u8"{1|one=1=2|many}",
+        u8"{1|a=custom A|other=#}",
+        u8"{1|foo=bar|one}",
+        u8"{1|\tone=tab|many=#}",
+    };
+
+}   // anon namespace
+
+
+///
+///  Tmpl gives the same as Fmt with one argument
+///
+TEST (LocTmpl, SameAsFmt)
+{
+    const loc::Locale* locales[] { &loc::DefaultLocale::INST, &ru, &custom };
+    for (auto lc : locales) {
+        for (auto tmpl : TEMPLATES) {
+            for (int n : { 0, 1, 2, 3, 5, 11, 12, 21, 22, 25, 111, -1, -2 })
+                expectSame(*lc, tmpl, n);
+            for (unsigned n : { 0u, 1u, 4u, 1000u })
+                expectSame(*lc, tmpl, n);
+            expectSame(*lc, tmpl, u8"str");
+            expectSame(*lc, tmpl, std::u8string_view{});
+            expectSame(*lc, tmpl);
+        }
+    }
+}
+
+
+///
+///  Several arguments: keys, gaps, missing and extra arguments
+///
+TEST (LocTmpl, Keys)
+{
+    auto& lc = loc::DefaultLocale::INST;
+    expectSame(lc, u8"a{1}b{2}c", 1, 2);
+    expectSame(lc, u8"a{1}b{2}c", 1);
+    expectSame(lc, u8"a{1}b{2}c", 1, 2, 3);
+    expectSame(lc, u8"{2} then {1}", u8"first", u8"second");
+    expectSame(lc, u8"{} {} {}", 1, u8"two", 3);
+    expectSame(lc, u8"{3}{}{1}{}", 1, 2, 3, 4);
+    expectSame(lc, u8"{2|one=# file|many=# files} in {1}", u8"dir", 1);
+    expectSame(lc, u8"{2|one=# file|many=# files} in {1}", u8"dir", 7);
+
+    EXPECT_EQ(u8"2 then first", loc::Tmpl(u8"{2} then {1}").str(u8"first", 2));
+    EXPECT_EQ(u8"1 and {2}", loc::Tmpl(u8"{1} and {2}").str(1));
+}
+
+
+///
+///  Plural rules, exact forms and fallbacks
+///
+TEST (LocTmpl, Plural)
+{
+    loc::Tmpl<char8_t> full(u8"{1|one=# файл|few=# файла|many=# файлов}");
+    EXPECT_EQ(u8"1 файл", full.str(ru, 1));
+    EXPECT_EQ(u8"2 файла", full.str(ru, 2));
+    EXPECT_EQ(u8"5 файлов", full.str(ru, 5));
+    EXPECT_EQ(u8"11 файлов", full.str(ru, 11));
+    EXPECT_EQ(u8"21 файл", full.str(ru, 21));
+    EXPECT_EQ(u8"22 файла", full.str(ru, 22));
+    EXPECT_EQ(u8"112 файлов", full.str(ru, 112u));
+    EXPECT_EQ(u8"-2 файла", full.str(ru, -2));
+    // Default rule: 1 = one, the rest is many
+    EXPECT_EQ(u8"1 файл", full.str(1));
+    EXPECT_EQ(u8"2 файлов", full.str(2));
+
+    // few → many is missing → other
+    loc::Tmpl<char8_t> en(u8"{1|one=# file|other=# files}");
+    EXPECT_EQ(u8"3 files", en.str(ru, 3));
+    EXPECT_EQ(u8"21 file", en.str(ru, 21));
+    // rest wins over everything but exact
+    loc::Tmpl<char8_t> rest(u8"{1|many=many|rest=rest|one=one}");
+    EXPECT_EQ(u8"one", rest.str(ru, 1));
+    EXPECT_EQ(u8"rest", rest.str(ru, 2));
+    EXPECT_EQ(u8"many", rest.str(ru, 5));
+    // Forward, then back
+    loc::Tmpl<char8_t> back(u8"{1|zero=zero|one=one}");
+    EXPECT_EQ(u8"one", back.str(ru, 5));
+    // Custom A
+    loc::Tmpl<char8_t> a(u8"{1|a=none|other=# pcs}");
+    EXPECT_EQ(u8"none", a.str(custom, 0));
+    EXPECT_EQ(u8"2 pcs", a.str(custom, 2));
+    // Strings are just substituted
+    EXPECT_EQ(u8"x", full.str(ru, u8"x"));
+}
+
+
+///
+///  Preformatted numbers, chars, other strings
+///
+TEST (LocTmpl, Args)
+{
+    loc::Tmpl<char8_t> t(u8"{1|one=# file|many=# files}, {2}{3}");
+    EXPECT_EQ(u8"1 000 files, ab",
+              t.str(loc::PreformN<char8_t, int>{ u8"1 000", 1000 }, u8'a', std::u8string(u8"b")));
+    EXPECT_EQ(u8"1.0 file, {2}{3}", t.str(loc::PreformN<char8_t, int>{ u8"1.0", 1 }));
+    EXPECT_EQ(u8"18446744073709551615 files, -9223372036854775808{3}",
+              t.str(std::numeric_limits<unsigned long long>::max(),
+                    std::numeric_limits<long long>::min()));
+
+    loc::Tmpl<wchar_t> w(L"{1|one=# file|many=# files}");
+    EXPECT_EQ(L"3 files", w.str(3));
+    loc::Tmpl<char> c(std::string("{1} {2}"));
+    EXPECT_EQ("4 x", c.str(4, 'x'));
+
+    // Appends, buffer is reused
+    std::u8string buf = u8">";
+    t.append(buf, 1, u8"x", u8"y");
+    t.append(ru, buf, 2, u8"x", u8"y");
+    EXPECT_EQ(u8">1 file, xy2 files, xy", buf);
+}
+
+
+///
+///  Templates parsed at compile time
+///
+TEST (LocTmpl, Static)
+{
+    constexpr auto& t = loc::tmpl<u8"{1|one=# файл|few=# файла|many=# файлов} в {2}">;
+    // Text, argument with 3 forms of 2 pieces, text, argument
+    static_assert(t.view().pieces.size() == 1 + 6 + 1 + 1);
+    static_assert(t.view().plurals.size() == 1);
+    static_assert(t.view().pool.starts_with(u8"{1|one="));
+    EXPECT_EQ(u8"1 файл в dir", t.str(ru, 1, u8"dir"));
+    EXPECT_EQ(u8"3 файла в dir", t.str(ru, 3, u8"dir"));
+    EXPECT_EQ(u8"{1|one=# файл|few=# файла|many=# файлов} в {2}", t.str());
+
+    static_assert(loc::tmpl<"">.view().pieces.empty());
+    static_assert(loc::tmpl<L"{{}">.view().pool == L"{}");
+    EXPECT_EQ(L"{}", loc::tmpl<L"{{}">.str(1));
+    EXPECT_EQ("a 5 b", loc::tmpl<"a {} b">.str(5));
+
+    for (auto n : { 0, 1, 2, 5, 11, 21 }) {
+        EXPECT_EQ(viaFmt(ru, TEMPLATES[11], n),
+                  loc::tmpl<u8"{1|one=# файл|few=# файла|many=# файлов}">.str(ru, n));
+        EXPECT_EQ(viaFmt(ru, TEMPLATES[19], n),
+                  loc::tmpl<u8"{1|one=a{#b{{c{|d{}e|many=x{=y}">.str(ru, n));
+    }
+}
+
+
+///
+///  Fmt vs. precompiled templates in a loop,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (LocTmpl, DISABLED_Benchmark)
+{
+    constexpr int N = 1'000'000;
+    constexpr std::u8string_view TEXT = u8"Found {1|one=# file|few=# files|many=# files} in {2}";
+    const std::u8string_view dir = u8"C:/Users/Documents";
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    size_t sum = 0;
+
+    auto start = Clock::now();
+    for (int i = 0; i < N; ++i) {
+        loc::Fmt<char8_t> fmt(ru, TEXT);
+        fmt(i, dir);
+        sum += fmt.str().length();
+    }
+    auto fmtTime = Ms(Clock::now() - start).count();
+
+    start = Clock::now();
+    loc::Tmpl<char8_t> tmpl(TEXT);
+    std::u8string buf;
+    for (int i = 0; i < N; ++i) {
+        buf.clear();
+        tmpl.append(ru, buf, i, dir);
+        sum += buf.length();
+    }
+    auto tmplTime = Ms(Clock::now() - start).count();
+
+    start = Clock::now();
+    auto& st = loc::tmpl<u8"Found {1|one=# file|few=# files|many=# files} in {2}">;
+    for (int i = 0; i < N; ++i) {
+        buf.clear();
+        st.append(ru, buf, i, dir);
+        sum += buf.length();
+    }
+    auto staticTime = Ms(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (int i = 0; i < N; ++i)
+        sum += tmpl.str(ru, i, dir).length();
+    auto strTime = Ms(Clock::now() - start).count();
+
+    EXPECT_NE(0u, sum);
+    auto ns = [](double ms) { return ms * 1e6 / N; };
+    std::cout << "Fmt: " << ns(fmtTime) << " ns\n"
+              << "Tmpl, reused buffer: " << ns(tmplTime) << " ns\n"
+              << "tmpl<literal>, reused buffer: " << ns(staticTime) << " ns\n"
+              << "Tmpl, new string: " << ns(strTime) << " ns\n";
+}
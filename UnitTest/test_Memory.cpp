@@ -0,0 +1,277 @@
+// What we test
+#include "TrMemory.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+// Libs
+#include "mojibake.h"
+
+// Translation
+#include "TrProject.h"
+
+
+namespace {
+
+    const std::u8string_view WORDS[] {
+        u8"Open", u8"file", u8"Save", u8"as", u8"project", u8"cancel",
+        u8"Привет", u8"мир", u8"ЁЛКА", u8"Straße", u8"日本語", u8"😀",
+    };
+
+    std::u8string randomPhrase(std::mt19937& rng)
+    {
+        std::u8string r;
+        auto n = 1 + rng() % 5;
+        for (unsigned i = 0; i < n; ++i) {
+            if (i != 0)
+                r += u8' ';
+            r += WORDS[rng() % std::size(WORDS)];
+        }
+        return r;
+    }
+
+    /// Plain O(nm) Levenshtein
+    unsigned distance(std::u8string_view a8, std::u8string_view b8)
+    {
+        auto a = mojibake::toM<std::u32string>(a8);
+        auto b = mojibake::toM<std::u32string>(b8);
+        std::vector<unsigned> prev(b.size() + 1), cur(b.size() + 1);
+        for (size_t j = 0; j <= b.size(); ++j)
+            prev[j] = j;
+        for (size_t i = 1; i <= a.size(); ++i) {
+            cur[0] = i;
+            for (size_t j = 1; j <= b.size(); ++j)
+                cur[j] = std::min({ prev[j - 1] + (a[i - 1] != b[j - 1]),
+                                    prev[j] + 1, cur[j - 1] + 1 });
+            std::swap(prev, cur);
+        }
+        return prev[b.size()];
+    }
+
+    unsigned score(std::u8string_view a, std::u8string_view b)
+    {
+        size_t longer = std::max(mojibake::countCps(a), mojibake::countCps(b));
+        return (longer - distance(a, b)) * 100 / longer;
+    }
+
+    void addSome(tr::TranslMemory& mem)
+    {
+        mem.add(u8"Open file", u8"Открыть файл", tr::MemSource::PROJECT);
+        mem.add(u8"Open files", u8"Открыть файлы", tr::MemSource::PROJECT);
+        mem.add(u8"Close file", u8"Закрыть файл", tr::MemSource::TRASH);
+        mem.add(u8"Save project as", u8"Сохранить проект как", tr::MemSource::OTHER);
+        mem.add(u8"Hello, world!", u8"Привет, мир!", tr::MemSource::OTHER);
+    }
+
+}   // anon namespace
+
+
+///
+///  Same original → 100, then similar ones by score
+///
+TEST (TranslMemory, Simple)
+{
+    tr::TranslMemory mem;
+    addSome(mem);
+    mem.build();
+    EXPECT_EQ(5u, mem.size());
+    EXPECT_EQ(0u, mem.nPending());
+
+    auto r = mem.find(u8"Open file");
+    ASSERT_EQ(2u, r.size());
+    EXPECT_EQ(u8"Открыть файл", r[0].translation);
+    EXPECT_EQ(100u, r[0].score);
+    EXPECT_EQ(u8"Open files", r[1].original);
+    EXPECT_EQ(90u, r[1].score);
+    r = mem.find(u8"Open file", 5, 50);
+    ASSERT_EQ(3u, r.size());
+    EXPECT_EQ(u8"Close file", r[2].original);
+    EXPECT_EQ(tr::MemSource::TRASH, r[2].source);
+    EXPECT_EQ(score(u8"Open file", u8"Close file"), r[2].score);
+
+    // maxCount and minScore
+    EXPECT_EQ(1u, mem.find(u8"Open file", 1).size());
+    EXPECT_EQ(1u, mem.find(u8"Open file", 5, 100).size());
+    EXPECT_TRUE(mem.find(u8"Something else entirely").empty());
+    EXPECT_TRUE(mem.find(u8"").empty());
+
+    // Case does not matter for trigrams, but is a difference
+    r = mem.find(u8"OPEN FILE", 5, 0);
+    ASSERT_FALSE(r.empty());
+    EXPECT_EQ(u8"Open file", r[0].original);
+    EXPECT_LT(r[0].score, 100u);
+}
+
+
+///
+///  Pending pairs are found, duplicates are merged, best source wins
+///
+TEST (TranslMemory, PendingAndDups)
+{
+    tr::TranslMemory mem;
+    mem.add(u8"Open file", u8"Открыть файл", tr::MemSource::OTHER);
+    mem.add(u8"Open file", u8"Открыть файл", tr::MemSource::PROJECT);
+    mem.add(u8"Open file", u8"", tr::MemSource::PROJECT);
+    EXPECT_EQ(2u, mem.nPending());
+    auto r = mem.find(u8"Open file");
+    ASSERT_EQ(1u, r.size());
+    EXPECT_EQ(tr::MemSource::PROJECT, r[0].source);
+
+    mem.build();
+    EXPECT_EQ(1u, mem.size());
+    mem.add(u8"Open files", u8"Открыть файлы", tr::MemSource::PROJECT);
+    EXPECT_EQ(1u, mem.nPending());
+    r = mem.find(u8"Open files!");
+    ASSERT_EQ(2u, r.size());
+    EXPECT_EQ(u8"Open files", r[0].original);
+    EXPECT_EQ(u8"Open file", r[1].original);
+}
+
+
+///
+///  Base memory is searched too
+///
+TEST (TranslMemory, Base)
+{
+    auto base = std::make_shared<tr::TranslMemory>();
+    addSome(*base);
+    base->build();
+    tr::TranslMemory mem(base);
+    mem.add(u8"Open file", u8"Открыть файл", tr::MemSource::PROJECT);
+    mem.add(u8"Open file…", u8"Открыть файл…", tr::MemSource::PROJECT);
+    mem.build();
+    EXPECT_EQ(2u, mem.size());
+    auto r = mem.find(u8"Open file");
+    ASSERT_EQ(3u, r.size());
+    EXPECT_EQ(u8"Open file", r[0].original);
+    // Equal scores and sources → own pairs first
+    EXPECT_EQ(u8"Open file…", r[1].original);
+    EXPECT_EQ(u8"Open files", r[2].original);
+}
+
+
+///
+///  Every suggestion has true score, the best one is never lost
+///
+TEST (TranslMemory, Random)
+{
+    std::mt19937 rng(42);
+    tr::TranslMemory mem;
+    std::vector<std::u8string> originals;
+    for (unsigned i = 0; i < 3000; ++i) {
+        auto& orig = originals.emplace_back(randomPhrase(rng));
+        mem.add(orig, randomPhrase(rng), tr::MemSource::PROJECT);
+        if (i == 2000)
+            mem.build();
+    }
+    for (unsigned i = 0; i < 200; ++i) {
+        auto query = (i % 2) ? randomPhrase(rng) : originals[rng() % originals.size()];
+        unsigned minScore = 50 + rng() % 51;
+        auto r = mem.find(query, 10, minScore);
+        bool hasExact = std::find(originals.begin(), originals.end(), query) != originals.end();
+        if (hasExact) {
+            ASSERT_FALSE(r.empty()) << i;
+            EXPECT_EQ(100u, r[0].score) << i;
+            EXPECT_EQ(query, r[0].original) << i;
+        }
+        // Best score is found
+        unsigned best = 0;
+        for (auto& v : originals)
+            best = std::max(best, score(query, v));
+        if (best >= minScore) {
+            ASSERT_FALSE(r.empty()) << i;
+            EXPECT_EQ(best, r[0].score) << i;
+        }
+        for (size_t j = 0; j < r.size(); ++j) {
+            EXPECT_EQ(score(query, r[j].original), r[j].score) << i;
+            EXPECT_GE(r[j].score, minScore) << i;
+            if (j != 0) {
+                EXPECT_GE(r[j - 1].score, r[j].score) << i;
+            }
+        }
+    }
+}
+
+
+///
+///  Saved and loaded memory finds the same
+///
+TEST (TranslMemory, SaveLoad)
+{
+    auto fname = std::filesystem::temp_directory_path() / "utranslator_test_memory.bin";
+    tr::TranslMemory mem;
+    addSome(mem);
+    mem.add(u8"Broken \xFF UTF-8", u8"Битая кодировка", tr::MemSource::OTHER);
+    mem.save(fname);
+    EXPECT_EQ(0u, mem.nPending());
+
+    tr::TranslMemory mem2;
+    ASSERT_TRUE(mem2.load(fname));
+    EXPECT_EQ(mem.size(), mem2.size());
+    EXPECT_TRUE(mem2.isUpToDate());
+    for (auto q : { u8"Open file", u8"Save project", u8"Hello world", u8"Broken \xFF UTF-8" }) {
+        auto r1 = mem.find(q, 5, 50);
+        auto r2 = mem2.find(q, 5, 50);
+        ASSERT_EQ(r1.size(), r2.size());
+        for (size_t i = 0; i < r1.size(); ++i) {
+            EXPECT_EQ(r1[i].original, r2[i].original);
+            EXPECT_EQ(r1[i].translation, r2[i].translation);
+            EXPECT_EQ(r1[i].score, r2[i].score);
+            EXPECT_EQ(r1[i].source, r2[i].source);
+        }
+    }
+    EXPECT_EQ(100u, mem2.find(u8"Broken \xFF UTF-8").at(0).score);
+
+    // Truncated file is not loaded, and does not spoil memory
+    auto size = std::filesystem::file_size(fname);
+    std::filesystem::resize_file(fname, size - 5);
+    EXPECT_FALSE(mem2.load(fname));
+    EXPECT_EQ(mem.size(), mem2.size());
+    std::filesystem::remove(fname);
+    EXPECT_FALSE(mem2.load(fname));
+}
+
+
+///
+///  Project and trash are in memory, exact matches fill texts,
+///  fuzzy ones also mark them for attention
+///
+TEST (TranslMemory, Pretranslate)
+{
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::FULL_TRANSL;
+    auto file = prj->addFile(u8"file", tr::Modify::NO);
+    auto t1 = file->addText(u8"t1", u8"Open file", tr::Modify::NO);
+    t1->tr.translation = u8"Открыть файл";
+    auto t2 = file->addText(u8"t2", u8"Open file", tr::Modify::NO);
+    auto t3 = file->addText(u8"t3", u8"Open files", tr::Modify::NO);
+    auto t4 = file->addText(u8"t4", u8"Close project", tr::Modify::NO);
+    auto t5 = file->addText(u8"t5", u8"Something else", tr::Modify::NO);
+    tr::Translatable lost;
+    lost.original = u8"Close project";
+    lost.translation = u8"Закрыть проект";
+    prj->trash.add({ .fileName = u8"file", .ids = { u8"t0" } }, lost);
+
+    tr::TranslMemory mem;
+    mem.addProject(*prj);
+    mem.build();
+    EXPECT_EQ(2u, mem.size());
+
+    // Exact only
+    EXPECT_EQ(2u, mem.pretranslate(*prj));
+    EXPECT_EQ(u8"Открыть файл", t2->tr.translationSv());
+    EXPECT_FALSE(t2->tr.forceAttention);
+    EXPECT_EQ(u8"Закрыть проект", t4->tr.translationSv());
+    EXPECT_FALSE(t3->tr.translation);
+
+    // Fuzzy, in several threads
+    EXPECT_EQ(1u, mem.pretranslate(*prj, 80, 3));
+    EXPECT_EQ(u8"Открыть файл", t3->tr.translationSv());
+    EXPECT_TRUE(t3->tr.forceAttention);
+    EXPECT_FALSE(t5->tr.translation);
+}
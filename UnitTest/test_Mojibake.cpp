@@ -0,0 +1,205 @@
+// What we test
+#include "mojibake.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <chrono>
+#include <deque>
+#include <random>
+
+
+namespace {
+
+    namespace simd = mojibake::detail::simd;
+
+    constexpr simd::Level ALL_LEVELS[] {
+        simd::Level::SCALAR, simd::Level::SSE2, simd::Level::AVX2 };
+
+    /// Sets level for a scope
+    class LevelSetter
+    {
+    public:
+        LevelSetter(simd::Level x) : old(simd::level()) { simd::setLevel(x); }
+        ~LevelSetter() { simd::setLevel(old); }
+    private:
+        simd::Level old;
+    };
+
+    const std::u8string_view PIECES[] {
+        u8"a", u8"Hello, world! ", u8"<b>%1</b>\n",
+        u8"ё", u8"Привет ", u8"Straße",
+        u8"日本語", u8"中文字符", u8"한국어",
+        u8"😀", u8"👍🏽", u8"𝄞",
+    };
+
+    /// Random UTF-8, maybe broken
+    std::u8string randomText(std::mt19937& rng, size_t nPieces, bool spoil)
+    {
+        std::u8string r;
+        for (size_t i = 0; i < nPieces; ++i)
+            r += PIECES[rng() % std::size(PIECES)];
+        if (spoil && !r.empty()) {
+            auto nBad = 1 + rng() % 3;
+            for (unsigned i = 0; i < nBad; ++i) {
+                auto& c = r[rng() % r.size()];
+                switch (rng() % 3) {
+                case 0: c = static_cast<char8_t>(rng()); break;
+                case 1: c = static_cast<char8_t>(0x80 | (rng() & 0x3F)); break;
+                default: c = static_cast<char8_t>(0xC0 | (rng() & 0x3F)); break;
+                }
+            }
+            if (rng() % 2)
+                r.resize(rng() % r.size());
+        }
+        return r;
+    }
+
+    /// Deque is not contiguous → scalar templates
+    struct Reference {
+        bool isValid;
+        size_t nCps;
+        std::u32string moji, skip, fold;
+
+        Reference(std::u8string_view x)
+        {
+            std::deque<char8_t> d(x.begin(), x.end());
+            isValid = mojibake::isValid(d);
+            nCps = mojibake::countCps(d);
+            moji = mojibake::toM<std::u32string>(d);
+            skip = mojibake::toS<std::u32string>(d);
+            fold = mojibake::simpleCaseFold<std::u32string>(d);
+        }
+    };
+
+    void checkSame(std::u8string_view x)
+    {
+        Reference ref(x);
+        for (auto level : ALL_LEVELS) {
+            LevelSetter setter(level);
+            auto name = static_cast<int>(simd::level());
+            EXPECT_EQ(ref.isValid, mojibake::isValid(x)) << name;
+            EXPECT_EQ(ref.nCps, mojibake::countCps(x)) << name;
+            EXPECT_EQ(ref.moji, mojibake::toM<std::u32string>(x)) << name;
+            EXPECT_EQ(ref.skip, mojibake::toS<std::u32string>(x)) << name;
+            EXPECT_EQ(ref.fold, mojibake::simpleCaseFold<std::u32string>(x)) << name;
+            // char rather than char8_t
+            std::string_view sv(reinterpret_cast<const char*>(x.data()), x.size());
+            EXPECT_EQ(ref.moji, mojibake::toM<std::u32string>(sv)) << name;
+        }
+    }
+
+}   // anon namespace
+
+
+///
+///  Random texts, good and bad: vectorized = scalar
+///
+TEST (MojibakeSimd, Random)
+{
+    std::mt19937 rng(42);
+    for (unsigned i = 0; i < 3000; ++i) {
+        auto text = randomText(rng, rng() % 40, i % 2);
+        checkSame(text);
+        if (HasFailure())
+            break;
+    }
+}
+
+
+///
+///  Every sequence at every place of 32-byte block
+///
+TEST (MojibakeSimd, Boundaries)
+{
+    for (auto piece : PIECES) {
+        for (size_t pos = 0; pos < 70; ++pos) {
+            std::u8string text(pos, u8'x');
+            text += piece;
+            text.append(70, u8'y');
+            checkSame(text);
+            // Truncated → abrupt end
+            for (size_t len = pos; len <= pos + piece.size(); ++len)
+                checkSame(std::u8string_view(text).substr(0, len));
+            // Broken in the middle
+            for (size_t i = 0; i < piece.size(); ++i) {
+                auto bad = text;
+                bad[pos + i] = u8'z';
+                checkSame(bad);
+                bad[pos + i] = 0xFF;
+                checkSame(bad);
+            }
+        }
+    }
+}
+
+
+///
+///  Edge cases of validator: overlong, surrogates, too high
+///
+TEST (MojibakeSimd, EdgeCases)
+{
+    const std::u8string_view SEQS[] {
+        u8"\xC0\x80", u8"\xC1\xBF", u8"\xC2\x80", u8"\xDF\xBF",
+        u8"\xE0\x80\x80", u8"\xE0\x9F\xBF", u8"\xE0\xA0\x80",
+        u8"\xED\x9F\xBF", u8"\xED\xA0\x80", u8"\xED\xBF\xBF", u8"\xEE\x80\x80",
+        u8"\xF0\x80\x80\x80", u8"\xF0\x8F\xBF\xBF", u8"\xF0\x90\x80\x80",
+        u8"\xF4\x8F\xBF\xBF", u8"\xF4\x90\x80\x80", u8"\xF5\x80\x80\x80",
+        u8"\xF8\x88\x80\x80\x80", u8"\xFF", u8"\x80", u8"\xBF\xBF",
+        u8"\xE1\x80", u8"\xF1\x80\x80",
+    };
+    for (auto seq : SEQS) {
+        for (size_t pos : { 0, 1, 15, 29, 30, 31, 32, 33, 63 }) {
+            std::u8string text(pos, u8'-');
+            text += seq;
+            text += u8"Привет, мир! 日本語 😀 and some tail";
+            checkSame(text);
+        }
+    }
+}
+
+
+///
+///  Speed on typical corpora, run with --gtest_also_run_disabled_tests
+///
+TEST (MojibakeSimd, DISABLED_Benchmark)
+{
+    struct Corpus {
+        const char* name;
+        std::u8string_view piece;
+    };
+    static const Corpus CORPORA[] {
+        { "ASCII", u8"Open file %1? <b>Cancel</b> to return.\n" },
+        { "Cyrillic", u8"Открыть файл %1? «Отмена» — вернуться.\n" },
+        { "CJK", u8"ファイル%1を開きますか？「キャンセル」で戻ります。文件已保存。\n" },
+        { "Emoji", u8"😀👍🏽🎉🚀❤️🔥✨🙏" },
+    };
+    using Clock = std::chrono::steady_clock;
+    for (auto& corpus : CORPORA) {
+        std::u8string text;
+        while (text.size() < 4'000'000)
+            text += corpus.piece;
+        for (auto level : ALL_LEVELS) {
+            LevelSetter setter(level);
+            if (simd::level() != level)
+                continue;
+            auto measure = [&text](auto&& body) {
+                auto start = Clock::now();
+                constexpr int N = 10;
+                for (int i = 0; i < N; ++i)
+                    body();
+                std::chrono::duration<double> time = Clock::now() - start;
+                return text.size() * N / time.count() / 1e6;
+            };
+            size_t dummy = 0;
+            auto valid = measure([&] { dummy += mojibake::isValid(text); });
+            auto count = measure([&] { dummy += mojibake::countCps(text); });
+            auto conv = measure([&] { dummy += mojibake::toM<std::u32string>(text).size(); });
+            std::cout << corpus.name << " level " << static_cast<int>(level)
+                      << ": isValid " << valid << " MB/s, countCps " << count
+                      << " MB/s, toM<u32> " << conv << " MB/s\n";
+            EXPECT_NE(0u, dummy);
+        }
+    }
+}
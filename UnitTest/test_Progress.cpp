@@ -0,0 +1,149 @@
+// What we test
+#include "TrProject.h"
+#include "TrSnapshot.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <filesystem>
+
+
+namespace {
+
+    constexpr unsigned N_TEXTS = 20000;
+
+    /// Records progress, cancels after some reports
+    class Recorder final : public tr::ProgressListener
+    {
+    public:
+        explicit Recorder(size_t aCancelAfter = 0) : cancelAfter(aCancelAfter) {}
+        void onProgress(size_t nDone, size_t nTotal) override
+        {
+            reports.emplace_back(nDone, nTotal);
+            if (reports.size() == cancelAfter)
+                isCancelled1 = true;
+        }
+        bool isCancelled() const override { return isCancelled1; }
+
+        SafeVector<std::pair<size_t, size_t>> reports;
+    private:
+        size_t cancelAfter;     ///< [0] never
+        bool isCancelled1 = false;
+    };
+
+    std::shared_ptr<tr::Project> makeOriginal()
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::ORIGINAL;
+        auto file = prj->addFile(u8"f", tr::Modify::NO);
+        for (unsigned i = 0; i < N_TEXTS; ++i) {
+            auto s = str::toU8(std::to_string(i));
+            file->addText(u8"t" + s, u8"orig" + s, tr::Modify::NO);
+        }
+        return prj;
+    }
+
+    size_t nTranslated(const tr::Project& prj)
+    {
+        size_t r = 0;
+        prj.traverseCTexts([&r](const tr::UiObject&, const tr::Translatable& t) {
+            if (t.translation)
+                ++r;
+        });
+        return r;
+    }
+
+}   // anon namespace
+
+
+///
+///  Load reports bytes, and stops when cancelled
+///
+TEST (Progress, Load)
+{
+    ut::TempFile file("utranslator_test_progress.uorig");
+    makeOriginal()->save(file.path);
+    auto size = std::filesystem::file_size(file.path);
+
+    Recorder rec;
+    auto prj = tr::Project::make();
+    prj->load(file.path, &rec);
+    EXPECT_EQ(N_TEXTS, prj->nChildren() ? prj->child(0)->nChildren() : 0);
+    ASSERT_GE(rec.reports.size(), 3u);
+    for (size_t i = 0; i < rec.reports.size(); ++i) {
+        EXPECT_EQ(size, rec.reports[i].second);
+        if (i != 0) {
+            EXPECT_LT(rec.reports[i - 1].first, rec.reports[i].first);
+        }
+    }
+    EXPECT_EQ(size, rec.reports.back().first);
+
+    Recorder canceller(2);
+    auto prj2 = tr::Project::make();
+    EXPECT_THROW(prj2->load(file.path, &canceller), tr::Cancelled);
+    EXPECT_EQ(2u, canceller.reports.size());
+}
+
+
+///
+///  Update cancelled while loading original does not touch project
+///
+TEST (Progress, Update)
+{
+    ut::TempFile file("utranslator_test_progress.uorig");
+    auto original = makeOriginal();
+    original->save(file.path);
+
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::FULL_TRANSL;
+    prj->updateData(tr::TrashMode::FILL, original.get());
+    prj->traverseTexts([](tr::UiObject&, tr::Translatable& t) {
+        t.translation = u8"transl";
+    });
+    prj->info.orig.absPath = file.path;
+    // Change original a bit: one text less
+    original->child(0)->extractChild(0, tr::Modify::NO);
+    original->save(file.path);
+
+    Recorder canceller(1);
+    EXPECT_THROW(prj->updateData(tr::TrashMode::FILL, nullptr, &canceller),
+                 tr::Cancelled);
+    EXPECT_EQ(N_TEXTS, nTranslated(*prj));
+    EXPECT_TRUE(prj->trash.isEmpty());
+
+    // Not cancelled → updated; files are reported after bytes
+    Recorder rec;
+    prj->updateData(tr::TrashMode::FILL, nullptr, &rec);
+    EXPECT_EQ(N_TEXTS - 1, nTranslated(*prj));
+    EXPECT_EQ(1u, prj->trash.size());
+    ASSERT_FALSE(rec.reports.empty());
+    EXPECT_EQ(std::make_pair(size_t{0}, size_t{1}), rec.reports.back());
+}
+
+
+///
+///  Cancelled save writes nothing
+///
+TEST (Progress, Save)
+{
+    ut::TempFile file("utranslator_test_progress.uorig");
+    auto prj = makeOriginal();
+    prj->addFile(u8"g", tr::Modify::NO);
+    prj->modify();
+
+    Recorder canceller(2);
+    EXPECT_THROW(prj->save(file.path, &canceller), tr::Cancelled);
+    EXPECT_FALSE(std::filesystem::exists(file.path));
+    EXPECT_TRUE(prj->isModified());
+
+    Recorder rec;
+    prj->save(file.path, &rec);
+    EXPECT_TRUE(std::filesystem::exists(file.path));
+    EXPECT_FALSE(prj->isModified());
+    EXPECT_EQ((SafeVector<std::pair<size_t, size_t>>{ { 0, 2 }, { 1, 2 }, { 2, 2 } }),
+              rec.reports);
+}
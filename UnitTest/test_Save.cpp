@@ -0,0 +1,54 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <filesystem>
+
+
+namespace {
+
+    std::shared_ptr<tr::Text> text(tr::Project& prj, std::u8string_view id)
+        { return prj.findFile(u8"f")->findText(id); }
+
+}   // anon namespace
+
+
+///
+///  Empty translation is not the same as no translation,
+///    and survives save → load → save
+///
+TEST (Save, EmptyTranslation)
+{
+    ut::TempDir dir("utranslator_test_save_empty");
+    auto fname1 = dir.path / "1.utran";
+    auto fname2 = dir.path / "2.utran";
+
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::FULL_TRANSL;
+    auto file = prj->addFile(u8"f", tr::Modify::NO);
+    auto t1 = file->addText(u8"t1", u8"Empty", tr::Modify::NO);
+    t1->tr.translation = u8"";
+    EXPECT_TRUE(t1->tr.translation->empty());
+    file->addText(u8"t2", u8"None", tr::Modify::NO);
+    auto t3 = file->addText(u8"t3", {}, tr::Modify::NO);
+    t3->tr.translation = u8"Empty original";
+    prj->save(fname1);
+
+    auto prj2 = tr::Project::make();
+    prj2->load(fname1);
+    ASSERT_TRUE(text(*prj2, u8"t1")->tr.translation);
+    EXPECT_EQ(u8"", *text(*prj2, u8"t1")->tr.translation);
+    EXPECT_FALSE(text(*prj2, u8"t2")->tr.translation);
+    EXPECT_EQ(u8"", text(*prj2, u8"t3")->tr.original);
+    EXPECT_EQ(u8"Empty original", *text(*prj2, u8"t3")->tr.translation);
+
+    // Strings loaded, and probably empty ones too, are from arena
+    prj2->saveCopy(fname2);
+    EXPECT_EQ(ut::readFile(fname1), ut::readFile(fname2));
+}
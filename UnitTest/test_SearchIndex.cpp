@@ -0,0 +1,326 @@
+// What we test
+#include "TrSearchIndex.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <chrono>
+#include <iostream>
+#include <random>
+
+// Libs
+#include "mojibake.h"
+
+// Translation
+#include "TrProject.h"
+
+
+namespace {
+
+    const std::u8string_view WORDS[] {
+        u8"Alpha", u8"bravo", u8"CHARLIE", u8"delta", u8"Echo",
+        u8"Привет", u8"мир", u8"ЁЛКА", u8"Straße", u8"ΣΊΣΥΦΟΣ",
+    };
+
+    std::u8string randomPhrase(std::mt19937& rng)
+    {
+        std::u8string r;
+        auto n = rng() % 4;
+        for (unsigned i = 0; i < n; ++i) {
+            if (i != 0)
+                r += u8' ';
+            r += WORDS[rng() % std::size(WORDS)];
+        }
+        return r;
+    }
+
+    std::shared_ptr<tr::Project> makeRandomProject(unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        auto file = prj->addFile(u8"file", tr::Modify::NO);
+        std::vector<std::shared_ptr<tr::VirtualGroup>> groups { file };
+        for (unsigned i = 0; i < 10; ++i) {
+            auto& parent = groups[rng() % groups.size()];
+            auto group = parent->addGroup(randomPhrase(rng), tr::Modify::NO);
+            group->comm.authors = randomPhrase(rng);
+            groups.push_back(group);
+        }
+        for (unsigned i = 0; i < 200; ++i) {
+            auto& parent = groups[rng() % groups.size()];
+            auto text = parent->addText(
+                    u8"id" + randomPhrase(rng), randomPhrase(rng), tr::Modify::NO);
+            if (rng() % 2)
+                text->tr.translation = randomPhrase(rng);
+            text->comm.importers = randomPhrase(rng);
+            text->comm.translators = randomPhrase(rng);
+        }
+        return prj;
+    }
+
+    std::u32string fold(std::u8string_view x)
+        { return mojibake::simpleCaseFold<std::u32string>(x); }
+
+    /// Slow case-insensitive search, index should never miss anything it finds
+    bool slowMatch(tr::UiObject& x, const tr::SearchQuery& q)
+    {
+        auto what = fold(q.text);
+        auto match = [&](tr::SearchChannel ch, std::u8string_view text) {
+            return q.channels.have(ch) && fold(text).find(what) != std::u32string::npos;
+        };
+        if (match(tr::SearchChannel::ID, x.idColumn()))
+            return true;
+        if (auto t = x.translatable()) {
+            if (match(tr::SearchChannel::ORIGINAL, t->original)
+                    || match(tr::SearchChannel::TRANSLATION, t->translationSv()))
+                return true;
+        }
+        if (auto c = x.comments()) {
+            if (match(tr::SearchChannel::IMPORTERS_COMMENT, c->importers)
+                    || match(tr::SearchChannel::AUTHORS_COMMENT, c->authors)
+                    || match(tr::SearchChannel::TRANSLATORS_COMMENT, c->translators))
+                return true;
+        }
+        return false;
+    }
+
+    struct CheckResult {
+        size_t nMatched = 0, nCandidates = 0, nMissed = 0;
+    };
+
+    void checkRec(tr::UiObject& x, const tr::SearchQuery& q,
+                  const tr::SearchCandidates& cands, CheckResult& r)
+    {
+        bool isCand = cands.has(x);
+        if (isCand)
+            ++r.nCandidates;
+        if (slowMatch(x, q)) {
+            ++r.nMatched;
+            if (!isCand)
+                ++r.nMissed;
+        }
+        for (size_t i = 0; i < x.nChildren(); ++i)
+            checkRec(*x.child(i), q, cands, r);
+    }
+
+    CheckResult check(tr::Project& prj, const tr::SearchQuery& q)
+    {
+        CheckResult r;
+        auto cands = prj.searchIndex()->find(prj, q);
+        EXPECT_TRUE(cands.has_value()) << str::toSv(q.text);
+        if (cands)
+            checkRec(prj, q, *cands, r);
+        return r;
+    }
+
+    constexpr auto ALL_CHANNELS = tr::SearchChannel::ID | tr::SearchChannel::ORIGINAL
+            | tr::SearchChannel::TRANSLATION | tr::SearchChannel::IMPORTERS_COMMENT
+            | tr::SearchChannel::AUTHORS_COMMENT | tr::SearchChannel::TRANSLATORS_COMMENT;
+
+}   // anon namespace
+
+
+///
+///  Random queries of any case never miss anything
+///
+TEST (SearchIndex, NoMisses)
+{
+    std::mt19937 rng(42);
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        auto prj = makeRandomProject(seed);
+        for (unsigned i = 0; i < 50; ++i) {
+            auto word = WORDS[rng() % std::size(WORDS)];
+            auto u32 = mojibake::toM<std::u32string>(word);
+            auto start = rng() % (u32.length() - 2);
+            auto part = u32.substr(start, 3 + rng() % (u32.length() - start - 2));
+            // Random case, index should not care
+            for (auto& c : part) {
+                if (rng() % 2)
+                    c = mojibake::simpleCaseFold(c);
+            }
+            tr::SearchQuery q { mojibake::toM<std::u8string>(part), ALL_CHANNELS };
+            if (rng() % 2)
+                q.channels = tr::SearchChannel::ORIGINAL | tr::SearchChannel::AUTHORS_COMMENT;
+            auto r = check(*prj, q);
+            EXPECT_EQ(0u, r.nMissed) << str::toSv(q.text);
+        }
+    }
+}
+
+
+///
+///  Index narrows search
+///
+TEST (SearchIndex, Narrows)
+{
+    auto prj = makeRandomProject(1);
+    prj->files[0]->addText(u8"uniq", u8"Quebec", tr::Modify::NO);
+    auto r = check(*prj, { u8"QUEB", ALL_CHANNELS });
+    EXPECT_EQ(1u, r.nMatched);
+    EXPECT_EQ(1u, r.nCandidates);
+    // No trigram → nothing
+    r = check(*prj, { u8"xyz", ALL_CHANNELS });
+    EXPECT_EQ(0u, r.nCandidates);
+    // Too short → no index
+    EXPECT_FALSE(prj->searchIndex()->find(*prj, { u8"Qu", ALL_CHANNELS }));
+}
+
+
+///
+///  Mutators keep index up to date
+///
+TEST (SearchIndex, Mutators)
+{
+    std::mt19937 rng(1);
+    auto prj = makeRandomProject(2);
+    auto text = prj->files[0]->addText(u8"uniq", u8"Quebec", tr::Modify::NO);
+    check(*prj, { u8"Quebec", ALL_CHANNELS });
+    ASSERT_TRUE(prj->searchIndex()->isIndexed(*text));
+
+    text->setOriginal(u8"Romeo", tr::Modify::YES);
+    auto r = check(*prj, { u8"Quebec", ALL_CHANNELS });
+    EXPECT_EQ(0u, r.nCandidates);
+    r = check(*prj, { u8"romeo", ALL_CHANNELS });
+    EXPECT_EQ(1u, r.nMatched);
+    EXPECT_EQ(1u, r.nCandidates);
+
+    text->setId(u8"Sierra", tr::Modify::YES);
+    r = check(*prj, { u8"Sierra", tr::SearchChannel::ID });
+    EXPECT_EQ(1u, r.nCandidates);
+    r = check(*prj, { u8"uniq", tr::SearchChannel::ID });
+    EXPECT_EQ(0u, r.nCandidates);
+
+    // Many random edits
+    std::vector<tr::UiObject*> texts;
+    prj->traverseTexts([&texts](tr::UiObject& x, tr::Translatable&) { texts.push_back(&x); });
+    for (unsigned i = 0; i < 300; ++i) {
+        auto& t = texts[rng() % texts.size()];
+        switch (rng() % 4) {
+        case 0: t->setOriginal(randomPhrase(rng), tr::Modify::YES); break;
+        case 1: t->setTranslation(randomPhrase(rng), tr::Modify::YES); break;
+        case 2: t->setTranslatorsComment(randomPhrase(rng), tr::Modify::YES); break;
+        default: t->setTranslation(std::nullopt, tr::Modify::YES); break;
+        }
+    }
+    // Same as rebuilt from scratch
+    std::vector<CheckResult> results;
+    for (auto word : WORDS) {
+        r = check(*prj, { std::u8string{word}, ALL_CHANNELS });
+        EXPECT_EQ(0u, r.nMissed) << str::toSv(word);
+        results.push_back(r);
+    }
+    prj->searchIndex()->clear();
+    for (size_t i = 0; i < std::size(WORDS); ++i) {
+        r = check(*prj, { std::u8string{WORDS[i]}, ALL_CHANNELS });
+        EXPECT_EQ(results[i].nCandidates, r.nCandidates) << str::toSv(WORDS[i]);
+    }
+}
+
+
+///
+///  Objects index does not know are always candidates
+///
+TEST (SearchIndex, Unindexed)
+{
+    auto prj = makeRandomProject(3);
+    check(*prj, { u8"Alpha", ALL_CHANNELS });
+    auto text = prj->files[0]->addText(u8"new", u8"Tango", tr::Modify::NO);
+    EXPECT_FALSE(prj->searchIndex()->isIndexed(*text));
+    auto r = check(*prj, { u8"Tango", ALL_CHANNELS });
+    EXPECT_EQ(1u, r.nMatched);
+    EXPECT_EQ(0u, r.nMissed);
+    // Bulk operation: rebuilt
+    prj->searchIndex()->clear();
+    r = check(*prj, { u8"Tango", ALL_CHANNELS });
+    EXPECT_TRUE(prj->searchIndex()->isIndexed(*text));
+    EXPECT_EQ(1u, r.nCandidates);
+}
+
+
+///
+///  Bad UTF-8 channels are always candidates
+///
+TEST (SearchIndex, BadUtf8)
+{
+    auto prj = makeRandomProject(4);
+    prj->files[0]->addText(u8"bad", u8"Ta\xFFngo", tr::Modify::NO);
+    auto r = check(*prj, { u8"Tango", tr::SearchChannel::ORIGINAL });
+    EXPECT_EQ(1u, r.nCandidates);
+    // Other channel → no
+    r = check(*prj, { u8"Tango", tr::SearchChannel::TRANSLATION });
+    EXPECT_EQ(0u, r.nCandidates);
+}
+
+
+///
+///  Search latency, index vs full scan,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (SearchIndex, DISABLED_Benchmark)
+{
+    constexpr unsigned N_GROUPS = 500;
+    constexpr unsigned N_TEXTS = 400;
+    constexpr int N_RUNS = 5;
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    std::mt19937 rng(1);
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::FULL_TRANSL;
+    auto file = prj->addFile(u8"file", tr::Modify::NO);
+    for (unsigned i = 0; i < N_GROUPS; ++i) {
+        auto group = file->addGroup(u8"group", tr::Modify::NO);
+        for (unsigned j = 0; j < N_TEXTS; ++j) {
+            auto n = str::toU8(std::to_string(i * N_TEXTS + j));
+            auto text = group->addText(u8"id" + n,
+                    randomPhrase(rng) + u8" #" + n, tr::Modify::NO);
+            if (j % 2 == 0)
+                text->tr.translation = randomPhrase(rng);
+        }
+    }
+
+    auto start = Clock::now();
+    prj->searchIndex()->find(*prj, { u8"Alpha", ALL_CHANNELS });
+    std::cout << N_GROUPS * N_TEXTS << " texts, index built in "
+              << Ms(Clock::now() - start).count() << " ms, "
+              << prj->searchIndex()->nEntries() << " entries\n";
+
+    /// Walks the tree, matches objects that index gives
+    auto search = [&prj](const tr::SearchQuery& q,
+                         const tr::SearchCandidates* cands) {
+        size_t nFound = 0;
+        std::vector<tr::UiObject*> stack { prj.get() };
+        while (!stack.empty()) {
+            auto x = stack.back();
+            stack.pop_back();
+            if (!cands || cands->has(*x))
+                nFound += slowMatch(*x, q);
+            for (size_t i = 0; i < x->nChildren(); ++i)
+                stack.push_back(x->childRaw(i));
+        }
+        return nFound;
+    };
+
+    for (std::u8string_view what : { u8"#12345", u8"Straße", u8"alpha bravo" }) {
+        tr::SearchQuery q { std::u8string{what}, ALL_CHANNELS };
+        double bestIndex = 1e30, bestScan = 1e30;
+        size_t nFound = 0, nCandidates = 0;
+        for (int i = 0; i < N_RUNS; ++i) {
+            start = Clock::now();
+            auto cands = prj->searchIndex()->find(*prj, q);
+            ASSERT_TRUE(cands);
+            nFound = search(q, &*cands);
+            nCandidates = cands->size();
+            bestIndex = std::min(bestIndex, Ms(Clock::now() - start).count());
+
+            start = Clock::now();
+            EXPECT_EQ(nFound, search(q, nullptr));
+            bestScan = std::min(bestScan, Ms(Clock::now() - start).count());
+        }
+        std::cout << '"' << str::toSv(what) << "\": " << nFound << " found, "
+                  << nCandidates << " candidates; index "
+                  << bestIndex << " ms, full scan " << bestScan << " ms\n";
+    }
+}
@@ -0,0 +1,260 @@
+// What we test
+#include "TrSnapshot.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+// Project
+#include "TrFile.h"
+#include "TrProject.h"
+
+
+namespace {
+
+    /// Saves project that has everything XML can store
+    void makeProject(const std::filesystem::path& fname)
+    {
+        auto dir = fname.parent_path();
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        prj->info.orig.lang = "en";
+        prj->info.orig.absPath = dir / "orig.uorig";
+        prj->info.ref.absPath = dir / "ref.utran";
+        prj->info.transl.lang = "ru";
+        prj->info.transl.pseudoloc = tr::PrjInfo::Transl::Pseudoloc::DFLT;
+
+        auto file = prj->addFile(u8"f", tr::Modify::NO);
+        file->info.isIdless = true;
+        file->info.origPath = u8"lang/en.ini";
+        file->info.translPath = u8"lang/ru.ini";
+        auto ini = std::make_unique<tf::Ini>();
+        ini->textFormat.writeBom = false;
+        ini->textEscape.space = escape::SpaceMode::DELIMITED;
+        file->info.format = std::move(ini);
+        file->comm.authors = u8"File comment";
+
+        auto group = file->addGroup(u8"g", tr::Modify::NO);
+        group->comm.importers = u8"Imported";
+        group->comm.translators = u8"Translated";
+        group->sync.format = tf::UiProto::INST.make();
+        group->sync.absPath = dir / "Forms" / "FmMain.ui";
+        group->sync.info.textOwner = tf::TextOwner::EDITOR;
+
+        auto t1 = group->addText(u8"t1", u8"Line 1\nLine 2", tr::Modify::NO);
+        t1->tr.translation = u8"Строка 1\nСтрока 2";
+        t1->tr.forceAttention = true;
+        t1->comm.authors = u8"Tamper me";
+        auto t2 = group->addText(u8"t2", u8"Empty translation", tr::Modify::NO);
+        t2->tr.translation = u8"";
+        auto t3 = group->addText(u8"t3", u8"New original", tr::Modify::NO);
+        t3->tr.knownOriginal.text = u8"Old original";
+        group->addGroup(u8"empty", tr::Modify::NO);
+        file->addText(u8"t4", u8"Untranslated", tr::Modify::NO);
+        prj->addFile(u8"empty", tr::Modify::NO);
+        prj->save(fname);
+    }
+
+    std::shared_ptr<tr::Project> load(
+            const std::filesystem::path& fname,
+            tr::LoadMode mode = tr::LoadMode::EDIT)
+    {
+        auto prj = tr::Project::make();
+        prj->load(fname, nullptr, mode);
+        return prj;
+    }
+
+    std::shared_ptr<tr::Text> text(tr::Project& prj, std::u8string_view id)
+        { return prj.findFile(u8"f")->findGroup(u8"g")->findText(id); }
+
+}   // anon namespace
+
+
+///
+///  Project from snapshot is the same as from XML
+///
+TEST (Snapshot, Same)
+{
+    ut::TempFile file("utranslator_test_snapshot.utran");
+    ut::TempFile copy("utranslator_test_snapshot_copy.utran");
+    makeProject(file.path);
+    auto snapName = tr::snapshot::fnameFor(file.path);
+    EXPECT_FALSE(std::filesystem::exists(snapName));
+
+    auto prj1 = load(file.path);
+    ASSERT_TRUE(std::filesystem::exists(snapName));
+    auto prj2 = load(file.path);
+    EXPECT_FALSE(prj2->isModified());
+    EXPECT_EQ(u8"Line 1\nLine 2", text(*prj2, u8"t1")->tr.original);
+    EXPECT_TRUE(text(*prj2, u8"t1")->tr.original.isBorrowed());
+    EXPECT_TRUE(text(*prj2, u8"t2")->tr.translation);
+    EXPECT_FALSE(text(*prj2, u8"t3")->tr.translation);
+    EXPECT_EQ(file.path.parent_path() / "Forms" / "FmMain.ui",
+              prj2->findFile(u8"f")->findGroup(u8"g")->sync.absPath);
+    // Index is OK
+    EXPECT_TRUE(prj2->findFile(u8"f")->findText(u8"t4"));
+
+    // The same XML back
+    prj2->saveCopy(copy.path);
+    EXPECT_EQ(ut::readFile(file.path), ut::readFile(copy.path));
+}
+
+
+///
+///  Snapshot is used while XML is the same, and rebuilt otherwise
+///
+TEST (Snapshot, Stale)
+{
+    ut::TempFile file("utranslator_test_snapshot.utran");
+    makeProject(file.path);
+    load(file.path);
+    auto snapName = tr::snapshot::fnameFor(file.path);
+
+    // Make snapshot say another thing → it is used
+    auto data = ut::readFile(snapName);
+    auto pos = data.find("Tamper me");
+    ASSERT_NE(std::string::npos, pos);
+    data.replace(pos, 9, "TAMPER ME");
+    ut::writeFile(snapName, data);
+    EXPECT_EQ(u8"TAMPER ME", text(*load(file.path), u8"t1")->comm.authors);
+
+    // XML changed, the same size and time → hash finds it
+    auto time = std::filesystem::last_write_time(file.path);
+    auto xml = ut::readFile(file.path);
+    pos = xml.find("Tamper me");
+    ASSERT_NE(std::string::npos, pos);
+    xml.replace(pos, 9, "Tamper it");
+    ut::writeFile(file.path, xml);
+    std::filesystem::last_write_time(file.path, time);
+    EXPECT_EQ(u8"Tamper it", text(*load(file.path), u8"t1")->comm.authors);
+    // Snapshot rebuilt
+    EXPECT_EQ(std::string::npos, ut::readFile(snapName).find("TAMPER ME"));
+    EXPECT_EQ(u8"Tamper it", text(*load(file.path), u8"t1")->comm.authors);
+
+    // Saved → XML is newer
+    auto prj = load(file.path);
+    text(*prj, u8"t1")->setTranslation(u8"New", tr::Modify::YES);
+    prj->save();
+    EXPECT_EQ(u8"New", text(*load(file.path), u8"t1")->tr.translationSv());
+}
+
+
+///
+///  Projects just read do not write snapshot, but use a fresh one
+///
+TEST (Snapshot, Modes)
+{
+    ut::TempFile file("utranslator_test_snapshot.utran");
+    makeProject(file.path);
+    auto snapName = tr::snapshot::fnameFor(file.path);
+
+    auto prj = load(file.path, tr::LoadMode::READ);
+    EXPECT_EQ(u8"Tamper me", text(*prj, u8"t1")->comm.authors);
+    EXPECT_FALSE(std::filesystem::exists(snapName));
+
+    // Opt-in
+    load(file.path, tr::LoadMode::CACHE);
+    ASSERT_TRUE(std::filesystem::exists(snapName));
+    auto data = ut::readFile(snapName);
+    auto pos = data.find("Tamper me");
+    ASSERT_NE(std::string::npos, pos);
+    data.replace(pos, 9, "TAMPER ME");
+    ut::writeFile(snapName, data);
+    EXPECT_EQ(u8"TAMPER ME", text(*load(file.path, tr::LoadMode::READ), u8"t1")->comm.authors);
+
+    // Stale snapshot is not rewritten by those who just read
+    auto xml = ut::readFile(file.path);
+    xml += "\n";
+    ut::writeFile(file.path, xml);
+    EXPECT_EQ(u8"Tamper me", text(*load(file.path, tr::LoadMode::READ), u8"t1")->comm.authors);
+    EXPECT_EQ(data, ut::readFile(snapName));
+}
+
+
+///
+///  Torn or broken snapshot → XML
+///
+TEST (Snapshot, Garbage)
+{
+    ut::TempFile file("utranslator_test_snapshot.utran");
+    makeProject(file.path);
+    load(file.path);
+    auto snapName = tr::snapshot::fnameFor(file.path);
+    auto size = std::filesystem::file_size(snapName);
+
+    std::filesystem::resize_file(snapName, size - 5);
+    EXPECT_EQ(u8"Tamper me", text(*load(file.path), u8"t1")->comm.authors);
+    // Rebuilt
+    EXPECT_EQ(size, std::filesystem::file_size(snapName));
+
+    // Node kinds and string indexes are broken
+    auto data = ut::readFile(snapName);
+    for (size_t i = 64; i < data.size() - 64; i += 7)
+        data[i] = '\xFF';
+    ut::writeFile(snapName, data);
+    EXPECT_EQ(u8"Tamper me", text(*load(file.path), u8"t1")->comm.authors);
+
+    ut::writeFile(snapName, "garbage");
+    EXPECT_EQ(u8"Tamper me", text(*load(file.path), u8"t1")->comm.authors);
+    EXPECT_EQ(size, std::filesystem::file_size(snapName));
+}
+
+
+///
+///  Load from XML and from snapshot, run with --gtest_also_run_disabled_tests
+///
+TEST (Snapshot, DISABLED_Benchmark)
+{
+    constexpr unsigned N_TEXTS = 100'000;
+    constexpr int N_RUNS = 5;
+    ut::TempFile file("utranslator_test_snapshot.utran");
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        prj->info.transl.lang = "ru";
+        auto f = prj->addFile(u8"f", tr::Modify::NO);
+        for (unsigned i = 0; i < N_TEXTS; ++i) {
+            auto s = str::toU8(std::to_string(i));
+            auto group = (i % 100 == 0) ? f->addGroup(u8"g" + s, tr::Modify::NO)
+                                        : f->findGroup(u8"g" + str::toU8(std::to_string(i / 100 * 100)));
+            auto t = group->addText(u8"t" + s,
+                    u8"Open file " + s + u8"? “Cancel” to return.\nOpen file?",
+                    tr::Modify::NO);
+            if (i % 3 != 0)
+                t->tr.translation = u8"Открыть файл " + s + u8"? «Отмена» — вернуться.";
+            if (i % 10 == 0)
+                t->comm.authors = u8"Comment " + s;
+        }
+        prj->save(file.path);
+    }
+    auto snapName = tr::snapshot::fnameFor(file.path);
+
+    using Clock = std::chrono::steady_clock;
+    auto measure = [&](bool useSnapshot) {
+        double best = 1e100;
+        for (int i = 0; i < N_RUNS; ++i) {
+            if (!useSnapshot)
+                std::filesystem::remove(snapName);
+            auto prj = tr::Project::make();
+            auto start = Clock::now();
+            prj->load(file.path, nullptr, tr::LoadMode::EDIT);
+            std::chrono::duration<double, std::milli> time = Clock::now() - start;
+            best = std::min(best, time.count());
+        }
+        return best;
+    };
+    auto xmlTime = measure(false);
+    auto snapTime = measure(true);
+    std::cout << N_TEXTS << " texts: XML " << std::filesystem::file_size(file.path)
+              << " bytes, snapshot " << std::filesystem::file_size(snapName) << " bytes\n"
+              << "Load from XML (+ writing snapshot): " << xmlTime << " ms\n"
+              << "Load from snapshot: " << snapTime << " ms\n";
+}
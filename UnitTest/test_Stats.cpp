@@ -0,0 +1,155 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <chrono>
+#include <iostream>
+#include <random>
+
+
+namespace {
+
+    /// Random tree: files, nested groups, texts in all attention modes
+    std::shared_ptr<tr::Project> makeRandomProject(unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        auto nFiles = 1 + rng() % 5;
+        for (unsigned iFile = 0; iFile < nFiles; ++iFile) {
+            auto file = prj->addFile(u8"f" + std::u8string(1, u8'0' + iFile), tr::Modify::NO);
+            std::vector<std::shared_ptr<tr::VirtualGroup>> groups { file };
+            auto nGroups = rng() % 40;
+            for (unsigned i = 0; i < nGroups; ++i) {
+                auto& parent = groups[rng() % groups.size()];
+                groups.push_back(parent->addGroup(u8"g", tr::Modify::NO));
+            }
+            auto nTexts = rng() % 300;
+            for (unsigned i = 0; i < nTexts; ++i) {
+                auto& parent = groups[rng() % groups.size()];
+                auto text = parent->addText(u8"t", u8"orig", tr::Modify::NO);
+                auto flags = rng();
+                if (flags & 1)
+                    text->tr.translation = u8"transl";
+                if (flags & 2)
+                    text->tr.knownOriginal.text = u8"known";
+                if ((flags & 12) == 0)
+                    text->tr.forceAttention = true;
+            }
+        }
+        return prj;
+    }
+
+    void collectStats(tr::UiObject& x, std::vector<std::optional<tr::Stats>>& r)
+    {
+        r.push_back(x.cache.stats);
+        for (size_t i = 0; i < x.nChildren(); ++i)
+            collectStats(*x.child(i), r);
+    }
+
+    /// Spoils caches: the function tested should recompute all of them
+    void spoilStats(tr::UiObject& x)
+    {
+        tr::Stats bad;
+        bad.nGroups = 12345;
+        x.cache.stats = bad;
+        for (size_t i = 0; i < x.nChildren(); ++i)
+            spoilStats(*x.child(i));
+    }
+
+}   // anon namespace
+
+
+///
+///  Parallel stats fill the same caches as serial ones
+///
+TEST (ParallelStats, SameAsSerial)
+{
+    for (unsigned seed = 1; seed <= 30; ++seed) {
+        auto prj = makeRandomProject(seed);
+
+        spoilStats(*prj);
+        auto serial = prj->stats(tr::StatsMode::ALL_CHILDREN, tr::CascadeDropCache::NO);
+        std::vector<std::optional<tr::Stats>> serialCaches;
+        collectStats(*prj, serialCaches);
+
+        for (unsigned nThreads : { 2u, 3u, 8u }) {
+            spoilStats(*prj);
+            auto parallel = prj->parallelStats(tr::CascadeDropCache::NO, nThreads);
+            std::vector<std::optional<tr::Stats>> parallelCaches;
+            collectStats(*prj, parallelCaches);
+            EXPECT_EQ(serial, parallel) << "seed " << seed << ", threads " << nThreads;
+            EXPECT_TRUE(serialCaches == parallelCaches)
+                    << "seed " << seed << ", threads " << nThreads;
+        }
+    }
+}
+
+
+///
+///  childRaw is child w/o refcounting
+///
+TEST (ParallelStats, ChildRaw)
+{
+    auto prj = makeRandomProject(1);
+    std::vector<tr::UiObject*> stack { prj.get() };
+    while (!stack.empty()) {
+        auto x = stack.back();
+        stack.pop_back();
+        for (size_t i = 0; i < x->nChildren(); ++i) {
+            EXPECT_EQ(x->child(i).get(), x->childRaw(i));
+            stack.push_back(x->childRaw(i));
+        }
+        EXPECT_EQ(nullptr, x->childRaw(x->nChildren()));
+    }
+}
+
+
+///
+///  Recount of 1M texts, serial and parallel,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (ParallelStats, DISABLED_Benchmark)
+{
+    constexpr unsigned N_FILES = 20;
+    constexpr unsigned N_GROUPS = 100;
+    constexpr unsigned N_TEXTS = 500;
+    constexpr int N_RUNS = 5;
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::FULL_TRANSL;
+    for (unsigned i = 0; i < N_FILES; ++i) {
+        auto file = prj->addFile(u8"f" + str::toU8(std::to_string(i)), tr::Modify::NO);
+        for (unsigned j = 0; j < N_GROUPS; ++j) {
+            auto group = file->addGroup(u8"g", tr::Modify::NO);
+            for (unsigned k = 0; k < N_TEXTS; ++k) {
+                auto text = group->addText(u8"t", u8"orig", tr::Modify::NO);
+                if (k % 2 == 0)
+                    text->tr.translation = u8"transl";
+            }
+        }
+    }
+
+    auto time = [&](auto recount) {
+        double best = 1e30;
+        for (int i = 0; i < N_RUNS; ++i) {
+            auto start = Clock::now();
+            auto& stats = recount();
+            best = std::min(best, Ms(Clock::now() - start).count());
+            EXPECT_EQ(N_FILES * N_GROUPS * N_TEXTS, stats.text.nTotal());
+        }
+        return best;
+    };
+    auto serial = time([&]() -> const tr::Stats&
+        { return prj->stats(tr::StatsMode::ALL_CHILDREN, tr::CascadeDropCache::NO); });
+    auto parallel = time([&]() -> const tr::Stats&
+        { return prj->parallelStats(tr::CascadeDropCache::NO); });
+    std::cout << N_FILES * N_GROUPS * N_TEXTS << " texts\n"
+              << "Serial: " << serial << " ms\n"
+              << "Parallel: " << parallel << " ms\n";
+}
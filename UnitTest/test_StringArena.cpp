@@ -0,0 +1,196 @@
+// What we test
+#include "u_StringArena.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// C++
+#include <iostream>
+#include <optional>
+#include <vector>
+#ifdef __GLIBC__
+    #include <malloc.h>
+#endif
+
+
+///// ArenaString //////////////////////////////////////////////////////////////
+
+
+TEST (ArenaString, Own)
+{
+    str::ArenaString s = u8"Alpha";
+    EXPECT_EQ(u8"Alpha", s);
+    EXPECT_EQ(5u, s.length());
+    EXPECT_FALSE(s.isBorrowed());
+    EXPECT_EQ(0, s.c_str()[5]);
+}
+
+
+TEST (ArenaString, Empty)
+{
+    str::ArenaString s;
+    EXPECT_TRUE(s.empty());
+    EXPECT_EQ(std::u8string_view{}, s);
+    EXPECT_EQ(0, s.c_str()[0]);
+    s = u8"";
+    EXPECT_TRUE(s.empty());
+}
+
+
+///
+///  Moving own string just takes the buffer
+///
+TEST (ArenaString, MoveOwn)
+{
+    str::ArenaString s1 = u8"Alpha";
+    auto data = s1.data();
+    str::ArenaString s2 = std::move(s1);
+    EXPECT_EQ(data, s2.data());
+    EXPECT_EQ(u8"Alpha", s2);
+}
+
+
+///
+///  Assigning a part of itself
+///
+TEST (ArenaString, AssignSelfPart)
+{
+    str::ArenaString s = u8"Alpha Bravo";
+    s = s.sv().substr(6);
+    EXPECT_EQ(u8"Bravo", s);
+}
+
+
+///// StringArena //////////////////////////////////////////////////////////////
+
+
+TEST (StringArena, Borrowed)
+{
+    str::StringArena arena;
+    str::ArenaString s1, s2;
+    arena.put(s1, u8"Alpha");
+    arena.put(s2, u8"Bravo");
+    EXPECT_TRUE(s1.isBorrowed());
+    EXPECT_EQ(u8"Alpha", s1);
+    EXPECT_EQ(u8"Bravo", s2);
+    EXPECT_EQ(0, s1.c_str()[5]);
+    // Same chunk, one after another
+    EXPECT_EQ(s1.data() + 6, s2.data());
+    EXPECT_EQ(12u, arena.nBytesUsed());
+}
+
+
+///
+///  Copy-on-write: copy/move of borrowed string is own
+///
+TEST (StringArena, CopyOnWrite)
+{
+    std::optional<str::ArenaString> s3;
+    {
+        str::StringArena arena;
+        str::ArenaString s1;
+        arena.put(s1, u8"Alpha");
+        str::ArenaString s2 = s1;
+        EXPECT_FALSE(s2.isBorrowed());
+        EXPECT_NE(s1.data(), s2.data());
+        s3 = std::move(s1);
+        EXPECT_FALSE(s3->isBorrowed());
+        EXPECT_EQ(u8"Alpha", s1);
+        // Edit → own
+        arena.put(s1, u8"Charlie");
+        s1 = s1.sv().substr(1);
+        EXPECT_FALSE(s1.isBorrowed());
+        EXPECT_EQ(u8"harlie", s1);
+    }
+    // Arena is dead here
+    EXPECT_EQ(u8"Alpha", *s3);
+}
+
+
+TEST (StringArena, Long)
+{
+    str::StringArena arena;
+    std::u8string big(100000, 'a');
+    str::ArenaString s1, s2;
+    arena.put(s1, u8"Alpha");
+    arena.put(s2, big);
+    EXPECT_EQ(big, s2);
+    EXPECT_TRUE(s2.isBorrowed());
+    // Long strings do not spend current chunk
+    str::ArenaString s3;
+    arena.put(s3, u8"Bravo");
+    EXPECT_EQ(s1.data() + 6, s3.data());
+}
+
+
+///
+///  Block of strings is copied at once, pieces are borrowed
+///
+TEST (StringArena, Block)
+{
+    str::StringArena arena;
+    constexpr std::u8string_view BLOCK { u8"Alpha\0Bravo\0", 12 };
+    auto block = arena.putBlock(BLOCK);
+    EXPECT_EQ(BLOCK, block);
+    EXPECT_NE(BLOCK.data(), block.data());
+    EXPECT_EQ(12u, arena.nBytesUsed());
+
+    str::ArenaString s1 = u8"Own", s2;
+    arena.borrow(s1, block.substr(0, 5));
+    arena.borrow(s2, block.substr(6, 5));
+    EXPECT_TRUE(s1.isBorrowed());
+    EXPECT_EQ(u8"Alpha", s1);
+    EXPECT_EQ(u8"Bravo", s2);
+    EXPECT_EQ(block.data(), s1.data());
+    EXPECT_EQ(0, s2.c_str()[5]);
+    arena.borrow(s1, {});
+    EXPECT_TRUE(s1.empty());
+}
+
+
+///
+///  Memory per string: std::u8string, own and borrowed ArenaString,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (StringArena, DISABLED_Benchmark)
+{
+#ifdef __GLIBC__
+    constexpr size_t N = 1'000'000;
+    // Lengths 4…63, like IDs and short texts of a project
+    std::vector<std::u8string> src;
+    src.reserve(N);
+    size_t nChars = 0;
+    for (size_t i = 0; i < N; ++i) {
+        auto& s = src.emplace_back(4 + i * 7919 % 60, u8'a');
+        nChars += s.length();
+    }
+    // Big blocks are mmap’ed, they go apart
+    auto heap = [] { auto mi = mallinfo2();  return mi.uordblks + mi.hblkhd; };
+    // Vector’s heap includes sizeof strings
+    auto report = [&](const char* name, size_t heapBefore) {
+        std::cout << name << ": " << double(heap() - heapBefore) / N
+                  << " bytes/string\n";
+    };
+    std::cout << double(nChars) / N << " chars/string\n";
+
+    {   auto h0 = heap();
+        std::vector<std::u8string> v(src.begin(), src.end());
+        report("std::u8string", h0);
+    }
+    {   auto h0 = heap();
+        std::vector<str::ArenaString> v(src.begin(), src.end());
+        report("ArenaString, own", h0);
+    }
+    {   auto h0 = heap();
+        str::StringArena arena;
+        std::vector<str::ArenaString> v(N);
+        for (size_t i = 0; i < N; ++i)
+            arena.put(v[i], src[i]);
+        report("ArenaString, borrowed", h0);
+        std::cout << "  arena: " << double(arena.nBytesUsed()) / N << " used, "
+                  << double(arena.nBytesAllocated()) / N << " allocated\n";
+    }
+#else
+    GTEST_SKIP() << "Needs glibc’s mallinfo2";
+#endif
+}
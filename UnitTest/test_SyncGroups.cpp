@@ -0,0 +1,283 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+// Project
+#include "TrFile.h"
+
+
+namespace {
+
+    /// Writes Qt form with nLabels labels: “Label i of <tag>”
+    void writeUi(const std::filesystem::path& fname, int nLabels, std::string_view tag)
+    {
+        std::ofstream os(fname, std::ios::binary);
+        os << R"(<?xml version="1.0" encoding="UTF-8"?>)" "\n"
+              R"(<ui version="4.0"><class>Form</class>)"
+              R"(<widget class="QWidget" name="Form"><layout class="QVBoxLayout" name="lay">)";
+        for (int i = 0; i < nLabels; ++i) {
+            os << R"(<item><widget class="QLabel" name="lb)" << i << R"(">)"
+                  R"(<property name="text"><string>Label )" << i << " of " << tag
+               << R"(</string></property></widget></item>)";
+        }
+        os << R"(</layout></widget></ui>)";
+    }
+
+    std::shared_ptr<tr::Group> addSyncGroup(
+            tr::File& file, const std::filesystem::path& fname,
+            tf::TextOwner textOwner = tf::TextOwner::EDITOR)
+    {
+        auto group = file.addGroup(fname.stem().u8string(), tr::Modify::NO);
+        group->sync.format = tf::UiProto::INST.make();
+        group->sync.absPath = fname;
+        group->sync.info.textOwner = textOwner;
+        return group;
+    }
+
+    /// Project with nGroups synchronized groups, nLabels texts each
+    std::shared_ptr<tr::Project> makeProject(
+            const std::filesystem::path& dir, int nGroups, int nLabels)
+    {
+        auto prj = tr::Project::make();
+        auto file = prj->addFile(u8"f", tr::Modify::NO);
+        for (int i = 0; i < nGroups; ++i) {
+            auto fname = dir / ("Fm" + std::to_string(i) + ".ui");
+            writeUi(fname, nLabels, "v1");
+            addSyncGroup(*file, fname);
+        }
+        return prj;
+    }
+
+    tr::Text& firstText(tr::Group& group)
+        { return static_cast<tr::Text&>(*group.children.at(0)); }
+
+}   // anon namespace
+
+
+///
+///  Fingerprint to string and back
+///
+TEST (SyncGroups, Fingerprint)
+{
+    tr::SyncFingerprint fp {
+        .source { .size = 123, .time = -5, .hash = 0xFEDC'BA98'7654'3210 },
+        .tree = 1 };
+    auto s = fp.toString();
+    EXPECT_EQ("7b-fffffffffffffffb-fedcba9876543210-1", s);
+    EXPECT_EQ(fp, tr::SyncFingerprint::parse(s));
+
+    EXPECT_EQ("", tr::SyncFingerprint{}.toString());
+    EXPECT_FALSE(tr::SyncFingerprint::parse(""));
+    EXPECT_FALSE(tr::SyncFingerprint::parse("1-2-3"));
+    EXPECT_FALSE(tr::SyncFingerprint::parse("1-2-3-4-"));
+    EXPECT_FALSE(tr::SyncFingerprint::parse("1-2-x-4"));
+    EXPECT_FALSE(tr::SyncFingerprint::parse("1-2-3-10000000000000000"));
+}
+
+
+///
+///  Unchanged group is skipped, changed source and hand edits are not
+///
+TEST (SyncGroups, Skip)
+{
+    ut::TempDir dir("utranslator_test_sync_skip");
+    auto prj = makeProject(dir.path, 2, 3);
+    auto groups = prj->syncGroups();
+    ASSERT_EQ(2u, groups.size());
+
+    auto r = prj->updateSyncGroups();
+    EXPECT_TRUE(r.isOk());
+    EXPECT_EQ(2u, r.nUpdated);
+    EXPECT_EQ(0u, r.nSkipped);
+    EXPECT_EQ(6u, r.data.nAdded);
+    EXPECT_TRUE(groups[0]->sync.fingerprint);
+    EXPECT_EQ(u8"Label 0 of v1", firstText(*groups[0]).tr.original);
+
+    // Nothing changed
+    r = prj->updateSyncGroups();
+    EXPECT_EQ(0u, r.nUpdated);
+    EXPECT_EQ(2u, r.nSkipped);
+    EXPECT_FALSE(r.data.hasSmth());
+
+    // Translation: update keeps it anyway
+    firstText(*groups[0]).tr.translation = u8"Метка";
+    r = prj->updateSyncGroups();
+    EXPECT_EQ(2u, r.nSkipped);
+
+    // Source changed
+    writeUi(groups[1]->sync.absPath, 3, "v2");
+    r = prj->updateSyncGroups();
+    EXPECT_EQ(1u, r.nUpdated);
+    EXPECT_EQ(1u, r.nSkipped);
+    EXPECT_EQ(3u, r.data.changed.nTotal());
+    EXPECT_EQ(u8"Label 0 of v2", firstText(*groups[1]).tr.original);
+
+    // Hand-edited original: external software owns texts → restored
+    firstText(*groups[0]).tr.original = u8"Hand-edited";
+    r = prj->updateSyncGroups();
+    EXPECT_EQ(1u, r.nUpdated);
+    EXPECT_EQ(u8"Label 0 of v1", firstText(*groups[0]).tr.original);
+    EXPECT_EQ(u8"Метка", firstText(*groups[0]).tr.translation);
+
+    // Hand-deleted text is restored too
+    groups[0]->children.pop_back();
+    groups[0]->dropChildIndex();
+    r = prj->updateSyncGroups();
+    EXPECT_EQ(1u, r.nUpdated);
+    EXPECT_EQ(3u, groups[0]->children.size());
+
+    // Sync settings changed
+    groups[1]->sync.info.textOwner = tf::TextOwner::ME;
+    r = prj->updateSyncGroups();
+    EXPECT_EQ(1u, r.nUpdated);
+    EXPECT_EQ(1u, r.nSkipped);
+}
+
+
+///
+///  Parallel update is the same as serial one, and as Group::updateData
+///
+TEST (SyncGroups, Parallel)
+{
+    ut::TempDir dir("utranslator_test_sync_parallel");
+    auto prj1 = makeProject(dir.path, 20, 10);
+    auto prj2 = makeProject(dir.path, 20, 10);
+    auto prj3 = makeProject(dir.path, 20, 10);
+    auto groups1 = prj1->syncGroups();
+    auto groups2 = prj2->syncGroups();
+    auto groups3 = prj3->syncGroups();
+    for (int i = 0; i < 20; i += 3) {
+        writeUi(groups1[i]->sync.absPath, 10 + i, "v2");
+    }
+
+    auto r1 = prj1->updateSyncGroups(1);
+    auto r2 = prj2->updateSyncGroups(8);
+    tr::UpdateInfo r3;
+    for (auto& v : groups3)
+        r3 += v->updateData();
+    EXPECT_EQ(r1.data, r2.data);
+    EXPECT_EQ(r1.data, r3);
+    EXPECT_EQ(20u, r2.nUpdated);
+    for (size_t i = 0; i < groups1.size(); ++i) {
+        EXPECT_EQ(groups1[i]->sync.fingerprint, groups2[i]->sync.fingerprint);
+        EXPECT_EQ(groups1[i]->sync.fingerprint, groups3[i]->sync.fingerprint);
+        ASSERT_EQ(groups1[i]->children.size(), groups2[i]->children.size());
+        for (size_t j = 0; j < groups1[i]->children.size(); ++j) {
+            auto& t1 = static_cast<tr::Text&>(*groups1[i]->children[j]);
+            auto& t2 = static_cast<tr::Text&>(*groups2[i]->children[j]);
+            EXPECT_EQ(t1.id, t2.id);
+            EXPECT_EQ(t1.tr.original, t2.tr.original);
+        }
+    }
+    EXPECT_EQ(20u, prj2->updateSyncGroups(8).nSkipped);
+}
+
+
+///
+///  Failed group does not prevent others from updating
+///
+TEST (SyncGroups, Error)
+{
+    ut::TempDir dir("utranslator_test_sync_error");
+    auto prj = makeProject(dir.path, 3, 2);
+    auto groups = prj->syncGroups();
+    std::filesystem::remove(groups[1]->sync.absPath);
+
+    auto r = prj->updateSyncGroups(4);
+    EXPECT_FALSE(r.isOk());
+    EXPECT_EQ(2u, r.nUpdated);
+    ASSERT_EQ(1u, r.errors.size());
+    EXPECT_EQ(groups[1], r.errors[0].group);
+    EXPECT_FALSE(r.errors[0].message.empty());
+    EXPECT_TRUE(groups[1]->children.empty());
+    EXPECT_FALSE(groups[1]->sync.fingerprint);
+    EXPECT_EQ(2u, groups[2]->children.size());
+}
+
+
+///
+///  Fingerprint is saved to project, and read from both XML and snapshot
+///
+TEST (SyncGroups, Save)
+{
+    ut::TempDir dir("utranslator_test_sync_save");
+    auto fname = dir.path / "prj.uorig";
+    auto prj = makeProject(dir.path, 2, 2);
+    prj->updateSyncGroups();
+    auto fp = prj->syncGroups()[1]->sync.fingerprint;
+    ASSERT_TRUE(fp);
+    prj->save(fname);
+
+    // 1st load from XML, 2nd from snapshot
+    for (int i = 0; i < 2; ++i) {
+        auto prj2 = tr::Project::make();
+        prj2->load(fname, nullptr, tr::LoadMode::CACHE);
+        auto groups = prj2->syncGroups();
+        ASSERT_EQ(2u, groups.size());
+        EXPECT_EQ(fp, groups[1]->sync.fingerprint);
+        EXPECT_EQ(2u, prj2->updateSyncGroups().nSkipped);
+    }
+}
+
+
+///
+///  Update of hundreds of Qt forms: serial, parallel, unchanged,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (SyncGroups, DISABLED_Benchmark)
+{
+    constexpr int N_GROUPS = 400;
+    constexpr int N_LABELS = 60;
+    ut::TempDir dir("utranslator_bench_sync");
+    auto prj = makeProject(dir.path, N_GROUPS, N_LABELS);
+    prj->updateSyncGroups();
+    auto groups = prj->syncGroups();
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    for (auto& v : groups)
+        v->sync.fingerprint = {};
+    auto start = Clock::now();
+    tr::UpdateInfo r;
+    for (auto& v : groups)
+        r += v->updateData();
+    auto oldTime = Ms(Clock::now() - start).count();
+
+    for (auto& v : groups)
+        v->sync.fingerprint = {};
+    start = Clock::now();
+    auto r1 = prj->updateSyncGroups(1);
+    auto serialTime = Ms(Clock::now() - start).count();
+
+    for (auto& v : groups)
+        v->sync.fingerprint = {};
+    start = Clock::now();
+    auto r2 = prj->updateSyncGroups(0);
+    auto parallelTime = Ms(Clock::now() - start).count();
+
+    start = Clock::now();
+    auto r3 = prj->updateSyncGroups(0);
+    auto skipTime = Ms(Clock::now() - start).count();
+
+    EXPECT_EQ(size_t{N_GROUPS}, r1.nUpdated);
+    EXPECT_EQ(size_t{N_GROUPS}, r2.nUpdated);
+    EXPECT_EQ(size_t{N_GROUPS}, r3.nSkipped);
+    std::cout << N_GROUPS << " forms × " << N_LABELS << " texts, "
+              << std::thread::hardware_concurrency() << " threads\n"
+              << "Group::updateData one by one: " << oldTime << " ms\n"
+              << "Serial: " << serialTime << " ms\n"
+              << "Parallel: " << parallelTime << " ms\n"
+              << "Unchanged, skipped: " << skipTime << " ms\n";
+}
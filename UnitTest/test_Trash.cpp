@@ -0,0 +1,164 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+
+namespace {
+
+    constexpr unsigned N_TEXTS = 10;
+
+    std::u8string textId(unsigned i)
+        { return u8"t" + std::u8string(1, u8'0' + i); }
+
+    std::u8string textOrig(unsigned i)
+        { return u8"orig" + std::u8string(1, u8'0' + i); }
+
+    /// Original project with N_TEXTS texts, except the one excluded
+    std::shared_ptr<tr::Project> makeOriginal(unsigned excluded = N_TEXTS)
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::ORIGINAL;
+        auto file = prj->addFile(u8"f", tr::Modify::NO);
+        for (unsigned i = 0; i < N_TEXTS; ++i) {
+            if (i != excluded)
+                file->addText(textId(i), textOrig(i), tr::Modify::NO);
+        }
+        return prj;
+    }
+
+    /// Translation project, all texts translated
+    std::shared_ptr<tr::Project> makeTranslation(const tr::Project& original)
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        prj->updateData(tr::TrashMode::FILL, &original);
+        return prj;
+    }
+
+    /// Translates untranslated texts
+    void translate(tr::Project& prj, std::u8string_view suffix)
+    {
+        prj.traverseTexts([suffix](tr::UiObject& obj, tr::Translatable& t) {
+            if (!t.translation) {
+                std::u8string s = u8"tr:";
+                s += obj.idColumn();
+                s += suffix;
+                t.translation = s;
+            }
+        });
+    }
+
+    const tr::StoringIdChain CHAIN3 { .fileName = u8"f", .ids = { u8"t3" } };
+
+}   // anon namespace
+
+
+///
+///  The same text lost again and again is stored once
+///
+TEST (Trash, SameLineOnce)
+{
+    auto full = makeOriginal();
+    auto lacking = makeOriginal(3);
+    auto prj = makeTranslation(*full);
+    translate(*prj, u8"");
+    EXPECT_TRUE(prj->trash.isEmpty());
+
+    for (unsigned i = 0; i < 100; ++i) {
+        prj->updateData(tr::TrashMode::FILL, lacking.get());
+        prj->updateData(tr::TrashMode::FILL, full.get());
+        translate(*prj, u8"");
+    }
+    ASSERT_EQ(1u, prj->trash.size());
+    // One more for makeTranslation
+    EXPECT_EQ(201u, prj->trash.generation());
+    auto& line = prj->trash[0];
+    EXPECT_EQ(CHAIN3, line.chain);
+    EXPECT_EQ(u8"orig3", line.tr.original.sv());
+    EXPECT_EQ(u8"tr:t3", line.tr.translationSv());
+    // Renewed by the last loss
+    EXPECT_EQ(200u, line.generation);
+
+    EXPECT_EQ(0u, prj->trash.findChain(CHAIN3));
+    EXPECT_FALSE(prj->trash.findChain({ .fileName = u8"f", .ids = { u8"t4" } }));
+    EXPECT_FALSE(prj->trash.findChain({ .fileName = u8"g", .ids = { u8"t3" } }));
+    EXPECT_EQ(SafeVector<size_t>{ 0 }, prj->trash.findOriginal(u8"orig3"));
+    EXPECT_TRUE(prj->trash.findOriginal(u8"orig4").empty());
+
+    // LEAVE mode does not touch trash
+    prj->updateData(tr::TrashMode::LEAVE, lacking.get());
+    EXPECT_EQ(201u, prj->trash.generation());
+    EXPECT_EQ(1u, prj->trash.size());
+}
+
+
+///
+///  Different translations are different lines;
+///  newest one is found by ID chain
+///
+TEST (Trash, Lookup)
+{
+    auto full = makeOriginal();
+    auto lacking = makeOriginal(3);
+    auto prj = makeTranslation(*full);
+    for (unsigned i = 0; i < 5; ++i) {
+        translate(*prj, std::u8string(1, u8'a' + (i % 3)));
+        prj->updateData(tr::TrashMode::FILL, lacking.get());
+        prj->updateData(tr::TrashMode::FILL, full.get());
+    }
+    // a, b, c, a, b → 3 lines, b is newest
+    ASSERT_EQ(3u, prj->trash.size());
+    auto newest = prj->trash.findChain(CHAIN3);
+    ASSERT_TRUE(newest);
+    EXPECT_EQ(u8"tr:t3b", prj->trash[*newest].tr.translationSv());
+    EXPECT_EQ((SafeVector<size_t>{ 0, 1, 2 }), prj->trash.findOriginal(u8"orig3"));
+}
+
+
+///
+///  Limits drop oldest lines, passport changes then
+///
+TEST (Trash, Limits)
+{
+    auto full = makeOriginal();
+    auto lacking = makeOriginal(3);
+    auto prj = makeTranslation(*full);
+    // Unlimited unless opted in
+    EXPECT_EQ(0u, prj->trash.limits.maxLines);
+    EXPECT_EQ(0u, prj->trash.limits.maxAge);
+    prj->trash.limits.maxLines = 10;
+    for (unsigned i = 0; i < 50; ++i) {
+        translate(*prj, u8"#" + std::u8string(1, u8'0' + i % 10)
+                              + std::u8string(1, u8'0' + i / 10));
+        auto oldPassport = prj->trash.passport;
+        auto oldSize = prj->trash.size();
+        prj->updateData(tr::TrashMode::FILL, lacking.get());
+        prj->updateData(tr::TrashMode::FILL, full.get());
+        EXPECT_LE(prj->trash.size(), 10u);
+        EXPECT_EQ(oldSize == 10, oldPassport != prj->trash.passport) << i;
+    }
+    ASSERT_EQ(10u, prj->trash.size());
+    // Lines are still in order of addition, and indexed
+    for (unsigned i = 0; i < 10; ++i) {
+        auto n = 40 + i;
+        std::u8string expected = u8"tr:t3#";
+        expected += char8_t(u8'0' + n % 10);
+        expected += char8_t(u8'0' + n / 10);
+        EXPECT_EQ(expected, prj->trash[i].tr.translationSv());
+    }
+    EXPECT_EQ(9u, prj->trash.findChain(CHAIN3));
+    EXPECT_EQ(10u, prj->trash.findOriginal(u8"orig3").size());
+
+    // Age: only lines lost in the last 3 updates
+    prj->trash.limits.maxAge = 3;
+    prj->updateData(tr::TrashMode::FILL, lacking.get());
+    ASSERT_EQ(1u, prj->trash.size());
+    EXPECT_EQ(u8"tr:t3#94", prj->trash[0].tr.translationSv());
+    EXPECT_EQ(0u, prj->trash.findChain(CHAIN3));
+
+    prj->trash.clear();
+    EXPECT_TRUE(prj->trash.isEmpty());
+    EXPECT_FALSE(prj->trash.findChain(CHAIN3));
+}
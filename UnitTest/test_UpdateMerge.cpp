@@ -0,0 +1,443 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+// Project
+#include "TrFile.h"
+
+
+///
+///  Differential tests: MERGE update engine gives the same as STEAL one
+///
+
+namespace {
+
+    using Rng = std::mt19937;
+
+    std::u8string numbered(std::u8string_view prefix, unsigned n)
+        { return std::u8string{prefix} + str::toU8(std::to_string(n)); }
+
+    bool chance(Rng& rng, unsigned percent)
+        { return std::uniform_int_distribution<unsigned>(0, 99)(rng) < percent; }
+
+    unsigned upTo(Rng& rng, unsigned n)
+        { return std::uniform_int_distribution<unsigned>(0, n)(rng); }
+
+    ///// Random trees /////////////////////////////////////////////////////////
+
+    /// Small alphabets → duplicate text IDs, same originals
+    void addRandomText(tr::VirtualGroup& group, Rng& rng)
+    {
+        auto text = group.addText(numbered(u8"t", upTo(rng, 12)),
+                                  numbered(u8"orig", upTo(rng, 5)), tr::Modify::NO);
+        if (chance(rng, 20))
+            text->comm.importers = numbered(u8"imp", upTo(rng, 2));
+        if (chance(rng, 10))
+            text->comm.authors = numbered(u8"au", upTo(rng, 2));
+    }
+
+    /// Group IDs are unique within parent
+    std::shared_ptr<tr::Group> addRandomGroup(tr::VirtualGroup& parent, Rng& rng)
+    {
+        std::u8string id;
+        do {
+            id = numbered(u8"g", upTo(rng, 6));
+        } while (parent.findGroup(id));
+        auto group = parent.addGroup(id, tr::Modify::NO);
+        if (chance(rng, 10)) {
+            group->sync.format = tf::UiProto::INST.make();
+            group->sync.absPath = numbered(u8"/form", upTo(rng, 3));
+            group->sync.info.textOwner = chance(rng, 50)
+                    ? tf::TextOwner::ME : tf::TextOwner::EDITOR;
+        }
+        if (chance(rng, 20))
+            group->comm.authors = numbered(u8"au", upTo(rng, 2));
+        return group;
+    }
+
+    void fillGroup(tr::VirtualGroup& group, Rng& rng, int depth)
+    {
+        auto n = upTo(rng, 8);
+        for (unsigned i = 0; i < n; ++i) {
+            if (depth < 3 && chance(rng, 25)) {
+                auto sub = addRandomGroup(group, rng);
+                fillGroup(*sub, rng, depth + 1);
+            } else {
+                addRandomText(group, rng);
+            }
+        }
+    }
+
+    std::shared_ptr<tr::File> addRandomFile(tr::Project& prj, Rng& rng)
+    {
+        std::u8string name;
+        do {
+            name = numbered(u8"file", upTo(rng, 6));
+        } while (prj.findFile(name));
+        auto file = prj.addFile(name, tr::Modify::NO);
+        file->info.isIdless = chance(rng, 20);
+        file->info.origPath = numbered(u8"/src", upTo(rng, 2));
+        fillGroup(*file, rng, 0);
+        return file;
+    }
+
+    std::shared_ptr<tr::Project> makeOriginal(Rng& rng)
+    {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::ORIGINAL;
+        auto n = 1 + upTo(rng, 3);
+        for (unsigned i = 0; i < n; ++i)
+            addRandomFile(*prj, rng);
+        return prj;
+    }
+
+    /// Changes originals, deletes, adds, reorders, moves texts
+    void mutateGroup(tr::VirtualGroup& group, Rng& rng, int depth)
+    {
+        for (size_t i = group.children.size(); i-- > 0; ) {
+            auto& v = group.children[i];
+            if (chance(rng, 10)) {
+                group.extractChild(i, tr::Modify::NO);
+            } else if (auto text = std::dynamic_pointer_cast<tr::Text>(v)) {
+                if (chance(rng, 20))
+                    text->tr.original = numbered(u8"orig", upTo(rng, 5));
+                if (chance(rng, 10))
+                    text->comm.importers = numbered(u8"imp", upTo(rng, 2));
+            } else if (auto sub = std::dynamic_pointer_cast<tr::Group>(v)) {
+                mutateGroup(*sub, rng, depth + 1);
+            }
+        }
+        if (chance(rng, 25)) {
+            std::shuffle(group.children.begin(), group.children.end(), rng);
+            group.dropChildIndex();
+            group.recache();
+        }
+        // Text moved to subgroup
+        if (!group.children.empty() && chance(rng, 20)) {
+            auto i = upTo(rng, group.children.size() - 1);
+            auto sub = std::dynamic_pointer_cast<tr::Group>(group.children[i]);
+            auto text = std::dynamic_pointer_cast<tr::Text>(group.children[0]);
+            if (sub && text) {
+                sub->addText(text->id, text->tr.original, tr::Modify::NO);
+                group.extractChild(0, tr::Modify::NO);
+            }
+        }
+        auto nAdded = chance(rng, 30) ? upTo(rng, 3) : 0;
+        for (unsigned i = 0; i < nAdded; ++i) {
+            if (depth < 3 && chance(rng, 25)) {
+                fillGroup(*addRandomGroup(group, rng), rng, depth + 1);
+            } else {
+                addRandomText(group, rng);
+            }
+        }
+    }
+
+    void mutateOriginal(tr::Project& prj, Rng& rng)
+    {
+        for (size_t i = prj.files.size(); i-- > 0; ) {
+            if (chance(rng, 10)) {
+                prj.extractChild(i, tr::Modify::NO);
+            } else {
+                mutateGroup(*prj.files[i], rng, 0);
+            }
+        }
+        if (chance(rng, 20))
+            addRandomFile(prj, rng);
+        if (chance(rng, 20)) {
+            std::shuffle(prj.files.begin(), prj.files.end(), rng);
+            prj.recache();
+        }
+    }
+
+    /// Translates, comments, forces attention, sets known originals
+    void decorateTranslation(tr::Project& prj, Rng& rng)
+    {
+        prj.traverseTexts([&rng](tr::UiObject& obj, tr::Translatable& t) {
+            if (chance(rng, 70))
+                t.translation = numbered(u8"transl", upTo(rng, 3));
+            t.forceAttention = chance(rng, 10);
+            t.wasChangedToday = chance(rng, 10);
+            if (chance(rng, 20)) {
+                t.knownOriginal.text = numbered(u8"orig", upTo(rng, 5));
+                t.knownOriginal.isSuppressed = chance(rng, 30);
+            }
+            if (chance(rng, 10))
+                t.reference = u8"ref";
+            if (chance(rng, 10))
+                obj.comments()->translators = u8"tr-cmt";
+        });
+        for (auto& file : prj.files) {
+            if (chance(rng, 50))
+                file->info.translPath = u8"/transl";
+            if (chance(rng, 20))
+                file->comm.translators = u8"file-cmt";
+        }
+    }
+
+    ///  Everything random is got from seed, so the case is built
+    ///    as many times as we want
+    struct Case {
+        std::shared_ptr<tr::Project> translation;
+        SafeVector<std::shared_ptr<tr::Project>> originals;  ///< updated one after another
+    };
+
+    Case makeCase(unsigned seed, size_t nUpdates)
+    {
+        Rng rng(seed);
+        Case r;
+        auto orig = makeOriginal(rng);
+        r.translation = tr::Project::make();
+        r.translation->info.type = tr::PrjType::FULL_TRANSL;
+        r.translation->updateData(tr::TrashMode::FILL, orig.get());
+        decorateTranslation(*r.translation, rng);
+        for (size_t i = 0; i < nUpdates; ++i) {
+            auto next = tr::Project::make();
+            next->copyFrom(*orig);
+            mutateOriginal(*next, rng);
+            r.originals.push_back(next);
+            orig = next;
+        }
+        return r;
+    }
+
+    ///// Comparison ///////////////////////////////////////////////////////////
+
+    void expectSame(const tr::Translatable& x, const tr::Translatable& y)
+    {
+        EXPECT_EQ(x.original, y.original);
+        EXPECT_EQ(x.knownOriginal.text, y.knownOriginal.text);
+        EXPECT_EQ(x.knownOriginal.isSuppressed, y.knownOriginal.isSuppressed);
+        EXPECT_EQ(x.reference, y.reference);
+        EXPECT_EQ(x.translation, y.translation);
+        EXPECT_EQ(x.forceAttention, y.forceAttention);
+        EXPECT_EQ(x.wasChangedToday, y.wasChangedToday);
+        EXPECT_EQ(x.trashState, y.trashState);
+    }
+
+    void expectSame(tr::UiObject& x, tr::UiObject& y)
+    {
+        SCOPED_TRACE(str::toSv(x.idColumn()));
+        ASSERT_EQ(x.objType(), y.objType());
+        EXPECT_EQ(x.idColumn(), y.idColumn());
+        EXPECT_EQ(x.cache.index, y.cache.index);
+        EXPECT_EQ(x.cache.stats, y.cache.stats);
+        for (auto ch : { tr::Mch::META, tr::Mch::ID, tr::Mch::ORIG, tr::Mch::TRANSL, tr::Mch::COMMENT })
+            EXPECT_EQ(x.cache.mod.has(ch), y.cache.mod.has(ch));
+        if (auto cx = x.comments()) {
+            auto cy = y.comments();
+            EXPECT_EQ(cx->importers, cy->importers);
+            EXPECT_EQ(cx->authors, cy->authors);
+            EXPECT_EQ(cx->translators, cy->translators);
+        }
+        if (auto ex = dynamic_cast<tr::Entity*>(&x)) {
+            EXPECT_EQ(ex->state, dynamic_cast<tr::Entity&>(y).state);
+        }
+        if (auto tx = x.translatable())
+            expectSame(*tx, *y.translatable());
+        if (auto gx = dynamic_cast<tr::Group*>(&x)) {
+            auto& gy = dynamic_cast<tr::Group&>(y);
+            EXPECT_EQ(static_cast<bool>(gx->sync), static_cast<bool>(gy.sync));
+            EXPECT_EQ(gx->sync.absPath, gy.sync.absPath);
+            EXPECT_EQ(gx->sync.info.textOwner, gy.sync.info.textOwner);
+            EXPECT_EQ(gx->sync.fingerprint, gy.sync.fingerprint);
+        }
+        if (auto fx = dynamic_cast<tr::File*>(&x)) {
+            auto& fy = dynamic_cast<tr::File&>(y);
+            EXPECT_EQ(static_cast<bool>(fx->info.format), static_cast<bool>(fy.info.format));
+            EXPECT_EQ(fx->info.origPath, fy.info.origPath);
+            EXPECT_EQ(fx->info.translPath, fy.info.translPath);
+            EXPECT_EQ(fx->info.isIdless, fy.info.isIdless);
+        }
+        ASSERT_EQ(x.nChildren(), y.nChildren());
+        for (size_t i = 0; i < x.nChildren(); ++i) {
+            auto chx = x.child(i);
+            auto chy = y.child(i);
+            // Parents are fixed
+            EXPECT_EQ(&x, chx->parent().get());
+            EXPECT_EQ(&y, chy->parent().get());
+            expectSame(*chx, *chy);
+        }
+    }
+
+    void expectSame(const tr::Trash& x, const tr::Trash& y)
+    {
+        EXPECT_EQ(x.generation(), y.generation());
+        ASSERT_EQ(x.size(), y.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            auto& lx = x[i];
+            auto& ly = y[i];
+            EXPECT_EQ(lx.chain.fileName, ly.chain.fileName);
+            EXPECT_EQ(lx.chain.ids, ly.chain.ids);
+            EXPECT_EQ(lx.generation, ly.generation);
+            expectSame(lx.tr, ly.tr);
+        }
+    }
+
+    void expectSame(tr::Project& x, tr::Project& y)
+    {
+        EXPECT_EQ(x.info.orig.lang, y.info.orig.lang);
+        expectSame(static_cast<tr::UiObject&>(x), static_cast<tr::UiObject&>(y));
+        expectSame(x.trash, y.trash);
+    }
+
+    /// Updates a and b with different engines, checks them
+    void updateAndCheck(tr::Project& a, tr::Project& b, const tr::Project* original)
+    {
+        auto ra = a.updateData(tr::TrashMode::FILL, original, nullptr, tr::UpdateEngine::STEAL);
+        auto rb = b.updateData(tr::TrashMode::FILL, original, nullptr, tr::UpdateEngine::MERGE);
+        EXPECT_EQ(ra, rb);
+        expectSame(a, b);
+    }
+
+}   // anon namespace
+
+
+///
+///  Samples: translations are updated from original files
+///
+TEST (UpdateMerge, Samples)
+{
+    auto srcDir = ut::samplesDir();
+    ASSERT_TRUE(std::filesystem::is_directory(srcDir)) << "No samples in " << srcDir;
+    ut::TempDir dir("utranslator_test_merge_samples");
+    std::filesystem::copy(srcDir, dir.path, std::filesystem::copy_options::recursive);
+
+    size_t nProjects = 0;
+    for (auto& entry : std::filesystem::recursive_directory_iterator(dir.path)) {
+        if (entry.path().extension() != ".utran")
+            continue;
+        SCOPED_TRACE(entry.path().string());
+        auto a = tr::Project::make();
+        auto b = tr::Project::make();
+        a->load(entry.path());
+        b->load(entry.path());
+        updateAndCheck(*a, *b, nullptr);
+        ++nProjects;
+    }
+    EXPECT_EQ(3u, nProjects);
+}
+
+
+///
+///  Random trees, several updates in a row, original in memory
+///
+TEST (UpdateMerge, Random)
+{
+    for (unsigned seed = 1; seed <= 300; ++seed) {
+        SCOPED_TRACE(seed);
+        auto a = makeCase(seed, 3);
+        auto b = makeCase(seed, 3);
+        auto pristine = makeCase(seed, 3);
+        for (size_t i = 0; i < a.originals.size(); ++i) {
+            updateAndCheck(*a.translation, *b.translation, b.originals[i].get());
+            // Original is just read
+            expectSame(*pristine.originals[i], *b.originals[i]);
+            if (testing::Test::HasFailure())
+                return;
+        }
+    }
+}
+
+
+///
+///  Random trees, original loaded from file and taken
+///
+TEST (UpdateMerge, RandomFromFile)
+{
+    ut::TempDir dir("utranslator_test_merge_file");
+    for (unsigned seed = 1; seed <= 50; ++seed) {
+        SCOPED_TRACE(seed);
+        auto a = makeCase(seed, 2);
+        auto b = makeCase(seed, 2);
+        for (size_t i = 0; i < a.originals.size(); ++i) {
+            auto fname = dir.path / ("orig" + std::to_string(seed) + "-"
+                                     + std::to_string(i) + ".uorig");
+            a.originals[i]->save(fname);
+            a.translation->info.orig.absPath = fname;
+            b.translation->info.orig.absPath = fname;
+            updateAndCheck(*a.translation, *b.translation, nullptr);
+            if (testing::Test::HasFailure())
+                return;
+        }
+    }
+}
+
+
+///
+///  Update of a large project by both engines,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (UpdateMerge, DISABLED_Benchmark)
+{
+    constexpr unsigned N_FILES = 20;
+    constexpr unsigned N_GROUPS = 50;
+    constexpr unsigned N_TEXTS = 200;
+    ut::TempDir dir("utranslator_bench_merge");
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    // Every 20th original is changed, every 50th text is gone
+    auto makeOrig = [](bool isNew) {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::ORIGINAL;
+        for (unsigned i = 0; i < N_FILES; ++i) {
+            auto file = prj->addFile(numbered(u8"file", i), tr::Modify::NO);
+            for (unsigned j = 0; j < N_GROUPS; ++j) {
+                auto group = file->addGroup(numbered(u8"g", j), tr::Modify::NO);
+                for (unsigned k = 0; k < N_TEXTS; ++k) {
+                    if (isNew && k % 50 == 7)
+                        continue;
+                    auto orig = numbered(u8"Some original text #", k);
+                    if (isNew && k % 20 == 3)
+                        orig += u8" changed";
+                    group->addText(numbered(u8"t", k), orig, tr::Modify::NO);
+                }
+            }
+        }
+        return prj;
+    };
+    auto oldOrig = makeOrig(false);
+    auto newOrig = makeOrig(true);
+    auto fname = dir.path / "new.uorig";
+    newOrig->save(fname);
+    tr::Project::make()->load(fname, nullptr, tr::LoadMode::CACHE);   // make snapshot
+    auto makeTransl = [&oldOrig, &fname] {
+        auto prj = tr::Project::make();
+        prj->info.type = tr::PrjType::FULL_TRANSL;
+        prj->info.orig.absPath = fname;
+        prj->updateData(tr::TrashMode::FILL, oldOrig.get());
+        prj->traverseTexts1([](tr::Translatable& t) {
+            t.translation = u8"Some translation";
+        });
+        return prj;
+    };
+
+    auto time = [&](const tr::Project* original, tr::UpdateEngine engine) {
+        auto prj = makeTransl();
+        auto start = Clock::now();
+        auto r = prj->updateData(tr::TrashMode::FILL, original, nullptr, engine);
+        auto ms = Ms(Clock::now() - start).count();
+        EXPECT_EQ(N_FILES * N_GROUPS * (N_TEXTS / 50), r.deleted.nTotal());
+        return ms;
+    };
+    auto stealMemory = time(newOrig.get(), tr::UpdateEngine::STEAL);
+    auto mergeMemory = time(newOrig.get(), tr::UpdateEngine::MERGE);
+    auto stealFile = time(nullptr, tr::UpdateEngine::STEAL);
+    auto mergeFile = time(nullptr, tr::UpdateEngine::MERGE);
+    std::cout << N_FILES * N_GROUPS * N_TEXTS << " texts\n"
+              << "Original in memory, steal: " << stealMemory << " ms\n"
+              << "Original in memory, merge: " << mergeMemory << " ms\n"
+              << "Original from file, steal: " << stealFile << " ms\n"
+              << "Original from file, merge: " << mergeFile << " ms\n";
+}
@@ -0,0 +1,293 @@
+// What we test
+#include "TrProject.h"
+
+// Google test
+#include "gtest/gtest.h"
+
+// Test helpers
+#include "TempFiles.h"
+
+// C++
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <span>
+
+// Project
+#include "TrFile.h"
+
+
+///
+///  FileWalker, as exporters see it, against the walk it replaced:
+///    traverse the file first, then climb parents for IDs
+///
+
+namespace {
+
+    using Rng = std::mt19937;
+
+    bool chance(Rng& rng, unsigned percent)
+        { return std::uniform_int_distribution<unsigned>(0, 99)(rng) < percent; }
+
+    unsigned upTo(Rng& rng, unsigned n)
+        { return std::uniform_int_distribution<unsigned>(0, n)(rng); }
+
+    std::u8string numbered(std::u8string_view prefix, unsigned n)
+        { return std::u8string{prefix} + str::toU8(std::to_string(n)); }
+
+    /// Line per text, every field of TextInfo
+    void appendLine(std::string& r, int prevDepth, int commonDepth,
+                    std::span<const std::u8string_view> ids,
+                    std::u8string_view text, std::u8string_view original,
+                    std::u8string_view translation, bool isFallbackLocale)
+    {
+        r += std::to_string(prevDepth);
+        r += ' ';
+        r += std::to_string(commonDepth);
+        for (auto v : ids) {
+            r += '/';
+            r += str::toSv(v);
+        }
+        r += '|';
+        r += str::toSv(text);
+        r += '|';
+        r += str::toSv(original);
+        r += '|';
+        r += str::toSv(translation);
+        r += isFallbackLocale ? "|fallback\n" : "\n";
+    }
+
+    class RecordingProto final : public tf::FormatProto
+    {
+    public:
+        Flags<tf::Fcap> caps() const noexcept override { return tf::Fcap::EXPORT; }
+        Flags<tf::Usfg> workingSets() const noexcept override { return {}; }
+        std::unique_ptr<tf::FileFormat> make() const override;
+        std::u8string_view locName() const override { return u8"Recording"; }
+        constexpr std::string_view techName() const noexcept override { return "recording"; }
+        std::u8string_view locDescription() const override { return {}; }
+        std::u8string_view locSoftware() const override { return {}; }
+        std::u8string_view locIdType() const override { return {}; }
+        filedlg::Filter fileFilter() const override { return {}; }
+        static const RecordingProto INST;
+    };
+
+    ///  Writes everything walker gives, or just counts texts
+    class Recording final : public tf::FileFormat
+    {
+    public:
+        tr::WalkOrder order = tr::WalkOrder::EXACT;
+        bool countOnly = false;
+        inline static size_t nCounted = 0;
+
+        void doExport(
+                tf::Walker& walker,
+                const std::filesystem::path&,
+                const std::filesystem::path& fnExported) override
+        {
+            std::string r;
+            size_t n = 0;
+            while (auto& q = walker.nextText()) {
+                if (countOnly) {
+                    ++n;
+                } else {
+                    appendLine(r, q.prevDepth, q.commonDepth, q.ids, q.text,
+                               q.original, q.translation, q.isFallbackLocale);
+                }
+            }
+            nCounted += n;
+            ut::writeFile(fnExported, r);
+        }
+        const RecordingProto& proto() const override { return RecordingProto::INST; }
+        std::unique_ptr<tf::FileFormat> clone() override
+            { return std::make_unique<Recording>(*this); }
+        tr::WalkOrder walkOrder() const override { return order; }
+        void save(pugi::xml_node&) const override {}
+        void load(const pugi::xml_node&) override {}
+    };
+
+    const RecordingProto RecordingProto::INST;
+
+    std::unique_ptr<tf::FileFormat> RecordingProto::make() const
+        { return std::make_unique<Recording>(); }
+
+    ///  Walk as it was: traverse remembers depths, IDs come from parents
+    class OldWalk final : public tr::TraverseListener
+    {
+    public:
+        std::string run(tr::File& file, tr::WalkOrder order, tr::WalkChannel channel);
+    private:
+        struct DepthInfo {
+            int commonDepth = 0, newDepth = 0;
+            std::shared_ptr<tr::Text> text {};
+        };
+        SafeVector<DepthInfo> texts;
+        DepthInfo depthInfo;
+
+        void onEnterGroup(const std::shared_ptr<tr::VirtualGroup>&) override
+            { ++depthInfo.newDepth; }
+        void onLeaveGroup(const std::shared_ptr<tr::VirtualGroup>&) override
+        {
+            if ((--depthInfo.newDepth) < depthInfo.commonDepth)
+                depthInfo.commonDepth = depthInfo.newDepth;
+        }
+        void onText(const std::shared_ptr<tr::Text>& x) override
+        {
+            auto& v = texts.emplace_back(depthInfo);
+            v.text = x;
+            depthInfo.commonDepth = depthInfo.newDepth;
+        }
+    };
+
+    std::string OldWalk::run(tr::File& file, tr::WalkOrder order, tr::WalkChannel channel)
+    {
+        texts.clear();
+        depthInfo = {};
+        file.traverse(*this, order, tr::EnterMe::NO);
+
+        std::string r;
+        int prevDepth = -1;
+        std::vector<std::u8string_view> ids;
+        for (auto& di : texts) {
+            ids.resize(di.newDepth + 1);
+            ids.back() = di.text->id;
+            auto p = di.text->parent();
+            for (auto depth = di.newDepth; depth > 0; p = p->parent())
+                ids[--depth] = p->idColumn();
+            auto& t = di.text->tr;
+            bool isFallback = (channel == tr::WalkChannel::TRANSLATION && !t.translation);
+            auto text = (channel == tr::WalkChannel::TRANSLATION && t.translation)
+                    ? t.translationSv() : t.original.sv();
+            appendLine(r, prevDepth, di.commonDepth, ids, text,
+                       t.original.sv(), t.translationSv(), isFallback);
+            prevDepth = di.newDepth;
+        }
+        return r;
+    }
+
+    /// Empty groups, texts before/after/between groups, deep nesting
+    void fillGroup(tr::VirtualGroup& group, Rng& rng, int depth)
+    {
+        for (auto n = upTo(rng, 6); n != 0; --n) {
+            if (depth < 4 && chance(rng, 30)) {
+                auto sub = group.addGroup(numbered(u8"g", upTo(rng, 1000)), tr::Modify::NO);
+                fillGroup(*sub, rng, depth + 1);
+            } else {
+                auto text = group.addText(numbered(u8"t", upTo(rng, 1000)),
+                                          numbered(u8"orig", upTo(rng, 1000)),
+                                          tr::Modify::NO);
+                if (chance(rng, 50))
+                    text->tr.translation = numbered(u8"transl", upTo(rng, 1000));
+            }
+        }
+    }
+
+    Recording& recording(tr::File& file)
+        { return dynamic_cast<Recording&>(*file.info.format); }
+
+}   // anon namespace
+
+
+///
+///  Random files: the same TextInfo’s in both orders and channels
+///
+TEST (Walker, Random)
+{
+    ut::TempDir dir("utranslator_test_walker");
+    OldWalk oldWalk;
+    for (unsigned seed = 1; seed <= 300; ++seed) {
+        SCOPED_TRACE(seed);
+        Rng rng(seed);
+        auto prj = tr::Project::make();
+        auto file = prj->addFile(u8"f.txt", tr::Modify::NO);
+        file->info.format = RecordingProto::INST.make();
+        fillGroup(*file, rng, 0);
+
+        for (auto type : { tr::PrjType::ORIGINAL, tr::PrjType::FULL_TRANSL }) {
+            prj->info.type = type;
+            for (auto order : { tr::WalkOrder::EXACT, tr::WalkOrder::ECONOMY }) {
+                recording(*file).order = order;
+                ASSERT_TRUE(prj->doBuild(dir.path).isOk());
+                EXPECT_EQ(oldWalk.run(*file, order, prj->walkChannel()),
+                          ut::readFile(dir.path / "f.txt"));
+            }
+        }
+    }
+}
+
+
+///
+///  Pseudo-localization: untranslated texts only
+///
+TEST (Walker, PseudoLoc)
+{
+    ut::TempDir dir("utranslator_test_walker");
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::FULL_TRANSL;
+    prj->info.transl.pseudoloc = tr::PrjInfo::Transl::Pseudoloc::DFLT;
+    ASSERT_TRUE(prj->info.wantPseudoLoc());
+    auto file = prj->addFile(u8"f.txt", tr::Modify::NO);
+    file->info.format = RecordingProto::INST.make();
+    file->addText(u8"t1", u8"One", tr::Modify::NO)->tr.translation = u8"Uno";
+    file->addText(u8"t2", u8"Two", tr::Modify::NO);
+
+    ASSERT_TRUE(prj->doBuild(dir.path).isOk());
+    auto data = ut::readFile(dir.path / "f.txt");
+    auto eol = data.find('\n');
+    EXPECT_EQ("-1 0/t1|Uno|One|Uno", data.substr(0, eol));
+    auto line2 = data.substr(eol + 1);
+    std::string_view head = "0 0/t2|", tail = "|Two||fallback\n";
+    ASSERT_TRUE(line2.starts_with(head) && line2.ends_with(tail)) << line2;
+    auto text = line2.substr(head.size(), line2.size() - head.size() - tail.size());
+    EXPECT_NE("Two", text);
+    EXPECT_NE(std::string::npos, text.find("Two")) << text;
+}
+
+
+///
+///  Walk throughput, both orders,
+///    run with --gtest_also_run_disabled_tests
+///
+TEST (Walker, DISABLED_Benchmark)
+{
+    constexpr unsigned N_FILES = 40;
+    constexpr unsigned N_GROUPS = 100;
+    constexpr unsigned N_TEXTS = 200;
+    constexpr int N_RUNS = 5;
+    using Clock = std::chrono::steady_clock;
+    using Sec = std::chrono::duration<double>;
+
+    ut::TempDir dir("utranslator_bench_walker");
+    auto prj = tr::Project::make();
+    prj->info.type = tr::PrjType::FULL_TRANSL;
+    for (unsigned i = 0; i < N_FILES; ++i) {
+        auto file = prj->addFile(numbered(u8"file", i), tr::Modify::NO);
+        file->info.format = RecordingProto::INST.make();
+        recording(*file).countOnly = true;
+        for (unsigned j = 0; j < N_GROUPS; ++j) {
+            auto group = file->addGroup(numbered(u8"g", j), tr::Modify::NO);
+            auto sub = group->addGroup(u8"sub", tr::Modify::NO);
+            for (unsigned k = 0; k < N_TEXTS; ++k) {
+                auto& where = (k % 4 == 0) ? *sub : *group;
+                auto text = where.addText(numbered(u8"t", k), u8"Original", tr::Modify::NO);
+                if (k % 2 == 0)
+                    text->tr.translation = u8"Translation";
+            }
+        }
+    }
+
+    for (auto order : { tr::WalkOrder::EXACT, tr::WalkOrder::ECONOMY }) {
+        for (auto& file : prj->files)
+            recording(*file).order = order;
+        double best = 1e30;
+        for (int i = 0; i < N_RUNS; ++i) {
+            Recording::nCounted = 0;
+            auto start = Clock::now();
+            prj->doBuild(dir.path, 1);
+            best = std::min(best, Sec(Clock::now() - start).count());
+            EXPECT_EQ(N_FILES * N_GROUPS * N_TEXTS, Recording::nCounted);
+        }
+        std::cout << (order == tr::WalkOrder::EXACT ? "EXACT" : "ECONOMY") << ": "
+                  << N_FILES * N_GROUPS * N_TEXTS / best / 1e6 << " M texts/s\n";
+    }
+}